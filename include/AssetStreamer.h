@@ -0,0 +1,113 @@
+#ifndef GENERATIONS_ASSETSTREAMER_H
+#define GENERATIONS_ASSETSTREAMER_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "ModelLoader.h"
+#include "Logger.h"
+#include "Components.h"
+
+namespace SGE {
+
+    enum class AssetState {
+        Unloaded,
+        Queued,
+        Loading,
+        Resident,
+        //the file could not be read or is larger than a whole budget, it is not requested again until retried
+        Failed
+    };
+
+    class AssetStreamer {
+    public:
+        AssetStreamer(ModelLoader *modelLoader, size_t cpuBudget, size_t gpuBudget, uint32_t ioThreads);
+
+        ~AssetStreamer();
+
+        //lower priority values are loaded first and may evict resident assets with higher values, the streaming
+        //system passes the camera distance
+        void request(uint32_t id, const std::string &file, float priority);
+
+        //main thread only, uploads finished loads and evicts until both budgets are met
+        void update();
+
+        //lets a failed asset be requested again, called once its file has changed
+        void retry(uint32_t id);
+
+        AssetState getState(uint32_t id) const;
+
+        bool isResident(uint32_t id) const;
+
+        size_t getCpuUsage() const { return cpuUsage; }
+
+        size_t getGpuUsage() const { return gpuUsage; }
+
+    private:
+        struct Asset {
+            std::string file;
+            AssetState state = AssetState::Unloaded;
+            float priority = 0.f;
+            size_t cpuSize = 0;
+            size_t gpuSize = 0;
+            uint64_t lastUsedFrame = 0;
+            //an asset that found no room is not requested again before retryFrame, waiting twice as long each time
+            uint64_t retryFrame = 0;
+            uint32_t backoff = 0;
+            std::list<uint32_t>::iterator lruPosition;
+        };
+
+        struct LoadResult {
+            uint32_t id;
+            //the PregenID the file declares, if its format carries one
+            uint32_t fileId;
+            bool success;
+            MeshComponent mesh;
+            std::string error;
+        };
+
+        void ioLoop();
+
+        void touch(Asset &asset);
+
+        //evicts assets not used this frame, least recently used first, then resident assets further away than
+        //priority, furthest first. Nothing is evicted when that still would not make enough room.
+        bool makeRoom(size_t cpuSize, size_t gpuSize, float priority);
+
+        void evict(uint32_t id, Asset &asset);
+
+
+        ModelLoader *m_modelLoader;
+        Logger *m_logger;
+
+        size_t cpuBudget, gpuBudget;
+        size_t cpuUsage = 0, gpuUsage = 0;
+        uint64_t frame = 0;
+        uint32_t maxInFlight;
+        uint32_t inFlight = 0;
+
+        //main thread state, the front of the lru list is the most recently used asset
+        std::unordered_map<uint32_t, Asset> assets;
+        std::set<std::pair<float, uint32_t>> pending;
+        std::list<uint32_t> lru;
+
+        //shared with the io threads, guarded by m_mutex
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<std::pair<uint32_t, std::string>> jobs;
+        std::vector<LoadResult> completed;
+        bool stopping = false;
+
+        std::vector<std::thread> workers;
+    };
+
+}
+
+#endif //GENERATIONS_ASSETSTREAMER_H
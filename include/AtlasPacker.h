@@ -0,0 +1,105 @@
+#ifndef GENERATIONS_ATLASPACKER_H
+#define GENERATIONS_ATLASPACKER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Components.h"
+
+namespace SGE {
+
+    struct AtlasRect {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    //bottom left skyline packer for one page. The skyline is the outline of everything placed so far, a new
+    //rectangle goes where it rests lowest on it, ties going to the leftmost spot. Cheap enough to pack thousands of
+    //rectangles per page and leaves little waste for sprites sorted by height.
+    class SkylinePacker {
+    public:
+        SkylinePacker(uint32_t width, uint32_t height);
+
+        bool insert(uint32_t width, uint32_t height, AtlasRect &rect);
+
+        uint64_t getUsedArea() const;
+
+        float getOccupancy() const;
+
+    private:
+        struct Segment {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+        };
+
+        //height the rectangle rests at when its left edge is on segment index, or UINT32_MAX when it does not fit
+        uint32_t restingHeight(size_t index, uint32_t width, uint32_t height) const;
+
+        void place(size_t index, const AtlasRect &rect);
+
+        uint32_t width, height;
+        uint64_t usedArea = 0;
+        std::vector<Segment> skyline;
+    };
+
+    struct AtlasSprite {
+        std::string name;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        //hash of the image contents, a changed image changes the input hash even when its size does not
+        uint64_t hash = 0;
+    };
+
+    struct AtlasDesc {
+        uint32_t pageWidth = 2048;
+        uint32_t pageHeight = 2048;
+        //pixels around every sprite, filled with its edge pixels so filtering never reads a neighbour
+        uint32_t padding = 1;
+        uint32_t maxPages = 16;
+    };
+
+    struct AtlasEntry {
+        std::string name;
+        uint32_t page = 0;
+        //the sprite itself, without its padding
+        AtlasRect rect;
+    };
+
+    struct AtlasLayout {
+        AtlasDesc desc;
+        uint64_t inputHash = 0;
+        uint32_t pageCount = 0;
+        //sorted by name
+        std::vector<AtlasEntry> entries;
+
+        const AtlasEntry *find(const std::string &name) const;
+    };
+
+    //packs sprites into as few pages as it can. Sprites are sorted by height, spread over the number of pages their
+    //area needs and every page is packed on its own thread, whatever does not fit is then tried on the pages that
+    //have room left before new pages are opened. The result only depends on the input, never on the thread count,
+    //so it can be cached by hashInputs.
+    class AtlasPacker {
+    public:
+        static uint64_t hashInputs(const std::vector<AtlasSprite> &sprites, const AtlasDesc &desc);
+
+        static bool pack(const std::vector<AtlasSprite> &sprites, const AtlasDesc &desc, AtlasLayout &layout,
+                         std::string &error);
+
+        //text file so cached layouts diff well, the input hash comes first so a stale file is rejected cheaply
+        static bool write(const std::string &path, const AtlasLayout &layout, std::string &error);
+
+        static bool read(const std::string &path, AtlasLayout &layout, std::string &error);
+
+        //moves texture coordinates in [0, 1] over the sprite to the sprite's place in the atlas, the page goes into
+        //texCoord.z for texture array lookups
+        static void remapTexCoords(MeshComponent &mesh, const AtlasLayout &layout, const AtlasEntry &entry);
+    };
+
+}
+
+#endif //GENERATIONS_ATLASPACKER_H
@@ -0,0 +1,23 @@
+#ifndef GENERATIONS_BLOCKCOMPRESSION_H
+#define GENERATIONS_BLOCKCOMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SGE {
+
+    //byte oriented lz77 codec writing the lz4 block format, fast enough to decompress while streaming assets
+    class BlockCompression {
+    public:
+        static size_t compressBound(size_t size);
+
+        //returns the compressed size, or 0 when the output does not fit into capacity
+        static size_t compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity);
+
+        //fails unless the block decodes to exactly size bytes
+        static bool decompress(const uint8_t *src, size_t compressedSize, uint8_t *dst, size_t size);
+    };
+
+}
+
+#endif //GENERATIONS_BLOCKCOMPRESSION_H
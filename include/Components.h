@@ -43,12 +43,19 @@ namespace SGE {
         bool running = true;
     };
 
+    //a UI element placed by the UILayout system. Each edge sits at its anchor, a fraction of the parent's size from
+    //its top left, plus an offset in pixels, the parent being the window when there is none. Equal min and max
+    //anchors keep the size fixed, different ones stretch with the parent. Set dirty after editing the rule.
     struct UIComponent {
-        float xScale = 1.0, yScale = 1.0;
+        glm::vec2 anchorMin{0.f};
+        glm::vec2 anchorMax{0.f};
+        glm::vec2 offsetMin{0.f};
+        glm::vec2 offsetMax{0.f};
+        entt::entity parent = entt::null;
+        //the placed rectangle in pixels from the top left of the window, written by UILayout
         int xTop = 0, yTop = 0;
         int xBottom = 0, yBottom = 0;
-        //xTop, yTop, xBottom, yBottom, xScale, yScale, width, height
-        std::function<void(int &, int &, int &, int &, float, float, int, int)> scalingFunction;
+        bool dirty = true;
     };
 
     struct ModelComponent {
@@ -64,9 +71,52 @@ namespace SGE {
         }
     };
 
+    //a range of MeshComponent::indices, every level shares the vertices of the full detail mesh
+    struct MeshLod {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        //simplification error in model space units
+        float error = 0.f;
+    };
+
     struct MeshComponent {
         std::vector<Vertex> vertices;
-        std::vector<uint16_t> indices;
+        //indices are always kept 32 bit on the cpu and narrowed to 16 bit on upload when they fit
+        std::vector<uint32_t> indices;
+        //empty when no lods were built, otherwise lods[0] is the full detail mesh
+        std::vector<MeshLod> lods;
+
+        bool uses32BitIndices() const {
+            return vertices.size() > 65536;
+        }
+
+        uint32_t indexStride() const {
+            return uses32BitIndices() ? sizeof(uint32_t) : sizeof(uint16_t);
+        }
+    };
+
+    struct StreamedMesh {
+        uint32_t meshId = 0;
+        std::string file;
+        //shader description loaded for meshId the first time the mesh becomes resident, empty when another system
+        //provides the program
+        std::string shader;
+        bool resident = false;
+        //set by HotReload when the file changed on disk, so a mesh that failed to load is tried again
+        bool changed = false;
+    };
+
+    //model space bounding box of the entity's mesh
+    struct Bounds {
+        glm::vec3 min{0.f};
+        glm::vec3 max{0.f};
+    };
+
+    //mesh stored in the ModelLoader that is drawn for this entity and the lod picked for this frame
+    struct MeshInstance {
+        uint32_t meshId = 0;
+        uint32_t lodCount = 1;
+        uint32_t lod = 0;
     };
 
     struct Program {
@@ -84,6 +134,7 @@ namespace SGE {
 
     struct IndexBuffer {
         Diligent::RefCntAutoPtr<Diligent::IBuffer> indexBuffer;
+        Diligent::VALUE_TYPE indexType = Diligent::VT_UINT16;
     };
 
     struct UniformBufferObject {
@@ -105,6 +156,19 @@ namespace SGE {
         float zoom;
     };
 
+    //written by the Camera system every frame
+    struct CameraView {
+        glm::mat4 viewProj{1.f};
+        //half of the visible area in world units
+        glm::vec2 halfExtents{0.f};
+        float pixelsPerUnit = 1.f;
+    };
+
+    //entities that survived culling this frame in view order, written by FrustumCulling onto the camera entity
+    struct VisibleList {
+        std::vector<entt::entity> entities;
+    };
+
     struct PrimaryController {
         bool correct = true;
     };
@@ -0,0 +1,66 @@
+#ifndef GENERATIONS_CONTEXTRECORDER_H
+#define GENERATIONS_CONTEXTRECORDER_H
+
+#include <unordered_map>
+
+#include "Components.h"
+#include "GeometryPool.h"
+#include "Includes.h"
+#include "RenderList.h"
+
+namespace SGE {
+
+    //everything a draw of one mesh needs, resolved on the main thread before recording so workers never touch the
+    //ModelLoader maps
+    struct MeshDrawState {
+        Program program;
+        VertexBuffer vertexBuffer;
+        IndexBuffer indexBuffer;
+        GeometryAllocation geometry;
+        std::vector<MeshLod> lods;
+    };
+
+    //frame data shared by every recorder, read only while recording
+    struct RecordFrame {
+        const std::unordered_map<uint32_t, MeshDrawState> *meshes = nullptr;
+        Diligent::IBuffer *instanceBuffer = nullptr;
+        uint64_t instanceOffset = 0;
+        Diligent::ITextureView *renderTarget = nullptr;
+        Diligent::ITextureView *depthStencil = nullptr;
+    };
+
+    //records draws on a Diligent context. A deferred context finishes into a command list on its worker that is
+    //executed on the immediate context at submit, the immediate context itself draws straight away and is only ever
+    //given a single range
+    class ContextRecorder : public CommandRecorder {
+    public:
+        ContextRecorder(Diligent::IDeviceContext *context, Diligent::IDeviceContext *immediateContext,
+                        bool deferred);
+
+        void setFrame(const RecordFrame &frame);
+
+        void begin() override;
+
+        void record(const DrawBatch &batch) override;
+
+        void end() override;
+
+        void submit() override;
+
+    private:
+        Diligent::IDeviceContext *m_context;
+        Diligent::IDeviceContext *m_immediateContext;
+        bool m_deferred;
+        //resources are moved into their states on the immediate context before deferred recording starts
+        Diligent::RESOURCE_STATE_TRANSITION_MODE m_transitionMode;
+        RecordFrame m_frame;
+        //meshes share their buffers through the GeometryPool, so binds are only issued when something changed
+        Diligent::IPipelineState *m_pipeline = nullptr;
+        Diligent::IBuffer *m_vertexBuffer = nullptr;
+        Diligent::IBuffer *m_indexBuffer = nullptr;
+        Diligent::RefCntAutoPtr<Diligent::ICommandList> m_commandList;
+    };
+
+}
+
+#endif //GENERATIONS_CONTEXTRECORDER_H
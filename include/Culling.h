@@ -0,0 +1,54 @@
+#ifndef GENERATIONS_CULLING_H
+#define GENERATIONS_CULLING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace SGE {
+
+    //world space boxes stored as centers and half extents in separate arrays, so a SIMD lane loads one coordinate
+    //of several boxes at once. The arrays are padded to a multiple of eight with boxes that are never visible.
+    struct BoxSoA {
+        std::vector<float> centerX, centerY, centerZ;
+        std::vector<float> extentX, extentY, extentZ;
+
+        void resize(size_t count);
+
+        size_t size() const;
+
+        void set(size_t index, const glm::vec3 &center, const glm::vec3 &extent);
+
+    private:
+        size_t count = 0;
+    };
+
+    //planes are (normal, distance) with the normal pointing into the volume, a point p is inside when
+    //dot(normal, p) + distance >= 0
+    class Culling {
+    public:
+        static constexpr size_t chunkSize = 4096;
+
+        //the left, right, bottom and top planes of a view projection, near and far are left out since 2d scenes are
+        //ordered by depth rather than clipped by it
+        static std::vector<glm::vec4> sidePlanes(const glm::mat4 &viewProj);
+
+        static std::vector<glm::vec4> frustumPlanes(const glm::mat4 &viewProj);
+
+        //world space box of a local box after scale, rotation and translation
+        static void transformBox(const glm::vec3 &min, const glm::vec3 &max, const glm::mat3 &rotationScale,
+                                 const glm::vec3 &translation, glm::vec3 &center, glm::vec3 &extent);
+
+        //writes the indices of every box intersecting all planes in ascending order, chunks are tested in parallel
+        static void cull(const BoxSoA &boxes, const std::vector<glm::vec4> &planes, std::vector<uint32_t> &visible);
+
+        //tests boxes [first, last) and appends the visible ones, using 8 or 4 boxes per instruction where available
+        static void cullRange(const BoxSoA &boxes, const std::vector<glm::vec4> &planes, size_t first, size_t last,
+                              std::vector<uint32_t> &visible);
+    };
+
+}
+
+#endif //GENERATIONS_CULLING_H
@@ -2,9 +2,35 @@
 #define VULKAN_CUSTOMYAML_H
 
 #include "Components.h"
+#include "TextLayout.h"
+#include "Particles.h"
+#include "FlowField.h"
+#include "Flocking.h"
+#include "Animation.h"
 #include "Includes.h"
+#include <algorithm>
 
 namespace YAML {
+    template<>
+    struct convert<glm::vec2> {
+        static Node encode(const glm::vec2 &rhs) {
+            Node node;
+            node.push_back(rhs.x);
+            node.push_back(rhs.y);
+            return node;
+        }
+
+        static bool decode(const Node &node, glm::vec2 &rhs) {
+            if (!node.IsSequence() || node.size() != 2) {
+                return false;
+            }
+
+            rhs.x = node[0].as<float>();
+            rhs.y = node[1].as<float>();
+            return true;
+        }
+    };
+
     template<>
     struct convert<glm::vec3> {
         static Node encode(const glm::vec3 &rhs) {
@@ -27,6 +53,30 @@ namespace YAML {
         }
     };
 
+    template<>
+    struct convert<glm::vec4> {
+        static Node encode(const glm::vec4 &rhs) {
+            Node node;
+            node.push_back(rhs.x);
+            node.push_back(rhs.y);
+            node.push_back(rhs.z);
+            node.push_back(rhs.w);
+            return node;
+        }
+
+        static bool decode(const Node &node, glm::vec4 &rhs) {
+            if (!node.IsSequence() || node.size() != 4) {
+                return false;
+            }
+
+            rhs.x = node[0].as<float>();
+            rhs.y = node[1].as<float>();
+            rhs.z = node[2].as<float>();
+            rhs.w = node[3].as<float>();
+            return true;
+        }
+    };
+
     template<>
     struct convert<glm::quat> {
         static Node encode(const glm::quat &rhs) {
@@ -242,26 +292,276 @@ namespace YAML {
     struct convert<SGE::UIComponent> {
         static Node encode(const SGE::UIComponent &rhs) {
             Node node;
-            node.push_back(rhs.xScale);
-            node.push_back(rhs.yScale);
-            node.push_back(rhs.xTop);
-            node.push_back(rhs.yTop);
-            node.push_back(rhs.xBottom);
-            node.push_back(rhs.yBottom);
+            node["anchorMin"] = rhs.anchorMin;
+            node["anchorMax"] = rhs.anchorMax;
+            node["offsetMin"] = rhs.offsetMin;
+            node["offsetMax"] = rhs.offsetMax;
+            if (rhs.parent != entt::null)
+                node["parent"] = (uint32_t) rhs.parent;
             return node;
         }
 
+        //missing anchors and offsets stay 0, without a parent the element is placed in the window
         static bool decode(const Node &node, SGE::UIComponent &rhs) {
-            if (!node.IsMap() || node.size() != 6) {
+            if (!node.IsMap()) {
+                return false;
+            }
+
+            if (node["anchorMin"])
+                rhs.anchorMin = node["anchorMin"].as<glm::vec2>();
+            if (node["anchorMax"])
+                rhs.anchorMax = node["anchorMax"].as<glm::vec2>();
+            if (node["offsetMin"])
+                rhs.offsetMin = node["offsetMin"].as<glm::vec2>();
+            if (node["offsetMax"])
+                rhs.offsetMax = node["offsetMax"].as<glm::vec2>();
+            if (node["parent"])
+                rhs.parent = node["parent"].as<entt::entity>();
+            rhs.dirty = true;
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<SGE::StreamedMesh> {
+        static Node encode(const SGE::StreamedMesh &rhs) {
+            Node node;
+            node["id"] = rhs.meshId;
+            node["file"] = rhs.file;
+            if (!rhs.shader.empty())
+                node["shader"] = rhs.shader;
+            return node;
+        }
+
+        static bool decode(const Node &node, SGE::StreamedMesh &rhs) {
+            if (!node.IsMap() || !node["id"] || !node["file"]) {
+                return false;
+            }
+
+            rhs.meshId = node["id"].as<uint32_t>();
+            rhs.file = node["file"].as<std::string>();
+            if (node["shader"])
+                rhs.shader = node["shader"].as<std::string>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<SGE::TextComponent> {
+        static Node encode(const SGE::TextComponent &rhs) {
+            Node node;
+            node["text"] = rhs.text;
+            node["position"] = rhs.position;
+            node["pixelSize"] = rhs.pixelSize;
+            node["maxWidth"] = rhs.maxWidth;
+            node["align"] = rhs.align == SGE::TextAlign::Center ? "center" :
+                            rhs.align == SGE::TextAlign::Right ? "right" : "left";
+            node["color"] = rhs.color;
+            return node;
+        }
+
+        //only text is required, everything else keeps its default
+        static bool decode(const Node &node, SGE::TextComponent &rhs) {
+            if (!node.IsMap() || !node["text"]) {
+                return false;
+            }
+
+            rhs.text = node["text"].as<std::string>();
+            if (node["position"])
+                rhs.position = node["position"].as<glm::vec2>();
+            if (node["pixelSize"])
+                rhs.pixelSize = node["pixelSize"].as<uint32_t>();
+            if (node["maxWidth"])
+                rhs.maxWidth = node["maxWidth"].as<float>();
+            if (node["align"]) {
+                auto align = node["align"].as<std::string>();
+                rhs.align = align == "center" ? SGE::TextAlign::Center :
+                            align == "right" ? SGE::TextAlign::Right : SGE::TextAlign::Left;
+            }
+            if (node["color"])
+                rhs.color = node["color"].as<glm::vec4>();
+            rhs.changed = true;
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<SGE::ParticleEmitter> {
+        static Node encode(const SGE::ParticleEmitter &rhs) {
+            Node node;
+            node["mesh"] = rhs.mesh;
+            node["rate"] = rhs.rate;
+            node["lifetime"] = rhs.lifetime;
+            node["speed"] = rhs.speed;
+            node["spread"] = rhs.spread;
+            node["size"] = rhs.size;
+            node["direction"] = rhs.direction;
+            node["gravity"] = rhs.gravity;
+            node["capacity"] = rhs.capacity;
+            node["emitting"] = rhs.emitting;
+            return node;
+        }
+
+        //only mesh is required, everything else keeps its default
+        static bool decode(const Node &node, SGE::ParticleEmitter &rhs) {
+            if (!node.IsMap() || !node["mesh"]) {
+                return false;
+            }
+
+            rhs.mesh = node["mesh"].as<uint32_t>();
+            if (node["rate"])
+                rhs.rate = node["rate"].as<float>();
+            if (node["lifetime"])
+                rhs.lifetime = node["lifetime"].as<float>();
+            if (node["speed"])
+                rhs.speed = node["speed"].as<float>();
+            if (node["spread"])
+                rhs.spread = node["spread"].as<float>();
+            if (node["size"])
+                rhs.size = node["size"].as<float>();
+            if (node["direction"])
+                rhs.direction = node["direction"].as<glm::vec3>();
+            if (node["gravity"])
+                rhs.gravity = node["gravity"].as<glm::vec3>();
+            if (node["capacity"])
+                rhs.capacity = node["capacity"].as<uint32_t>();
+            if (node["emitting"])
+                rhs.emitting = node["emitting"].as<bool>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<SGE::NavAgent> {
+        static Node encode(const SGE::NavAgent &rhs) {
+            Node node;
+            node["goal"] = rhs.goal;
+            node["speed"] = rhs.speed;
+            return node;
+        }
+
+        static bool decode(const Node &node, SGE::NavAgent &rhs) {
+            if (!node.IsMap() || !node["goal"]) {
+                return false;
+            }
+
+            rhs.goal = node["goal"].as<glm::vec2>();
+            if (node["speed"])
+                rhs.speed = node["speed"].as<float>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<SGE::Boid> {
+        static Node encode(const SGE::Boid &rhs) {
+            Node node;
+            node["maxSpeed"] = rhs.maxSpeed;
+            node["maxForce"] = rhs.maxForce;
+            return node;
+        }
+
+        //an empty map keeps the defaults
+        static bool decode(const Node &node, SGE::Boid &rhs) {
+            if (!node.IsMap()) {
+                return false;
+            }
+
+            if (node["maxSpeed"])
+                rhs.maxSpeed = node["maxSpeed"].as<float>();
+            if (node["maxForce"])
+                rhs.maxForce = node["maxForce"].as<float>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<SGE::Animator> {
+        static Node encode(const SGE::Animator &rhs) {
+            Node node;
+            node["clip"] = rhs.clip;
+            node["time"] = rhs.time;
+            node["speed"] = rhs.speed;
+            node["loop"] = rhs.loop;
+            node["playing"] = rhs.playing;
+            return node;
+        }
+
+        //only clip is required, everything else keeps its default
+        static bool decode(const Node &node, SGE::Animator &rhs) {
+            if (!node.IsMap() || !node["clip"]) {
+                return false;
+            }
+
+            rhs.clip = node["clip"].as<uint32_t>();
+            if (node["time"])
+                rhs.time = node["time"].as<float>();
+            if (node["speed"])
+                rhs.speed = node["speed"].as<float>();
+            if (node["loop"])
+                rhs.loop = node["loop"].as<bool>();
+            if (node["playing"])
+                rhs.playing = node["playing"].as<bool>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<SGE::AnimationTrack> {
+        static Node encode(const SGE::AnimationTrack &rhs) {
+            Node node;
+            node["Times"] = rhs.times;
+            for (const glm::vec4 &value: rhs.values) {
+                node["Values"].push_back(value);
+            }
+            return node;
+        }
+
+        //values are [x, y, z] or, for rotations, [w, x, y, z], one per time. Times have to be ascending.
+        static bool decode(const Node &node, SGE::AnimationTrack &rhs) {
+            if (!node.IsMap() || !node["Times"] || !node["Values"] || node["Times"].size() != node["Values"].size()) {
+                return false;
+            }
+
+            rhs.times = node["Times"].as<std::vector<float>>();
+            if (!std::is_sorted(rhs.times.begin(), rhs.times.end()))
+                return false;
+            rhs.values.clear();
+            for (const Node &value: node["Values"]) {
+                if (!value.IsSequence() || value.size() < 3 || value.size() > 4)
+                    return false;
+                rhs.values.emplace_back(value[0].as<float>(), value[1].as<float>(), value[2].as<float>(),
+                                        value.size() == 4 ? value[3].as<float>() : 0.f);
+            }
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<SGE::AnimationClip> {
+        static Node encode(const SGE::AnimationClip &rhs) {
+            Node node;
+            node["Duration"] = rhs.duration;
+            node["Position"] = rhs.tracks[SGE::AnimationClip::Position];
+            node["Rotation"] = rhs.tracks[SGE::AnimationClip::Rotation];
+            node["Scale"] = rhs.tracks[SGE::AnimationClip::Scale];
+            return node;
+        }
+
+        //every track is optional, the duration defaults to the time of the last key
+        static bool decode(const Node &node, SGE::AnimationClip &rhs) {
+            if (!node.IsMap()) {
                 return false;
             }
 
-            rhs.xScale = node["xScale"].as<float>();
-            rhs.yScale = node["yScale"].as<float>();
-            rhs.xTop = node["xTop"].as<int>();
-            rhs.yTop = node["yTop"].as<int>();
-            rhs.xBottom = node["xBottom"].as<int>();
-            rhs.yBottom = node["yBottom"].as<int>();
+            if (node["Duration"])
+                rhs.duration = node["Duration"].as<float>();
+            if (node["Position"])
+                rhs.tracks[SGE::AnimationClip::Position] = node["Position"].as<SGE::AnimationTrack>();
+            if (node["Rotation"])
+                rhs.tracks[SGE::AnimationClip::Rotation] = node["Rotation"].as<SGE::AnimationTrack>();
+            if (node["Scale"])
+                rhs.tracks[SGE::AnimationClip::Scale] = node["Scale"].as<SGE::AnimationTrack>();
             return true;
         }
     };
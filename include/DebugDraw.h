@@ -0,0 +1,83 @@
+#ifndef GENERATIONS_DEBUGDRAW_H
+#define GENERATIONS_DEBUGDRAW_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Components.h"
+
+#ifndef SGE_DEBUG_DRAW
+#ifdef NDEBUG
+#define SGE_DEBUG_DRAW 0
+#else
+#define SGE_DEBUG_DRAW 1
+#endif
+#endif
+
+namespace SGE {
+
+    //immediate mode lines, boxes and circles in world space for debugging, callable from any system on any thread.
+    //Every thread records into its own buffer, so parallel systems never wait on each other, and the
+    //DebugDrawRenderer collects all of them once per frame into a single vertex stream drawn with one draw call.
+    //Builds with NDEBUG, or SGE_DEBUG_DRAW set to 0, turn every call into an empty inline function and compile
+    //DebugDraw.cpp to nothing.
+    class DebugDraw {
+    public:
+        static constexpr bool enabled = SGE_DEBUG_DRAW;
+
+        //a thread stops recording after this many vertices in one frame, so a frame nobody collects cannot grow
+        //without bound
+        static constexpr size_t maxThreadVertices = 1u << 20;
+
+        static void line(const glm::vec3 &from, const glm::vec3 &to, const glm::vec4 &color) {
+            if constexpr (enabled)
+                recordLine(from, to, color);
+        }
+
+        //the outline of a rectangle in the plane at height z
+        static void rect(const glm::vec2 &min, const glm::vec2 &max, const glm::vec4 &color, float z = 0.f) {
+            if constexpr (enabled)
+                recordRect(min, max, color, z);
+        }
+
+        //the twelve edges of an axis aligned box
+        static void box(const glm::vec3 &min, const glm::vec3 &max, const glm::vec4 &color) {
+            if constexpr (enabled)
+                recordBox(min, max, color);
+        }
+
+        //a circle in the plane z = center.z
+        static void circle(const glm::vec3 &center, float radius, const glm::vec4 &color, uint32_t segments = 32) {
+            if constexpr (enabled)
+                recordCircle(center, radius, color, segments);
+        }
+
+        static void cross(const glm::vec3 &center, float size, const glm::vec4 &color) {
+            if constexpr (enabled)
+                recordCross(center, size, color);
+        }
+
+        //appends everything every thread recorded since the last call as a line list, two vertices per line with
+        //the color in texCoord, and empties the thread buffers. Called once per frame by the DebugDrawRenderer.
+        static void collect(std::vector<Vertex> &vertices) {
+            if constexpr (enabled)
+                collectThreads(vertices);
+        }
+
+    private:
+        static void recordLine(const glm::vec3 &from, const glm::vec3 &to, const glm::vec4 &color);
+
+        static void recordRect(const glm::vec2 &min, const glm::vec2 &max, const glm::vec4 &color, float z);
+
+        static void recordBox(const glm::vec3 &min, const glm::vec3 &max, const glm::vec4 &color);
+
+        static void recordCircle(const glm::vec3 &center, float radius, const glm::vec4 &color, uint32_t segments);
+
+        static void recordCross(const glm::vec3 &center, float size, const glm::vec4 &color);
+
+        static void collectThreads(std::vector<Vertex> &vertices);
+    };
+
+}
+
+#endif //GENERATIONS_DEBUGDRAW_H
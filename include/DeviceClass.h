@@ -16,6 +16,10 @@ namespace SGE {
         Diligent::RefCntAutoPtr<Diligent::IRenderDevice> m_pDevice;
         Diligent::RefCntAutoPtr<Diligent::IDeviceContext> m_pImmediateContext;
         Diligent::RefCntAutoPtr<Diligent::ISwapChain> m_pSwapChain;
+        //empty on backends without command lists, the renderer then records on the immediate context
+        std::vector<Diligent::RefCntAutoPtr<Diligent::IDeviceContext>> m_pDeferredContexts;
+
+        static constexpr Diligent::Uint32 deferredContextCount = 4;
     };
 }
 #endif //GENERATIONS_DEVICECLASS_H
@@ -0,0 +1,39 @@
+#ifndef GENERATIONS_DILIGENTGRAPHBACKEND_H
+#define GENERATIONS_DILIGENTGRAPHBACKEND_H
+
+#include <vector>
+
+#include "Includes.h"
+#include "RenderGraph.h"
+
+namespace SGE {
+
+    //creates the graph's transient textures on a Diligent device and records its barriers on a context. Textures
+    //are only recreated when the physical layout of the compiled graph changes, so a graph compiled once and
+    //executed every frame allocates nothing after its first frame.
+    class DiligentGraphBackend : public GraphBackend {
+    public:
+        DiligentGraphBackend(Diligent::IRenderDevice *device, Diligent::IDeviceContext *context);
+
+        //imported textures change every frame, such as the current back buffer, and are set before executing. They
+        //are not referenced, a swap chain cannot resize its buffers while anything still holds on to them
+        void setTexture(uint32_t physical, Diligent::ITexture *texture);
+
+        Diligent::ITexture *getTexture(uint32_t physical) const;
+
+        void prepare(const RenderGraph &graph) override;
+
+        void transition(const RenderGraph &graph, const std::vector<GraphBarrier> &barriers) override;
+
+    private:
+        Diligent::IRenderDevice *m_device;
+        Diligent::IDeviceContext *m_context;
+        std::vector<TextureInfo> infos;
+        std::vector<Diligent::RefCntAutoPtr<Diligent::ITexture>> textures;
+        std::vector<Diligent::ITexture *> imported;
+        std::vector<Diligent::StateTransitionDesc> transitions;
+    };
+
+}
+
+#endif //GENERATIONS_DILIGENTGRAPHBACKEND_H
@@ -0,0 +1,75 @@
+#ifndef GENERATIONS_DTPARSER_H
+#define GENERATIONS_DTPARSER_H
+
+#include <string>
+#include <cstdint>
+
+#include "Components.h"
+
+namespace SGE {
+
+    //everything in a .dt file besides the geometry, see data/models/example.dt for the field order
+    struct DtHeader {
+        std::string name;
+        bool model = false;
+        std::string modelName;
+        uint32_t numVerts = 0;
+        uint32_t numIndices = 0;
+        std::string vertexShader;
+        std::string fragmentShader;
+        glm::vec3 position{0.f};
+        glm::vec3 rotation{0.f};
+    };
+
+    class DtParser {
+    public:
+        static constexpr size_t chunkSize = 1 << 20;
+
+        //streams the file in fixed size chunks and writes the geometry straight into mesh
+        static bool parseFile(const std::string &path, MeshComponent &mesh, DtHeader &header, std::string &error);
+
+    private:
+        enum Field {
+            Name,
+            Model,
+            ModelName,
+            NumVerts,
+            NumIndices,
+            Vertices,
+            Indices,
+            VertexShader,
+            FragmentShader,
+            Position,
+            Rotation,
+            FieldCount
+        };
+
+        DtParser(MeshComponent &mesh, DtHeader &header);
+
+        //returns the first byte that could not be consumed yet, a number cut off by the end of the chunk
+        const char *consume(const char *begin, const char *end, bool last);
+
+        bool number(const char *begin, const char *end);
+
+        bool endField();
+
+        MeshComponent &m_mesh;
+        DtHeader &m_header;
+        std::string error;
+
+        int field = Name;
+        bool inField = false;
+        bool inComment = false;
+        //slash seen outside a field, a second one starts a comment
+        bool slash = false;
+        std::string text;
+        //the counts in the header are only trusted as far as the file could hold that many numbers
+        uint64_t fileSize = 0;
+
+        float components[3] = {0.f, 0.f, 0.f};
+        int component = 0;
+    };
+
+}
+
+#endif //GENERATIONS_DTPARSER_H
@@ -68,11 +68,14 @@
 #include <cstdint>
 #include <iostream>
 #include <any>
+#include <memory>
 
 #include "SystemManager.h"
 #include "Input.h"
 #include "Components.h"
 #include "Includes.h"
+#include "RenderGraph.h"
+#include "DiligentGraphBackend.h"
 
 namespace SGE {
 
@@ -97,17 +100,25 @@ namespace SGE {
         void startSystems();
 
     private:
+        //the frame as a render graph, rebuilt only when the back buffer changes size
+        bool buildRenderGraph();
+
         std::string m_name;
         uint32_t WIDTH, HEIGHT;
 
         GLFWwindow *window = nullptr;
-        entt::entity windowEnt;
+        entt::entity windowEnt = entt::null;
 
         static DeviceClass* m_deviceClass;
 
         entt::registry m_registry;
 
         SystemManager m_manager = SystemManager(m_registry);
+
+        RenderGraph m_renderGraph;
+        std::unique_ptr<DiligentGraphBackend> m_graphBackend;
+        ResourceHandle backBuffer = RenderGraph::none;
+        uint32_t graphWidth = 0, graphHeight = 0;
     };
 
 }
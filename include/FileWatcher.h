@@ -0,0 +1,52 @@
+#ifndef GENERATIONS_FILEWATCHER_H
+#define GENERATIONS_FILEWATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SGE {
+
+    //reports files that changed under a set of directories. Linux uses inotify, other platforms fall back to
+    //comparing modification times. Editors tend to save in several writes, so a path is only reported once it has
+    //been quiet for the debounce interval and a burst of events comes out as a single change.
+    class FileWatcher {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit FileWatcher(std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher &) = delete;
+
+        FileWatcher &operator=(const FileWatcher &) = delete;
+
+        //watches the directory and everything below it, directories created later are picked up as they appear
+        bool watch(const std::string &directory);
+
+        //never blocks, appends the settled paths in the generic form they were watched under
+        void poll(std::vector<std::string> &changed);
+
+    private:
+        void addDirectory(const std::filesystem::path &directory);
+
+        void scan(Clock::time_point now);
+
+        std::chrono::milliseconds m_debounce;
+        std::unordered_map<std::string, Clock::time_point> m_pending;
+#if PLATFORM_LINUX
+        int m_fd = -1;
+        std::unordered_map<int, std::filesystem::path> m_watches;
+#else
+        std::vector<std::filesystem::path> m_roots;
+        std::unordered_map<std::string, std::filesystem::file_time_type> m_times;
+        Clock::time_point m_lastScan;
+#endif
+    };
+
+}
+
+#endif //GENERATIONS_FILEWATCHER_H
@@ -0,0 +1,122 @@
+#ifndef GENERATIONS_FLOCKING_H
+#define GENERATIONS_FLOCKING_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace SGE {
+
+    //flocks its entity with every other boid nearby in the xy plane by setting Physics::acceleration. A boid
+    //steers towards maxSpeed and never accelerates harder than maxForce.
+    struct Boid {
+        float maxSpeed = 4.f;
+        float maxForce = 8.f;
+    };
+
+    //boids within radius are neighbours, the ones within separationRadius are also pushed away from. The weights
+    //scale the three steering forces before they are summed.
+    struct FlockSettings {
+        float radius = 2.f;
+        float separationRadius = 0.75f;
+        float separation = 1.5f;
+        float alignment = 1.f;
+        float cohesion = 1.f;
+    };
+
+    //points sorted by the square cell of side cellSize they lie in, rebuilt from scratch with a counting sort every
+    //time the points move. Cells are hashed into a table about as large as the point count by wrapping the grid
+    //around it, so an unbounded world costs nothing for the space between the points, and cells next to each other
+    //in a row stay next to each other in memory. Points of one cell are contiguous in getOrder and ordered by
+    //index, which keeps the result the same however the parallel passes were scheduled.
+    class SpatialHash {
+    public:
+        struct Cell {
+            int32_t x, y;
+            //range of getOrder
+            uint32_t first, last;
+        };
+
+        //points updated by one task
+        static constexpr size_t chunkSize = 8192;
+
+        void build(const glm::vec2 *positions, uint32_t count, float cellSize);
+
+        //point index by sorted position
+        const std::vector<uint32_t> &getOrder() const;
+
+        //every non-empty cell, cells sharing a hash bucket are adjacent
+        const std::vector<Cell> &getCells() const;
+
+        //the cell at (x, y), nullptr when it holds no points
+        const Cell *find(int32_t x, int32_t y) const;
+
+        //ranges of getOrder holding every point of the cells x - 1 to x + 1 in row y, along with the points of any
+        //other cells hashed between them, which the caller tells apart by position. Returns how many ranges were
+        //written, one unless the row wraps around the table.
+        uint32_t findRow(int32_t x, int32_t y, uint32_t (&ranges)[3][2]) const;
+
+        float getCellSize() const;
+
+    private:
+        uint32_t bucketOf(int32_t x, int32_t y) const;
+
+        float cellSize = 1.f;
+        uint32_t columnBits = 0, rowMask = 0;
+        std::vector<glm::ivec2> pointCells;
+        std::vector<uint32_t> pointBuckets;
+        std::unique_ptr<std::atomic<uint32_t>[]> cursors;
+        size_t cursorCount = 0;
+        //bucketStart indexes getOrder and bucketCells indexes getCells, both have one entry per bucket plus an end
+        std::vector<uint32_t> bucketStart;
+        std::vector<uint32_t> bucketCells;
+        std::vector<uint32_t> order;
+        std::vector<Cell> cells;
+    };
+
+    //separation, alignment and cohesion for a set of boids in the plane. Neighbours are found through a
+    //SpatialHash with cells as large as the neighbour radius, so a boid only looks at the nine cells around its own.
+    //Boids are copied into cell order first, and the boids of a cell test the neighbourhood they share 8 or 4 at a
+    //time where available. The forces of the cells are computed in parallel.
+    class Flock {
+    public:
+        //cells steered by one task
+        static constexpr size_t cellChunk = 256;
+
+        //drops every boid and makes room for count of them, set each one before steer
+        void resize(uint32_t count);
+
+        //safe to call from several threads for different boids
+        void set(uint32_t boid, const glm::vec2 &position, const glm::vec2 &velocity, const Boid &limits);
+
+        void steer(const FlockSettings &settings);
+
+        uint32_t size() const;
+
+        const glm::vec2 &getAcceleration(uint32_t boid) const;
+
+        const SpatialHash &getHash() const;
+
+    private:
+        //the boids of the nine cells around one, copied next to each other and padded to a multiple of eight with
+        //boids too far away to count
+        struct Neighbourhood {
+            std::vector<float> x, y, velocityX, velocityY;
+        };
+
+        void steerCell(const SpatialHash::Cell &cell, const FlockSettings &settings, Neighbourhood &neighbourhood);
+
+        std::vector<glm::vec2> positions, velocities;
+        std::vector<Boid> limits;
+        std::vector<glm::vec2> accelerations;
+        //positions and velocities in cell order
+        std::vector<float> sortedX, sortedY, sortedVelocityX, sortedVelocityY;
+        SpatialHash hash;
+    };
+
+}
+
+#endif //GENERATIONS_FLOCKING_H
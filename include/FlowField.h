@@ -0,0 +1,159 @@
+#ifndef GENERATIONS_FLOWFIELD_H
+#define GENERATIONS_FLOWFIELD_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace SGE {
+
+    //moves its entity towards goal, a world position, by setting Physics::velocity from the flow field of the goal's
+    //cell. Agents on the goal's cell or with no way to it stand still.
+    struct NavAgent {
+        glm::vec2 goal{0.f};
+        float speed = 1.f;
+    };
+
+    //movement costs of a grid of cells for navigation, 1 for open ground up to blocked for walls. Cells are grouped
+    //into square sectors, the unit flow fields are invalidated in. Cell (0, 0) has its corner at origin and y
+    //grows upwards, like the tiles of a Tilemap.
+    class NavGrid {
+    public:
+        static constexpr uint32_t sectorSize = 32;
+        static constexpr uint8_t blocked = 255;
+        //cells are packed as y << 16 | x
+        static constexpr uint32_t maxSize = 65536;
+
+        NavGrid(uint32_t width, uint32_t height, float cellSize, const glm::vec2 &origin = glm::vec2(0.f));
+
+        uint32_t getWidth() const;
+
+        uint32_t getHeight() const;
+
+        //out of range cells are blocked
+        uint8_t getCost(uint32_t x, uint32_t y) const;
+
+        //costs of 0 are raised to 1, a change marks the cell's sector
+        void setCost(uint32_t x, uint32_t y, uint8_t cost);
+
+        //sectors whose costs changed since the last call
+        void takeChangedSectors(std::vector<uint32_t> &sectors);
+
+        uint32_t getSectorsX() const;
+
+        uint32_t getSectorsY() const;
+
+        //false outside the grid
+        bool cellAt(const glm::vec2 &position, uint32_t &x, uint32_t &y) const;
+
+        glm::vec2 getCellCenter(uint32_t x, uint32_t y) const;
+
+    private:
+        uint32_t width, height;
+        uint32_t sectorsX, sectorsY;
+        float cellSize;
+        glm::vec2 origin;
+        std::vector<uint8_t> costs;
+        std::vector<uint8_t> sectorChanged;
+        std::vector<uint32_t> changed;
+    };
+
+    //integration and flow field towards one goal cell. Both are filled by a Dijkstra search from the goal that only
+    //runs as far as the cells asked for with require, so a goal costs memory and time for the part of the map its
+    //agents are spread over, and the search resumes where it stopped when agents show up further away. Storage is
+    //allocated per sector on first touch. A cell's flow points at its cheapest neighbour and is known from the
+    //moment the search settles the cell, and sampling only reads, so any number of threads can sample at once.
+    class FlowField {
+    public:
+        static constexpr uint32_t unvisited = UINT32_MAX;
+
+        FlowField(const NavGrid *grid, uint32_t goalX, uint32_t goalY);
+
+        //asks for the cell to be settled by the next expand
+        void require(uint32_t x, uint32_t y);
+
+        //settles cells until every required one is reached, the search runs out of cells or budget cells were
+        //settled, and returns how many were
+        uint32_t expand(uint32_t budget);
+
+        //repairs the field after the costs of sectors changed. Only the cells in and next to the sectors and the ones
+        //whose cheapest path may lead through them are searched again, starting from the cells around them.
+        void invalidate(const std::vector<uint32_t> &sectors);
+
+        bool hasRequired() const;
+
+        bool isSettled(uint32_t x, uint32_t y) const;
+
+        //cost of the cheapest path to the goal, in tenths of a straight step over a cell of cost 1
+        uint32_t getIntegration(uint32_t x, uint32_t y) const;
+
+        //unit step towards the goal, zero on the goal itself. False while the cell is not settled or cannot reach
+        //the goal.
+        bool getDirection(uint32_t x, uint32_t y, glm::vec2 &direction) const;
+
+        uint32_t getAllocatedSectors() const;
+
+    private:
+        struct Sector {
+            std::vector<uint32_t> integration;
+            std::vector<uint8_t> flow;
+        };
+
+        //whether the neighbour in direction can be entered, given the costs of all eight neighbours
+        static bool passable(const uint8_t *costs, int direction);
+
+        uint8_t lowestNeighbour(uint32_t x, uint32_t y) const;
+
+        uint32_t getValue(uint32_t x, uint32_t y) const;
+
+        Sector &touch(uint32_t x, uint32_t y);
+
+        void push(uint32_t value, uint32_t x, uint32_t y);
+
+        const NavGrid *grid;
+        uint32_t goalX, goalY;
+        std::vector<std::unique_ptr<Sector>> sectors;
+        uint32_t allocated = 0;
+        //min heap of integration << 32 | cell, entries whose value has since dropped are skipped when popped
+        std::vector<uint64_t> open;
+        std::vector<uint32_t> required;
+    };
+
+    //flow fields by goal cell, kept between frames so agents heading to the same goal share one and a goal nobody
+    //moves to is eventually dropped
+    class FlowFieldCache {
+    public:
+        FlowFieldCache(const NavGrid *grid, size_t maxFields);
+
+        //created on first use, valid until endFrame evicts it
+        FlowField *get(uint32_t goalX, uint32_t goalY);
+
+        //expands every field with required cells by up to budget cells, fields are searched in parallel
+        void expand(uint32_t budget);
+
+        void invalidate(const std::vector<uint32_t> &sectors);
+
+        //drops the fields least recently asked for beyond maxFields. Fields asked for this frame are always kept, so
+        //the cache grows past maxFields while more goals than that are in use
+        void endFrame();
+
+        size_t getFieldCount() const;
+
+    private:
+        struct Entry {
+            std::unique_ptr<FlowField> field;
+            uint64_t lastUsed = 0;
+        };
+
+        const NavGrid *grid;
+        size_t maxFields;
+        std::unordered_map<uint32_t, Entry> fields;
+        uint64_t frame = 0;
+    };
+
+}
+
+#endif //GENERATIONS_FLOWFIELD_H
@@ -0,0 +1,90 @@
+#ifndef GENERATIONS_GEOMETRYPOOL_H
+#define GENERATIONS_GEOMETRYPOOL_H
+
+#include <unordered_map>
+
+#include "Components.h"
+#include "Includes.h"
+#include "RangeAllocator.h"
+
+namespace SGE {
+
+    //where a mesh lives inside the pool, indices are relative to baseVertex
+    struct GeometryAllocation {
+        uint32_t baseVertex = 0;
+        uint32_t vertexCount = 0;
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        Diligent::VALUE_TYPE indexType = Diligent::VT_UINT16;
+    };
+
+    //keeps the vertices and indices of every mesh in one vertex buffer and two index buffers, one for 16 and one
+    //for 32 bit indices, so draws of different meshes share their buffer bindings. Space is handed out by a
+    //RangeAllocator per buffer, buffers grow by doubling and are compacted once free space gets too scattered.
+    class GeometryPool {
+    public:
+        GeometryPool(Diligent::IRenderDevice *device, uint64_t vertexCapacity, uint64_t indexCapacity);
+
+        //copies the mesh's vertices in, replacing any it had
+        bool uploadVertices(Diligent::IDeviceContext *context, uint32_t id, const MeshComponent &mesh);
+
+        //copies the mesh's indices in, replacing any it had. Indices are narrowed to 16 bit whenever every vertex
+        //fits, which now holds for any mesh below 65536 vertices since they are relative to baseVertex
+        bool uploadIndices(Diligent::IDeviceContext *context, uint32_t id, const MeshComponent &mesh);
+
+        void release(uint32_t id);
+
+        bool hasVertices(uint32_t id) const;
+
+        bool hasIndices(uint32_t id) const;
+
+        const GeometryAllocation *find(uint32_t id) const;
+
+        Diligent::IBuffer *getVertexBuffer() const;
+
+        Diligent::IBuffer *getIndexBuffer(Diligent::VALUE_TYPE indexType) const;
+
+        //packs every buffer whose fragmentation is above threshold, returns whether anything moved
+        bool defragment(Diligent::IDeviceContext *context, float threshold);
+
+    private:
+        //one gpu buffer and the allocator in front of it, sizes and offsets are in elements
+        struct Arena {
+            std::string name;
+            Diligent::BIND_FLAGS bindFlags;
+            uint32_t stride;
+            RangeAllocator allocator;
+            Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+        };
+
+        uint64_t allocate(Diligent::IDeviceContext *context, Arena &arena, uint64_t count);
+
+        struct Copy {
+            uint64_t from;
+            uint64_t to;
+            uint64_t size;
+        };
+
+        //moves the arena into a new buffer of the given capacity, copying the listed ranges across
+        void rebuild(Diligent::IDeviceContext *context, Arena &arena, uint64_t capacity, const std::vector<Copy> &copies);
+
+        bool defragment(Diligent::IDeviceContext *context, Arena &arena);
+
+        Arena &indexArena(Diligent::VALUE_TYPE indexType);
+
+        struct Entry {
+            GeometryAllocation allocation;
+            bool vertices = false;
+            bool indices = false;
+        };
+
+        Diligent::IRenderDevice *m_device;
+        Arena vertices;
+        Arena indices16;
+        Arena indices32;
+        std::unordered_map<uint32_t, Entry> entries;
+    };
+
+}
+
+#endif //GENERATIONS_GEOMETRYPOOL_H
@@ -0,0 +1,112 @@
+#ifndef GENERATIONS_GLYPHCACHE_H
+#define GENERATIONS_GLYPHCACHE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "AtlasPacker.h"
+
+namespace SGE {
+
+    //vertical measurements of a font at one pixel size, in pixels
+    struct FontMetrics {
+        float ascent = 0.f;
+        float descent = 0.f;
+        float lineHeight = 0.f;
+    };
+
+    //a rasterized glyph, bearingY is how far its top sits above the baseline
+    struct GlyphBitmap {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        int32_t bearingX = 0;
+        int32_t bearingY = 0;
+        float advance = 0.f;
+        //one coverage byte per pixel, rows from the top
+        std::vector<uint8_t> pixels;
+    };
+
+    //where glyphs come from, so the cache and layout never depend on a font library and run headless
+    class GlyphSource {
+    public:
+        virtual ~GlyphSource() = default;
+
+        virtual FontMetrics getMetrics(uint32_t pixelSize) const = 0;
+
+        //codepoints the source has no glyph for are drawn with its replacement glyph
+        virtual void rasterize(uint32_t codepoint, uint32_t pixelSize, GlyphBitmap &glyph) const = 0;
+    };
+
+    //built in 5x7 font covering printable ascii, scaled by whole pixels so it stays sharp at every size. Good
+    //enough for debug text and the fallback when no other font is set up.
+    class BitmapFont : public GlyphSource {
+    public:
+        FontMetrics getMetrics(uint32_t pixelSize) const override;
+
+        void rasterize(uint32_t codepoint, uint32_t pixelSize, GlyphBitmap &glyph) const override;
+
+    private:
+        //pixel size 8 draws the font 1:1, larger sizes round to the nearest whole multiple
+        static uint32_t scaleFor(uint32_t pixelSize);
+    };
+
+    //a glyph in the atlas, rect is the glyph itself without the padding around it
+    struct CachedGlyph {
+        AtlasRect rect;
+        int32_t bearingX = 0;
+        int32_t bearingY = 0;
+        float advance = 0.f;
+    };
+
+    //one coverage texture that glyphs are rasterized into the first time they are asked for, at every pixel size
+    //used. Nothing is ever evicted on its own, when the page is full get returns nullptr and the owner clears the
+    //cache, which bumps the generation so everything built from the old contents can tell it is stale.
+    class GlyphCache {
+    public:
+        GlyphCache(const GlyphSource *source, uint32_t width, uint32_t height);
+
+        //nullptr when the glyph does not fit in what is left of the page
+        const CachedGlyph *get(uint32_t codepoint, uint32_t pixelSize);
+
+        FontMetrics getMetrics(uint32_t pixelSize) const;
+
+        void clear();
+
+        uint32_t getGeneration() const;
+
+        uint32_t getWidth() const;
+
+        uint32_t getHeight() const;
+
+        const std::vector<uint8_t> &getPixels() const;
+
+        //the area written since the last call, false when nothing changed
+        bool takeDirtyRect(AtlasRect &rect);
+
+        uint32_t getGlyphCount() const;
+
+        //glyphs rasterized since construction, stays flat once the text on screen is cached
+        uint64_t getRasterizedCount() const;
+
+    private:
+        static constexpr uint32_t padding = 1;
+
+        void markDirty(const AtlasRect &rect);
+
+        const GlyphSource *source;
+        uint32_t width, height;
+        SkylinePacker packer;
+        std::vector<uint8_t> pixels;
+        //pixel size in the high half, codepoint in the low half
+        std::unordered_map<uint64_t, CachedGlyph> glyphs;
+        GlyphBitmap scratch;
+        uint32_t generation = 0;
+        uint64_t rasterized = 0;
+        bool dirty = false;
+        uint32_t dirtyX0 = 0, dirtyY0 = 0, dirtyX1 = 0, dirtyY1 = 0;
+    };
+
+}
+
+#endif //GENERATIONS_GLYPHCACHE_H
@@ -0,0 +1,34 @@
+#ifndef GENERATIONS_MESHFILE_H
+#define GENERATIONS_MESHFILE_H
+
+#include <string>
+#include <cstdint>
+
+#include "Components.h"
+
+namespace SGE {
+
+    //binary runtime mesh, a header followed by the raw vertex array, the indices already narrowed to their upload
+    //size and the lod table
+    struct MeshFileHeader {
+        char magic[4] = {'S', 'G', 'E', 'M'};
+        uint32_t version = 2;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint32_t indexStride = 0;
+        uint32_t lodCount = 0;
+    };
+
+    class MeshFile {
+    public:
+        static bool write(const std::string &path, const MeshComponent &mesh, std::string &error);
+
+        static bool read(const std::string &path, MeshComponent &mesh, std::string &error);
+
+        //parses a mesh file image that is already in memory
+        static bool read(const char *data, size_t size, MeshComponent &mesh, std::string &error);
+    };
+
+}
+
+#endif //GENERATIONS_MESHFILE_H
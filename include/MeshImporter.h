@@ -0,0 +1,33 @@
+#ifndef GENERATIONS_MESHIMPORTER_H
+#define GENERATIONS_MESHIMPORTER_H
+
+#include <string>
+#include <cstdint>
+
+#include "AtlasPacker.h"
+#include "Components.h"
+
+namespace SGE {
+
+    //shared by the runtime loader and the offline AssetCooker so both produce identical meshes
+    class MeshImporter {
+    public:
+        //reads .mesh, .dt and yaml meshes. Source formats are optimized and get lods, report then describes the
+        //optimization. id is only written by formats that carry a PregenID. Yaml meshes naming a Sprite have their
+        //texture coordinates moved into the atlas when one is given.
+        static bool read(const std::string &path, uint32_t &id, MeshComponent &mesh, std::string &error,
+                         std::string &report, const AtlasLayout *atlas = nullptr);
+
+        //.dt files and yaml files with a Mesh node
+        static bool isSourceFormat(const std::string &path);
+
+        //optimization and lod generation applied to every source mesh after parsing
+        static std::string process(const std::string &name, MeshComponent &mesh);
+
+        static bool readYaml(const std::string &path, uint32_t &id, MeshComponent &mesh, std::string &error,
+                             const AtlasLayout *atlas = nullptr);
+    };
+
+}
+
+#endif //GENERATIONS_MESHIMPORTER_H
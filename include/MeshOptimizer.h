@@ -0,0 +1,53 @@
+#ifndef GENERATIONS_MESHOPTIMIZER_H
+#define GENERATIONS_MESHOPTIMIZER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Components.h"
+
+namespace SGE {
+
+    struct MeshStats {
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        size_t sizeBytes = 0;
+        //average cache miss ratio, transformed vertices per triangle
+        float acmr = 0.f;
+    };
+
+    struct MeshOptimizationReport {
+        MeshStats before;
+        MeshStats after;
+    };
+
+    class MeshOptimizer {
+    public:
+        //welds duplicate vertices, reorders triangles for a post transform cache of cacheSize vertices and vertices
+        //for fetch locality. The indices have to be checked with validate first.
+        static MeshOptimizationReport optimize(MeshComponent &mesh, uint32_t cacheSize = 16);
+
+        //false when an index is past the last vertex or the indices do not form whole triangles
+        static bool validate(const MeshComponent &mesh, std::string &error);
+
+        static void weldVertices(MeshComponent &mesh);
+
+        static void optimizeVertexCache(MeshComponent &mesh, uint32_t cacheSize = 16);
+
+        static void optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+        static void optimizeVertexFetch(MeshComponent &mesh);
+
+        static float computeAcmr(const MeshComponent &mesh, uint32_t cacheSize);
+
+        static MeshStats computeStats(const MeshComponent &mesh, uint32_t cacheSize);
+
+        static void computeBounds(const MeshComponent &mesh, Bounds &bounds);
+
+        static std::string formatReport(const std::string &name, const MeshOptimizationReport &report);
+    };
+
+}
+
+#endif //GENERATIONS_MESHOPTIMIZER_H
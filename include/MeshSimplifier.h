@@ -0,0 +1,26 @@
+#ifndef GENERATIONS_MESHSIMPLIFIER_H
+#define GENERATIONS_MESHSIMPLIFIER_H
+
+#include <vector>
+#include <cstdint>
+
+#include "Components.h"
+
+namespace SGE {
+
+    class MeshSimplifier {
+    public:
+        //quadric error edge collapse, vertices are only ever merged into other vertices so no new ones are created.
+        //targetError is relative to the mesh extent, the reached error is returned in model space units
+        static std::vector<uint32_t> simplify(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+                                              size_t targetIndexCount, float targetError, float &resultError);
+
+        //appends up to maxLevels - 1 simplified index ranges to mesh.indices and describes them in mesh.lods,
+        //each level aims for reduction times the index count of the previous one
+        static void buildLods(MeshComponent &mesh, uint32_t maxLevels = 4, float reduction = 0.5f,
+                              float targetError = 0.05f);
+    };
+
+}
+
+#endif //GENERATIONS_MESHSIMPLIFIER_H
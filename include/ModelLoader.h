@@ -8,6 +8,9 @@
 #include "DeviceClass.h"
 #include "Includes.h"
 #include "Components.h"
+#include "MeshOptimizer.h"
+#include "PipelineCache.h"
+#include "GeometryPool.h"
 
 namespace SGE {
     class ModelLoader {
@@ -18,12 +21,54 @@ namespace SGE {
 
         bool loadMesh(const std::string &loc);
 
+        //id is used for formats that do not carry their own PregenID, such as .dt files
+        bool loadMesh(const std::string &loc, uint32_t id);
+
+        //parses a mesh file without touching any storage so it can be called from worker threads
+        static bool readMesh(const std::string &loc, uint32_t &id, MeshComponent &mesh, std::string &error);
+
+        //asks the os to start paging a packed mesh in, does nothing for loose files
+        static void prefetchMesh(const std::string &loc);
+
+        void addMesh(uint32_t id, MeshComponent &&mesh);
+
+        //swaps in a re-parsed mesh and rebuilds whichever gpu buffers it already had
+        void replaceMesh(uint32_t id, MeshComponent &&mesh, const std::string &name);
+
+        void unloadMesh(uint32_t id);
+
+        bool hasMesh(uint32_t id) const;
+
+        //points the entity at a stored mesh by giving it MeshInstance and Bounds components
+        void attachMesh(entt::entity entity, uint32_t id);
+
         bool loadVertexBuffer(const std::string &loc);
 
         bool loadIndexBuffer(const std::string &loc);
 
+        bool createVertexBuffer(uint32_t id, const std::string &name);
+
+        bool createIndexBuffer(uint32_t id, const std::string &name);
+
         bool loadShader(const std::string& loc);
 
+        //id is used for descriptions that do not carry their own PregenID, so one description can serve many meshes
+        bool loadShader(const std::string &loc, uint32_t id);
+
+        //mesh ids loaded from the given source file, used to find what a changed file affects
+        std::vector<uint32_t> findMeshIds(const std::string &path) const;
+
+        //shader descriptions that are either the given file or compile the given .vsh/.psh
+        std::vector<std::string> findShaderDescriptions(const std::string &path) const;
+
+        //every mesh id a shader description was loaded for
+        std::vector<uint32_t> getShaderIds(const std::string &loc) const;
+
+        static std::string normalizePath(const std::string &path);
+
+        //normalized path of a mesh or shader description under data/models, the form the file watcher reports
+        static std::string modelPath(const std::string &loc);
+
         ModelLoader(entt::registry *registry);
 
         MeshComponent& getMesh(uint32_t id);
@@ -32,11 +77,39 @@ namespace SGE {
 
         IndexBuffer getIndexBuffer(uint32_t id);
 
+        //where the mesh sits in the shared vertex and index buffers returned above
+        GeometryAllocation getGeometry(uint32_t id) const;
+
+        //packs the shared geometry buffers once more than threshold of their free space is scattered
+        void compactGeometry(float threshold);
+
         Program getShaderProgram(uint32_t id);
 
-        ModelViewProjMatrix getProjectionMatrix(uint32_t id);
+        //draws mesh id with the program of mesh source, for generated meshes that have no shader description. The
+        //share is kept up when the program of source is loaded again
+        bool shareShaderProgram(uint32_t id, uint32_t source);
+
+        //changes every time a program is created for id, bindings set on an older one have to be set again
+        uint32_t getProgramGeneration(uint32_t id) const;
+
+        //view projection shared by every shader using UseModelViewProj, null until one is loaded
+        ModelViewProjMatrix getFrameConstants() const;
+
+        //lookups that never create an empty entry, for systems that only draw what is ready
+        bool hasShaderProgram(uint32_t id) const;
+
+        bool hasGpuMesh(uint32_t id) const;
+
+        static constexpr const char *pakPath = "data/cooked/assets.pak";
 
     private:
+        struct ShaderDescription {
+            std::vector<uint32_t> ids;
+            std::string file;
+            std::string vertexShader;
+            std::string pixelShader;
+        };
+
         ModelLoader() {
             this->m_registry = nullptr;
         }
@@ -48,10 +121,15 @@ namespace SGE {
         static std::unique_ptr<ModelLoader> modelLoader;
 
         std::unordered_map<uint32_t, MeshComponent> meshStorage;
-        std::unordered_map<uint32_t, Diligent::RefCntAutoPtr<Diligent::IBuffer>> vbStorage;
-        std::unordered_map<uint32_t, Diligent::RefCntAutoPtr<Diligent::IBuffer>> ibStorage;
+        std::unique_ptr<GeometryPool> geometryPool;
         std::unordered_map<uint32_t, std::pair<Diligent::RefCntAutoPtr<Diligent::IPipelineState>, Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>>> programStorage;
-        std::unordered_map<uint32_t, Diligent::RefCntAutoPtr<Diligent::IBuffer>> projMatrixStorage;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> programSharers;
+        std::unordered_map<uint32_t, uint32_t> programGenerations;
+        Diligent::RefCntAutoPtr<Diligent::IBuffer> frameConstants;
+        std::unordered_map<std::string, std::vector<uint32_t>> meshFiles;
+        std::unordered_map<std::string, ShaderDescription> shaderDescriptions;
+        std::unique_ptr<PipelineDevice> pipelineDevice;
+        std::unique_ptr<PipelineCache> pipelineCache;
 
     };
 
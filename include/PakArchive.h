@@ -0,0 +1,142 @@
+#ifndef GENERATIONS_PAKARCHIVE_H
+#define GENERATIONS_PAKARCHIVE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SGE {
+
+    //layout of a .pak file: header, entry data with every entry starting on a 4 KiB boundary, then the table of
+    //contents. The table is a bucket array indexed by the top bits of the name hash followed by the entries sorted by
+    //hash, so a lookup is one bucket read and a scan over the few entries sharing it. Names are kept in a string blob
+    //after the entries to resolve hash collisions.
+    struct PakHeader {
+        char magic[4] = {'S', 'G', 'E', 'P'};
+        uint32_t version = 1;
+        uint32_t entryCount = 0;
+        uint32_t bucketBits = 0;
+        uint64_t tocOffset = 0;
+        uint64_t tocSize = 0;
+    };
+
+    enum PakEntryFlags : uint32_t {
+        PakCompressed = 1
+    };
+
+    struct PakEntry {
+        uint64_t hash = 0;
+        uint64_t offset = 0;
+        //bytes stored in the archive, equal to size unless the entry is compressed
+        uint64_t storedSize = 0;
+        uint64_t size = 0;
+        uint32_t nameOffset = 0;
+        uint32_t nameLength = 0;
+        uint32_t flags = 0;
+        uint32_t padding = 0;
+    };
+
+    class PakArchive {
+    public:
+        static constexpr uint64_t alignment = 4096;
+
+        //the archive built by the AssetCooker, opened once by the ModelLoader on the main thread
+        static PakArchive *getInstance();
+
+        PakArchive() = default;
+
+        ~PakArchive();
+
+        PakArchive(const PakArchive &) = delete;
+
+        PakArchive &operator=(const PakArchive &) = delete;
+
+        bool open(const std::string &path, std::string &error);
+
+        void close();
+
+        bool isOpen() const;
+
+        const PakEntry *find(std::string_view name) const;
+
+        std::string_view getName(const PakEntry &entry) const;
+
+        const std::vector<PakEntry> &getEntries() const;
+
+        //points straight into the mapping, only possible for entries stored uncompressed
+        bool view(const PakEntry &entry, const char *&data, size_t &size) const;
+
+        //copies or decompresses the entry into out, safe to call from any thread once the archive is open
+        bool read(const PakEntry &entry, std::vector<char> &out, std::string &error) const;
+
+        bool read(std::string_view name, std::vector<char> &out, std::string &error) const;
+
+        //hints the os to page the range in ahead of a read, returns immediately
+        void prefetch(const PakEntry &entry) const;
+
+        void prefetch(const PakEntry &entry, uint64_t offset, uint64_t size) const;
+
+        static uint64_t hashName(std::string_view name);
+
+    private:
+        static std::unique_ptr<PakArchive> pakArchive;
+
+        const char *m_data = nullptr;
+        uint64_t m_size = 0;
+        uint32_t m_bucketBits = 0;
+        std::vector<uint32_t> m_buckets;
+        std::vector<PakEntry> m_entries;
+        std::string m_names;
+#if PLATFORM_WIN32
+        void *m_file = nullptr;
+        void *m_mapping = nullptr;
+#endif
+    };
+
+    //sequential reader over one entry, uncompressed entries are copied out of the mapping while the window ahead of
+    //the cursor is prefetched, compressed entries are decoded once up front
+    class PakStream {
+    public:
+        static constexpr uint64_t readAhead = 256 * 1024;
+
+        PakStream(const PakArchive &archive, const PakEntry &entry);
+
+        size_t read(char *out, size_t size);
+
+        uint64_t remaining() const;
+
+        bool failed() const;
+
+    private:
+        const PakArchive &m_archive;
+        const PakEntry &m_entry;
+        const char *m_data = nullptr;
+        uint64_t m_cursor = 0;
+        uint64_t m_prefetched = 0;
+        std::vector<char> m_decoded;
+        bool m_failed = false;
+    };
+
+    class PakWriter {
+    public:
+        //entries that do not shrink by at least an eighth are stored as is
+        void add(const std::string &name, std::vector<char> data, bool compress);
+
+        bool write(const std::string &path, std::string &error) const;
+
+    private:
+        struct Pending {
+            std::string name;
+            std::vector<char> data;
+            uint64_t size = 0;
+            bool compressed = false;
+        };
+
+        std::vector<Pending> m_pending;
+    };
+
+}
+
+#endif //GENERATIONS_PAKARCHIVE_H
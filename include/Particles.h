@@ -0,0 +1,86 @@
+#ifndef GENERATIONS_PARTICLES_H
+#define GENERATIONS_PARTICLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "RenderQueue.h"
+
+namespace SGE {
+
+    //spawns particles at the position of its entity, drawn by the ParticleSystem as one instance of mesh each. They
+    //leave along direction at speed, every velocity component is randomized by up to spread times speed, and they
+    //shrink from size to nothing over lifetime. Changing capacity drops the emitter's live particles.
+    struct ParticleEmitter {
+        uint32_t mesh = 0;
+        float rate = 100.f;
+        float lifetime = 2.f;
+        float speed = 1.f;
+        float spread = 0.f;
+        float size = 0.1f;
+        glm::vec3 direction{0.f, 1.f, 0.f};
+        glm::vec3 gravity{0.f};
+        uint32_t capacity = 4096;
+        bool emitting = true;
+    };
+
+    struct ParticleSpawn {
+        glm::vec3 position{0.f};
+        glm::vec3 velocity{0.f};
+        float spread = 0.f;
+        float lifetime = 1.f;
+        float size = 1.f;
+    };
+
+    //a fixed number of particles kept as one array per attribute, so a SIMD lane loads the same attribute of eight
+    //particles at once. Live particles are always the first size() entries, a particle that dies is replaced by the
+    //last one. The arrays are padded to a multiple of eight and never reallocated after construction.
+    class ParticlePool {
+    public:
+        //particles updated or written by one task, a multiple of every lane count
+        static constexpr size_t chunkSize = 16384;
+
+        explicit ParticlePool(uint32_t capacity, uint64_t seed = 1);
+
+        //adds up to count particles and returns how many fit
+        uint32_t spawn(uint32_t count, const ParticleSpawn &spawn);
+
+        //moves every particle by dt under gravity, then removes the ones past their lifetime. Chunks are updated in
+        //parallel.
+        void update(float dt, const glm::vec3 &gravity);
+
+        //writes the world matrix of every live particle in pool order, chunks are written in parallel
+        void writeInstances(InstanceData *instances) const;
+
+        uint32_t size() const;
+
+        uint32_t getCapacity() const;
+
+        glm::vec3 getPosition(uint32_t particle) const;
+
+        float getAge(uint32_t particle) const;
+
+    private:
+        //integrates [first, last), 8 or 4 particles per instruction where available
+        void updateRange(size_t first, size_t last, float dt, const glm::vec3 &gravity);
+
+        void writeRange(size_t first, size_t last, InstanceData *instances) const;
+
+        void removeDead();
+
+        float random();
+
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> velocityX, velocityY, velocityZ;
+        std::vector<float> age, lifetime, startSize;
+        uint32_t count = 0;
+        uint32_t capacity = 0;
+        uint64_t state;
+    };
+
+}
+
+#endif //GENERATIONS_PARTICLES_H
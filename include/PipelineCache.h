@@ -0,0 +1,117 @@
+#ifndef GENERATIONS_PIPELINECACHE_H
+#define GENERATIONS_PIPELINECACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Includes.h"
+
+namespace SGE {
+
+    struct ShaderSource {
+        Diligent::SHADER_TYPE type = Diligent::SHADER_TYPE_UNKNOWN;
+        std::string name;
+        std::string entryPoint = "main";
+        std::string source;
+    };
+
+    //everything that makes two pipelines different, the shaders are identified by the hash of their source
+    struct PipelineDesc {
+        std::string name;
+        ShaderSource vertexShader;
+        ShaderSource pixelShader;
+        std::vector<Diligent::LayoutElement> layout;
+        Diligent::TEXTURE_FORMAT rtvFormat = Diligent::TEX_FORMAT_UNKNOWN;
+        Diligent::TEXTURE_FORMAT dsvFormat = Diligent::TEX_FORMAT_UNKNOWN;
+        Diligent::PRIMITIVE_TOPOLOGY topology = Diligent::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        Diligent::CULL_MODE cullMode = Diligent::CULL_MODE_BACK;
+        Diligent::FILL_MODE fillMode = Diligent::FILL_MODE_SOLID;
+        bool depthEnable = true;
+        bool depthWrite = true;
+        //pixel shader textures the bindings set at run time, each sampled through a linear clamping sampler
+        std::vector<std::string> textures;
+    };
+
+    //the part of the render device the cache needs, kept narrow so the cache can run against a stub without a gpu
+    class PipelineDevice {
+    public:
+        virtual ~PipelineDevice() = default;
+
+        //part of every shader hash since bytecode from one backend is useless to another
+        virtual std::string getBackendName() const = 0;
+
+        //backends that can only build shaders from source get the source back as their "bytecode" and are never
+        //persisted
+        virtual bool canLoadBytecode() const = 0;
+
+        virtual bool compileShader(const ShaderSource &shader, std::vector<uint8_t> &bytecode, std::string &error) = 0;
+
+        virtual bool createPipeline(const PipelineDesc &desc, const std::vector<uint8_t> &vertexBytecode,
+                                    const std::vector<uint8_t> &pixelBytecode,
+                                    Diligent::RefCntAutoPtr<Diligent::IPipelineState> &pipeline,
+                                    std::string &error) = 0;
+    };
+
+    class DiligentPipelineDevice : public PipelineDevice {
+    public:
+        explicit DiligentPipelineDevice(Diligent::IRenderDevice *device);
+
+        std::string getBackendName() const override;
+
+        bool canLoadBytecode() const override;
+
+        bool compileShader(const ShaderSource &shader, std::vector<uint8_t> &bytecode, std::string &error) override;
+
+        bool createPipeline(const PipelineDesc &desc, const std::vector<uint8_t> &vertexBytecode,
+                            const std::vector<uint8_t> &pixelBytecode,
+                            Diligent::RefCntAutoPtr<Diligent::IPipelineState> &pipeline,
+                            std::string &error) override;
+
+    private:
+        bool createShader(Diligent::SHADER_TYPE type, const std::string &name, const std::vector<uint8_t> &bytecode,
+                          Diligent::RefCntAutoPtr<Diligent::IShader> &shader);
+
+        Diligent::IRenderDevice *m_device;
+        Diligent::RefCntAutoPtr<Diligent::IShaderSourceInputStreamFactory> m_sourceFactory;
+    };
+
+    //pipelines are shared by every description that hashes the same within a run, compiled shader bytecode is kept
+    //on disk under <directory>/<hash>.bin so later runs skip the compiler entirely
+    class PipelineCache {
+    public:
+        PipelineCache(PipelineDevice *device, std::string directory);
+
+        bool getPipeline(const PipelineDesc &desc, Diligent::RefCntAutoPtr<Diligent::IPipelineState> &pipeline,
+                         std::string &error);
+
+        uint64_t hashShader(const ShaderSource &shader) const;
+
+        uint64_t hashPipeline(const PipelineDesc &desc) const;
+
+        static bool readSource(const std::string &path, std::string &source);
+
+        size_t getPipelineHits() const;
+
+        size_t getShaderCompiles() const;
+
+        size_t getShaderDiskHits() const;
+
+    private:
+        bool getBytecode(const ShaderSource &shader, std::vector<uint8_t> &bytecode, std::string &error);
+
+        std::string getCachePath(uint64_t hash) const;
+
+        PipelineDevice *m_device;
+        std::string m_directory;
+        std::unordered_map<uint64_t, Diligent::RefCntAutoPtr<Diligent::IPipelineState>> m_pipelines;
+        std::unordered_map<uint64_t, std::vector<uint8_t>> m_bytecode;
+        size_t m_pipelineHits = 0;
+        size_t m_shaderCompiles = 0;
+        size_t m_shaderDiskHits = 0;
+    };
+
+}
+
+#endif //GENERATIONS_PIPELINECACHE_H
@@ -0,0 +1,44 @@
+#ifndef GENERATIONS_PROCEDURALMESH_H
+#define GENERATIONS_PROCEDURALMESH_H
+
+#include <string>
+#include <cstdint>
+
+#include "Components.h"
+
+namespace SGE {
+
+    enum class ProceduralShape {
+        Grid,
+        Plane,
+        CubeSphere
+    };
+
+    struct ProceduralMeshDesc {
+        ProceduralShape shape = ProceduralShape::Grid;
+        //grid: vertex counts along x and y, plane: quads along each side, cubesphere: quads along each face edge
+        uint32_t width = 2;
+        uint32_t height = 2;
+        //grid: distance between vertices, plane: side length, cubesphere: radius
+        float size = 1.f;
+    };
+
+    //all shapes use clockwise front faces to match the default Diligent rasterizer state
+    class ProceduralMesh {
+    public:
+        static bool generate(const ProceduralMeshDesc &desc, MeshComponent &mesh);
+
+        //width by height vertices centred on the origin in the xy plane, one row is generated per task
+        static void grid(MeshComponent &mesh, uint32_t width, uint32_t height, float spacing);
+
+        static void plane(MeshComponent &mesh, float sideLength, uint32_t subdivisions);
+
+        //each cube face is generated by its own task, the seams are not welded
+        static void cubeSphere(MeshComponent &mesh, uint32_t subdivisions, float radius);
+
+        static bool parseShape(const std::string &name, ProceduralShape &shape);
+    };
+
+}
+
+#endif //GENERATIONS_PROCEDURALMESH_H
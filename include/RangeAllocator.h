@@ -0,0 +1,92 @@
+#ifndef GENERATIONS_RANGEALLOCATOR_H
+#define GENERATIONS_RANGEALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace SGE {
+
+    //two level segregated fit allocator over a range of elements. Free blocks are binned by the top bits of their
+    //size, a bitmap per level finds a large enough bin in constant time and neighbouring free blocks are merged on
+    //free. Works on plain offsets so it can sit in front of any buffer.
+    class RangeAllocator {
+    public:
+        static constexpr uint64_t invalidOffset = UINT64_MAX;
+
+        struct Move {
+            uint64_t from;
+            uint64_t to;
+            uint64_t size;
+        };
+
+        explicit RangeAllocator(uint64_t capacity = 0);
+
+        //offset of size free elements, or invalidOffset when no free block is large enough
+        uint64_t allocate(uint64_t size);
+
+        void free(uint64_t offset);
+
+        //extends the range, the new space joins a free block at the end
+        void grow(uint64_t newCapacity);
+
+        //packs every allocation to the start of the range in offset order and returns the copies that do it, the
+        //moves never overlap a destination that is still to be read when applied in order
+        std::vector<Move> defragment();
+
+        uint64_t getCapacity() const;
+
+        uint64_t getUsedSize() const;
+
+        uint64_t getLargestFreeBlock() const;
+
+        //share of the free space that is not in the largest free block, 0 when all of it is contiguous
+        float getFragmentation() const;
+
+        size_t getAllocationCount() const;
+
+    private:
+        static constexpr uint32_t secondLevelBits = 3;
+        static constexpr uint32_t secondLevelCount = 1u << secondLevelBits;
+        static constexpr uint32_t firstLevelCount = 64 - secondLevelBits + 1;
+        static constexpr uint32_t none = UINT32_MAX;
+
+        struct Block {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint32_t previous = none;
+            uint32_t next = none;
+            uint32_t previousFree = none;
+            uint32_t nextFree = none;
+            bool free = false;
+        };
+
+        static void mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel);
+
+        uint32_t newBlock();
+
+        void insertFree(uint32_t block);
+
+        void removeFree(uint32_t block);
+
+        //merges the block with free physical neighbours and bins the result
+        void release(uint32_t block);
+
+        uint32_t findFree(uint64_t size) const;
+
+        std::vector<Block> blocks;
+        std::vector<uint32_t> unusedBlocks;
+        std::unordered_map<uint64_t, uint32_t> allocated;
+        std::vector<uint32_t> bins;
+        uint64_t firstLevelMap = 0;
+        std::vector<uint32_t> secondLevelMaps;
+        uint32_t first = none;
+        uint32_t last = none;
+        uint64_t capacity = 0;
+        uint64_t used = 0;
+    };
+
+}
+
+#endif //GENERATIONS_RANGEALLOCATOR_H
@@ -0,0 +1,186 @@
+#ifndef GENERATIONS_RENDERGRAPH_H
+#define GENERATIONS_RENDERGRAPH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace SGE {
+
+    enum class ResourceState : uint8_t {
+        Undefined,
+        RenderTarget,
+        DepthWrite,
+        DepthRead,
+        ShaderResource,
+        UnorderedAccess,
+        CopySource,
+        CopyDest,
+        Present
+    };
+
+    //format and bind flags hold the backend's own values, the graph only compares them
+    struct TextureInfo {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t format = 0;
+        uint32_t bindFlags = 0;
+        uint32_t bytesPerPixel = 4;
+
+        bool operator==(const TextureInfo &other) const;
+
+        uint64_t size() const;
+    };
+
+    //a handle names one version of a resource, every write produces a new version
+    using ResourceHandle = uint32_t;
+
+    struct GraphBarrier {
+        uint32_t physical;
+        ResourceState before;
+        ResourceState after;
+    };
+
+    class RenderGraph;
+
+    //applies the compiled graph to a device
+    class GraphBackend {
+    public:
+        virtual ~GraphBackend() = default;
+
+        //called before the first pass, creates or recycles a texture for every physical resource
+        virtual void prepare(const RenderGraph &graph) = 0;
+
+        virtual void transition(const RenderGraph &graph, const std::vector<GraphBarrier> &barriers) = 0;
+    };
+
+    struct CompiledPass {
+        uint32_t pass;
+        std::vector<GraphBarrier> barriers;
+    };
+
+    struct RenderGraphStats {
+        uint32_t passCount = 0;
+        uint32_t culledPasses = 0;
+        uint32_t barrierCount = 0;
+        uint32_t transientCount = 0;
+        uint32_t physicalCount = 0;
+        //memory every transient would need on its own and what is allocated after aliasing
+        uint64_t transientBytes = 0;
+        uint64_t allocatedBytes = 0;
+    };
+
+    //passes declare what they read and write and the compiler works out the rest. Passes are ordered by their
+    //dependencies, passes whose results nobody uses are dropped, every state change becomes a barrier before the
+    //pass that needs it and transient textures whose lifetimes do not overlap share one physical texture. Compiling
+    //is cpu only, the GraphBackend turns the result into device calls.
+    class RenderGraph {
+    public:
+        static constexpr uint32_t none = UINT32_MAX;
+
+        class PassBuilder {
+        public:
+            void read(ResourceHandle handle, ResourceState state);
+
+            //returns the handle of the version this pass produces, later readers should use it
+            ResourceHandle write(ResourceHandle handle, ResourceState state);
+
+            //keeps the pass even when nothing reads its results
+            void sideEffect();
+
+        private:
+            friend class RenderGraph;
+
+            PassBuilder(RenderGraph *graph, uint32_t pass);
+
+            RenderGraph *m_graph;
+            uint32_t m_pass;
+        };
+
+        //drops every pass and resource
+        void reset();
+
+        //a texture owned outside the graph, such as the back buffer. Writing to it counts as a side effect and it
+        //is left in finalState.
+        ResourceHandle importTexture(const std::string &name, const TextureInfo &info, ResourceState initialState,
+                                     ResourceState finalState);
+
+        //a texture that only lives between its first and last use this frame
+        ResourceHandle createTexture(const std::string &name, const TextureInfo &info);
+
+        uint32_t addPass(const std::string &name, const std::function<void(PassBuilder &)> &setup,
+                         std::function<void()> execute);
+
+        bool compile(std::string &error);
+
+        //runs the compiled passes with their barriers
+        void execute(GraphBackend &backend) const;
+
+        const std::vector<CompiledPass> &getCompiledPasses() const;
+
+        const std::vector<GraphBarrier> &getFinalBarriers() const;
+
+        const std::string &getPassName(uint32_t pass) const;
+
+        //physical texture holding the resource of any version of it
+        uint32_t getPhysical(ResourceHandle handle) const;
+
+        const std::vector<TextureInfo> &getPhysicalTextures() const;
+
+        //whether the physical texture is an imported one, which the backend does not create
+        bool isImported(uint32_t physical) const;
+
+        const RenderGraphStats &getStats() const;
+
+    private:
+        struct Resource {
+            std::string name;
+            TextureInfo info;
+            bool imported = false;
+            ResourceState initialState = ResourceState::Undefined;
+            ResourceState finalState = ResourceState::Undefined;
+            uint32_t physical = none;
+        };
+
+        struct Version {
+            uint32_t resource;
+            uint32_t writer = none;
+            uint32_t previous = none;
+            std::vector<uint32_t> readers;
+        };
+
+        struct Access {
+            ResourceHandle version;
+            ResourceState state;
+        };
+
+        struct Pass {
+            std::string name;
+            std::function<void()> execute;
+            std::vector<Access> reads;
+            std::vector<Access> writes;
+            bool sideEffect = false;
+        };
+
+        bool order(std::string &error);
+
+        void assignPhysical();
+
+        bool buildBarriers(std::string &error);
+
+        std::vector<Resource> resources;
+        std::vector<Version> versions;
+        std::vector<Pass> passes;
+
+        std::vector<uint32_t> ordered;
+        std::vector<CompiledPass> compiled;
+        std::vector<GraphBarrier> finalBarriers;
+        std::vector<TextureInfo> physicalTextures;
+        std::vector<bool> physicalImported;
+        RenderGraphStats stats;
+    };
+
+}
+
+#endif //GENERATIONS_RENDERGRAPH_H
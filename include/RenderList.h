@@ -0,0 +1,65 @@
+#ifndef GENERATIONS_RENDERLIST_H
+#define GENERATIONS_RENDERLIST_H
+
+#include <cstdint>
+#include <vector>
+
+#include "RenderQueue.h"
+
+namespace SGE {
+
+    //records the draws of one contiguous range of batches. begin, record and end run on a worker thread, submit runs
+    //on the submitting thread once every worker is done, in range order
+    class CommandRecorder {
+    public:
+        virtual ~CommandRecorder() = default;
+
+        virtual void begin() = 0;
+
+        virtual void record(const DrawBatch &batch) = 0;
+
+        virtual void end() = 0;
+
+        virtual void submit() = 0;
+    };
+
+    struct RecordRange {
+        uint32_t first = 0;
+        uint32_t last = 0;
+    };
+
+    class RenderList {
+    public:
+        //splits the sorted batches into at most workerCount contiguous, non empty ranges of roughly equal cost, where a
+        //batch costs a fixed amount for its state changes plus one per instance
+        static std::vector<RecordRange> partition(const std::vector<DrawBatch> &batches, uint32_t workerCount,
+                                                  uint32_t batchCost = 64);
+
+        //records every range on its own recorder in parallel and then submits the recorders in range order, so the
+        //result matches recording the whole list on one thread
+        static void record(const std::vector<DrawBatch> &batches, const std::vector<RecordRange> &ranges,
+                           const std::vector<CommandRecorder *> &recorders);
+    };
+
+    //recording stub, collects the draws instead of issuing them so partitioning and merge order can be checked
+    //without a device
+    class PacketRecorder : public CommandRecorder {
+    public:
+        explicit PacketRecorder(std::vector<DrawBatch> *merged);
+
+        void begin() override;
+
+        void record(const DrawBatch &batch) override;
+
+        void end() override;
+
+        void submit() override;
+
+    private:
+        std::vector<DrawBatch> *m_merged;
+        std::vector<DrawBatch> m_packets;
+    };
+
+}
+
+#endif //GENERATIONS_RENDERLIST_H
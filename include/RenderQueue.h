@@ -0,0 +1,85 @@
+#ifndef GENERATIONS_RENDERQUEUE_H
+#define GENERATIONS_RENDERQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace SGE {
+
+    struct RenderItem {
+        uint64_t key = 0;
+        uint32_t instance = 0;
+    };
+
+    //per instance vertex data, read from the second vertex buffer slot by instanced shaders
+    struct InstanceData {
+        glm::mat4 world{1.f};
+    };
+
+    //one instanced draw, the instances are the contiguous range [firstInstance, firstInstance + instanceCount)
+    struct DrawBatch {
+        uint64_t pipeline = 0;
+        uint32_t mesh = 0;
+        uint32_t lod = 0;
+        uint32_t firstInstance = 0;
+        uint32_t instanceCount = 0;
+    };
+
+    //collects everything visible this frame, sorts it by a 64 bit key and merges runs with the same pipeline, mesh
+    //and lod into instanced draws. It knows nothing about the registry or the device so it can be driven and timed
+    //headless.
+    //key layout, most significant first: pipeline slot (12 bits), mesh slot (20 bits), lod (4 bits), depth (28 bits)
+    class RenderQueue {
+    public:
+        static constexpr uint32_t pipelineBits = 12;
+        static constexpr uint32_t meshBits = 20;
+        static constexpr uint32_t lodBits = 4;
+        static constexpr uint32_t depthBits = 28;
+
+        void clear();
+
+        void reserve(size_t count);
+
+        //pipeline is any value that identifies the pipeline state, depth is 0 at the near plane and 1 at the far one
+        void push(uint64_t pipeline, uint32_t mesh, uint32_t lod, float depth, const glm::mat4 &world);
+
+        void sort();
+
+        //fills the batches and rewrites the instances into sorted order, call after sort
+        void buildBatches();
+
+        static uint64_t makeKey(uint32_t pipelineSlot, uint32_t meshSlot, uint32_t lod, float depth);
+
+        size_t size() const;
+
+        const std::vector<RenderItem> &getItems() const;
+
+        const std::vector<InstanceData> &getInstances() const;
+
+        const std::vector<DrawBatch> &getBatches() const;
+
+    private:
+        uint32_t getPipelineSlot(uint64_t pipeline);
+
+        uint32_t getMeshSlot(uint32_t mesh);
+
+        std::vector<RenderItem> items;
+        std::vector<RenderItem> scratch;
+        std::vector<InstanceData> gathered;
+        std::vector<InstanceData> instances;
+        std::vector<DrawBatch> batches;
+
+        //slots stay stable across frames so keys of unchanged entities do not move
+        std::unordered_map<uint64_t, uint32_t> pipelineSlots;
+        std::unordered_map<uint32_t, uint32_t> meshSlots;
+        std::vector<uint64_t> pipelines;
+        std::vector<uint32_t> meshes;
+    };
+
+}
+
+#endif //GENERATIONS_RENDERQUEUE_H
@@ -0,0 +1,101 @@
+#ifndef GENERATIONS_SOFTWARERASTERIZER_H
+#define GENERATIONS_SOFTWARERASTERIZER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Components.h"
+#include "RenderList.h"
+#include "RenderQueue.h"
+
+namespace SGE {
+
+    //colors are packed as 0xAABBGGRR, depth is in [0, 1] with 1 at the far plane
+    struct Framebuffer {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint32_t> color;
+        std::vector<float> depth;
+
+        void resize(uint32_t newWidth, uint32_t newHeight);
+
+        void clear(uint32_t clearColor, float clearDepth);
+
+        //binary ppm, enough for image diffs without pulling in an image library
+        bool writePpm(const std::string &path) const;
+    };
+
+    //a triangle after projection, in pixels with the attributes divided by w for perspective correct interpolation
+    struct RasterTriangle {
+        float x[3], y[3], z[3];
+        float inverseW[3];
+        glm::vec4 colorOverW[3];
+    };
+
+    //cpu stand in for the gpu that runs the same sorted draw batches. Recorders transform and clip their ranges in
+    //parallel, the triangles are then binned into tiles in submission order and every tile is rasterized with a
+    //depth test on its own thread, so the image does not depend on how the work was split. Vertex colors come from
+    //the texCoord channel since meshes carry no other material data.
+    class SoftwareRasterizer {
+    public:
+        static constexpr uint32_t tileSize = 64;
+
+        SoftwareRasterizer(uint32_t width, uint32_t height);
+
+        //meshes by id, looked up read only while recording
+        void setMeshes(const std::unordered_map<uint32_t, const MeshComponent *> *meshes);
+
+        void beginFrame(const glm::mat4 &viewProj, const std::vector<InstanceData> *instances,
+                        uint32_t clearColor = 0xff000000);
+
+        //transforms, clips and projects every instance of the batch, safe to call from several threads
+        void transform(const DrawBatch &batch, std::vector<RasterTriangle> &triangles) const;
+
+        //adds triangles in the order they should be drawn, called from one thread
+        void append(const std::vector<RasterTriangle> &triangles);
+
+        //bins everything appended and rasterizes the tiles in parallel
+        void rasterize();
+
+        const Framebuffer &getFramebuffer() const;
+
+        size_t getTriangleCount() const;
+
+    private:
+        void rasterizeTile(uint32_t tile);
+
+        void emit(const glm::vec4 *clip, const glm::vec4 *colors, std::vector<RasterTriangle> &triangles) const;
+
+        Framebuffer framebuffer;
+        uint32_t tilesX = 0;
+        uint32_t tilesY = 0;
+        glm::mat4 viewProj{1.f};
+        const std::unordered_map<uint32_t, const MeshComponent *> *meshes = nullptr;
+        const std::vector<InstanceData> *instances = nullptr;
+        std::vector<RasterTriangle> triangles;
+        std::vector<std::vector<uint32_t>> tileTriangles;
+    };
+
+    //records a range of batches into triangles for the SoftwareRasterizer, submit appends them in range order
+    class RasterRecorder : public CommandRecorder {
+    public:
+        explicit RasterRecorder(SoftwareRasterizer *rasterizer);
+
+        void begin() override;
+
+        void record(const DrawBatch &batch) override;
+
+        void end() override;
+
+        void submit() override;
+
+    private:
+        SoftwareRasterizer *m_rasterizer;
+        std::vector<RasterTriangle> m_triangles;
+    };
+
+}
+
+#endif //GENERATIONS_SOFTWARERASTERIZER_H
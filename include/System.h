@@ -2,11 +2,31 @@
 #define VULKAN_SYSTEM_H
 
 #include "ModelLoader.h"
+#include "AssetStreamer.h"
+#include "ProceduralMesh.h"
+#include "MeshImporter.h"
+#include "FileWatcher.h"
+#include "RenderQueue.h"
+#include "Culling.h"
+#include "RenderList.h"
+#include "ContextRecorder.h"
+#include "UniformRing.h"
+#include "Tilemap.h"
+#include "TextLayout.h"
+#include "AnchorLayout.h"
+#include "FlowField.h"
+#include "Flocking.h"
+#include "Animation.h"
+#include "DebugDraw.h"
+#include "Particles.h"
 #include <cassert>
+#include <cstring>
 #include <filesystem>
 #include <execution>
 #include <iostream>
 #include <atomic>
+#include <future>
+#include <unordered_set>
 
 #include "Input.h"
 #include "CustomYaml.h"
@@ -47,9 +67,38 @@ namespace SGE {
         void setUp(entt::registry *registry, YAML::Node &node) {
             node = node["MeshModelLoader"];
             for (auto it = node.begin(); it != node.end(); it++) {
+                if (it->second["procedural"]) {
+                    ProceduralMeshDesc desc;
+                    std::string shape = it->second["procedural"].as<std::string>();
+                    if (!ProceduralMesh::parseShape(shape, desc.shape)) {
+                        boxer::show(("Unknown procedural shape " + shape).c_str(), "Mesh Model Loader Error");
+                        continue;
+                    }
+                    desc.width = it->second["width"].as<uint32_t>();
+                    if (it->second["height"])
+                        desc.height = it->second["height"].as<uint32_t>();
+                    if (it->second["size"])
+                        desc.size = it->second["size"].as<float>();
+                    procedural.emplace_back(it->second["id"].as<entt::entity>(), desc);
+                    continue;
+                }
+                if (!it->second["file"])
+                    continue;
                 translation.insert(std::pair<std::string, entt::entity>(it->second["file"].as<std::string>(),
                                                                         it->second["id"].as<entt::entity>()));
             }
+            //the shader description each mesh is drawn with, loaded once the mesh is on the gpu. Entries with only a
+            //shader are programs for systems that write their own vertices, such as the debug lines
+            for (auto it = node.begin(); it != node.end(); it++) {
+                if (!it->second["shader"])
+                    continue;
+                auto entity = it->second["id"].as<entt::entity>();
+                auto loc = it->second["shader"].as<std::string>();
+                if (it->second["file"] || it->second["procedural"])
+                    shaders.emplace_back(entity, loc);
+                else
+                    programs.emplace_back(entity, loc);
+            }
             setUp(registry);
         }
 
@@ -58,23 +107,52 @@ namespace SGE {
         }
 
         bool run() {
-            const std::filesystem::path path{"data/models"};
             ModelLoader *modelLoader = ModelLoader::createInstance(m_registry);
-            for (const auto &entry: std::filesystem::directory_iterator(path)) {
-                std::string fileName = entry.path().filename().string();
-                if (fileName.find("example") != std::string::npos)
-                    continue;
-                for (auto it = translation.find(fileName); it != translation.end(); it = translation.find(fileName)) {
-                    modelLoader->loadMesh(fileName);
-                    translation.erase(it);
+            //meshes are looked up by name in the asset archive, or opened directly when they are not packed, so
+            //there is no need to scan the models directory. Every read is hinted first so the pages load together.
+            for (const auto &[fileName, entity]: translation) {
+                ModelLoader::prefetchMesh(fileName);
+            }
+            for (const auto &[fileName, entity]: translation) {
+                if (modelLoader->loadMesh(fileName, (uint32_t) entity))
+                    modelLoader->attachMesh(entity, (uint32_t) entity);
+            }
+            translation.clear();
+
+            //procedural meshes are generated on demand instead of being shipped as text assets
+            for (auto &[entity, desc]: procedural) {
+                MeshComponent mesh;
+                if (ProceduralMesh::generate(desc, mesh)) {
+                    modelLoader->addMesh((uint32_t) entity, std::move(mesh));
+                    modelLoader->attachMesh(entity, (uint32_t) entity);
                 }
             }
+            procedural.clear();
+
+            //meshes given a shader go to the gpu now and are drawn from the first frame, streamed meshes upload on
+            //their own schedule
+            for (auto &[entity, loc]: shaders) {
+                auto id = (uint32_t) entity;
+                if (!modelLoader->hasMesh(id))
+                    continue;
+                std::string name = "mesh " + std::to_string(id);
+                if (modelLoader->createVertexBuffer(id, name) && modelLoader->createIndexBuffer(id, name))
+                    modelLoader->loadShader(loc, id);
+            }
+            shaders.clear();
+            for (auto &[entity, loc]: programs) {
+                modelLoader->loadShader(loc, (uint32_t) entity);
+            }
+            programs.clear();
             return true;
         }
 
     private:
         entt::registry *m_registry;
         std::multimap<std::string, entt::entity> translation;
+        std::vector<std::pair<entt::entity, ProceduralMeshDesc>> procedural;
+        std::vector<std::pair<entt::entity, std::string>> shaders;
+        std::vector<std::pair<entt::entity, std::string>> programs;
     };
 
     class GraphicsUnloader : public System {
@@ -163,6 +241,7 @@ namespace SGE {
 
         void setUp(entt::registry *registry) {
             m_registry = registry;
+            registry->emplace_or_replace<CameraView>(camera);
             recalculatePosition(registry->get<CameraComponent>(camera).position);
         }
 
@@ -194,10 +273,16 @@ namespace SGE {
                 float half_width = half_height * ratio;
 
                 ortho = glm::ortho(-half_width, half_width, -half_height, half_height, 0.0f, 100.f);
+                halfSize = {half_width, half_height};
             }
 
             scaledOrtho = ortho * scale;
-            //add in code to set view transform
+
+            //the ortho projection maps one unit to one pixel before zooming, so zoom is also pixels per unit
+            auto &view = m_registry->get<CameraView>(camera);
+            view.viewProj = scaledOrtho * cameraMtx;
+            view.pixelsPerUnit = cameraComponent.zoom;
+            view.halfExtents = cameraComponent.zoom > 0.f ? halfSize / cameraComponent.zoom : halfSize;
 
             return true;
         }
@@ -217,6 +302,7 @@ namespace SGE {
         glm::mat4 scaledOrtho{0};
         glm::mat4 scale{0};
         glm::mat4 cameraMtx;
+        glm::vec2 halfSize{0.f};
         float previousZoom = 0.f;
     };
 
@@ -242,6 +328,7 @@ namespace SGE {
                 auto &transform = m_registry->get<Transform>(entity);
                 auto &physics = m_registry->get<Physics>(entity);
                 transform.position += (physics.velocity * dt) + 0.5f * physics.acceleration * dt * dt;
+                physics.velocity += physics.acceleration * dt;
             }
             return true;
         }
@@ -251,6 +338,246 @@ namespace SGE {
         entt::entity timer;
     };
 
+    //plays every Animator's clip on its Transform. clips lists the clips by name with the id animators play them by
+    //and their file in data/animations, a file listed under several ids is loaded once. All animators are sampled
+    //together in one batched pass, an animator whose clip id is not listed is left alone.
+    class AnimationPlayer : public System {
+    public:
+        AnimationPlayer() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            YAML::Node config = node["AnimationPlayer"];
+            timer = config["timer"].as<entt::entity>();
+            YAML::Node clips = config["clips"];
+            for (auto it = clips.begin(); it != clips.end(); it++) {
+                auto id = it->second["id"].as<uint32_t>();
+                auto file = it->second["file"].as<std::string>();
+                uint32_t clip = library.find(file);
+                if (clip == library.size()) {
+                    try {
+                        clip = library.add(file, YAML::LoadFile("data/animations/" + file).as<AnimationClip>());
+                    } catch (const YAML::Exception &e) {
+                        boxer::show(("Could not load the animation " + file + ": " + e.what()).c_str(),
+                                    "Error loading animation");
+                        continue;
+                    }
+                }
+                if (clipsById.size() <= id)
+                    clipsById.resize(id + 1, UINT32_MAX);
+                clipsById[id] = clip;
+            }
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            float dt = m_registry->get<Time>(timer).dt;
+            auto view = m_registry->view<Animator, Transform>();
+            animated.clear();
+            for (auto entity: view) {
+                uint32_t clip = view.get<Animator>(entity).clip;
+                if (clip < clipsById.size() && library.get(clipsById[clip]))
+                    animated.push_back(entity);
+            }
+            sampler.resize((uint32_t) animated.size());
+            //the entity's place in animated is its slot in the sampler
+            std::for_each(std::execution::par, animated.begin(), animated.end(), [&](const entt::entity &entity) {
+                auto &animator = view.get<Animator>(entity);
+                sampler.prepare((uint32_t) (&entity - animated.data()), *library.get(clipsById[animator.clip]),
+                                animator, view.get<Transform>(entity), dt);
+            });
+            sampler.evaluate();
+            std::for_each(std::execution::par, animated.begin(), animated.end(), [&](const entt::entity &entity) {
+                sampler.read((uint32_t) (&entity - animated.data()), view.get<Transform>(entity));
+            });
+            return true;
+        }
+
+    private:
+        AnimationLibrary library;
+        //library's clip by the ids animators use, UINT32_MAX for ids not listed
+        std::vector<uint32_t> clipsById;
+        AnimationSampler sampler;
+        std::vector<entt::entity> animated;
+        entt::entity timer;
+        entt::registry *m_registry;
+    };
+
+    //steers every NavAgent through the flow field of its goal. The fields are built over the tilemap's tiles, each
+    //tile id costing what costs lists for it, and are shared by all agents with the same goal. Tiles edited during
+    //play only make the fields search again what lies behind the edited sectors. A field that still has to reach
+    //an agent grows by at most budget cells a frame, agents it has not reached yet wait where they are.
+    class Navigation : public System {
+    public:
+        static_assert(Tilemap::chunkSize == NavGrid::sectorSize, "a tilemap chunk has to map onto one sector");
+
+        Navigation() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            YAML::Node config = node["Navigation"];
+            map = config["map"].as<entt::entity>();
+            if (config["costs"])
+                costs = config["costs"].as<std::vector<uint32_t>>();
+            if (config["maxFields"])
+                maxFields = std::max(1u, config["maxFields"].as<uint32_t>());
+            if (config["budget"])
+                budget = std::max(1u, config["budget"].as<uint32_t>());
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            if (!sync())
+                return true;
+
+            auto view = m_registry->view<NavAgent, Transform, Physics>();
+            agents.clear();
+            FlowField *field = nullptr;
+            uint32_t fieldX = UINT32_MAX, fieldY = UINT32_MAX;
+            for (auto entity: view) {
+                const auto &agent = view.get<NavAgent>(entity);
+                uint32_t goalX, goalY, x, y;
+                if (!grid->cellAt(agent.goal, goalX, goalY) ||
+                    !grid->cellAt(glm::vec2(view.get<Transform>(entity).position), x, y)) {
+                    view.get<Physics>(entity).velocity = glm::vec3(0.f);
+                    continue;
+                }
+                //agents sharing a goal are usually created together, so the last field is tried first
+                if (goalX != fieldX || goalY != fieldY) {
+                    field = cache->get(goalX, goalY);
+                    fieldX = goalX;
+                    fieldY = goalY;
+                }
+                field->require(x, y);
+                agents.push_back({entity, field, x, y});
+            }
+            cache->expand(budget);
+
+            std::for_each(std::execution::par, agents.begin(), agents.end(), [&](const AgentCell &agent) {
+                glm::vec2 direction(0.f);
+                agent.field->getDirection(agent.x, agent.y, direction);
+                float speed = view.get<NavAgent>(agent.entity).speed;
+                view.get<Physics>(agent.entity).velocity = glm::vec3(direction * speed, 0.f);
+            });
+            cache->endFrame();
+            return true;
+        }
+
+    private:
+        struct AgentCell {
+            entt::entity entity;
+            FlowField *field;
+            uint32_t x, y;
+        };
+
+        //copies the costs of every chunk edited since the last frame into the grid and repairs the fields
+        bool sync() {
+            auto *component = m_registry->try_get<TilemapComponent>(map);
+            if (component == nullptr || !component->tilemap)
+                return false;
+            const Tilemap &tilemap = *component->tilemap;
+            if (!grid) {
+                grid = std::make_unique<NavGrid>(tilemap.getWidth(), tilemap.getHeight(), tilemap.getTileSize(),
+                                                 tilemap.getOrigin());
+                cache = std::make_unique<FlowFieldCache>(grid.get(), maxFields);
+                versions.assign(tilemap.getChunkCount(), UINT32_MAX);
+            }
+
+            for (uint32_t chunk = 0; chunk < versions.size(); chunk++) {
+                if (versions[chunk] == tilemap.getChunkVersion(chunk))
+                    continue;
+                versions[chunk] = tilemap.getChunkVersion(chunk);
+                uint32_t x0 = chunk % grid->getSectorsX() * NavGrid::sectorSize;
+                uint32_t y0 = chunk / grid->getSectorsX() * NavGrid::sectorSize;
+                uint32_t x1 = std::min(x0 + NavGrid::sectorSize, grid->getWidth());
+                uint32_t y1 = std::min(y0 + NavGrid::sectorSize, grid->getHeight());
+                for (uint32_t y = y0; y < y1; y++) {
+                    for (uint32_t x = x0; x < x1; x++) {
+                        uint16_t tile = tilemap.get(x, y);
+                        grid->setCost(x, y, (uint8_t) std::min<uint32_t>(tile < costs.size() ? costs[tile] : 1,
+                                                                         NavGrid::blocked));
+                    }
+                }
+            }
+            grid->takeChangedSectors(changed);
+            cache->invalidate(changed);
+            return true;
+        }
+
+        std::unique_ptr<NavGrid> grid;
+        std::unique_ptr<FlowFieldCache> cache;
+        std::vector<uint32_t> versions;
+        std::vector<uint32_t> changed;
+        std::vector<AgentCell> agents;
+        //by tile id, ids past the end cost 1
+        std::vector<uint32_t> costs;
+        uint32_t maxFields = 8;
+        uint32_t budget = 16384;
+        entt::entity map = entt::null;
+        entt::registry *m_registry;
+    };
+
+    //flocks every Boid with the boids within radius of it in the xy plane, as configured by the FlockSettings keys
+    //of its node. The flock is hashed into cells and steered in parallel every frame, and the forces are written to
+    //Physics::acceleration for UpdateMovement to apply.
+    class Steering : public System {
+    public:
+        Steering() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            YAML::Node config = node["Steering"];
+            if (config) {
+                for (auto [key, value]: {std::pair{"radius", &settings.radius},
+                                         {"separationRadius", &settings.separationRadius},
+                                         {"separation", &settings.separation}, {"alignment", &settings.alignment},
+                                         {"cohesion", &settings.cohesion}}) {
+                    if (config[key])
+                        *value = config[key].as<float>();
+                }
+            }
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            auto view = m_registry->view<Boid, Transform, Physics>();
+            boids.assign(view.begin(), view.end());
+            flock.resize((uint32_t) boids.size());
+            //the entity's place in boids is its index in the flock
+            std::for_each(std::execution::par, boids.begin(), boids.end(), [&](const entt::entity &entity) {
+                flock.set((uint32_t) (&entity - boids.data()), glm::vec2(view.get<Transform>(entity).position),
+                          glm::vec2(view.get<Physics>(entity).velocity), view.get<Boid>(entity));
+            });
+            flock.steer(settings);
+            std::for_each(std::execution::par, boids.begin(), boids.end(), [&](const entt::entity &entity) {
+                view.get<Physics>(entity).acceleration =
+                        glm::vec3(flock.getAcceleration((uint32_t) (&entity - boids.data())), 0.f);
+            });
+            return true;
+        }
+
+    private:
+        Flock flock;
+        FlockSettings settings;
+        std::vector<entt::entity> boids;
+        entt::registry *m_registry;
+    };
+
     class PrimaryMovement : public System {
     public:
         PrimaryMovement() {
@@ -350,6 +677,686 @@ namespace SGE {
         bool detached = false;
     };
 
+    class AssetStreaming : public System {
+    public:
+        AssetStreaming() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            YAML::Node config = node["AssetStreaming"];
+            camera = config["camera"].as<entt::entity>();
+            size_t cpuBudget = config["cpuBudgetMB"].as<size_t>() << 20;
+            size_t gpuBudget = config["gpuBudgetMB"].as<size_t>() << 20;
+            uint32_t ioThreads = config["ioThreads"].as<uint32_t>();
+            if (config["compactThreshold"])
+                compactThreshold = config["compactThreshold"].as<float>();
+            streamer = std::make_unique<AssetStreamer>(ModelLoader::createInstance(registry), cpuBudget, gpuBudget,
+                                                       ioThreads);
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            glm::vec3 cameraPosition = m_registry->get<CameraComponent>(camera).position;
+            for (auto &&[entity, streamed, transform]: m_registry->view<StreamedMesh, Transform>().each()) {
+                if (streamed.changed) {
+                    streamer->retry(streamed.meshId);
+                    streamed.changed = false;
+                }
+                streamer->request(streamed.meshId, streamed.file, glm::distance(cameraPosition, transform.position));
+            }
+
+            streamer->update();
+
+            ModelLoader *modelLoader = ModelLoader::createInstance(m_registry);
+            //evictions leave holes in the shared geometry buffers, they are packed before they get too scattered
+            modelLoader->compactGeometry(compactThreshold);
+            for (auto &&[entity, streamed]: m_registry->view<StreamedMesh>().each()) {
+                bool resident = streamer->isResident(streamed.meshId);
+                if (resident && !streamed.resident) {
+                    //the program outlives evictions, it is only created the first time the mesh arrives
+                    if (!streamed.shader.empty() && !modelLoader->hasShaderProgram(streamed.meshId))
+                        modelLoader->loadShader(streamed.shader, streamed.meshId);
+                    modelLoader->attachMesh(entity, streamed.meshId);
+                    m_registry->emplace_or_replace<VertexBuffer>(entity, modelLoader->getVertexBuffer(streamed.meshId));
+                    m_registry->emplace_or_replace<IndexBuffer>(entity, modelLoader->getIndexBuffer(streamed.meshId));
+                } else if (!resident && streamed.resident) {
+                    m_registry->remove<MeshInstance, VertexBuffer, IndexBuffer>(entity);
+                }
+                streamed.resident = resident;
+            }
+            return true;
+        }
+
+    private:
+        std::unique_ptr<AssetStreamer> streamer;
+        float compactThreshold = 0.5f;
+        entt::entity camera = entt::null;
+        entt::registry *m_registry;
+    };
+
+    class LodSelection : public System {
+    public:
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            camera = node["LodSelection"]["camera"].as<entt::entity>();
+            //projected sizes in pixels below which lod 1, 2, ... are used, largest first
+            screenSizes = node["LodSelection"]["screenSizes"].as<std::vector<float>>();
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            float pixelsPerUnit = m_registry->get<CameraView>(camera).pixelsPerUnit;
+            auto view = m_registry->view<MeshInstance, Bounds, Transform>();
+            for (auto &&[entity, instance, bounds, transform]: view.each()) {
+                glm::vec3 scale = glm::abs(transform.scale);
+                float maxScale = std::max(scale.x, std::max(scale.y, scale.z));
+                float screenSize = glm::length(bounds.max - bounds.min) * maxScale * pixelsPerUnit;
+
+                uint32_t level = 0;
+                while (level < screenSizes.size() && screenSize < screenSizes[level])
+                    level++;
+                instance.lod = std::min(level, instance.lodCount - 1);
+            }
+            return true;
+        }
+
+    private:
+        std::vector<float> screenSizes;
+        entt::entity camera = entt::null;
+        entt::registry *m_registry;
+    };
+
+    class HotReload : public System {
+    public:
+        HotReload() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            YAML::Node config = node["HotReload"];
+            if (config && config["enabled"].as<bool>()) {
+                watcher = std::make_unique<FileWatcher>(std::chrono::milliseconds(config["debounceMs"].as<int>()));
+                for (const auto &directory: config["directories"].as<std::vector<std::string>>()) {
+                    if (!watcher->watch(directory))
+                        Logger::getInstance()->writeToLog("Error, hot reload could not watch " + directory);
+                }
+                //meshes naming a sprite are remapped into the atlas the AssetCooker packed, the same way it cooks them
+                std::error_code ec;
+                if (std::filesystem::exists(atlasPath, ec)) {
+                    auto layout = std::make_shared<AtlasLayout>();
+                    std::string error;
+                    if (AtlasPacker::read(atlasPath, *layout, error))
+                        atlas = layout;
+                    else
+                        Logger::getInstance()->writeToLog("Error, hot reload could not read the atlas: " + error);
+                }
+            }
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        //runs alone between the simulation and rendering systems, so swapping components here is a frame boundary
+        bool run() {
+            if (!watcher)
+                return true;
+
+            ModelLoader *modelLoader = ModelLoader::createInstance(m_registry);
+            applyMeshes(modelLoader);
+
+            changed.clear();
+            watcher->poll(changed);
+            std::unordered_set<std::string> shaders;
+            for (const auto &path: changed) {
+                bool streamed = markStreamed(path);
+                if (streamed || !modelLoader->findMeshIds(path).empty())
+                    reparse(path);
+                for (auto &loc: modelLoader->findShaderDescriptions(path)) {
+                    shaders.insert(loc);
+                }
+            }
+
+            //pipeline creation needs the device, so shaders are rebuilt here instead of on a worker. The renderers
+            //look programs up by mesh id every frame, meshes sharing a program are updated by loadShader
+            for (const auto &loc: shaders) {
+                bool loaded = false;
+                for (uint32_t id: modelLoader->getShaderIds(loc)) {
+                    loaded |= modelLoader->loadShader(loc, id);
+                }
+                if (loaded)
+                    Logger::getInstance()->writeToLog("Reloaded shader " + loc);
+            }
+            return true;
+        }
+
+    private:
+        struct MeshReload {
+            std::string path;
+            MeshComponent mesh;
+            std::string error;
+            std::string report;
+            bool success = false;
+        };
+
+        //flags every streamed mesh read from path so the streamer retries any that failed
+        bool markStreamed(const std::string &path) {
+            bool streamedPath = false;
+            for (auto &&[entity, streamed]: m_registry->view<StreamedMesh>().each()) {
+                if (ModelLoader::modelPath(streamed.file) == path) {
+                    streamed.changed = true;
+                    streamedPath = true;
+                }
+            }
+            return streamedPath;
+        }
+
+        void reparse(const std::string &path) {
+            //a file saved again while its previous version is still parsing is picked up once that finishes
+            if (busy.find(path) != busy.end()) {
+                again.insert(path);
+                return;
+            }
+            busy.insert(path);
+            inFlight.push_back(std::async(std::launch::async, [path, layout = atlas]() {
+                //the source is read directly, cooked copies are stale until the next AssetCooker run
+                MeshReload reload;
+                reload.path = path;
+                uint32_t id = 0;
+                reload.success = MeshImporter::read(path, id, reload.mesh, reload.error, reload.report, layout.get());
+                return reload;
+            }));
+        }
+
+        void applyMeshes(ModelLoader *modelLoader) {
+            std::unordered_set<uint32_t> reloaded;
+            for (auto it = inFlight.begin(); it != inFlight.end();) {
+                if (it->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                    it++;
+                    continue;
+                }
+                MeshReload reload = it->get();
+                it = inFlight.erase(it);
+                busy.erase(reload.path);
+
+                if (!reload.success) {
+                    Logger::getInstance()->writeToLog("Error, failed to reload " + reload.path + ": " + reload.error);
+                } else {
+                    std::vector<uint32_t> ids = modelLoader->findMeshIds(reload.path);
+                    for (auto &&[entity, streamed]: m_registry->view<StreamedMesh>().each()) {
+                        if (ModelLoader::modelPath(streamed.file) == reload.path &&
+                            modelLoader->hasMesh(streamed.meshId))
+                            ids.push_back(streamed.meshId);
+                    }
+                    for (auto id: ids) {
+                        if (reloaded.insert(id).second)
+                            modelLoader->replaceMesh(id, MeshComponent(reload.mesh), reload.path);
+                    }
+                    if (!reload.report.empty())
+                        Logger::getInstance()->writeToLog(reload.report);
+                }
+
+                if (again.erase(reload.path) > 0)
+                    reparse(reload.path);
+            }
+            if (reloaded.empty())
+                return;
+
+            for (auto &&[entity, instance]: m_registry->view<MeshInstance>().each()) {
+                if (reloaded.find(instance.meshId) == reloaded.end())
+                    continue;
+                uint32_t id = instance.meshId;
+                modelLoader->attachMesh(entity, id);
+                if (m_registry->all_of<VertexBuffer>(entity))
+                    m_registry->replace<VertexBuffer>(entity, modelLoader->getVertexBuffer(id));
+                if (m_registry->all_of<IndexBuffer>(entity))
+                    m_registry->replace<IndexBuffer>(entity, modelLoader->getIndexBuffer(id));
+            }
+        }
+
+        static constexpr const char *atlasPath = "data/cooked/atlas/atlas.layout";
+
+        std::unique_ptr<FileWatcher> watcher;
+        std::vector<std::string> changed;
+        //null when no sprites were cooked, shared with the reloads still parsing
+        std::shared_ptr<const AtlasLayout> atlas;
+        std::vector<std::future<MeshReload>> inFlight;
+        std::unordered_set<std::string> busy;
+        std::unordered_set<std::string> again;
+        entt::registry *m_registry;
+    };
+
+    class FrustumCulling : public System {
+    public:
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            camera = node["FrustumCulling"]["camera"].as<entt::entity>();
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+            registry->emplace_or_replace<VisibleList>(camera);
+        }
+
+        bool run() {
+            auto view = m_registry->view<MeshInstance, Bounds, Transform>();
+            entities.assign(view.begin(), view.end());
+            boxes.resize(entities.size());
+
+            //world boxes are rebuilt in parallel straight into the SoA arrays the SIMD test reads
+            std::for_each(std::execution::par, entities.begin(), entities.end(), [&](const entt::entity &entity) {
+                size_t index = &entity - entities.data();
+                const auto &bounds = view.get<Bounds>(entity);
+                const auto &transform = view.get<Transform>(entity);
+                glm::mat3 rotationScale = glm::mat3_cast(transform.rotation);
+                rotationScale[0] *= transform.scale.x;
+                rotationScale[1] *= transform.scale.y;
+                rotationScale[2] *= transform.scale.z;
+                glm::vec3 center, extent;
+                Culling::transformBox(bounds.min, bounds.max, rotationScale, transform.position, center, extent);
+                boxes.set(index, center, extent);
+            });
+
+            Culling::cull(boxes, Culling::sidePlanes(m_registry->get<CameraView>(camera).viewProj), visible);
+
+            auto &list = m_registry->get<VisibleList>(camera);
+            list.entities.resize(visible.size());
+            for (size_t i = 0; i < visible.size(); i++) {
+                list.entities[i] = entities[visible[i]];
+            }
+            return true;
+        }
+
+    private:
+        std::vector<entt::entity> entities;
+        BoxSoA boxes;
+        std::vector<uint32_t> visible;
+        entt::entity camera = entt::null;
+        entt::registry *m_registry;
+    };
+
+    class TilemapRenderer : public System {
+    public:
+        //chunk meshes take ids from here up so they never collide with meshes named after entities
+        static constexpr uint32_t chunkMeshBase = 1u << 30;
+
+        TilemapRenderer() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            YAML::Node config = node["TilemapRenderer"];
+            camera = config["camera"].as<entt::entity>();
+            map = config["map"].as<entt::entity>();
+            //the chunks are drawn with the program loaded for this mesh
+            shader = config["shader"].as<uint32_t>();
+            float tileSize = config["tileSize"] ? config["tileSize"].as<float>() : 1.f;
+            auto tilemap = std::make_unique<Tilemap>(config["width"].as<uint32_t>(), config["height"].as<uint32_t>(),
+                                                     tileSize);
+            if (config["palette"])
+                tilemap->setPalette(config["palette"].as<std::vector<glm::vec4>>());
+            if (config["fill"])
+                tilemap->fill(0, 0, tilemap->getWidth(), tilemap->getHeight(), config["fill"].as<uint16_t>());
+            registry->emplace_or_replace<TilemapComponent>(map, std::move(tilemap));
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            Tilemap &tilemap = *m_registry->get<TilemapComponent>(map).tilemap;
+            if (chunkEntities.size() != tilemap.getChunkCount())
+                chunkEntities.assign(tilemap.getChunkCount(), entt::null);
+
+            //edits wait in the dirty list until the shader they are drawn with has been loaded
+            ModelLoader *modelLoader = ModelLoader::createInstance(m_registry);
+            if (!modelLoader->hasShaderProgram(shader))
+                return true;
+            for (uint32_t chunk: tilemap.rebuildDirty()) {
+                upload(modelLoader, tilemap, chunk);
+            }
+
+            //FrustumCulling has already filled the list, the chunks under the view are added to it directly
+            const auto &view = m_registry->get<CameraView>(camera);
+            glm::vec3 center = m_registry->get<CameraComponent>(camera).position;
+            tilemap.visibleChunks(glm::vec2(center.x, center.y), view.halfExtents, visible);
+            auto *list = m_registry->try_get<VisibleList>(camera);
+            if (list == nullptr)
+                return true;
+            for (uint32_t chunk: visible) {
+                if (chunkEntities[chunk] != entt::null)
+                    list->entities.push_back(chunkEntities[chunk]);
+            }
+            return true;
+        }
+
+    private:
+        void upload(ModelLoader *modelLoader, Tilemap &tilemap, uint32_t chunk) {
+            uint32_t meshId = chunkMeshBase + chunk;
+            entt::entity &entity = chunkEntities[chunk];
+            if (tilemap.isChunkEmpty(chunk)) {
+                if (entity != entt::null) {
+                    m_registry->destroy(entity);
+                    entity = entt::null;
+                    modelLoader->unloadMesh(meshId);
+                }
+                return;
+            }
+
+            modelLoader->addMesh(meshId, tilemap.takeChunkMesh(chunk));
+            std::string name = "tile chunk " + std::to_string(chunk);
+            if (!modelLoader->createVertexBuffer(meshId, name) || !modelLoader->createIndexBuffer(meshId, name))
+                return;
+            if (entity == entt::null) {
+                modelLoader->shareShaderProgram(meshId, shader);
+                //no Bounds, so FrustumCulling and LodSelection leave chunks to this system
+                entity = m_registry->create();
+                m_registry->emplace<Transform>(entity).position = tilemap.getChunkOrigin(chunk);
+                m_registry->emplace<MeshInstance>(entity).meshId = meshId;
+            }
+        }
+
+        std::vector<entt::entity> chunkEntities;
+        std::vector<uint32_t> visible;
+        uint32_t shader = 0;
+        entt::entity camera = entt::null;
+        entt::entity map = entt::null;
+        entt::registry *m_registry;
+    };
+
+    //places every UIComponent from its anchor rule. The rules are kept flattened in an AnchorLayout and solved in
+    //one pass over all elements, only on the frames where the window changed size or an element was marked dirty.
+    //An element whose parent did not change only has its rule updated, anything else rebuilds the flattened tree.
+    class UILayout : public System {
+    public:
+        UILayout() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            window = node["UILayout"]["window"].as<entt::entity>();
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            auto &windowComponent = m_registry->get<WindowPtr>(window);
+            auto elements = m_registry->view<UIComponent>();
+            bool rebuild = elements.size() != entities.size();
+            bool recompute = rebuild || windowComponent.sizeChange;
+            for (auto entity: elements) {
+                auto &element = elements.get<UIComponent>(entity);
+                if (rebuild || !element.dirty)
+                    continue;
+                recompute = true;
+                auto it = indexOf.find(entity);
+                if (it == indexOf.end() || parents[it->second] != element.parent) {
+                    rebuild = true;
+                    continue;
+                }
+                layout.setRule(it->second, ruleOf(element));
+                element.dirty = false;
+            }
+            if (rebuild)
+                build();
+            if (!recompute)
+                return true;
+
+            int width, height;
+            glfwGetWindowSize(windowComponent.window, &width, &height);
+            layout.compute((float) width, (float) height);
+            for (uint32_t i = 0; i < entities.size(); i++) {
+                UIRect rect = layout.getRect(i);
+                auto &element = elements.get<UIComponent>(entities[i]);
+                element.xTop = (int) std::lround(rect.left);
+                element.yTop = (int) std::lround(rect.top);
+                element.xBottom = (int) std::lround(rect.right);
+                element.yBottom = (int) std::lround(rect.bottom);
+            }
+            return true;
+        }
+
+    private:
+        static AnchorRule ruleOf(const UIComponent &element) {
+            return {element.anchorMin, element.anchorMax, element.offsetMin, element.offsetMax};
+        }
+
+        void build() {
+            auto elements = m_registry->view<UIComponent>();
+            entities.clear();
+            parents.clear();
+            indexOf.clear();
+            rules.clear();
+            for (auto entity: elements) {
+                auto &element = elements.get<UIComponent>(entity);
+                indexOf[entity] = (uint32_t) entities.size();
+                entities.push_back(entity);
+                parents.push_back(element.parent);
+                rules.push_back(ruleOf(element));
+                element.dirty = false;
+            }
+            //a parent that is not a UI element itself means the window
+            parentIndices.resize(entities.size());
+            for (uint32_t i = 0; i < entities.size(); i++) {
+                auto it = indexOf.find(parents[i]);
+                parentIndices[i] = it == indexOf.end() ? AnchorLayout::window : it->second;
+            }
+            std::string error;
+            if (!layout.build(rules, parentIndices, error))
+                Logger::getInstance()->writeToLog("Error, " + error);
+        }
+
+        AnchorLayout layout;
+        std::vector<entt::entity> entities;
+        std::vector<entt::entity> parents;
+        std::unordered_map<entt::entity, uint32_t> indexOf;
+        std::vector<AnchorRule> rules;
+        std::vector<uint32_t> parentIndices;
+        entt::entity window = entt::null;
+        entt::registry *m_registry;
+    };
+
+    //draws every TextComponent as a single batch of screen space quads. Glyphs are rasterized into one atlas the
+    //first time they are used and strings are laid out through a TextLayoutCache, the batch is only rebuilt when a
+    //text is edited, added or removed or the window changes size. Any other frame just moves the batch along with
+    //the camera.
+    class TextRenderer : public System {
+    public:
+        //right under the tilemap chunk ids
+        static constexpr uint32_t batchMeshId = TilemapRenderer::chunkMeshBase - 1;
+
+        TextRenderer() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            YAML::Node config = node["TextRenderer"];
+            camera = config["camera"].as<entt::entity>();
+            window = config["window"].as<entt::entity>();
+            //the batch is drawn with the program loaded for this mesh, its pixel shader samples the glyph atlas
+            //through g_Texture
+            shader = config["shader"].as<uint32_t>();
+            uint32_t atlasSize = config["atlasSize"] ? config["atlasSize"].as<uint32_t>() : 512;
+            glyphs = std::make_unique<GlyphCache>(&font, atlasSize, atlasSize);
+            layouts = std::make_unique<TextLayoutCache>(glyphs.get());
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            auto &windowComponent = m_registry->get<WindowPtr>(window);
+            dirty |= windowComponent.sizeChange;
+            ModelLoader *modelLoader = ModelLoader::createInstance(m_registry);
+            if (!modelLoader->hasShaderProgram(shader))
+                return true;
+
+            auto texts = m_registry->view<TextComponent>();
+            dirty |= texts.size() != textCount;
+            for (auto entity: texts) {
+                auto &text = texts.get<TextComponent>(entity);
+                dirty |= text.changed;
+                text.changed = false;
+            }
+            if (dirty) {
+                textCount = texts.size();
+                build(windowComponent);
+                upload(modelLoader);
+                dirty = false;
+            }
+            uploadAtlas(windowComponent, modelLoader);
+            if (batchEntity == entt::null)
+                return true;
+
+            //the camera maps one unit to zoom pixels around its position, undoing both leaves the batch in pixels
+            const auto &cameraComponent = m_registry->get<CameraComponent>(camera);
+            auto &transform = m_registry->get<Transform>(batchEntity);
+            float zoom = cameraComponent.zoom > 0.f ? cameraComponent.zoom : 1.f;
+            transform.position = {cameraComponent.position.x, cameraComponent.position.y, 0.f};
+            transform.scale = glm::vec3(1.f / zoom);
+            auto *list = m_registry->try_get<VisibleList>(camera);
+            if (list != nullptr)
+                list->entities.push_back(batchEntity);
+            return true;
+        }
+
+    private:
+        void build(const WindowPtr &windowComponent) {
+            int width, height;
+            glfwGetWindowSize(windowComponent.window, &width, &height);
+            glm::vec2 half((float) width / 2.f, (float) height / 2.f);
+
+            //laying a string out can clear a full glyph cache, the quads already in the batch then point at glyphs
+            //that are gone and the batch is built once more against the new contents
+            auto texts = m_registry->view<TextComponent>();
+            for (int attempt = 0; attempt < 2; attempt++) {
+                uint32_t generation = glyphs->getGeneration();
+                batch.vertices.clear();
+                batch.indices.clear();
+                for (auto entity: texts) {
+                    const auto &text = texts.get<TextComponent>(entity);
+                    TextStyle style;
+                    style.pixelSize = text.pixelSize;
+                    style.align = text.align;
+                    style.maxWidth = text.maxWidth > 0.f ? text.maxWidth : std::max(1.f, (float) width -
+                                                                                         text.position.x);
+                    const TextBlock &block = layouts->layout(text.text, style);
+                    TextLayoutCache::appendQuads(block, {text.position.x - half.x, half.y - text.position.y},
+                                                 text.color, batch);
+                }
+                if (glyphs->getGeneration() == generation)
+                    break;
+            }
+            layouts->endFrame();
+        }
+
+        void upload(ModelLoader *modelLoader) {
+            if (batch.vertices.empty()) {
+                if (batchEntity != entt::null) {
+                    m_registry->destroy(batchEntity);
+                    batchEntity = entt::null;
+                    modelLoader->unloadMesh(batchMeshId);
+                }
+                return;
+            }
+
+            modelLoader->addMesh(batchMeshId, std::move(batch));
+            batch = MeshComponent();
+            if (!modelLoader->createVertexBuffer(batchMeshId, "text batch") ||
+                !modelLoader->createIndexBuffer(batchMeshId, "text batch"))
+                return;
+            if (batchEntity == entt::null) {
+                modelLoader->shareShaderProgram(batchMeshId, shader);
+                //no Bounds, the text is always on screen and never culled
+                batchEntity = m_registry->create();
+                m_registry->emplace<Transform>(batchEntity);
+                m_registry->emplace<MeshInstance>(batchEntity).meshId = batchMeshId;
+            }
+        }
+
+        //the texture is created with the atlas the first time and after that only the rows glyphs were added to
+        //are copied. It is bound again whenever the program is recreated, a reloaded shader has a fresh binding.
+        void uploadAtlas(WindowPtr &windowComponent, ModelLoader *modelLoader) {
+            AtlasRect rect;
+            bool changed = glyphs->takeDirtyRect(rect);
+            const std::vector<uint8_t> &pixels = glyphs->getPixels();
+            uint32_t stride = glyphs->getWidth();
+            uint32_t generation = modelLoader->getProgramGeneration(shader);
+            if (atlasTexture && generation != atlasGeneration) {
+                bindAtlas(modelLoader);
+                atlasGeneration = generation;
+            }
+            if (!atlasTexture) {
+                Diligent::TextureDesc desc;
+                desc.Name = "Glyph atlas";
+                desc.Type = Diligent::RESOURCE_DIM_TEX_2D;
+                desc.Width = glyphs->getWidth();
+                desc.Height = glyphs->getHeight();
+                desc.Format = Diligent::TEX_FORMAT_R8_UNORM;
+                desc.BindFlags = Diligent::BIND_SHADER_RESOURCE;
+                desc.Usage = Diligent::USAGE_DEFAULT;
+                Diligent::TextureSubResData level(pixels.data(), stride);
+                Diligent::TextureData data(&level, 1);
+                windowComponent.m_Device->CreateTexture(desc, &data, &atlasTexture);
+                if (!atlasTexture)
+                    return;
+                bindAtlas(modelLoader);
+                atlasGeneration = generation;
+            } else if (changed) {
+                Diligent::Box box(rect.x, rect.x + rect.width, rect.y, rect.y + rect.height);
+                Diligent::TextureSubResData level(pixels.data() + (size_t) rect.y * stride + rect.x, stride);
+                windowComponent.m_ImmediateContext->UpdateTexture(atlasTexture, 0, 0, box, level,
+                                                                  Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                                                  Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            } else {
+                return;
+            }
+            //deferred contexts only verify states, so the atlas is left readable before they record
+            Diligent::StateTransitionDesc barrier(atlasTexture, Diligent::RESOURCE_STATE_UNKNOWN,
+                                                  Diligent::RESOURCE_STATE_SHADER_RESOURCE,
+                                                  Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE);
+            windowComponent.m_ImmediateContext->TransitionResourceStates(1, &barrier);
+        }
+
+        void bindAtlas(ModelLoader *modelLoader) {
+            Diligent::IShaderResourceVariable *variable = modelLoader->getShaderProgram(shader).shaderBinding->
+                    GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture");
+            if (variable != nullptr)
+                variable->Set(atlasTexture->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
+        }
+
+        BitmapFont font;
+        std::unique_ptr<GlyphCache> glyphs;
+        std::unique_ptr<TextLayoutCache> layouts;
+        Diligent::RefCntAutoPtr<Diligent::ITexture> atlasTexture;
+        //program generation the atlas was last bound to
+        uint32_t atlasGeneration = 0;
+        MeshComponent batch;
+        entt::entity batchEntity = entt::null;
+        size_t textCount = 0;
+        bool dirty = true;
+        uint32_t shader = 0;
+        entt::entity camera = entt::null;
+        entt::entity window = entt::null;
+        entt::registry *m_registry;
+    };
+
     class Renderer : public System {
     public:
         Renderer() {
@@ -357,6 +1364,323 @@ namespace SGE {
         }
 
         void setUp(entt::registry *registry, YAML::Node &node) {
+            camera = node["Renderer"]["camera"].as<entt::entity>();
+            if (node["Renderer"]["workers"])
+                workers = std::max(1u, node["Renderer"]["workers"].as<uint32_t>());
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            ModelLoader *modelLoader = ModelLoader::createInstance(m_registry);
+            const glm::mat4 &viewProj = m_registry->get<CameraView>(camera).viewProj;
+            gather(modelLoader, viewProj);
+            queue.sort();
+            queue.buildBatches();
+            submit(modelLoader, viewProj);
+            return true;
+        }
+
+    private:
+        void gather(ModelLoader *modelLoader, const glm::mat4 &viewProj) {
+            queue.clear();
+            //resolved once per mesh instead of once per entity, copying a Program touches two reference counts
+            pipelineOf.clear();
+
+            //only what FrustumCulling let through is drawn, the full view is the fallback when culling is not set up
+            auto view = m_registry->view<MeshInstance, Transform>();
+            auto *visible = m_registry->try_get<VisibleList>(camera);
+            if (visible != nullptr) {
+                queue.reserve(visible->entities.size());
+                for (auto entity: visible->entities) {
+                    push(modelLoader, viewProj, view.get<MeshInstance>(entity), view.get<Transform>(entity));
+                }
+            } else {
+                queue.reserve(view.size_hint());
+                for (auto &&[entity, instance, transform]: view.each()) {
+                    push(modelLoader, viewProj, instance, transform);
+                }
+            }
+        }
+
+        void push(ModelLoader *modelLoader, const glm::mat4 &viewProj, const MeshInstance &instance,
+                  const Transform &transform) {
+            auto found = pipelineOf.find(instance.meshId);
+            if (found == pipelineOf.end()) {
+                uint64_t pipeline = 0;
+                if (modelLoader->hasShaderProgram(instance.meshId) && modelLoader->hasGpuMesh(instance.meshId)) {
+                    Program program = modelLoader->getShaderProgram(instance.meshId);
+                    pipeline = (uint64_t) (uintptr_t) program.shaderPointer.RawPtr();
+                }
+                found = pipelineOf.emplace(instance.meshId, pipeline).first;
+            }
+            if (found->second == 0)
+                return;
+
+            glm::vec4 clip = viewProj * glm::vec4(transform.position, 1.f);
+            float depth = clip.w != 0.f ? clip.z / clip.w : clip.z;
+            queue.push(found->second, instance.meshId, instance.lod, depth, transform.getTransform());
+        }
+
+        void submit(ModelLoader *modelLoader, const glm::mat4 &viewProj) {
+            const auto &instances = queue.getInstances();
+            const auto &batches = queue.getBatches();
+            if (instances.empty())
+                return;
+
+            DeviceClass *device = DeviceClass::getInstance();
+            auto *context = device->m_pImmediateContext.RawPtr();
+            //the whole frame's instances are one allocation in the ring, uploaded in a single update
+            instanceRing.beginFrame(device->m_pDevice);
+            uint64_t instanceOffset = instanceRing.write(instances.data(), instances.size() * sizeof(InstanceData),
+                                                         sizeof(InstanceData));
+            instanceRing.upload(context);
+            if (instanceOffset == RingAllocator::invalidOffset) {
+                instanceRing.endFrame(context);
+                return;
+            }
+
+            auto constants = modelLoader->getFrameConstants().vsConstants;
+            if (constants != nullptr) {
+                glm::mat4 viewProjT = glm::transpose(viewProj);
+                context->UpdateBuffer(constants, 0, sizeof(glm::mat4), &viewProjT,
+                                      Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            }
+
+            //resolve every mesh once on this thread, the recorders only read the result
+            meshStates.clear();
+            for (const auto &batch: batches) {
+                if (meshStates.find(batch.mesh) != meshStates.end())
+                    continue;
+                MeshDrawState &state = meshStates[batch.mesh];
+                state.program = modelLoader->getShaderProgram(batch.mesh);
+                state.vertexBuffer = modelLoader->getVertexBuffer(batch.mesh);
+                state.indexBuffer = modelLoader->getIndexBuffer(batch.mesh);
+                state.geometry = modelLoader->getGeometry(batch.mesh);
+                state.lods = modelLoader->getMesh(batch.mesh).lods;
+            }
+
+            //without deferred contexts everything is recorded as one range on the immediate context
+            uint32_t workerCount = std::min<uint32_t>(workers, (uint32_t) device->m_pDeferredContexts.size());
+            auto ranges = RenderList::partition(batches, std::max(workerCount, 1u));
+            bool deferred = ranges.size() > 1;
+            if (deferred)
+                transitionResources(context);
+
+            if (recorders.empty() || recordersDeferred != deferred) {
+                recorders.clear();
+                if (deferred) {
+                    for (auto &deferredContext: device->m_pDeferredContexts) {
+                        recorders.push_back(std::make_unique<ContextRecorder>(deferredContext, context, true));
+                    }
+                } else {
+                    recorders.push_back(std::make_unique<ContextRecorder>(context, context, false));
+                }
+                recordersDeferred = deferred;
+            }
+
+            RecordFrame frame;
+            frame.meshes = &meshStates;
+            frame.instanceBuffer = instanceRing.getBuffer();
+            frame.instanceOffset = instanceOffset;
+            frame.renderTarget = device->m_pSwapChain->GetCurrentBackBufferRTV();
+            frame.depthStencil = device->m_pSwapChain->GetDepthBufferDSV();
+            std::vector<CommandRecorder *> active(ranges.size());
+            for (size_t i = 0; i < ranges.size(); i++) {
+                recorders[i]->setFrame(frame);
+                active[i] = recorders[i].get();
+            }
+            RenderList::record(batches, ranges, active);
+            //signalled after the draws so the ring only reuses this frame's space once they have run
+            instanceRing.endFrame(context);
+        }
+
+        //deferred contexts only verify resource states, so everything they read is moved into place here
+        void transitionResources(Diligent::IDeviceContext *context) {
+            barriers.clear();
+            auto add = [&](Diligent::IDeviceObject *resource, Diligent::RESOURCE_STATE state) {
+                //most meshes share the pool's buffers, each is only moved once
+                if (resource == nullptr || std::any_of(barriers.begin(), barriers.end(), [&](const auto &barrier) {
+                    return barrier.pResource == resource;
+                }))
+                    return;
+                Diligent::StateTransitionDesc barrier;
+                barrier.pResource = resource;
+                barrier.OldState = Diligent::RESOURCE_STATE_UNKNOWN;
+                barrier.NewState = state;
+                barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
+                barriers.push_back(barrier);
+            };
+            add(instanceRing.getBuffer(), Diligent::RESOURCE_STATE_VERTEX_BUFFER);
+            for (auto &[mesh, state]: meshStates) {
+                add(state.vertexBuffer.vertexBuffer, Diligent::RESOURCE_STATE_VERTEX_BUFFER);
+                add(state.indexBuffer.indexBuffer, Diligent::RESOURCE_STATE_INDEX_BUFFER);
+            }
+            for (auto &[mesh, state]: meshStates) {
+                //constant buffers bound through the shader resource binding
+                context->TransitionShaderResources(state.program.shaderPointer, state.program.shaderBinding);
+            }
+            context->TransitionResourceStates((Diligent::Uint32) barriers.size(), barriers.data());
+        }
+
+        RenderQueue queue;
+        std::unordered_map<uint32_t, uint64_t> pipelineOf;
+        std::unordered_map<uint32_t, MeshDrawState> meshStates;
+        std::vector<std::unique_ptr<ContextRecorder>> recorders;
+        bool recordersDeferred = false;
+        std::vector<Diligent::StateTransitionDesc> barriers;
+        //three frames of 4096 instances before it first grows
+        UniformRing instanceRing{"Instance transforms", Diligent::BIND_VERTEX_BUFFER, 3 * 4096 * sizeof(InstanceData)};
+        uint32_t workers = 1;
+        entt::entity camera = entt::null;
+        entt::registry *m_registry;
+    };
+
+    //simulates the particles of every ParticleEmitter in a pool of its own and draws them as instances of the
+    //emitter's mesh. The world matrices of all emitters are written straight into one ring buffer allocation per
+    //frame, and every emitter costs a single instanced draw however many particles it has.
+    class ParticleSystem : public System {
+    public:
+        ParticleSystem() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            timer = node["ParticleSystem"]["timer"].as<entt::entity>();
+            setUp(registry);
+        }
+
+        void setUp(entt::registry *registry) {
+            m_registry = registry;
+        }
+
+        bool run() {
+            simulate(m_registry->get<Time>(timer).dt);
+            draw();
+            return true;
+        }
+
+    private:
+        struct EmitterState {
+            std::unique_ptr<ParticlePool> pool;
+            //fraction of a particle carried over to the next frame, so low rates still emit
+            float carry = 0.f;
+        };
+
+        void simulate(float dt) {
+            for (auto it = emitters.begin(); it != emitters.end();) {
+                if (!m_registry->valid(it->first) || !m_registry->all_of<ParticleEmitter>(it->first))
+                    it = emitters.erase(it);
+                else
+                    it++;
+            }
+
+            auto view = m_registry->view<ParticleEmitter, Transform>();
+            for (auto entity: view) {
+                const auto &emitter = view.get<ParticleEmitter>(entity);
+                EmitterState &state = emitters[entity];
+                if (!state.pool || state.pool->getCapacity() != emitter.capacity)
+                    state.pool = std::make_unique<ParticlePool>(emitter.capacity, (uint64_t) entity + 1);
+                if (emitter.emitting) {
+                    state.carry += emitter.rate * dt;
+                    auto count = (uint32_t) state.carry;
+                    state.carry -= (float) count;
+                    ParticleSpawn spawn;
+                    spawn.position = view.get<Transform>(entity).position;
+                    float length = glm::length(emitter.direction);
+                    spawn.velocity = length > 0.f ? emitter.direction * (emitter.speed / length) : glm::vec3(0.f);
+                    spawn.spread = emitter.spread * emitter.speed;
+                    spawn.lifetime = emitter.lifetime;
+                    spawn.size = emitter.size;
+                    state.pool->spawn(count, spawn);
+                }
+                state.pool->update(dt, emitter.gravity);
+            }
+        }
+
+        void draw() {
+            ModelLoader *modelLoader = ModelLoader::createInstance(m_registry);
+            batches.clear();
+            batchPools.clear();
+            meshStates.clear();
+            uint32_t total = 0;
+            for (auto &[entity, state]: emitters) {
+                uint32_t mesh = m_registry->get<ParticleEmitter>(entity).mesh;
+                if (state.pool->size() == 0 || !modelLoader->hasShaderProgram(mesh) || !modelLoader->hasGpuMesh(mesh))
+                    continue;
+                batches.push_back({0, mesh, 0, total, state.pool->size()});
+                batchPools.push_back(state.pool.get());
+                total += state.pool->size();
+                if (meshStates.find(mesh) != meshStates.end())
+                    continue;
+                MeshDrawState &meshState = meshStates[mesh];
+                meshState.program = modelLoader->getShaderProgram(mesh);
+                meshState.vertexBuffer = modelLoader->getVertexBuffer(mesh);
+                meshState.indexBuffer = modelLoader->getIndexBuffer(mesh);
+                meshState.geometry = modelLoader->getGeometry(mesh);
+            }
+            if (total == 0)
+                return;
+
+            DeviceClass *device = DeviceClass::getInstance();
+            auto *context = device->m_pImmediateContext.RawPtr();
+            instanceRing.beginFrame(device->m_pDevice);
+            void *data = nullptr;
+            uint64_t offset = instanceRing.reserve((uint64_t) total * sizeof(InstanceData), sizeof(InstanceData), data);
+            if (offset == RingAllocator::invalidOffset) {
+                instanceRing.endFrame(context);
+                return;
+            }
+            //each pool fills the range of instances its batch draws
+            auto *instances = (InstanceData *) data;
+            for (size_t i = 0; i < batches.size(); i++) {
+                batchPools[i]->writeInstances(instances + batches[i].firstInstance);
+            }
+            instanceRing.upload(context);
+
+            if (!recorder)
+                recorder = std::make_unique<ContextRecorder>(context, context, false);
+            RecordFrame frame;
+            frame.meshes = &meshStates;
+            frame.instanceBuffer = instanceRing.getBuffer();
+            frame.instanceOffset = offset;
+            frame.renderTarget = device->m_pSwapChain->GetCurrentBackBufferRTV();
+            frame.depthStencil = device->m_pSwapChain->GetDepthBufferDSV();
+            recorder->setFrame(frame);
+            recorder->begin();
+            for (const auto &drawBatch: batches) {
+                recorder->record(drawBatch);
+            }
+            recorder->end();
+            instanceRing.endFrame(context);
+        }
+
+        std::unordered_map<entt::entity, EmitterState> emitters;
+        std::vector<DrawBatch> batches;
+        std::vector<const ParticlePool *> batchPools;
+        std::unordered_map<uint32_t, MeshDrawState> meshStates;
+        std::unique_ptr<ContextRecorder> recorder;
+        //grows to whatever the emitters need, a million particles take 64MB a frame
+        UniformRing instanceRing{"Particle instances", Diligent::BIND_VERTEX_BUFFER, 3 * 65536 * sizeof(InstanceData)};
+        entt::entity timer = entt::null;
+        entt::registry *m_registry;
+    };
+
+    //draws everything recorded through DebugDraw this frame over the scene. The lines of every thread are collected
+    //into one vertex stream, written to a ring buffer and drawn with a single call, whatever was recorded.
+    //The program has to be loaded with Topology: lines, Immediate and without Instanced, as line.yml is.
+    class DebugDrawRenderer : public System {
+    public:
+        DebugDrawRenderer() {
+            threadFlag = SingleThread;
+        }
+
+        void setUp(entt::registry *registry, YAML::Node &node) {
+            if (node["DebugDrawRenderer"])
+                shader = node["DebugDrawRenderer"]["shader"].as<uint32_t>();
             setUp(registry);
         }
 
@@ -365,11 +1689,45 @@ namespace SGE {
         }
 
         bool run() {
-            //TODO add in new rendering code to replace old BGFX code.
+            if constexpr (!DebugDraw::enabled)
+                return true;
+            //collected even when nothing can be drawn so the thread buffers never fill up
+            vertices.clear();
+            DebugDraw::collect(vertices);
+            ModelLoader *modelLoader = ModelLoader::createInstance(m_registry);
+            if (vertices.empty() || !modelLoader->hasShaderProgram(shader))
+                return true;
+
+            DeviceClass *device = DeviceClass::getInstance();
+            auto *context = device->m_pImmediateContext.RawPtr();
+            stream.beginFrame(device->m_pDevice);
+            uint64_t offset = stream.write(vertices.data(), vertices.size() * sizeof(Vertex), 16);
+            stream.upload(context);
+            if (offset != RingAllocator::invalidOffset) {
+                Program program = modelLoader->getShaderProgram(shader);
+                Diligent::ITextureView *renderTarget = device->m_pSwapChain->GetCurrentBackBufferRTV();
+                context->SetRenderTargets(1, &renderTarget, device->m_pSwapChain->GetDepthBufferDSV(),
+                                          Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                context->SetPipelineState(program.shaderPointer);
+                context->CommitShaderResources(program.shaderBinding,
+                                               Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                Diligent::IBuffer *buffer = stream.getBuffer();
+                Diligent::Uint64 bufferOffset = offset;
+                context->SetVertexBuffers(0, 1, &buffer, &bufferOffset,
+                                          Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                          Diligent::SET_VERTEX_BUFFERS_FLAG_RESET);
+                Diligent::DrawAttribs draw((Diligent::Uint32) vertices.size(), Diligent::DRAW_FLAG_VERIFY_ALL);
+                context->Draw(draw);
+            }
+            stream.endFrame(context);
             return true;
         }
 
     private:
+        std::vector<Vertex> vertices;
+        //three frames of 64k lines before it first grows
+        UniformRing stream{"Debug draw", Diligent::BIND_VERTEX_BUFFER, 3 * 2 * 65536 * sizeof(Vertex)};
+        uint32_t shader = 0;
         entt::registry *m_registry;
     };
 
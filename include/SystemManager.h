@@ -64,9 +64,21 @@ namespace SGE {
         //always running systems
         std::unique_ptr<GameTime> gameTime = std::make_unique<GameTime>();
         std::unique_ptr<PrimaryMovement> primaryMovement = std::make_unique<PrimaryMovement>();
+        std::unique_ptr<Navigation> navigation = std::make_unique<Navigation>();
+        std::unique_ptr<Steering> steering = std::make_unique<Steering>();
         std::unique_ptr<UpdateMovement> updateMovement = std::make_unique<UpdateMovement>();
+        std::unique_ptr<AnimationPlayer> animationPlayer = std::make_unique<AnimationPlayer>();
         std::unique_ptr<Camera> camera = std::make_unique<Camera>();
+        std::unique_ptr<UILayout> uiLayout = std::make_unique<UILayout>();
+        std::unique_ptr<AssetStreaming> assetStreaming = std::make_unique<AssetStreaming>();
+        std::unique_ptr<HotReload> hotReload = std::make_unique<HotReload>();
+        std::unique_ptr<LodSelection> lodSelection = std::make_unique<LodSelection>();
+        std::unique_ptr<FrustumCulling> frustumCulling = std::make_unique<FrustumCulling>();
+        std::unique_ptr<TilemapRenderer> tilemapRenderer = std::make_unique<TilemapRenderer>();
+        std::unique_ptr<TextRenderer> textRenderer = std::make_unique<TextRenderer>();
         std::unique_ptr<Renderer> render = std::make_unique<Renderer>();
+        std::unique_ptr<ParticleSystem> particleSystem = std::make_unique<ParticleSystem>();
+        std::unique_ptr<DebugDrawRenderer> debugDrawRenderer = std::make_unique<DebugDrawRenderer>();
 
         //startup systems
         std::unique_ptr<MeshModelLoader> meshModelLoader = std::make_unique<MeshModelLoader>();
@@ -0,0 +1,104 @@
+#ifndef GENERATIONS_TEXTLAYOUT_H
+#define GENERATIONS_TEXTLAYOUT_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Components.h"
+#include "GlyphCache.h"
+
+namespace SGE {
+
+    enum class TextAlign : uint8_t {
+        Left,
+        Center,
+        Right
+    };
+
+    struct TextStyle {
+        uint32_t pixelSize = 16;
+        //lines wrap at spaces once they get wider than this, 0 never wraps
+        float maxWidth = 0.f;
+        TextAlign align = TextAlign::Left;
+
+        bool operator==(const TextStyle &other) const;
+    };
+
+    //one glyph of laid out text, in pixels with y growing downwards from the top left of the block
+    struct GlyphQuad {
+        glm::vec2 min;
+        glm::vec2 max;
+        glm::vec2 uvMin;
+        glm::vec2 uvMax;
+    };
+
+    struct TextBlock {
+        std::vector<GlyphQuad> quads;
+        glm::vec2 size{0.f};
+        //generation of the glyph cache the uvs point into
+        uint32_t generation = 0;
+    };
+
+    //lays out utf-8 strings into glyph quads and keeps the result by string and style, so text that does not change
+    //is decoded, shaped and wrapped once and every frame after that costs one lookup. Layouts that were not asked
+    //for between two calls to endFrame are dropped. When the glyph cache fills up it is cleared and the layout is
+    //redone, blocks built before that have an older generation and are laid out again the next time they are used.
+    class TextLayoutCache {
+    public:
+        explicit TextLayoutCache(GlyphCache *glyphs);
+
+        const TextBlock &layout(const std::string &text, const TextStyle &style);
+
+        void endFrame();
+
+        void clear();
+
+        uint32_t getBlockCount() const;
+
+        uint64_t getHits() const;
+
+        uint64_t getMisses() const;
+
+        //adds the block to a quad batch. topLeft is where the block goes in y up coordinates, the glyph uvs go into
+        //texCoord.xy, the color packed as 0xRRGGBB into texCoord.z and its alpha into texCoord.w.
+        static void appendQuads(const TextBlock &block, const glm::vec2 &topLeft, const glm::vec4 &color,
+                                MeshComponent &mesh);
+
+        static void decodeUtf8(const std::string &text, std::vector<uint32_t> &codepoints);
+
+    private:
+        struct Entry {
+            std::string text;
+            TextStyle style;
+            TextBlock block;
+            bool built = false;
+            bool used = false;
+        };
+
+        //false when the glyph cache ran out of room part way through
+        bool build(const std::string &text, const TextStyle &style, TextBlock &block);
+
+        GlyphCache *glyphs;
+        std::unordered_map<uint64_t, Entry> entries;
+        std::vector<uint32_t> codepoints;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    //screen space text drawn by the TextRenderer. position is in pixels from the top left of the window, a
+    //maxWidth of 0 wraps at the right edge of the window. Set changed after editing any field.
+    struct TextComponent {
+        std::string text;
+        glm::vec2 position{0.f};
+        uint32_t pixelSize = 16;
+        float maxWidth = 0.f;
+        TextAlign align = TextAlign::Left;
+        glm::vec4 color{1.f};
+        bool changed = true;
+    };
+
+}
+
+#endif //GENERATIONS_TEXTLAYOUT_H
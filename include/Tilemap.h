@@ -0,0 +1,95 @@
+#ifndef GENERATIONS_TILEMAP_H
+#define GENERATIONS_TILEMAP_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Components.h"
+
+namespace SGE {
+
+    //a grid of tiles stored in square chunks, each chunk holding its tiles contiguously and owning one mesh. Edits
+    //only mark their chunk dirty, rebuildDirty then remeshes just those chunks in parallel, and visibleChunks turns
+    //a view rectangle straight into the range of chunks under it, so neither the cost of an edit nor of finding what
+    //to draw grows with the size of the map. Tile 0 is empty, any other id is drawn with its palette color.
+    class Tilemap {
+    public:
+        static constexpr uint32_t chunkSize = 32;
+        static constexpr uint16_t emptyTile = 0;
+
+        //width and height are in tiles, origin is the world position of the corner of tile (0, 0)
+        Tilemap(uint32_t width, uint32_t height, float tileSize, const glm::vec2 &origin = glm::vec2(0.f));
+
+        uint32_t getWidth() const;
+
+        uint32_t getHeight() const;
+
+        float getTileSize() const;
+
+        const glm::vec2 &getOrigin() const;
+
+        uint16_t get(uint32_t x, uint32_t y) const;
+
+        //out of range tiles are ignored
+        void set(uint32_t x, uint32_t y, uint16_t tile);
+
+        //sets the tiles in [x0, x1) x [y0, y1), clamped to the map
+        void fill(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, uint16_t tile);
+
+        //colors by tile id, ids past the end are drawn white. Every chunk is rebuilt on the next rebuildDirty.
+        void setPalette(const std::vector<glm::vec4> &palette);
+
+        //remeshes every dirty chunk on worker threads and returns the chunks whose mesh changed
+        const std::vector<uint32_t> &rebuildDirty();
+
+        //chunks with at least one tile that overlap the rectangle, in row order
+        void visibleChunks(const glm::vec2 &center, const glm::vec2 &halfExtents, std::vector<uint32_t> &chunks) const;
+
+        uint32_t getChunkCount() const;
+
+        //the mesh is in chunk local coordinates, getChunkOrigin places it
+        const MeshComponent &getChunkMesh(uint32_t chunk) const;
+
+        //hands the mesh to the caller, leaving the chunk with an empty one until its next rebuild
+        MeshComponent takeChunkMesh(uint32_t chunk);
+
+        bool isChunkEmpty(uint32_t chunk) const;
+
+        glm::vec3 getChunkOrigin(uint32_t chunk) const;
+
+        //bumped whenever a tile of the chunk changes, for systems that keep something derived from the tiles
+        uint32_t getChunkVersion(uint32_t chunk) const;
+
+    private:
+        struct Chunk {
+            //allocated on the first tile set, a chunk that was never touched costs nothing
+            std::vector<uint16_t> tiles;
+            uint32_t tileCount = 0;
+            uint32_t version = 0;
+            bool dirty = false;
+            MeshComponent mesh;
+        };
+
+        void markDirty(uint32_t chunk);
+
+        void buildMesh(Chunk &chunk) const;
+
+        uint32_t width, height;
+        uint32_t chunksX, chunksY;
+        float tileSize;
+        glm::vec2 origin;
+        std::vector<glm::vec4> palette;
+        std::vector<Chunk> chunks;
+        std::vector<uint32_t> dirty;
+        std::vector<uint32_t> rebuilt;
+    };
+
+    //owned by the map entity, gameplay code edits tiles through it and the TilemapRenderer draws it
+    struct TilemapComponent {
+        std::unique_ptr<Tilemap> tilemap;
+    };
+
+}
+
+#endif //GENERATIONS_TILEMAP_H
@@ -0,0 +1,104 @@
+#ifndef GENERATIONS_UNIFORMRING_H
+#define GENERATIONS_UNIFORMRING_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Includes.h"
+
+namespace SGE {
+
+    //ring suballocator over a fixed range of bytes. Allocations made between two finishFrame calls belong to that
+    //frame and their space only becomes free again once the frame is released as completed, so data the gpu may
+    //still read is never handed out twice. Knows nothing about the gpu and works on plain offsets.
+    class RingAllocator {
+    public:
+        static constexpr uint64_t invalidOffset = UINT64_MAX;
+
+        explicit RingAllocator(uint64_t capacity = 0);
+
+        //drops every allocation, including those of frames still in flight
+        void reset(uint64_t capacity);
+
+        //offset of size free bytes aligned to alignment, a power of two, or invalidOffset when only space still
+        //owned by frames in flight is left. Skipped bytes at the end of the range count as used by the frame.
+        uint64_t allocate(uint64_t size, uint64_t alignment);
+
+        //closes the allocations made since the previous call as belonging to frame
+        void finishFrame(uint64_t frame);
+
+        //frees the space of every finished frame up to and including completedFrame
+        void releaseCompleted(uint64_t completedFrame);
+
+        uint64_t getCapacity() const;
+
+        uint64_t getUsedSize() const;
+
+        size_t getFramesInFlight() const;
+
+    private:
+        struct FrameTail {
+            uint64_t frame;
+            uint64_t tail;
+            uint64_t size;
+        };
+
+        std::deque<FrameTail> frames;
+        uint64_t capacity = 0;
+        //oldest byte still in use and the next free one
+        uint64_t head = 0;
+        uint64_t tail = 0;
+        uint64_t used = 0;
+        uint64_t currentFrameSize = 0;
+    };
+
+    //a gpu buffer filled through a RingAllocator. Writes land in a cpu copy and are uploaded with one update per
+    //contiguous span, a fence signalled at the end of the frame tells when its space can be reused.
+    class UniformRing {
+    public:
+        UniformRing(std::string name, Diligent::BIND_FLAGS bindFlags, uint64_t capacity);
+
+        //frees the space of frames the gpu has finished with
+        void beginFrame(Diligent::IRenderDevice *device);
+
+        //copies size bytes into the ring and returns their offset in the buffer. When the ring is full and nothing
+        //was written yet this frame the buffer is replaced by a larger one, otherwise invalidOffset is returned.
+        uint64_t write(const void *data, uint64_t size, uint64_t alignment);
+
+        //like write, but hands out the size bytes at the returned offset to be filled in place before the next
+        //upload, for data that would otherwise be built in a buffer of its own only to be copied over
+        uint64_t reserve(uint64_t size, uint64_t alignment, void *&data);
+
+        //uploads what was written since the last upload, has to happen before the draws reading it are recorded
+        void upload(Diligent::IDeviceContext *context);
+
+        //uploads anything left and signals the frame's fence, called after the frame's draws were submitted
+        void endFrame(Diligent::IDeviceContext *context);
+
+        Diligent::IBuffer *getBuffer() const;
+
+    private:
+        struct Span {
+            uint64_t begin;
+            uint64_t end;
+        };
+
+        void createBuffer(Diligent::IRenderDevice *device, uint64_t capacity);
+
+        std::string name;
+        Diligent::BIND_FLAGS bindFlags;
+        RingAllocator allocator;
+        std::vector<uint8_t> staging;
+        std::vector<Span> spans;
+        size_t uploaded = 0;
+        Diligent::IRenderDevice *device = nullptr;
+        Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+        Diligent::RefCntAutoPtr<Diligent::IFence> fence;
+        uint64_t frame = 1;
+    };
+
+}
+
+#endif //GENERATIONS_UNIFORMRING_H
@@ -0,0 +1,152 @@
+#include "AnchorLayout.h"
+
+#include <algorithm>
+
+namespace SGE {
+
+    bool AnchorLayout::build(const std::vector<AnchorRule> &rules, const std::vector<uint32_t> &parents,
+                             std::string &error) {
+        auto count = (uint32_t) rules.size();
+        bool valid = true;
+        auto fail = [&](const std::string &message) {
+            if (valid)
+                error = message;
+            valid = false;
+        };
+        std::vector<uint32_t> parentOf(parents.begin(), parents.end());
+        parentOf.resize(count, window);
+
+        //depth of every element, 0 for top level ones. Found by walking up each chain of parents without recursing,
+        //so deep trees are fine, with every element on the walk marked until its depth is known.
+        std::vector<uint32_t> depth(count, 0);
+        std::vector<uint8_t> state(count, 0);
+        std::vector<uint32_t> chain;
+        for (uint32_t element = 0; element < count; element++) {
+            uint32_t current = element;
+            while (current != window && state[current] == 0) {
+                state[current] = 1;
+                chain.push_back(current);
+                if (parentOf[current] != window && parentOf[current] >= count) {
+                    fail("UI element " + std::to_string(current) + " has a parent that does not exist");
+                    parentOf[current] = window;
+                }
+                current = parentOf[current];
+            }
+            if (current != window && state[current] == 1) {
+                //the walk came back to itself, the element closing the cycle moves into the window
+                fail("UI element " + std::to_string(chain.back()) + " is its own ancestor");
+                parentOf[chain.back()] = window;
+            }
+            while (!chain.empty()) {
+                uint32_t done = chain.back();
+                chain.pop_back();
+                depth[done] = parentOf[done] == window ? 0 : depth[parentOf[done]] + 1;
+                state[done] = 2;
+            }
+        }
+
+        //counting sort by depth, elements of the same depth keep their order
+        uint32_t levels = 0;
+        for (uint32_t element = 0; element < count; element++) {
+            levels = std::max(levels, depth[element] + 1);
+        }
+        levelStart.assign(levels + 1, 0);
+        for (uint32_t element = 0; element < count; element++) {
+            levelStart[depth[element] + 1]++;
+        }
+        levelStart[0] = 1;
+        for (uint32_t level = 0; level < levels; level++) {
+            levelStart[level + 1] += levelStart[level];
+        }
+        std::vector<uint32_t> next(levelStart.begin(), levelStart.end() - 1);
+        slotOf.resize(count);
+        for (uint32_t element = 0; element < count; element++) {
+            slotOf[element] = next[depth[element]]++;
+        }
+
+        uint32_t slots = count + 1;
+        for (auto *array: {&anchorMinX, &anchorMinY, &anchorMaxX, &anchorMaxY, &offsetMinX, &offsetMinY, &offsetMaxX,
+                           &offsetMaxY, &left, &top, &right, &bottom, &parentLeft, &parentTop, &parentWidth,
+                           &parentHeight}) {
+            array->assign(slots, 0.f);
+        }
+        parentSlot.assign(slots, 0);
+        for (uint32_t element = 0; element < count; element++) {
+            uint32_t slot = slotOf[element];
+            parentSlot[slot] = parentOf[element] == window ? 0 : slotOf[parentOf[element]];
+            setRule(element, rules[element]);
+        }
+        return valid;
+    }
+
+    void AnchorLayout::setRule(uint32_t element, const AnchorRule &rule) {
+        uint32_t slot = slotOf[element];
+        anchorMinX[slot] = rule.anchorMin.x;
+        anchorMinY[slot] = rule.anchorMin.y;
+        anchorMaxX[slot] = rule.anchorMax.x;
+        anchorMaxY[slot] = rule.anchorMax.y;
+        offsetMinX[slot] = rule.offsetMin.x;
+        offsetMinY[slot] = rule.offsetMin.y;
+        offsetMaxX[slot] = rule.offsetMax.x;
+        offsetMaxY[slot] = rule.offsetMax.y;
+    }
+
+    void AnchorLayout::compute(float width, float height) {
+        if (left.empty())
+            return;
+        left[0] = 0.f;
+        top[0] = 0.f;
+        right[0] = width;
+        bottom[0] = height;
+        for (size_t level = 0; level + 1 < levelStart.size(); level++) {
+            uint32_t first = levelStart[level];
+            uint32_t count = levelStart[level + 1] - first;
+            //the parents are gathered into their own arrays first so the placement below only streams through
+            //contiguous memory
+            const uint32_t *parent = parentSlot.data() + first;
+            float *pLeft = parentLeft.data(), *pTop = parentTop.data();
+            float *pWidth = parentWidth.data(), *pHeight = parentHeight.data();
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t p = parent[i];
+                pLeft[i] = left[p];
+                pTop[i] = top[p];
+                pWidth[i] = right[p] - left[p];
+                pHeight[i] = bottom[p] - top[p];
+            }
+
+            const float *minX = anchorMinX.data() + first, *minY = anchorMinY.data() + first;
+            const float *maxX = anchorMaxX.data() + first, *maxY = anchorMaxY.data() + first;
+            const float *offMinX = offsetMinX.data() + first, *offMinY = offsetMinY.data() + first;
+            const float *offMaxX = offsetMaxX.data() + first, *offMaxY = offsetMaxY.data() + first;
+            float *outLeft = left.data() + first, *outTop = top.data() + first;
+            float *outRight = right.data() + first, *outBottom = bottom.data() + first;
+            //one loop per edge, each only has a single output that could alias its inputs
+            for (uint32_t i = 0; i < count; i++) {
+                outLeft[i] = pLeft[i] + pWidth[i] * minX[i] + offMinX[i];
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                outTop[i] = pTop[i] + pHeight[i] * minY[i] + offMinY[i];
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                outRight[i] = pLeft[i] + pWidth[i] * maxX[i] + offMaxX[i];
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                outBottom[i] = pTop[i] + pHeight[i] * maxY[i] + offMaxY[i];
+            }
+        }
+    }
+
+    UIRect AnchorLayout::getRect(uint32_t element) const {
+        uint32_t slot = slotOf[element];
+        return {left[slot], top[slot], right[slot], bottom[slot]};
+    }
+
+    uint32_t AnchorLayout::getElementCount() const {
+        return (uint32_t) slotOf.size();
+    }
+
+    uint32_t AnchorLayout::getDepth() const {
+        return levelStart.empty() ? 0 : (uint32_t) levelStart.size() - 1;
+    }
+
+}
@@ -0,0 +1,330 @@
+#include "Animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numeric>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define SGE_ANIMATION_SSE
+#include <emmintrin.h>
+#endif
+
+namespace SGE {
+
+    namespace {
+        //every lane count used below divides this
+        constexpr size_t padding = 8;
+
+        size_t padded(size_t count) {
+            return (count + padding - 1) / padding * padding;
+        }
+
+        //runs task on [first, last) ranges of at most chunkSize covering [0, count), in parallel when there are several
+        template<typename Task>
+        void forEachChunk(size_t count, const Task &task) {
+            size_t chunkCount = (count + AnimationSampler::chunkSize - 1) / AnimationSampler::chunkSize;
+            if (chunkCount <= 1) {
+                task(0, count);
+                return;
+            }
+            std::vector<size_t> chunks(chunkCount);
+            std::iota(chunks.begin(), chunks.end(), 0);
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+                size_t first = chunk * AnimationSampler::chunkSize;
+                task(first, std::min(first + AnimationSampler::chunkSize, count));
+            });
+        }
+
+        //the keys of track around time as the key before, the key after and how far time is between them. Playing
+        //forwards usually stays between the same keys or moves on to the next ones, only a jump searches.
+        void findKeys(const AnimationTrack &track, float time, uint32_t &cursor, uint32_t &before, uint32_t &after,
+                      float &fraction) {
+            const std::vector<float> &times = track.times;
+            auto last = (uint32_t) times.size() - 1;
+            fraction = 0.f;
+            if (time <= times.front()) {
+                cursor = before = after = 0;
+                return;
+            }
+            if (time >= times.back()) {
+                cursor = before = after = last;
+                return;
+            }
+            if (cursor >= last || times[cursor] > time) {
+                cursor = (uint32_t) (std::upper_bound(times.begin(), times.end(), time) - times.begin()) - 1;
+            } else {
+                while (times[cursor + 1] <= time) {
+                    cursor++;
+                }
+            }
+            before = cursor;
+            after = cursor + 1;
+            fraction = (time - times[before]) / (times[after] - times[before]);
+        }
+
+#if !defined(__AVX__) && !defined(SGE_ANIMATION_SSE)
+        //slerp's t for a normalized lerp between quaternions whose dot product is d, fitted by Arseny Kapoulkine
+        float correctedT(float d, float t) {
+            float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+            float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+            float k = a * (t - 0.5f) * (t - 0.5f) + b;
+            return t + t * (t - 0.5f) * (t - 1.f) * k;
+        }
+#endif
+    }
+
+    uint32_t AnimationLibrary::add(const std::string &key, AnimationClip clip) {
+        auto found = keys.find(key);
+        if (found != keys.end())
+            return found->second;
+        //a clip without a duration runs until its last key
+        if (clip.duration <= 0.f) {
+            for (const AnimationTrack &track: clip.tracks) {
+                if (!track.times.empty())
+                    clip.duration = std::max(clip.duration, track.times.back());
+            }
+        }
+        clips.push_back(std::move(clip));
+        keys.emplace(key, (uint32_t) clips.size() - 1);
+        return (uint32_t) clips.size() - 1;
+    }
+
+    const AnimationClip *AnimationLibrary::get(uint32_t clip) const {
+        return clip < clips.size() ? &clips[clip] : nullptr;
+    }
+
+    uint32_t AnimationLibrary::find(const std::string &key) const {
+        auto found = keys.find(key);
+        return found != keys.end() ? found->second : size();
+    }
+
+    uint32_t AnimationLibrary::size() const {
+        return (uint32_t) clips.size();
+    }
+
+    template<size_t Components>
+    void AnimationSampler::Batch<Components>::resize(size_t count) {
+        //every slot is overwritten by prepare, only the padding needs a value
+        for (size_t component = 0; component < Components; component++) {
+            from[component].resize(padded(count));
+            to[component].resize(padded(count));
+            result[component].resize(padded(count));
+            std::fill(from[component].begin() + (ptrdiff_t) count, from[component].end(), 0.f);
+            std::fill(to[component].begin() + (ptrdiff_t) count, to[component].end(), 0.f);
+        }
+        t.resize(padded(count));
+        std::fill(t.begin() + (ptrdiff_t) count, t.end(), 0.f);
+        //padding rotations are the identity rather than a zero quaternion nothing can normalize
+        std::fill(from[0].begin() + (ptrdiff_t) count, from[0].end(), 1.f);
+        std::fill(to[0].begin() + (ptrdiff_t) count, to[0].end(), 1.f);
+    }
+
+    template<size_t Components>
+    void AnimationSampler::Batch<Components>::set(uint32_t slot, const float *before, const float *after,
+                                                  float fraction) {
+        for (size_t component = 0; component < Components; component++) {
+            from[component][slot] = before[component];
+            to[component][slot] = after[component];
+        }
+        t[slot] = fraction;
+    }
+
+    void AnimationSampler::resize(uint32_t animators) {
+        count = animators;
+        positions.resize(count);
+        scales.resize(count);
+        rotations.resize(count);
+    }
+
+    void AnimationSampler::prepare(uint32_t slot, const AnimationClip &clip, Animator &animator,
+                                   const Transform &current, float dt) {
+        if (animator.playing)
+            animator.time += dt * animator.speed;
+        if (clip.duration > 0.f) {
+            if (animator.loop) {
+                //a frame rarely passes the end more than once
+                if (animator.time >= clip.duration)
+                    animator.time -= clip.duration;
+                else if (animator.time < 0.f)
+                    animator.time += clip.duration;
+                if (animator.time >= clip.duration || animator.time < 0.f) {
+                    animator.time = std::fmod(animator.time, clip.duration);
+                    if (animator.time < 0.f)
+                        animator.time += clip.duration;
+                }
+            } else if (animator.time >= clip.duration || animator.time < 0.f) {
+                //played past either end, backwards playback ends at the start
+                animator.time = std::clamp(animator.time, 0.f, clip.duration);
+                animator.playing = false;
+            }
+        }
+
+        const float position[3] = {current.position.x, current.position.y, current.position.z};
+        const float rotation[4] = {current.rotation.w, current.rotation.x, current.rotation.y, current.rotation.z};
+        const float scale[3] = {current.scale.x, current.scale.y, current.scale.z};
+        uint32_t before, after;
+        float fraction;
+        for (uint32_t channel = 0; channel < 3; channel++) {
+            const AnimationTrack &track = clip.tracks[channel];
+            const float *from, *to;
+            if (track.times.empty()) {
+                from = to = channel == AnimationClip::Position ? position :
+                            channel == AnimationClip::Rotation ? rotation : scale;
+                fraction = 0.f;
+            } else {
+                findKeys(track, animator.time, animator.cursors[channel], before, after, fraction);
+                from = &track.values[before].x;
+                to = &track.values[after].x;
+            }
+            if (channel == AnimationClip::Rotation)
+                rotations.set(slot, from, to, fraction);
+            else
+                (channel == AnimationClip::Position ? positions : scales).set(slot, from, to, fraction);
+        }
+    }
+
+    void AnimationSampler::evaluate() {
+        forEachChunk(padded(count), [this](size_t first, size_t last) {
+            lerp(positions, first, last);
+            lerp(scales, first, last);
+            slerp(rotations, first, last);
+        });
+    }
+
+    void AnimationSampler::read(uint32_t slot, Transform &transform) const {
+        transform.position = {positions.result[0][slot], positions.result[1][slot], positions.result[2][slot]};
+        transform.rotation = glm::quat(rotations.result[0][slot], rotations.result[1][slot],
+                                       rotations.result[2][slot], rotations.result[3][slot]);
+        transform.scale = {scales.result[0][slot], scales.result[1][slot], scales.result[2][slot]};
+    }
+
+    uint32_t AnimationSampler::size() const {
+        return count;
+    }
+
+    void AnimationSampler::lerp(Batch<3> &batch, size_t first, size_t last) {
+        const float *t = batch.t.data();
+        for (size_t component = 0; component < 3; component++) {
+            const float *from = batch.from[component].data(), *to = batch.to[component].data();
+            float *result = batch.result[component].data();
+#if defined(__AVX__)
+            for (size_t i = first; i < last; i += 8) {
+                __m256 a = _mm256_loadu_ps(from + i);
+                __m256 difference = _mm256_sub_ps(_mm256_loadu_ps(to + i), a);
+                _mm256_storeu_ps(result + i, _mm256_add_ps(a, _mm256_mul_ps(difference, _mm256_loadu_ps(t + i))));
+            }
+#elif defined(SGE_ANIMATION_SSE)
+            for (size_t i = first; i < last; i += 4) {
+                __m128 a = _mm_loadu_ps(from + i);
+                __m128 difference = _mm_sub_ps(_mm_loadu_ps(to + i), a);
+                _mm_storeu_ps(result + i, _mm_add_ps(a, _mm_mul_ps(difference, _mm_loadu_ps(t + i))));
+            }
+#else
+            for (size_t i = first; i < last; i++) {
+                result[i] = from[i] + (to[i] - from[i]) * t[i];
+            }
+#endif
+        }
+    }
+
+    void AnimationSampler::slerp(Batch<4> &batch, size_t first, size_t last) {
+        //a normalized lerp with t corrected by correctedT, the same polynomials written out for every lane. It
+        //takes the shorter way round, the second quaternion counts negated when the dot product is negative.
+        const float *aw = batch.from[0].data(), *ax = batch.from[1].data();
+        const float *ay = batch.from[2].data(), *az = batch.from[3].data();
+        const float *bw = batch.to[0].data(), *bx = batch.to[1].data();
+        const float *by = batch.to[2].data(), *bz = batch.to[3].data();
+        const float *t = batch.t.data();
+        float *rw = batch.result[0].data(), *rx = batch.result[1].data();
+        float *ry = batch.result[2].data(), *rz = batch.result[3].data();
+#if defined(__AVX__)
+        const __m256 one = _mm256_set1_ps(1.f), half = _mm256_set1_ps(0.5f);
+        const __m256 sign = _mm256_set1_ps(-0.f);
+        for (size_t i = first; i < last; i += 8) {
+            __m256 w0 = _mm256_loadu_ps(aw + i), x0 = _mm256_loadu_ps(ax + i);
+            __m256 y0 = _mm256_loadu_ps(ay + i), z0 = _mm256_loadu_ps(az + i);
+            __m256 w1 = _mm256_loadu_ps(bw + i), x1 = _mm256_loadu_ps(bx + i);
+            __m256 y1 = _mm256_loadu_ps(by + i), z1 = _mm256_loadu_ps(bz + i);
+            __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w0, w1), _mm256_mul_ps(x0, x1)),
+                                       _mm256_add_ps(_mm256_mul_ps(y0, y1), _mm256_mul_ps(z0, z1)));
+            __m256 negative = _mm256_and_ps(dot, sign);
+            __m256 d = _mm256_andnot_ps(sign, dot);
+            __m256 s = _mm256_loadu_ps(t + i);
+            __m256 a = _mm256_add_ps(_mm256_set1_ps(1.0904f), _mm256_mul_ps(d, _mm256_add_ps(
+                    _mm256_set1_ps(-3.2452f), _mm256_mul_ps(d, _mm256_sub_ps(
+                            _mm256_set1_ps(3.55645f), _mm256_mul_ps(d, _mm256_set1_ps(1.43519f)))))));
+            __m256 b = _mm256_add_ps(_mm256_set1_ps(0.848013f), _mm256_mul_ps(d, _mm256_add_ps(
+                    _mm256_set1_ps(-1.06021f), _mm256_mul_ps(d, _mm256_set1_ps(0.215638f)))));
+            __m256 centered = _mm256_sub_ps(s, half);
+            __m256 k = _mm256_add_ps(_mm256_mul_ps(a, _mm256_mul_ps(centered, centered)), b);
+            __m256 corrected = _mm256_add_ps(s, _mm256_mul_ps(_mm256_mul_ps(s, centered),
+                                                              _mm256_mul_ps(_mm256_sub_ps(s, one), k)));
+            __m256 keep = _mm256_sub_ps(one, corrected);
+            __m256 take = _mm256_xor_ps(corrected, negative);
+            __m256 w = _mm256_add_ps(_mm256_mul_ps(w0, keep), _mm256_mul_ps(w1, take));
+            __m256 x = _mm256_add_ps(_mm256_mul_ps(x0, keep), _mm256_mul_ps(x1, take));
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(y0, keep), _mm256_mul_ps(y1, take));
+            __m256 z = _mm256_add_ps(_mm256_mul_ps(z0, keep), _mm256_mul_ps(z1, take));
+            __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w, w), _mm256_mul_ps(x, x)),
+                                                         _mm256_add_ps(_mm256_mul_ps(y, y), _mm256_mul_ps(z, z))));
+            __m256 inverse = _mm256_div_ps(one, length);
+            _mm256_storeu_ps(rw + i, _mm256_mul_ps(w, inverse));
+            _mm256_storeu_ps(rx + i, _mm256_mul_ps(x, inverse));
+            _mm256_storeu_ps(ry + i, _mm256_mul_ps(y, inverse));
+            _mm256_storeu_ps(rz + i, _mm256_mul_ps(z, inverse));
+        }
+#elif defined(SGE_ANIMATION_SSE)
+        const __m128 one = _mm_set1_ps(1.f), half = _mm_set1_ps(0.5f);
+        const __m128 sign = _mm_set1_ps(-0.f);
+        for (size_t i = first; i < last; i += 4) {
+            __m128 w0 = _mm_loadu_ps(aw + i), x0 = _mm_loadu_ps(ax + i);
+            __m128 y0 = _mm_loadu_ps(ay + i), z0 = _mm_loadu_ps(az + i);
+            __m128 w1 = _mm_loadu_ps(bw + i), x1 = _mm_loadu_ps(bx + i);
+            __m128 y1 = _mm_loadu_ps(by + i), z1 = _mm_loadu_ps(bz + i);
+            __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, w1), _mm_mul_ps(x0, x1)),
+                                    _mm_add_ps(_mm_mul_ps(y0, y1), _mm_mul_ps(z0, z1)));
+            __m128 negative = _mm_and_ps(dot, sign);
+            __m128 d = _mm_andnot_ps(sign, dot);
+            __m128 s = _mm_loadu_ps(t + i);
+            __m128 a = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(
+                    _mm_set1_ps(-3.2452f), _mm_mul_ps(d, _mm_sub_ps(
+                            _mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+            __m128 b = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(
+                    _mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+            __m128 centered = _mm_sub_ps(s, half);
+            __m128 k = _mm_add_ps(_mm_mul_ps(a, _mm_mul_ps(centered, centered)), b);
+            __m128 corrected = _mm_add_ps(s, _mm_mul_ps(_mm_mul_ps(s, centered), _mm_mul_ps(_mm_sub_ps(s, one), k)));
+            __m128 keep = _mm_sub_ps(one, corrected);
+            __m128 take = _mm_xor_ps(corrected, negative);
+            __m128 w = _mm_add_ps(_mm_mul_ps(w0, keep), _mm_mul_ps(w1, take));
+            __m128 x = _mm_add_ps(_mm_mul_ps(x0, keep), _mm_mul_ps(x1, take));
+            __m128 y = _mm_add_ps(_mm_mul_ps(y0, keep), _mm_mul_ps(y1, take));
+            __m128 z = _mm_add_ps(_mm_mul_ps(z0, keep), _mm_mul_ps(z1, take));
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(x, x)),
+                                                   _mm_add_ps(_mm_mul_ps(y, y), _mm_mul_ps(z, z))));
+            __m128 inverse = _mm_div_ps(one, length);
+            _mm_storeu_ps(rw + i, _mm_mul_ps(w, inverse));
+            _mm_storeu_ps(rx + i, _mm_mul_ps(x, inverse));
+            _mm_storeu_ps(ry + i, _mm_mul_ps(y, inverse));
+            _mm_storeu_ps(rz + i, _mm_mul_ps(z, inverse));
+        }
+#else
+        for (size_t i = first; i < last; i++) {
+            float dot = aw[i] * bw[i] + ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+            float corrected = correctedT(std::abs(dot), t[i]);
+            float keep = 1.f - corrected, take = dot < 0.f ? -corrected : corrected;
+            float w = aw[i] * keep + bw[i] * take, x = ax[i] * keep + bx[i] * take;
+            float y = ay[i] * keep + by[i] * take, z = az[i] * keep + bz[i] * take;
+            float inverse = 1.f / std::sqrt(w * w + x * x + y * y + z * z);
+            rw[i] = w * inverse;
+            rx[i] = x * inverse;
+            ry[i] = y * inverse;
+            rz[i] = z * inverse;
+        }
+#endif
+    }
+
+}
@@ -0,0 +1,229 @@
+#include "AssetStreamer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace SGE {
+
+    namespace {
+        //frames an asset that found no room waits at most before it is loaded again
+        constexpr uint32_t maxBackoff = 64;
+    }
+
+    AssetStreamer::AssetStreamer(ModelLoader *modelLoader, size_t cpuBudget, size_t gpuBudget, uint32_t ioThreads)
+            : m_modelLoader(modelLoader), cpuBudget(cpuBudget), gpuBudget(gpuBudget) {
+        m_logger = Logger::getInstance();
+        if (ioThreads == 0)
+            ioThreads = 1;
+        //keep a couple of loads queued per thread so a finished load never waits on the main thread
+        maxInFlight = ioThreads * 2;
+        for (uint32_t i = 0; i < ioThreads; i++) {
+            workers.emplace_back(&AssetStreamer::ioLoop, this);
+        }
+    }
+
+    AssetStreamer::~AssetStreamer() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stopping = true;
+        }
+        m_condition.notify_all();
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+
+    void AssetStreamer::request(uint32_t id, const std::string &file, float priority) {
+        auto &asset = assets[id];
+        asset.lastUsedFrame = frame;
+        switch (asset.state) {
+            case AssetState::Unloaded:
+                if (frame < asset.retryFrame)
+                    break;
+                asset.file = file;
+                asset.priority = priority;
+                asset.state = AssetState::Queued;
+                pending.insert({priority, id});
+                //packed meshes start paging in while they wait for a free io thread
+                ModelLoader::prefetchMesh(file);
+                break;
+            case AssetState::Queued:
+                if (priority != asset.priority) {
+                    pending.erase({asset.priority, id});
+                    asset.priority = priority;
+                    pending.insert({priority, id});
+                }
+                break;
+            case AssetState::Resident:
+                asset.priority = priority;
+                touch(asset);
+                break;
+            case AssetState::Loading:
+                asset.priority = priority;
+                break;
+            case AssetState::Failed:
+                break;
+        }
+    }
+
+    void AssetStreamer::update() {
+        std::vector<LoadResult> results;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            results.swap(completed);
+            inFlight -= results.size();
+
+            while (inFlight < maxInFlight && !pending.empty()) {
+                uint32_t id = pending.begin()->second;
+                pending.erase(pending.begin());
+                auto &asset = assets[id];
+                asset.state = AssetState::Loading;
+                jobs.emplace_back(id, asset.file);
+                inFlight++;
+            }
+        }
+        m_condition.notify_all();
+
+        for (auto &result: results) {
+            auto &asset = assets[result.id];
+            asset.state = AssetState::Unloaded;
+            if (!result.success) {
+                //reading the file again would fail the same way, so it is reported once and left alone
+                m_logger->writeToLog("Error, failed to stream " + asset.file + ": " + result.error);
+                asset.state = AssetState::Failed;
+                continue;
+            }
+            //entities refer to the streamed id, a different id in the file is most likely a copied asset
+            if (result.fileId != result.id) {
+                m_logger->writeToLog("Warning, " + asset.file + " declares PregenID " + std::to_string(result.fileId) +
+                                     " but is streamed as mesh " + std::to_string(result.id));
+            }
+
+            size_t vertexSize = result.mesh.vertices.size() * sizeof(Vertex);
+            size_t cpuSize = vertexSize + result.mesh.indices.size() * sizeof(uint32_t);
+            size_t gpuSize = vertexSize + result.mesh.indices.size() * result.mesh.indexStride();
+            if (cpuSize > cpuBudget || gpuSize > gpuBudget) {
+                m_logger->writeToLog("Error, streaming budget is too small to ever fit " + asset.file);
+                asset.state = AssetState::Failed;
+                continue;
+            }
+            if (!makeRoom(cpuSize, gpuSize, asset.priority)) {
+                //everything resident is nearer, the asset waits for some of it to go out of view
+                asset.backoff = std::min(std::max(asset.backoff * 2, 1u), maxBackoff);
+                asset.retryFrame = frame + asset.backoff;
+                continue;
+            }
+            asset.backoff = 0;
+
+            m_modelLoader->addMesh(result.id, std::move(result.mesh));
+            m_modelLoader->createVertexBuffer(result.id, asset.file);
+            m_modelLoader->createIndexBuffer(result.id, asset.file);
+
+            asset.cpuSize = cpuSize;
+            asset.gpuSize = gpuSize;
+            cpuUsage += asset.cpuSize;
+            gpuUsage += asset.gpuSize;
+            asset.state = AssetState::Resident;
+            lru.push_front(result.id);
+            asset.lruPosition = lru.begin();
+        }
+
+        frame++;
+    }
+
+    void AssetStreamer::retry(uint32_t id) {
+        auto it = assets.find(id);
+        if (it == assets.end() || it->second.state != AssetState::Failed)
+            return;
+        it->second.state = AssetState::Unloaded;
+        it->second.retryFrame = 0;
+        it->second.backoff = 0;
+    }
+
+    AssetState AssetStreamer::getState(uint32_t id) const {
+        auto it = assets.find(id);
+        if (it == assets.end())
+            return AssetState::Unloaded;
+        return it->second.state;
+    }
+
+    bool AssetStreamer::isResident(uint32_t id) const {
+        return getState(id) == AssetState::Resident;
+    }
+
+    void AssetStreamer::ioLoop() {
+        while (true) {
+            std::pair<uint32_t, std::string> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping)
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            LoadResult result;
+            result.id = job.first;
+            //formats without a PregenID leave the id alone
+            result.fileId = job.first;
+            result.success = ModelLoader::readMesh(job.second, result.fileId, result.mesh, result.error);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            completed.push_back(std::move(result));
+        }
+    }
+
+    void AssetStreamer::touch(Asset &asset) {
+        lru.splice(lru.begin(), lru, asset.lruPosition);
+    }
+
+    bool AssetStreamer::makeRoom(size_t cpuSize, size_t gpuSize, float priority) {
+        auto fits = [&](size_t cpuFreed, size_t gpuFreed) {
+            return cpuUsage - cpuFreed + cpuSize <= cpuBudget && gpuUsage - gpuFreed + gpuSize <= gpuBudget;
+        };
+        while (!fits(0, 0) && !lru.empty()) {
+            uint32_t id = lru.back();
+            auto &asset = assets[id];
+            //anything requested this frame is visible, it is only given up for a nearer asset below
+            if (asset.lastUsedFrame == frame)
+                break;
+            evict(id, asset);
+        }
+        if (fits(0, 0))
+            return true;
+
+        //assets the lru pass stopped in front of that were not requested this frame go first
+        std::vector<std::pair<float, uint32_t>> further;
+        for (uint32_t id: lru) {
+            const Asset &asset = assets[id];
+            float distance = asset.lastUsedFrame == frame ? asset.priority : std::numeric_limits<float>::infinity();
+            if (distance > priority)
+                further.emplace_back(distance, id);
+        }
+        std::sort(further.begin(), further.end(), std::greater<>());
+        size_t count = 0, cpuFreed = 0, gpuFreed = 0;
+        while (!fits(cpuFreed, gpuFreed) && count < further.size()) {
+            const Asset &asset = assets[further[count++].second];
+            cpuFreed += asset.cpuSize;
+            gpuFreed += asset.gpuSize;
+        }
+        if (!fits(cpuFreed, gpuFreed))
+            return false;
+        for (size_t i = 0; i < count; i++) {
+            evict(further[i].second, assets[further[i].second]);
+        }
+        return true;
+    }
+
+    void AssetStreamer::evict(uint32_t id, Asset &asset) {
+        m_modelLoader->unloadMesh(id);
+        cpuUsage -= asset.cpuSize;
+        gpuUsage -= asset.gpuSize;
+        asset.cpuSize = 0;
+        asset.gpuSize = 0;
+        asset.state = AssetState::Unloaded;
+        lru.erase(asset.lruPosition);
+    }
+
+}
@@ -0,0 +1,296 @@
+#include "AtlasPacker.h"
+
+#include <algorithm>
+#include <execution>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace SGE {
+
+    namespace {
+        uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+            auto bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        template<typename T>
+        uint64_t hashValue(uint64_t hash, const T &value) {
+            return hashBytes(hash, &value, sizeof(value));
+        }
+
+        //pages are filled to about this much before the spill round, more leaves too many sprites for it
+        constexpr float targetOccupancy = 0.85f;
+    }
+
+    SkylinePacker::SkylinePacker(uint32_t width, uint32_t height) : width(width), height(height) {
+        skyline.push_back({0, 0, width});
+    }
+
+    uint32_t SkylinePacker::restingHeight(size_t index, uint32_t rectWidth, uint32_t rectHeight) const {
+        if (skyline[index].x + rectWidth > width)
+            return UINT32_MAX;
+        uint32_t y = 0;
+        uint32_t covered = 0;
+        for (size_t i = index; covered < rectWidth; i++) {
+            y = std::max(y, skyline[i].y);
+            if (y + rectHeight > height)
+                return UINT32_MAX;
+            covered += skyline[i].width;
+        }
+        return y;
+    }
+
+    bool SkylinePacker::insert(uint32_t rectWidth, uint32_t rectHeight, AtlasRect &rect) {
+        if (rectWidth == 0 || rectHeight == 0 || rectWidth > width || rectHeight > height)
+            return false;
+        size_t best = SIZE_MAX;
+        uint32_t bestY = UINT32_MAX;
+        for (size_t i = 0; i < skyline.size(); i++) {
+            uint32_t y = restingHeight(i, rectWidth, rectHeight);
+            if (y < bestY) {
+                best = i;
+                bestY = y;
+            }
+        }
+        if (best == SIZE_MAX)
+            return false;
+        rect = {skyline[best].x, bestY, rectWidth, rectHeight};
+        place(best, rect);
+        usedArea += (uint64_t) rectWidth * rectHeight;
+        return true;
+    }
+
+    void SkylinePacker::place(size_t index, const AtlasRect &rect) {
+        skyline.insert(skyline.begin() + (ptrdiff_t) index, {rect.x, rect.y + rect.height, rect.width});
+        //segments now under the rectangle are cut back or removed
+        size_t i = index + 1;
+        while (i < skyline.size()) {
+            uint32_t end = rect.x + rect.width;
+            if (skyline[i].x >= end)
+                break;
+            uint32_t shrink = std::min(skyline[i].width, end - skyline[i].x);
+            skyline[i].x += shrink;
+            skyline[i].width -= shrink;
+            if (skyline[i].width > 0)
+                break;
+            skyline.erase(skyline.begin() + (ptrdiff_t) i);
+        }
+        //neighbours at the same height merge so the skyline stays short
+        for (size_t j = 0; j + 1 < skyline.size();) {
+            if (skyline[j].y == skyline[j + 1].y) {
+                skyline[j].width += skyline[j + 1].width;
+                skyline.erase(skyline.begin() + (ptrdiff_t) j + 1);
+            } else {
+                j++;
+            }
+        }
+    }
+
+    uint64_t SkylinePacker::getUsedArea() const {
+        return usedArea;
+    }
+
+    float SkylinePacker::getOccupancy() const {
+        return (float) usedArea / (float) ((uint64_t) width * height);
+    }
+
+    const AtlasEntry *AtlasLayout::find(const std::string &name) const {
+        auto it = std::lower_bound(entries.begin(), entries.end(), name, [](const AtlasEntry &entry,
+                                                                           const std::string &key) {
+            return entry.name < key;
+        });
+        return it != entries.end() && it->name == name ? &*it : nullptr;
+    }
+
+    uint64_t AtlasPacker::hashInputs(const std::vector<AtlasSprite> &sprites, const AtlasDesc &desc) {
+        std::vector<const AtlasSprite *> sorted(sprites.size());
+        for (size_t i = 0; i < sprites.size(); i++) {
+            sorted[i] = &sprites[i];
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const AtlasSprite *a, const AtlasSprite *b) {
+            return a->name < b->name;
+        });
+
+        uint64_t hash = 14695981039346656037ull;
+        hash = hashValue(hash, desc.pageWidth);
+        hash = hashValue(hash, desc.pageHeight);
+        hash = hashValue(hash, desc.padding);
+        hash = hashValue(hash, desc.maxPages);
+        for (const AtlasSprite *sprite: sorted) {
+            hash = hashBytes(hash, sprite->name.data(), sprite->name.size() + 1);
+            hash = hashValue(hash, sprite->width);
+            hash = hashValue(hash, sprite->height);
+            hash = hashValue(hash, sprite->hash);
+        }
+        return hash;
+    }
+
+    bool AtlasPacker::pack(const std::vector<AtlasSprite> &sprites, const AtlasDesc &desc, AtlasLayout &layout,
+                           std::string &error) {
+        layout = AtlasLayout();
+        layout.desc = desc;
+        layout.inputHash = hashInputs(sprites, desc);
+
+        uint32_t padding = desc.padding;
+        uint64_t totalArea = 0;
+        for (const auto &sprite: sprites) {
+            if (sprite.width + 2 * padding > desc.pageWidth || sprite.height + 2 * padding > desc.pageHeight) {
+                error = sprite.name + " does not fit on an atlas page";
+                return false;
+            }
+            totalArea += (uint64_t) (sprite.width + 2 * padding) * (sprite.height + 2 * padding);
+        }
+
+        //tallest first, then widest, then by name so equal sprites always land in the same order
+        std::vector<uint32_t> pending(sprites.size());
+        std::iota(pending.begin(), pending.end(), 0);
+        auto taller = [&](uint32_t a, uint32_t b) {
+            if (sprites[a].height != sprites[b].height)
+                return sprites[a].height > sprites[b].height;
+            if (sprites[a].width != sprites[b].width)
+                return sprites[a].width > sprites[b].width;
+            return sprites[a].name < sprites[b].name;
+        };
+        std::sort(pending.begin(), pending.end(), taller);
+
+        struct Page {
+            SkylinePacker packer;
+            std::vector<uint32_t> sprites;
+            std::vector<uint32_t> failed;
+        };
+        std::vector<Page> pages;
+        std::vector<AtlasEntry> placed(sprites.size());
+        auto insert = [&](Page &page, uint32_t pageIndex, uint32_t sprite) {
+            AtlasRect rect;
+            if (!page.packer.insert(sprites[sprite].width + 2 * padding, sprites[sprite].height + 2 * padding, rect))
+                return false;
+            placed[sprite] = {sprites[sprite].name, pageIndex,
+                              {rect.x + padding, rect.y + padding, sprites[sprite].width, sprites[sprite].height}};
+            return true;
+        };
+
+        uint64_t pageArea = (uint64_t) desc.pageWidth * desc.pageHeight;
+        uint64_t pendingArea = totalArea;
+        while (!pending.empty()) {
+            auto newPages = (uint32_t) std::max<uint64_t>(1, (uint64_t) ((double) pendingArea /
+                                                                         ((double) pageArea * targetOccupancy)));
+            if (pages.size() + newPages > desc.maxPages)
+                newPages = desc.maxPages - (uint32_t) pages.size();
+            if (newPages == 0) {
+                error = "The sprites need more than " + std::to_string(desc.maxPages) + " atlas pages";
+                return false;
+            }
+
+            //dealt out in turn so every page gets a similar mix of large and small sprites
+            auto first = (uint32_t) pages.size();
+            for (uint32_t i = 0; i < newPages; i++) {
+                pages.push_back({SkylinePacker(desc.pageWidth, desc.pageHeight), {}, {}});
+            }
+            for (size_t i = 0; i < pending.size(); i++) {
+                pages[first + i % newPages].sprites.push_back(pending[i]);
+            }
+            std::vector<uint32_t> indices(newPages);
+            std::iota(indices.begin(), indices.end(), first);
+            std::for_each(std::execution::par, indices.begin(), indices.end(), [&](uint32_t index) {
+                Page &page = pages[index];
+                for (uint32_t sprite: page.sprites) {
+                    if (!insert(page, index, sprite))
+                        page.failed.push_back(sprite);
+                }
+            });
+
+            //the spill goes into whichever page still has room, in page order, before another round opens more
+            std::vector<uint32_t> spill;
+            for (uint32_t index = first; index < pages.size(); index++) {
+                spill.insert(spill.end(), pages[index].failed.begin(), pages[index].failed.end());
+                pages[index].failed.clear();
+            }
+            std::sort(spill.begin(), spill.end(), taller);
+            pending.clear();
+            pendingArea = 0;
+            for (uint32_t sprite: spill) {
+                bool done = false;
+                for (uint32_t index = 0; index < pages.size() && !done; index++) {
+                    done = insert(pages[index], index, sprite);
+                }
+                if (!done) {
+                    pending.push_back(sprite);
+                    pendingArea += (uint64_t) (sprites[sprite].width + 2 * padding) *
+                                   (sprites[sprite].height + 2 * padding);
+                }
+            }
+        }
+
+        layout.pageCount = (uint32_t) pages.size();
+        layout.entries = std::move(placed);
+        std::sort(layout.entries.begin(), layout.entries.end(), [](const AtlasEntry &a, const AtlasEntry &b) {
+            return a.name < b.name;
+        });
+        return true;
+    }
+
+    bool AtlasPacker::write(const std::string &path, const AtlasLayout &layout, std::string &error) {
+        std::ofstream file(path, std::ios::trunc);
+        file << "atlas " << layout.inputHash << " " << layout.desc.pageWidth << " " << layout.desc.pageHeight << " "
+             << layout.desc.padding << " " << layout.desc.maxPages << " " << layout.pageCount << "\n";
+        for (const auto &entry: layout.entries) {
+            file << entry.page << " " << entry.rect.x << " " << entry.rect.y << " " << entry.rect.width << " "
+                 << entry.rect.height << " " << entry.name << "\n";
+        }
+        if (!file) {
+            error = "could not write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    bool AtlasPacker::read(const std::string &path, AtlasLayout &layout, std::string &error) {
+        std::ifstream file(path);
+        std::string line, magic;
+        layout = AtlasLayout();
+        if (!file || !std::getline(file, line)) {
+            error = "could not read " + path;
+            return false;
+        }
+        std::istringstream header(line);
+        header >> magic >> layout.inputHash >> layout.desc.pageWidth >> layout.desc.pageHeight >> layout.desc.padding
+               >> layout.desc.maxPages >> layout.pageCount;
+        if (header.fail() || magic != "atlas") {
+            error = path + " is not an atlas layout";
+            return false;
+        }
+        while (std::getline(file, line)) {
+            std::istringstream stream(line);
+            AtlasEntry entry;
+            stream >> entry.page >> entry.rect.x >> entry.rect.y >> entry.rect.width >> entry.rect.height;
+            stream.get();
+            std::getline(stream, entry.name);
+            if (stream.fail() || entry.name.empty() || entry.page >= layout.pageCount) {
+                error = "broken entry in " + path;
+                return false;
+            }
+            layout.entries.push_back(std::move(entry));
+        }
+        std::sort(layout.entries.begin(), layout.entries.end(), [](const AtlasEntry &a, const AtlasEntry &b) {
+            return a.name < b.name;
+        });
+        return true;
+    }
+
+    void AtlasPacker::remapTexCoords(MeshComponent &mesh, const AtlasLayout &layout, const AtlasEntry &entry) {
+        float left = (float) entry.rect.x / (float) layout.desc.pageWidth;
+        float top = (float) entry.rect.y / (float) layout.desc.pageHeight;
+        float width = (float) entry.rect.width / (float) layout.desc.pageWidth;
+        float height = (float) entry.rect.height / (float) layout.desc.pageHeight;
+        for (auto &vertex: mesh.vertices) {
+            vertex.texCoord.x = left + vertex.texCoord.x * width;
+            vertex.texCoord.y = top + vertex.texCoord.y * height;
+            vertex.texCoord.z = (float) entry.page;
+        }
+    }
+
+}
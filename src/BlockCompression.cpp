@@ -0,0 +1,159 @@
+#include "BlockCompression.h"
+
+#include <cstring>
+#include <vector>
+
+namespace SGE {
+
+    namespace {
+        constexpr size_t kMinMatch = 4;
+        //the format requires the last five bytes to be literals and the last match to start 12 bytes before the end
+        constexpr size_t kLastLiterals = 5;
+        constexpr size_t kMatchLimit = 12;
+        constexpr size_t kMaxOffset = 65535;
+        constexpr int kHashBits = 16;
+
+        inline uint32_t read32(const uint8_t *p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint32_t hash(uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32 - kHashBits);
+        }
+
+        //writes the 255 continuation bytes of a length that did not fit into its token nibble
+        inline bool writeLength(uint8_t *&out, const uint8_t *end, size_t length) {
+            while (length >= 255) {
+                if (out >= end)
+                    return false;
+                *out++ = 255;
+                length -= 255;
+            }
+            if (out >= end)
+                return false;
+            *out++ = (uint8_t) length;
+            return true;
+        }
+
+        bool writeSequence(uint8_t *&out, const uint8_t *end, const uint8_t *literals, size_t literalCount,
+                           size_t offset, size_t matchLength) {
+            if (out >= end)
+                return false;
+            uint8_t *token = out++;
+            *token = (uint8_t) ((literalCount >= 15 ? 15 : literalCount) << 4);
+            if (literalCount >= 15 && !writeLength(out, end, literalCount - 15))
+                return false;
+            if ((size_t) (end - out) < literalCount)
+                return false;
+            std::memcpy(out, literals, literalCount);
+            out += literalCount;
+
+            //the final sequence has literals only
+            if (matchLength == 0)
+                return true;
+
+            if (end - out < 2)
+                return false;
+            *out++ = (uint8_t) (offset & 0xff);
+            *out++ = (uint8_t) (offset >> 8);
+            size_t code = matchLength - kMinMatch;
+            *token |= (uint8_t) (code >= 15 ? 15 : code);
+            return code < 15 || writeLength(out, end, code - 15);
+        }
+
+        inline bool readLength(const uint8_t *&in, const uint8_t *end, size_t &length) {
+            uint8_t byte;
+            do {
+                if (in >= end)
+                    return false;
+                byte = *in++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+    }
+
+    size_t BlockCompression::compressBound(size_t size) {
+        return size + size / 255 + 16;
+    }
+
+    size_t BlockCompression::compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity) {
+        uint8_t *out = dst;
+        const uint8_t *end = dst + capacity;
+        size_t anchor = 0;
+        size_t pos = 0;
+
+        //positions are stored off by one so zero means empty
+        std::vector<uint32_t> table(1 << kHashBits, 0);
+        while (size > kMatchLimit && pos < size - kMatchLimit) {
+            uint32_t sequence = read32(src + pos);
+            uint32_t &slot = table[hash(sequence)];
+            size_t candidate = slot;
+            slot = (uint32_t) pos + 1;
+
+            if (candidate == 0 || pos - (candidate - 1) > kMaxOffset || read32(src + candidate - 1) != sequence) {
+                pos++;
+                continue;
+            }
+
+            size_t match = candidate - 1;
+            size_t length = kMinMatch;
+            size_t limit = size - kLastLiterals;
+            while (pos + length < limit && src[match + length] == src[pos + length])
+                length++;
+
+            if (!writeSequence(out, end, src + anchor, pos - anchor, pos - match, length))
+                return 0;
+            pos += length;
+            anchor = pos;
+        }
+
+        if (!writeSequence(out, end, src + anchor, size - anchor, 0, 0))
+            return 0;
+        return out - dst;
+    }
+
+    bool BlockCompression::decompress(const uint8_t *src, size_t compressedSize, uint8_t *dst, size_t size) {
+        const uint8_t *in = src;
+        const uint8_t *inEnd = src + compressedSize;
+        uint8_t *out = dst;
+        uint8_t *outEnd = dst + size;
+
+        while (in < inEnd) {
+            uint8_t token = *in++;
+            size_t literalCount = token >> 4;
+            if (literalCount == 15 && !readLength(in, inEnd, literalCount))
+                return false;
+            if ((size_t) (inEnd - in) < literalCount || (size_t) (outEnd - out) < literalCount)
+                return false;
+            std::memcpy(out, in, literalCount);
+            in += literalCount;
+            out += literalCount;
+
+            if (in == inEnd)
+                break;
+
+            if (inEnd - in < 2)
+                return false;
+            size_t offset = in[0] | (in[1] << 8);
+            in += 2;
+            size_t matchLength = token & 15;
+            if (matchLength == 15 && !readLength(in, inEnd, matchLength))
+                return false;
+            matchLength += kMinMatch;
+
+            if (offset == 0 || offset > (size_t) (out - dst) || (size_t) (outEnd - out) < matchLength)
+                return false;
+            //matches may overlap their own output so they are copied forwards byte by byte
+            const uint8_t *match = out - offset;
+            for (size_t i = 0; i < matchLength; i++) {
+                out[i] = match[i];
+            }
+            out += matchLength;
+        }
+        return out == outEnd;
+    }
+
+}
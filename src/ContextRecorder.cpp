@@ -0,0 +1,82 @@
+#include "ContextRecorder.h"
+
+namespace SGE {
+
+    ContextRecorder::ContextRecorder(Diligent::IDeviceContext *context, Diligent::IDeviceContext *immediateContext,
+                                     bool deferred) : m_context(context), m_immediateContext(immediateContext),
+                                                      m_deferred(deferred) {
+        m_transitionMode = deferred ? Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY
+                                    : Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+    }
+
+    void ContextRecorder::setFrame(const RecordFrame &frame) {
+        m_frame = frame;
+    }
+
+    void ContextRecorder::begin() {
+        m_pipeline = nullptr;
+        m_vertexBuffer = nullptr;
+        m_indexBuffer = nullptr;
+        if (!m_deferred)
+            return;
+        //deferred contexts start without state, the targets and the default viewport are set again for every list
+        m_context->Begin(0);
+        m_context->SetRenderTargets(1, &m_frame.renderTarget, m_frame.depthStencil, m_transitionMode);
+        m_context->SetViewports(1, nullptr, 0, 0);
+    }
+
+    void ContextRecorder::record(const DrawBatch &batch) {
+        auto found = m_frame.meshes->find(batch.mesh);
+        if (found == m_frame.meshes->end())
+            return;
+        const MeshDrawState &state = found->second;
+
+        if (state.program.shaderPointer != m_pipeline) {
+            m_context->SetPipelineState(state.program.shaderPointer);
+            m_pipeline = state.program.shaderPointer;
+        }
+        m_context->CommitShaderResources(state.program.shaderBinding, m_transitionMode);
+        if (state.vertexBuffer.vertexBuffer != m_vertexBuffer) {
+            Diligent::IBuffer *buffers[] = {state.vertexBuffer.vertexBuffer, m_frame.instanceBuffer};
+            Diligent::Uint64 offsets[] = {0, m_frame.instanceOffset};
+            m_context->SetVertexBuffers(0, 2, buffers, offsets, m_transitionMode,
+                                        Diligent::SET_VERTEX_BUFFERS_FLAG_RESET);
+            m_vertexBuffer = state.vertexBuffer.vertexBuffer;
+        }
+        if (state.indexBuffer.indexBuffer != m_indexBuffer) {
+            m_context->SetIndexBuffer(state.indexBuffer.indexBuffer, 0, m_transitionMode);
+            m_indexBuffer = state.indexBuffer.indexBuffer;
+        }
+
+        Diligent::DrawIndexedAttribs attribs;
+        attribs.IndexType = state.indexBuffer.indexType;
+        attribs.BaseVertex = state.geometry.baseVertex;
+        attribs.FirstIndexLocation = state.geometry.firstIndex;
+        if (batch.lod < state.lods.size()) {
+            attribs.NumIndices = state.lods[batch.lod].indexCount;
+            attribs.FirstIndexLocation += state.lods[batch.lod].firstIndex;
+        } else {
+            attribs.NumIndices = state.geometry.indexCount;
+        }
+        attribs.NumInstances = batch.instanceCount;
+        attribs.FirstInstanceLocation = batch.firstInstance;
+        attribs.Flags = Diligent::DRAW_FLAG_VERIFY_ALL;
+        m_context->DrawIndexed(attribs);
+    }
+
+    void ContextRecorder::end() {
+        if (m_deferred)
+            m_context->FinishCommandList(&m_commandList);
+    }
+
+    void ContextRecorder::submit() {
+        if (!m_deferred || m_commandList == nullptr)
+            return;
+        Diligent::ICommandList *list = m_commandList;
+        m_immediateContext->ExecuteCommandLists(1, &list);
+        //lets the deferred context release the memory of the list once the gpu is done with it
+        m_context->FinishFrame();
+        m_commandList.Release();
+    }
+
+}
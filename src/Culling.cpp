@@ -0,0 +1,182 @@
+#include "Culling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numeric>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define SGE_CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+namespace SGE {
+
+    namespace {
+        //every lane count used below divides this
+        constexpr size_t padding = 8;
+
+        glm::vec4 row(const glm::mat4 &matrix, int index) {
+            return {matrix[0][index], matrix[1][index], matrix[2][index], matrix[3][index]};
+        }
+
+        glm::vec4 normalizePlane(const glm::vec4 &plane) {
+            float length = glm::length(glm::vec3(plane));
+            return length > 0.f ? plane / length : plane;
+        }
+
+        //appends first + i for every set bit i of a lane mask, bits past last are padding
+        inline void appendMask(uint32_t mask, size_t first, size_t last, std::vector<uint32_t> &visible) {
+            while (mask != 0) {
+                uint32_t lane = 0;
+                while ((mask & (1u << lane)) == 0)
+                    lane++;
+                mask &= mask - 1;
+                if (first + lane < last)
+                    visible.push_back((uint32_t) (first + lane));
+            }
+        }
+    }
+
+    void BoxSoA::resize(size_t newCount) {
+        count = newCount;
+        size_t padded = (newCount + padding - 1) / padding * padding;
+        for (auto *array: {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ}) {
+            array->assign(padded, 0.f);
+        }
+    }
+
+    size_t BoxSoA::size() const {
+        return count;
+    }
+
+    void BoxSoA::set(size_t index, const glm::vec3 &center, const glm::vec3 &extent) {
+        centerX[index] = center.x;
+        centerY[index] = center.y;
+        centerZ[index] = center.z;
+        extentX[index] = extent.x;
+        extentY[index] = extent.y;
+        extentZ[index] = extent.z;
+    }
+
+    std::vector<glm::vec4> Culling::sidePlanes(const glm::mat4 &viewProj) {
+        glm::vec4 x = row(viewProj, 0);
+        glm::vec4 y = row(viewProj, 1);
+        glm::vec4 w = row(viewProj, 3);
+        return {normalizePlane(w + x), normalizePlane(w - x), normalizePlane(w + y), normalizePlane(w - y)};
+    }
+
+    std::vector<glm::vec4> Culling::frustumPlanes(const glm::mat4 &viewProj) {
+        //glm's default clip space has z in [-w, w]
+        std::vector<glm::vec4> planes = sidePlanes(viewProj);
+        glm::vec4 z = row(viewProj, 2);
+        glm::vec4 w = row(viewProj, 3);
+        planes.push_back(normalizePlane(w + z));
+        planes.push_back(normalizePlane(w - z));
+        return planes;
+    }
+
+    void Culling::transformBox(const glm::vec3 &min, const glm::vec3 &max, const glm::mat3 &rotationScale,
+                               const glm::vec3 &translation, glm::vec3 &center, glm::vec3 &extent) {
+        glm::vec3 localCenter = (min + max) * 0.5f;
+        glm::vec3 localExtent = (max - min) * 0.5f;
+        center = rotationScale * localCenter + translation;
+        glm::mat3 absolute(glm::abs(rotationScale[0]), glm::abs(rotationScale[1]), glm::abs(rotationScale[2]));
+        extent = absolute * localExtent;
+    }
+
+    void Culling::cull(const BoxSoA &boxes, const std::vector<glm::vec4> &planes, std::vector<uint32_t> &visible) {
+        visible.clear();
+        size_t count = boxes.size();
+        size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+        if (chunkCount <= 1) {
+            cullRange(boxes, planes, 0, count, visible);
+            return;
+        }
+
+        //each chunk fills its own list, concatenating them in chunk order keeps the result sorted
+        std::vector<std::vector<uint32_t>> chunkVisible(chunkCount);
+        std::vector<size_t> chunks(chunkCount);
+        std::iota(chunks.begin(), chunks.end(), 0);
+        std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+            size_t first = chunk * chunkSize;
+            cullRange(boxes, planes, first, std::min(first + chunkSize, count), chunkVisible[chunk]);
+        });
+
+        size_t total = 0;
+        for (const auto &list: chunkVisible) {
+            total += list.size();
+        }
+        visible.reserve(total);
+        for (const auto &list: chunkVisible) {
+            visible.insert(visible.end(), list.begin(), list.end());
+        }
+    }
+
+    void Culling::cullRange(const BoxSoA &boxes, const std::vector<glm::vec4> &planes, size_t first, size_t last,
+                            std::vector<uint32_t> &visible) {
+        //a box is outside a plane when even its corner furthest along the normal is behind it, that corner's distance
+        //is dot(n, center) + dot(|n|, extent) + d
+#if defined(__AVX__)
+        const __m256 zero = _mm256_setzero_ps();
+        for (size_t i = first; i < last; i += 8) {
+            __m256 cx = _mm256_loadu_ps(&boxes.centerX[i]);
+            __m256 cy = _mm256_loadu_ps(&boxes.centerY[i]);
+            __m256 cz = _mm256_loadu_ps(&boxes.centerZ[i]);
+            __m256 ex = _mm256_loadu_ps(&boxes.extentX[i]);
+            __m256 ey = _mm256_loadu_ps(&boxes.extentY[i]);
+            __m256 ez = _mm256_loadu_ps(&boxes.extentZ[i]);
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const auto &plane: planes) {
+                __m256 distance = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)), _mm256_mul_ps(cy, _mm256_set1_ps(plane.y))),
+                        _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+                __m256 radius = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(std::abs(plane.x))),
+                                      _mm256_mul_ps(ey, _mm256_set1_ps(std::abs(plane.y)))),
+                        _mm256_mul_ps(ez, _mm256_set1_ps(std::abs(plane.z))));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+            }
+            appendMask((uint32_t) _mm256_movemask_ps(inside), i, last, visible);
+        }
+#elif defined(SGE_CULLING_SSE)
+        const __m128 zero = _mm_setzero_ps();
+        for (size_t i = first; i < last; i += 4) {
+            __m128 cx = _mm_loadu_ps(&boxes.centerX[i]);
+            __m128 cy = _mm_loadu_ps(&boxes.centerY[i]);
+            __m128 cz = _mm_loadu_ps(&boxes.centerZ[i]);
+            __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+            __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+            __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const auto &plane: planes) {
+                __m128 distance = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y))),
+                        _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+                __m128 radius = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(std::abs(plane.x))), _mm_mul_ps(ey, _mm_set1_ps(std::abs(plane.y)))),
+                        _mm_mul_ps(ez, _mm_set1_ps(std::abs(plane.z))));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+            }
+            appendMask((uint32_t) _mm_movemask_ps(inside), i, last, visible);
+        }
+#else
+        for (size_t i = first; i < last; i++) {
+            bool inside = true;
+            for (size_t p = 0; p < planes.size() && inside; p++) {
+                const glm::vec4 &plane = planes[p];
+                float distance = boxes.centerX[i] * plane.x + boxes.centerY[i] * plane.y + boxes.centerZ[i] * plane.z +
+                                 plane.w;
+                float radius = boxes.extentX[i] * std::abs(plane.x) + boxes.extentY[i] * std::abs(plane.y) +
+                               boxes.extentZ[i] * std::abs(plane.z);
+                inside = distance + radius >= 0.f;
+            }
+            if (inside)
+                visible.push_back((uint32_t) i);
+        }
+#endif
+    }
+
+}
@@ -0,0 +1,139 @@
+#include "DebugDraw.h"
+
+#if SGE_DEBUG_DRAW
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+namespace SGE {
+
+    namespace {
+        //the mutex is only ever contended while collect drains the buffer, recording threads never share one
+        struct ThreadBuffer {
+            std::mutex mutex;
+            std::vector<Vertex> vertices;
+        };
+
+        std::mutex buffersMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+        ThreadBuffer &threadBuffer() {
+            //the list keeps its own reference, so lines recorded just before a thread exits are still drawn
+            thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+                auto created = std::make_shared<ThreadBuffer>();
+                std::lock_guard<std::mutex> lock(buffersMutex);
+                buffers.push_back(created);
+                return created;
+            }();
+            return *buffer;
+        }
+
+        //locks the calling thread's buffer and returns room for count more vertices, nullptr once it is full
+        class Recording {
+        public:
+            explicit Recording(size_t count) : buffer(threadBuffer()), lock(buffer.mutex) {
+                size_t size = buffer.vertices.size();
+                if (size + count <= DebugDraw::maxThreadVertices) {
+                    buffer.vertices.resize(size + count);
+                    out = buffer.vertices.data() + size;
+                }
+            }
+
+            Vertex *vertices() const {
+                return out;
+            }
+
+        private:
+            ThreadBuffer &buffer;
+            std::lock_guard<std::mutex> lock;
+            Vertex *out = nullptr;
+        };
+    }
+
+    void DebugDraw::recordLine(const glm::vec3 &from, const glm::vec3 &to, const glm::vec4 &color) {
+        Recording recording(2);
+        Vertex *out = recording.vertices();
+        if (out == nullptr)
+            return;
+        out[0] = {from, color};
+        out[1] = {to, color};
+    }
+
+    void DebugDraw::recordRect(const glm::vec2 &min, const glm::vec2 &max, const glm::vec4 &color, float z) {
+        glm::vec3 corners[4] = {{min.x, min.y, z}, {max.x, min.y, z}, {max.x, max.y, z}, {min.x, max.y, z}};
+        Recording recording(8);
+        Vertex *out = recording.vertices();
+        if (out == nullptr)
+            return;
+        for (uint32_t i = 0; i < 4; i++) {
+            out[2 * i] = {corners[i], color};
+            out[2 * i + 1] = {corners[(i + 1) % 4], color};
+        }
+    }
+
+    void DebugDraw::recordBox(const glm::vec3 &min, const glm::vec3 &max, const glm::vec4 &color) {
+        //corner i takes x from bit 0, y from bit 1 and z from bit 2, edges join corners one bit apart
+        auto corner = [&](uint32_t i) {
+            return glm::vec3(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+        };
+        Recording recording(24);
+        Vertex *out = recording.vertices();
+        if (out == nullptr)
+            return;
+        for (uint32_t i = 0; i < 8; i++) {
+            for (uint32_t bit = 1; bit < 8; bit <<= 1) {
+                if (i & bit)
+                    continue;
+                *out++ = {corner(i), color};
+                *out++ = {corner(i | bit), color};
+            }
+        }
+    }
+
+    void DebugDraw::recordCircle(const glm::vec3 &center, float radius, const glm::vec4 &color, uint32_t segments) {
+        segments = std::max(segments, 3u);
+        Recording recording(2 * (size_t) segments);
+        Vertex *out = recording.vertices();
+        if (out == nullptr)
+            return;
+        float step = 6.28318530718f / (float) segments;
+        glm::vec3 previous = center + glm::vec3(radius, 0.f, 0.f);
+        for (uint32_t i = 1; i <= segments; i++) {
+            float angle = step * (float) (i % segments);
+            glm::vec3 next = center + glm::vec3(radius * std::cos(angle), radius * std::sin(angle), 0.f);
+            *out++ = {previous, color};
+            *out++ = {next, color};
+            previous = next;
+        }
+    }
+
+    void DebugDraw::recordCross(const glm::vec3 &center, float size, const glm::vec4 &color) {
+        float half = size / 2.f;
+        Recording recording(4);
+        Vertex *out = recording.vertices();
+        if (out == nullptr)
+            return;
+        out[0] = {center - glm::vec3(half, half, 0.f), color};
+        out[1] = {center + glm::vec3(half, half, 0.f), color};
+        out[2] = {center - glm::vec3(half, -half, 0.f), color};
+        out[3] = {center + glm::vec3(half, -half, 0.f), color};
+    }
+
+    void DebugDraw::collectThreads(std::vector<Vertex> &vertices) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto &buffer: buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            vertices.insert(vertices.end(), buffer->vertices.begin(), buffer->vertices.end());
+            buffer->vertices.clear();
+        }
+        //buffers only referenced from here belong to threads that have exited and were just drained
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const std::shared_ptr<ThreadBuffer> &buffer) {
+            return buffer.use_count() == 1;
+        }), buffers.end());
+    }
+
+}
+
+#endif
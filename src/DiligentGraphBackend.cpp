@@ -0,0 +1,90 @@
+#include "DiligentGraphBackend.h"
+
+namespace SGE {
+
+    namespace {
+        Diligent::RESOURCE_STATE toDiligent(ResourceState state) {
+            switch (state) {
+                case ResourceState::RenderTarget:
+                    return Diligent::RESOURCE_STATE_RENDER_TARGET;
+                case ResourceState::DepthWrite:
+                    return Diligent::RESOURCE_STATE_DEPTH_WRITE;
+                case ResourceState::DepthRead:
+                    return Diligent::RESOURCE_STATE_DEPTH_READ;
+                case ResourceState::ShaderResource:
+                    return Diligent::RESOURCE_STATE_SHADER_RESOURCE;
+                case ResourceState::UnorderedAccess:
+                    return Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
+                case ResourceState::CopySource:
+                    return Diligent::RESOURCE_STATE_COPY_SOURCE;
+                case ResourceState::CopyDest:
+                    return Diligent::RESOURCE_STATE_COPY_DEST;
+                case ResourceState::Present:
+                    return Diligent::RESOURCE_STATE_PRESENT;
+                default:
+                    return Diligent::RESOURCE_STATE_UNKNOWN;
+            }
+        }
+    }
+
+    DiligentGraphBackend::DiligentGraphBackend(Diligent::IRenderDevice *device, Diligent::IDeviceContext *context) :
+            m_device(device), m_context(context) {
+    }
+
+    void DiligentGraphBackend::setTexture(uint32_t physical, Diligent::ITexture *texture) {
+        if (physical >= imported.size())
+            imported.resize(physical + 1, nullptr);
+        imported[physical] = texture;
+    }
+
+    Diligent::ITexture *DiligentGraphBackend::getTexture(uint32_t physical) const {
+        if (physical < imported.size() && imported[physical] != nullptr)
+            return imported[physical];
+        return physical < textures.size() ? textures[physical].RawPtr() : nullptr;
+    }
+
+    void DiligentGraphBackend::prepare(const RenderGraph &graph) {
+        const std::vector<TextureInfo> &physical = graph.getPhysicalTextures();
+        textures.resize(physical.size());
+        infos.resize(physical.size());
+        imported.resize(physical.size(), nullptr);
+        for (uint32_t i = 0; i < physical.size(); i++) {
+            if (graph.isImported(i)) {
+                //a transient texture that used to sit at this index is no longer needed
+                textures[i] = nullptr;
+                continue;
+            }
+            imported[i] = nullptr;
+            if (textures[i] && infos[i] == physical[i])
+                continue;
+            Diligent::TextureDesc desc;
+            desc.Name = "Render graph transient";
+            desc.Type = Diligent::RESOURCE_DIM_TEX_2D;
+            desc.Width = physical[i].width;
+            desc.Height = physical[i].height;
+            desc.Format = (Diligent::TEXTURE_FORMAT) physical[i].format;
+            desc.BindFlags = (Diligent::BIND_FLAGS) physical[i].bindFlags;
+            desc.Usage = Diligent::USAGE_DEFAULT;
+            textures[i] = nullptr;
+            m_device->CreateTexture(desc, nullptr, &textures[i]);
+            infos[i] = physical[i];
+        }
+    }
+
+    void DiligentGraphBackend::transition(const RenderGraph &graph, const std::vector<GraphBarrier> &barriers) {
+        transitions.clear();
+        for (const auto &barrier: barriers) {
+            Diligent::ITexture *texture = getTexture(barrier.physical);
+            if (texture == nullptr)
+                continue;
+            transitions.emplace_back(texture, toDiligent(barrier.before), toDiligent(barrier.after),
+                                     Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE);
+            //a texture reused for another resource starts undefined, its old contents are not kept
+            if (barrier.before == ResourceState::Undefined)
+                transitions.back().Flags |= Diligent::STATE_TRANSITION_FLAG_DISCARD_CONTENT;
+        }
+        if (!transitions.empty())
+            m_context->TransitionResourceStates((Diligent::Uint32) transitions.size(), transitions.data());
+    }
+
+}
@@ -0,0 +1,233 @@
+#include "DtParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace SGE {
+
+    namespace {
+        //longest number we accept, anything longer than this is not a float or an index
+        constexpr size_t maxToken = 64;
+
+        inline bool isNumberStart(char c) {
+            return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.';
+        }
+
+        inline bool isNumberChar(char c) {
+            return isNumberStart(c) || c == 'e' || c == 'E';
+        }
+
+        bool parseCount(const std::string &text, uint32_t &out) {
+            size_t begin = text.find_first_not_of(" \t\r\n");
+            if (begin == std::string::npos) {
+                out = 0;
+                return true;
+            }
+            size_t end = text.find_last_not_of(" \t\r\n") + 1;
+            auto result = std::from_chars(text.data() + begin, text.data() + end, out);
+            return result.ec == std::errc() && result.ptr == text.data() + end;
+        }
+    }
+
+    DtParser::DtParser(MeshComponent &mesh, DtHeader &header) : m_mesh(mesh), m_header(header) {
+    }
+
+    bool DtParser::parseFile(const std::string &path, MeshComponent &mesh, DtHeader &header, std::string &error) {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        mesh.vertices.clear();
+        mesh.indices.clear();
+        DtParser parser(mesh, header);
+        if (std::fseek(file, 0, SEEK_END) == 0) {
+            long size = std::ftell(file);
+            parser.fileSize = size > 0 ? (uint64_t) size : 0;
+        }
+        std::rewind(file);
+
+        //a number split by the chunk boundary is moved to the front and finished by the next read
+        std::unique_ptr<char[]> buffer(new char[chunkSize + maxToken]);
+        size_t carry = 0;
+        bool last = false;
+        //a mesh too large to hold is reported like any other broken file, the callers run on worker threads
+        try {
+            while (!last) {
+                size_t read = std::fread(buffer.get() + carry, 1, chunkSize, file);
+                last = read < chunkSize;
+                const char *end = buffer.get() + carry + read;
+                const char *rest = parser.consume(buffer.get(), end, last);
+                if (!parser.error.empty())
+                    break;
+
+                carry = end - rest;
+                if (carry > maxToken) {
+                    parser.error = "Number too long";
+                    break;
+                }
+                std::memmove(buffer.get(), rest, carry);
+            }
+        } catch (std::bad_alloc &) {
+            parser.error = "Out of memory";
+        }
+        std::fclose(file);
+
+        if (parser.error.empty() && (parser.inField || parser.field <= Indices))
+            parser.error = "Unexpected end of file";
+        if (!parser.error.empty()) {
+            error = path + ": " + parser.error;
+            return false;
+        }
+        return true;
+    }
+
+    const char *DtParser::consume(const char *begin, const char *end, bool last) {
+        const char *p = begin;
+        while (p < end) {
+            char c = *p;
+            if (inComment) {
+                if (c == '\n')
+                    inComment = false;
+                p++;
+                continue;
+            }
+
+            if (!inField) {
+                if (c == '[') {
+                    inField = true;
+                    text.clear();
+                    component = 0;
+                } else if (c == '/' && slash) {
+                    inComment = true;
+                }
+                slash = c == '/' && !slash;
+                p++;
+                continue;
+            }
+
+            if (c == ']') {
+                if (!endField())
+                    return p;
+                inField = false;
+                p++;
+                continue;
+            }
+
+            if (field == Vertices || field == Indices || field == Position || field == Rotation) {
+                //braces, commas and whitespace only separate numbers so they are skipped
+                if (isNumberStart(c)) {
+                    const char *tokenEnd = p + 1;
+                    while (tokenEnd < end && isNumberChar(*tokenEnd))
+                        tokenEnd++;
+                    if (tokenEnd == end && !last)
+                        return p;
+                    if (!number(p, tokenEnd))
+                        return p;
+                    p = tokenEnd;
+                } else {
+                    p++;
+                }
+                continue;
+            }
+
+            text.push_back(c);
+            p++;
+        }
+        return p;
+    }
+
+    bool DtParser::number(const char *begin, const char *end) {
+        if (*begin == '+')
+            begin++;
+
+        if (field == Indices) {
+            uint32_t index;
+            auto result = std::from_chars(begin, end, index);
+            if (result.ec != std::errc() || result.ptr != end) {
+                error = "Invalid index " + std::string(begin, end);
+                return false;
+            }
+            m_mesh.indices.push_back(index);
+            return true;
+        }
+
+        float value;
+        auto result = std::from_chars(begin, end, value);
+        if (result.ec != std::errc() || result.ptr != end) {
+            error = "Invalid number " + std::string(begin, end);
+            return false;
+        }
+
+        if (field == Vertices) {
+            components[component++] = value;
+            if (component == 3) {
+                m_mesh.vertices.push_back({glm::vec3(components[0], components[1], components[2]), glm::vec4(0.f)});
+                component = 0;
+            }
+        } else if (component < 3) {
+            components[component++] = value;
+        }
+        return true;
+    }
+
+    bool DtParser::endField() {
+        switch (field) {
+            case Name:
+                m_header.name = text;
+                break;
+            case Model:
+                m_header.model = text == "true";
+                break;
+            case ModelName:
+                m_header.modelName = text;
+                break;
+            case NumVerts:
+                if (!parseCount(text, m_header.numVerts)) {
+                    error = "Invalid vertex count " + text;
+                    return false;
+                }
+                //every vertex takes at least three digits and two separators
+                m_mesh.vertices.reserve((size_t) std::min<uint64_t>(m_header.numVerts, fileSize / 5));
+                break;
+            case NumIndices:
+                if (!parseCount(text, m_header.numIndices)) {
+                    error = "Invalid index count " + text;
+                    return false;
+                }
+                //and every index a digit and a separator
+                m_mesh.indices.reserve((size_t) std::min<uint64_t>(m_header.numIndices, fileSize / 2));
+                break;
+            case Vertices:
+                if (component != 0) {
+                    error = "Vertex list is not a multiple of three";
+                    return false;
+                }
+                break;
+            case VertexShader:
+                m_header.vertexShader = text;
+                break;
+            case FragmentShader:
+                m_header.fragmentShader = text;
+                break;
+            case Position:
+                if (component == 3)
+                    m_header.position = glm::vec3(components[0], components[1], components[2]);
+                break;
+            case Rotation:
+                if (component == 3)
+                    m_header.rotation = glm::vec3(components[0], components[1], components[2]);
+                break;
+            default:
+                break;
+        }
+        field++;
+        return true;
+    }
+
+}
@@ -15,6 +15,7 @@ namespace SGE{
     Engine::~Engine() {
         if (m_deviceClass->m_pImmediateContext)
             m_deviceClass->m_pImmediateContext->Flush();
+        m_graphBackend.reset();
         m_deviceClass->m_pSwapChain = nullptr;
         m_deviceClass->m_pImmediateContext = nullptr;
         m_deviceClass->m_pDevice = nullptr;
@@ -28,6 +29,9 @@ namespace SGE{
         Engine *engine = static_cast<Engine *>(glfwGetWindowUserPointer(window));
         if (m_deviceClass->m_pSwapChain != nullptr)
             m_deviceClass->m_pSwapChain->Resize(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        //systems that depend on the window size pick this up on the next frame, update clears it after that
+        if (engine != nullptr && engine->m_registry.valid(engine->windowEnt))
+            engine->m_registry.get<WindowPtr>(engine->windowEnt).sizeChange = true;
     }
 
     bool Engine::createWindow(int glfwAPIHint) {
@@ -138,7 +142,15 @@ namespace SGE{
                 auto *pFactoryVk = Diligent::GetEngineFactoryVk();
 
                 Diligent::EngineVkCreateInfo EngineCI;
-                pFactoryVk->CreateDeviceAndContextsVk(EngineCI, &m_deviceClass->m_pDevice, &m_deviceClass->m_pImmediateContext);
+                EngineCI.NumDeferredContexts = DeviceClass::deferredContextCount;
+                //the immediate context comes first, followed by the deferred ones
+                std::vector<Diligent::IDeviceContext *> contexts(1 + EngineCI.NumDeferredContexts, nullptr);
+                pFactoryVk->CreateDeviceAndContextsVk(EngineCI, &m_deviceClass->m_pDevice, contexts.data());
+                m_deviceClass->m_pImmediateContext.Attach(contexts[0]);
+                for (size_t i = 1; i < contexts.size(); i++) {
+                    if (contexts[i] != nullptr)
+                        m_deviceClass->m_pDeferredContexts.emplace_back().Attach(contexts[i]);
+                }
                 pFactoryVk->CreateSwapChainVk(m_deviceClass->m_pDevice, m_deviceClass->m_pImmediateContext, desc, Window, &m_deviceClass->m_pSwapChain);
             }
                 break;
@@ -176,6 +188,9 @@ namespace SGE{
         windPtr.m_ImmediateContext = m_deviceClass->m_pImmediateContext;
         windPtr.m_SwapChain = m_deviceClass->m_pSwapChain;
 
+        m_graphBackend = std::make_unique<DiligentGraphBackend>(m_deviceClass->m_pDevice,
+                                                                m_deviceClass->m_pImmediateContext);
+
         startSystems();
         m_manager.runStartUp();
 
@@ -187,18 +202,54 @@ namespace SGE{
         while (!glfwWindowShouldClose(window) && comp.running) {
             glfwPollEvents();
 
+            if (!buildRenderGraph())
+                break;
+            Diligent::ITexture *target = m_deviceClass->m_pSwapChain->GetCurrentBackBufferRTV()->GetTexture();
+            m_graphBackend->setTexture(m_renderGraph.getPhysical(backBuffer), target);
+            m_renderGraph.execute(*m_graphBackend);
+
+            m_deviceClass->m_pImmediateContext->Flush();
+            m_deviceClass->m_pSwapChain->Present();
+            comp.sizeChange = false;
+        }
+    }
+
+    bool Engine::buildRenderGraph() {
+        const Diligent::SwapChainDesc &desc = m_deviceClass->m_pSwapChain->GetDesc();
+        if (backBuffer != RenderGraph::none && desc.Width == graphWidth && desc.Height == graphHeight)
+            return true;
+        graphWidth = desc.Width;
+        graphHeight = desc.Height;
+
+        m_renderGraph.reset();
+        TextureInfo info;
+        info.width = desc.Width;
+        info.height = desc.Height;
+        info.format = desc.ColorBufferFormat;
+        info.bindFlags = Diligent::BIND_RENDER_TARGET;
+        backBuffer = m_renderGraph.importTexture("Back buffer", info, ResourceState::Undefined,
+                                                 ResourceState::Present);
+
+        //the systems still draw straight into the back buffer, further passes hang off the graph from here
+        m_renderGraph.addPass("Scene", [this](RenderGraph::PassBuilder &builder) {
+            builder.write(backBuffer, ResourceState::RenderTarget);
+        }, [this]() {
             Diligent::ITextureView *pRTV = m_deviceClass->m_pSwapChain->GetCurrentBackBufferRTV();
             m_deviceClass->m_pImmediateContext->SetRenderTargets(1, &pRTV, nullptr,
-                                                               Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                                                               Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY);
 
             const float clearColor[4] = {};
             m_deviceClass->m_pImmediateContext->ClearRenderTarget(pRTV, clearColor, Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY);
 
             m_manager.runSystems();
+        });
 
-            m_deviceClass->m_pImmediateContext->Flush();
-            m_deviceClass->m_pSwapChain->Present();
+        std::string error;
+        if (!m_renderGraph.compile(error)) {
+            boxer::show(("Render graph failed to compile: " + error).c_str(), "Error");
+            return false;
         }
+        return true;
     }
 
     void Engine::startSystems() {
@@ -227,6 +278,18 @@ namespace SGE{
                 m_registry.emplace<WindowPtr>(entity) = sub["WindowPtr"].as<WindowPtr>();
             if (sub["UIComponent"])
                 m_registry.emplace<UIComponent>(entity) = sub["UIComponent"].as<UIComponent>();
+            if (sub["StreamedMesh"])
+                m_registry.emplace<StreamedMesh>(entity) = sub["StreamedMesh"].as<StreamedMesh>();
+            if (sub["TextComponent"])
+                m_registry.emplace<TextComponent>(entity) = sub["TextComponent"].as<TextComponent>();
+            if (sub["ParticleEmitter"])
+                m_registry.emplace<ParticleEmitter>(entity) = sub["ParticleEmitter"].as<ParticleEmitter>();
+            if (sub["NavAgent"])
+                m_registry.emplace<NavAgent>(entity) = sub["NavAgent"].as<NavAgent>();
+            if (sub["Boid"])
+                m_registry.emplace<Boid>(entity) = sub["Boid"].as<Boid>();
+            if (sub["Animator"])
+                m_registry.emplace<Animator>(entity) = sub["Animator"].as<Animator>();
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "FileWatcher.h"
+
+#if PLATFORM_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace SGE {
+
+    namespace fs = std::filesystem;
+
+    FileWatcher::FileWatcher(std::chrono::milliseconds debounce) : m_debounce(debounce) {
+#if PLATFORM_LINUX
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    FileWatcher::~FileWatcher() {
+#if PLATFORM_LINUX
+        if (m_fd >= 0)
+            close(m_fd);
+#endif
+    }
+
+    bool FileWatcher::watch(const std::string &directory) {
+        std::error_code ec;
+        if (!fs::is_directory(directory, ec))
+            return false;
+#if PLATFORM_LINUX
+        if (m_fd < 0)
+            return false;
+#else
+        m_roots.emplace_back(directory);
+#endif
+        addDirectory(directory);
+        return true;
+    }
+
+    void FileWatcher::addDirectory(const fs::path &directory) {
+        std::error_code ec;
+#if PLATFORM_LINUX
+        //close write and moved to cover both editors that write in place and ones that save through a rename
+        uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+        int watch = inotify_add_watch(m_fd, directory.string().c_str(), mask);
+        if (watch >= 0)
+            m_watches[watch] = directory;
+        for (const auto &entry: fs::directory_iterator(directory, ec)) {
+            if (entry.is_directory(ec))
+                addDirectory(entry.path());
+        }
+#else
+        //files already present are recorded without being reported
+        for (const auto &entry: fs::recursive_directory_iterator(directory, ec)) {
+            if (entry.is_regular_file(ec))
+                m_times[entry.path().generic_string()] = entry.last_write_time(ec);
+        }
+#endif
+    }
+
+    void FileWatcher::poll(std::vector<std::string> &changed) {
+        auto now = Clock::now();
+        scan(now);
+
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            if (now - it->second >= m_debounce) {
+                changed.push_back(it->first);
+                it = m_pending.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+
+#if PLATFORM_LINUX
+    void FileWatcher::scan(Clock::time_point now) {
+        if (m_fd < 0)
+            return;
+
+        alignas(inotify_event) char buffer[16 * 1024];
+        while (true) {
+            ssize_t length = read(m_fd, buffer, sizeof(buffer));
+            if (length <= 0)
+                break;
+
+            for (ssize_t offset = 0; offset < length;) {
+                auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                auto watch = m_watches.find(event->wd);
+                if ((event->mask & IN_IGNORED) != 0) {
+                    if (watch != m_watches.end())
+                        m_watches.erase(watch);
+                    continue;
+                }
+                if (watch == m_watches.end() || event->len == 0)
+                    continue;
+
+                fs::path path = watch->second / event->name;
+                if ((event->mask & IN_ISDIR) != 0) {
+                    if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+                        addDirectory(path);
+                    continue;
+                }
+                //a plain create is followed by a close write once the content is there
+                if ((event->mask & IN_CREATE) != 0)
+                    continue;
+                m_pending[path.generic_string()] = now;
+            }
+        }
+    }
+#else
+    void FileWatcher::scan(Clock::time_point now) {
+        if (now - m_lastScan < m_debounce)
+            return;
+        m_lastScan = now;
+
+        std::error_code ec;
+        std::unordered_map<std::string, fs::file_time_type> times;
+        for (const auto &root: m_roots) {
+            for (const auto &entry: fs::recursive_directory_iterator(root, ec)) {
+                if (!entry.is_regular_file(ec))
+                    continue;
+                std::string path = entry.path().generic_string();
+                auto time = entry.last_write_time(ec);
+                auto previous = m_times.find(path);
+                if (previous == m_times.end() || previous->second != time)
+                    m_pending[path] = now;
+                times[path] = time;
+            }
+        }
+        for (const auto &[path, time]: m_times) {
+            if (times.find(path) == times.end())
+                m_pending[path] = now;
+        }
+        m_times.swap(times);
+    }
+#endif
+
+}
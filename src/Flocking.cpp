@@ -0,0 +1,395 @@
+#include "Flocking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numeric>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define SGE_FLOCKING_SSE
+#include <emmintrin.h>
+#endif
+
+namespace SGE {
+
+    namespace {
+        //runs task on [first, last) ranges of at most chunk covering [0, count), in parallel when there are several
+        template<typename Task>
+        void forEachChunk(size_t count, size_t chunk, const Task &task) {
+            size_t chunkCount = (count + chunk - 1) / chunk;
+            if (chunkCount <= 1) {
+                task(0, count);
+                return;
+            }
+            std::vector<size_t> chunks(chunkCount);
+            std::iota(chunks.begin(), chunks.end(), 0);
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t index) {
+                size_t first = index * chunk;
+                task(first, std::min(first + chunk, count));
+            });
+        }
+
+        //coordinates past this are clamped, far enough out that nothing playable shares a cell by accident
+        constexpr float maxCell = 1 << 30;
+
+        int32_t cellCoordinate(float position, float cellSize) {
+            return (int32_t) std::clamp(std::floor(position / cellSize), -maxCell, maxCell);
+        }
+
+        //every lane count used below divides this
+        constexpr size_t padding = 8;
+
+        //far enough that a padding boid is never a neighbour, near enough that its squared distance stays finite
+        constexpr float nowhere = 1e18f;
+
+        //sums over every boid of the neighbourhood within radius of (x, y) except itself: how many there are, their
+        //positions and velocities, and the separation push of the ones within separationRadius. Boids are counted or
+        //not by masks rather than branches, whether one counts is a coin toss for the branch predictor.
+        struct Sums {
+            float neighbours = 0.f, x = 0.f, y = 0.f, velocityX = 0.f, velocityY = 0.f, awayX = 0.f, awayY = 0.f;
+        };
+
+        Sums accumulate(const float *boidX, const float *boidY, const float *boidVelocityX, const float *boidVelocityY,
+                        size_t count, float x, float y, float radius, float separationRadius) {
+            Sums sums;
+#if defined(__AVX__)
+            const __m256 selfX = _mm256_set1_ps(x), selfY = _mm256_set1_ps(y);
+            const __m256 near = _mm256_set1_ps(radius), close = _mm256_set1_ps(separationRadius);
+            const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.f);
+            __m256 neighbours = zero, sumX = zero, sumY = zero, headingX = zero, headingY = zero;
+            __m256 awayX = zero, awayY = zero;
+            for (size_t i = 0; i < count; i += 8) {
+                __m256 otherX = _mm256_loadu_ps(boidX + i), otherY = _mm256_loadu_ps(boidY + i);
+                __m256 dx = _mm256_sub_ps(otherX, selfX), dy = _mm256_sub_ps(otherY, selfY);
+                __m256 distance = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+                __m256 apart = _mm256_cmp_ps(distance, zero, _CMP_GT_OQ);
+                __m256 counted = _mm256_and_ps(apart, _mm256_cmp_ps(distance, near, _CMP_LT_OQ));
+                __m256 push = _mm256_and_ps(_mm256_and_ps(apart, _mm256_cmp_ps(distance, close, _CMP_LT_OQ)),
+                                            _mm256_div_ps(one, distance));
+                neighbours = _mm256_add_ps(neighbours, _mm256_and_ps(counted, one));
+                sumX = _mm256_add_ps(sumX, _mm256_and_ps(counted, otherX));
+                sumY = _mm256_add_ps(sumY, _mm256_and_ps(counted, otherY));
+                headingX = _mm256_add_ps(headingX, _mm256_and_ps(counted, _mm256_loadu_ps(boidVelocityX + i)));
+                headingY = _mm256_add_ps(headingY, _mm256_and_ps(counted, _mm256_loadu_ps(boidVelocityY + i)));
+                awayX = _mm256_sub_ps(awayX, _mm256_mul_ps(dx, push));
+                awayY = _mm256_sub_ps(awayY, _mm256_mul_ps(dy, push));
+            }
+            float lanes[7][8];
+            for (auto [lane, total]: {std::pair{neighbours, &sums.neighbours}, {sumX, &sums.x}, {sumY, &sums.y},
+                                      {headingX, &sums.velocityX}, {headingY, &sums.velocityY},
+                                      {awayX, &sums.awayX}, {awayY, &sums.awayY}}) {
+                _mm256_storeu_ps(lanes[0], lane);
+                for (float value: lanes[0]) {
+                    *total += value;
+                }
+            }
+#elif defined(SGE_FLOCKING_SSE)
+            const __m128 selfX = _mm_set1_ps(x), selfY = _mm_set1_ps(y);
+            const __m128 near = _mm_set1_ps(radius), close = _mm_set1_ps(separationRadius);
+            const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+            __m128 neighbours = zero, sumX = zero, sumY = zero, headingX = zero, headingY = zero;
+            __m128 awayX = zero, awayY = zero;
+            for (size_t i = 0; i < count; i += 4) {
+                __m128 otherX = _mm_loadu_ps(boidX + i), otherY = _mm_loadu_ps(boidY + i);
+                __m128 dx = _mm_sub_ps(otherX, selfX), dy = _mm_sub_ps(otherY, selfY);
+                __m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+                __m128 apart = _mm_cmpgt_ps(distance, zero);
+                __m128 counted = _mm_and_ps(apart, _mm_cmplt_ps(distance, near));
+                __m128 push = _mm_and_ps(_mm_and_ps(apart, _mm_cmplt_ps(distance, close)), _mm_div_ps(one, distance));
+                neighbours = _mm_add_ps(neighbours, _mm_and_ps(counted, one));
+                sumX = _mm_add_ps(sumX, _mm_and_ps(counted, otherX));
+                sumY = _mm_add_ps(sumY, _mm_and_ps(counted, otherY));
+                headingX = _mm_add_ps(headingX, _mm_and_ps(counted, _mm_loadu_ps(boidVelocityX + i)));
+                headingY = _mm_add_ps(headingY, _mm_and_ps(counted, _mm_loadu_ps(boidVelocityY + i)));
+                awayX = _mm_sub_ps(awayX, _mm_mul_ps(dx, push));
+                awayY = _mm_sub_ps(awayY, _mm_mul_ps(dy, push));
+            }
+            float lanes[4];
+            for (auto [lane, total]: {std::pair{neighbours, &sums.neighbours}, {sumX, &sums.x}, {sumY, &sums.y},
+                                      {headingX, &sums.velocityX}, {headingY, &sums.velocityY},
+                                      {awayX, &sums.awayX}, {awayY, &sums.awayY}}) {
+                _mm_storeu_ps(lanes, lane);
+                *total += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            }
+#else
+            for (size_t i = 0; i < count; i++) {
+                float dx = boidX[i] - x, dy = boidY[i] - y;
+                float distance = dx * dx + dy * dy;
+                if (distance >= radius || distance <= 0.f)
+                    continue;
+                sums.neighbours += 1.f;
+                sums.x += boidX[i];
+                sums.y += boidY[i];
+                sums.velocityX += boidVelocityX[i];
+                sums.velocityY += boidVelocityY[i];
+                if (distance < separationRadius) {
+                    sums.awayX -= dx / distance;
+                    sums.awayY -= dy / distance;
+                }
+            }
+#endif
+            return sums;
+        }
+
+        //the change of velocity towards heading along direction at maxSpeed, no longer than maxForce
+        void steerTowards(float directionX, float directionY, float velocityX, float velocityY, const Boid &limits,
+                          float &outX, float &outY) {
+            float length = std::sqrt(directionX * directionX + directionY * directionY);
+            if (length <= 0.f) {
+                outX = outY = 0.f;
+                return;
+            }
+            outX = directionX / length * limits.maxSpeed - velocityX;
+            outY = directionY / length * limits.maxSpeed - velocityY;
+            float force = std::sqrt(outX * outX + outY * outY);
+            if (force > limits.maxForce) {
+                outX *= limits.maxForce / force;
+                outY *= limits.maxForce / force;
+            }
+        }
+    }
+
+    void SpatialHash::build(const glm::vec2 *positions, uint32_t count, float size) {
+        cellSize = size;
+        //a power of two at least the point count keeps buckets short without clearing a large table every frame
+        size_t buckets = 1024;
+        while (buckets < count)
+            buckets *= 2;
+        columnBits = 0;
+        while ((size_t) 1 << (2 * columnBits) < buckets)
+            columnBits++;
+        rowMask = (uint32_t) (buckets >> columnBits) - 1;
+        if (cursorCount != buckets) {
+            cursors = std::make_unique<std::atomic<uint32_t>[]>(buckets);
+            cursorCount = buckets;
+        }
+        for (size_t bucket = 0; bucket < buckets; bucket++) {
+            cursors[bucket].store(0, std::memory_order_relaxed);
+        }
+        pointCells.resize(count);
+        pointBuckets.resize(count);
+        order.resize(count);
+
+        //counting sort by bucket: count, prefix sum, scatter
+        forEachChunk(count, chunkSize, [&](size_t first, size_t last) {
+            for (size_t point = first; point < last; point++) {
+                glm::ivec2 cell(cellCoordinate(positions[point].x, cellSize),
+                                cellCoordinate(positions[point].y, cellSize));
+                pointCells[point] = cell;
+                pointBuckets[point] = bucketOf(cell.x, cell.y);
+                cursors[pointBuckets[point]].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        bucketStart.resize(buckets + 1);
+        uint32_t start = 0;
+        for (size_t bucket = 0; bucket < buckets; bucket++) {
+            bucketStart[bucket] = start;
+            start += cursors[bucket].load(std::memory_order_relaxed);
+            cursors[bucket].store(bucketStart[bucket], std::memory_order_relaxed);
+        }
+        bucketStart[buckets] = start;
+        forEachChunk(count, chunkSize, [&](size_t first, size_t last) {
+            for (size_t point = first; point < last; point++) {
+                order[cursors[pointBuckets[point]].fetch_add(1, std::memory_order_relaxed)] = (uint32_t) point;
+            }
+        });
+
+        //the scatter leaves a bucket in whatever order the threads got there, sorting it by cell and index groups
+        //the cells sharing the bucket and makes the order the same every run
+        forEachChunk(buckets, chunkSize, [&](size_t first, size_t last) {
+            for (size_t bucket = first; bucket < last; bucket++) {
+                auto begin = order.begin() + bucketStart[bucket], end = order.begin() + bucketStart[bucket + 1];
+                if (end - begin < 2)
+                    continue;
+                std::sort(begin, end, [this](uint32_t a, uint32_t b) {
+                    const glm::ivec2 &cellA = pointCells[a], &cellB = pointCells[b];
+                    if (cellA.y != cellB.y)
+                        return cellA.y < cellB.y;
+                    if (cellA.x != cellB.x)
+                        return cellA.x < cellB.x;
+                    return a < b;
+                });
+            }
+        });
+
+        cells.clear();
+        bucketCells.resize(buckets + 1);
+        for (size_t bucket = 0; bucket < buckets; bucket++) {
+            bucketCells[bucket] = (uint32_t) cells.size();
+            for (uint32_t slot = bucketStart[bucket]; slot < bucketStart[bucket + 1]; slot++) {
+                const glm::ivec2 &cell = pointCells[order[slot]];
+                if (slot == bucketStart[bucket] || cell.x != cells.back().x || cell.y != cells.back().y)
+                    cells.push_back({cell.x, cell.y, slot, slot});
+                cells.back().last = slot + 1;
+            }
+        }
+        bucketCells[buckets] = (uint32_t) cells.size();
+    }
+
+    const std::vector<uint32_t> &SpatialHash::getOrder() const {
+        return order;
+    }
+
+    const std::vector<SpatialHash::Cell> &SpatialHash::getCells() const {
+        return cells;
+    }
+
+    const SpatialHash::Cell *SpatialHash::find(int32_t x, int32_t y) const {
+        if (bucketCells.empty())
+            return nullptr;
+        uint32_t bucket = bucketOf(x, y);
+        for (uint32_t cell = bucketCells[bucket]; cell < bucketCells[bucket + 1]; cell++) {
+            if (cells[cell].x == x && cells[cell].y == y)
+                return &cells[cell];
+        }
+        return nullptr;
+    }
+
+    uint32_t SpatialHash::findRow(int32_t x, int32_t y, uint32_t (&ranges)[3][2]) const {
+        if (bucketStart.empty())
+            return 0;
+        uint32_t left = bucketOf(x - 1, y), right = bucketOf(x + 1, y);
+        if (right == left + 2) {
+            ranges[0][0] = bucketStart[left];
+            ranges[0][1] = bucketStart[right + 1];
+            return 1;
+        }
+        for (int32_t column = 0; column < 3; column++) {
+            uint32_t bucket = bucketOf(x - 1 + column, y);
+            ranges[column][0] = bucketStart[bucket];
+            ranges[column][1] = bucketStart[bucket + 1];
+        }
+        return 3;
+    }
+
+    float SpatialHash::getCellSize() const {
+        return cellSize;
+    }
+
+    uint32_t SpatialHash::bucketOf(int32_t x, int32_t y) const {
+        return ((uint32_t) y & rowMask) << columnBits | ((uint32_t) x & ((1u << columnBits) - 1));
+    }
+
+    void Flock::resize(uint32_t count) {
+        positions.resize(count);
+        velocities.resize(count);
+        limits.resize(count);
+        accelerations.assign(count, glm::vec2(0.f));
+    }
+
+    void Flock::set(uint32_t boid, const glm::vec2 &position, const glm::vec2 &velocity, const Boid &boidLimits) {
+        positions[boid] = position;
+        velocities[boid] = velocity;
+        limits[boid] = boidLimits;
+    }
+
+    void Flock::steer(const FlockSettings &settings) {
+        hash.build(positions.data(), size(), std::max(settings.radius, 1e-3f));
+        const std::vector<uint32_t> &order = hash.getOrder();
+        for (auto *array: {&sortedX, &sortedY, &sortedVelocityX, &sortedVelocityY}) {
+            array->resize(order.size());
+        }
+        forEachChunk(order.size(), SpatialHash::chunkSize, [&](size_t first, size_t last) {
+            for (size_t slot = first; slot < last; slot++) {
+                sortedX[slot] = positions[order[slot]].x;
+                sortedY[slot] = positions[order[slot]].y;
+                sortedVelocityX[slot] = velocities[order[slot]].x;
+                sortedVelocityY[slot] = velocities[order[slot]].y;
+            }
+        });
+        const std::vector<SpatialHash::Cell> &cells = hash.getCells();
+        forEachChunk(cells.size(), cellChunk, [&](size_t first, size_t last) {
+            Neighbourhood neighbourhood;
+            for (size_t cell = first; cell < last; cell++) {
+                steerCell(cells[cell], settings, neighbourhood);
+            }
+        });
+    }
+
+    uint32_t Flock::size() const {
+        return (uint32_t) positions.size();
+    }
+
+    const glm::vec2 &Flock::getAcceleration(uint32_t boid) const {
+        return accelerations[boid];
+    }
+
+    const SpatialHash &Flock::getHash() const {
+        return hash;
+    }
+
+    void Flock::steerCell(const SpatialHash::Cell &cell, const FlockSettings &settings,
+                          Neighbourhood &neighbourhood) {
+        //the cell is as large as the radius, so every neighbour of its boids is in one of the nine around it. They
+        //are gathered once a row at a time and tested by every boid of the cell, itself included, which is never its
+        //own neighbour.
+        uint32_t ranges[9][2];
+        uint32_t rangeCount = 0;
+        size_t gathered = 0;
+        for (int32_t y = -1; y <= 1; y++) {
+            uint32_t row[3][2];
+            uint32_t rowCount = hash.findRow(cell.x, cell.y + y, row);
+            for (uint32_t range = 0; range < rowCount; range++) {
+                if (row[range][0] == row[range][1])
+                    continue;
+                ranges[rangeCount][0] = row[range][0];
+                ranges[rangeCount++][1] = row[range][1];
+                gathered += row[range][1] - row[range][0];
+            }
+        }
+        size_t count = (gathered + padding - 1) / padding * padding;
+        for (auto *array: {&neighbourhood.x, &neighbourhood.y, &neighbourhood.velocityX, &neighbourhood.velocityY}) {
+            if (array->size() < count)
+                array->resize(count);
+        }
+        size_t offset = 0;
+        for (uint32_t range = 0; range < rangeCount; range++) {
+            uint32_t first = ranges[range][0], last = ranges[range][1];
+            std::copy(sortedX.begin() + first, sortedX.begin() + last, neighbourhood.x.begin() + offset);
+            std::copy(sortedY.begin() + first, sortedY.begin() + last, neighbourhood.y.begin() + offset);
+            std::copy(sortedVelocityX.begin() + first, sortedVelocityX.begin() + last,
+                      neighbourhood.velocityX.begin() + offset);
+            std::copy(sortedVelocityY.begin() + first, sortedVelocityY.begin() + last,
+                      neighbourhood.velocityY.begin() + offset);
+            offset += last - first;
+        }
+        std::fill(neighbourhood.x.begin() + offset, neighbourhood.x.begin() + count, nowhere);
+        std::fill(neighbourhood.y.begin() + offset, neighbourhood.y.begin() + count, nowhere);
+        std::fill(neighbourhood.velocityX.begin() + offset, neighbourhood.velocityX.begin() + count, 0.f);
+        std::fill(neighbourhood.velocityY.begin() + offset, neighbourhood.velocityY.begin() + count, 0.f);
+
+        float radius = settings.radius * settings.radius;
+        float separationRadius = settings.separationRadius * settings.separationRadius;
+        const std::vector<uint32_t> &order = hash.getOrder();
+        for (uint32_t self = cell.first; self < cell.last; self++) {
+            float x = sortedX[self], y = sortedY[self];
+            float velocityX = sortedVelocityX[self], velocityY = sortedVelocityY[self];
+            Sums sums = accumulate(neighbourhood.x.data(), neighbourhood.y.data(), neighbourhood.velocityX.data(),
+                                   neighbourhood.velocityY.data(), count, x, y, radius, separationRadius);
+
+            uint32_t boid = order[self];
+            const Boid &boidLimits = limits[boid];
+            glm::vec2 acceleration(0.f);
+            if (sums.neighbours > 0.f) {
+                float forceX, forceY;
+                steerTowards(sums.awayX, sums.awayY, velocityX, velocityY, boidLimits, forceX, forceY);
+                acceleration.x += forceX * settings.separation;
+                acceleration.y += forceY * settings.separation;
+                steerTowards(sums.velocityX, sums.velocityY, velocityX, velocityY, boidLimits, forceX, forceY);
+                acceleration.x += forceX * settings.alignment;
+                acceleration.y += forceY * settings.alignment;
+                steerTowards(sums.x / sums.neighbours - x, sums.y / sums.neighbours - y, velocityX, velocityY,
+                             boidLimits, forceX, forceY);
+                acceleration.x += forceX * settings.cohesion;
+                acceleration.y += forceY * settings.cohesion;
+                float force = std::sqrt(acceleration.x * acceleration.x + acceleration.y * acceleration.y);
+                if (force > boidLimits.maxForce)
+                    acceleration *= boidLimits.maxForce / force;
+            }
+            accelerations[boid] = acceleration;
+        }
+    }
+
+}
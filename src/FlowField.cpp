@@ -0,0 +1,355 @@
+#include "FlowField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <functional>
+
+namespace SGE {
+
+    namespace {
+        //the eight neighbours, straight ones first
+        constexpr int stepX[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+        constexpr int stepY[8] = {0, 0, 1, -1, 1, 1, -1, -1};
+        constexpr uint32_t straightCost = 10;
+        constexpr uint32_t diagonalCost = 14;
+        constexpr uint8_t unknownFlow = 0xFF;
+        constexpr uint8_t goalFlow = 8;
+        //how many cells are settled between checks whether the required ones are done
+        constexpr uint32_t checkInterval = 4096;
+
+        inline uint32_t pack(uint32_t x, uint32_t y) {
+            return y << 16 | x;
+        }
+
+        inline uint32_t local(uint32_t x, uint32_t y) {
+            return (y % NavGrid::sectorSize) * NavGrid::sectorSize + x % NavGrid::sectorSize;
+        }
+    }
+
+    NavGrid::NavGrid(uint32_t width, uint32_t height, float cellSize, const glm::vec2 &origin) :
+            width(std::min(width, maxSize)), height(std::min(height, maxSize)), cellSize(cellSize), origin(origin) {
+        sectorsX = (this->width + sectorSize - 1) / sectorSize;
+        sectorsY = (this->height + sectorSize - 1) / sectorSize;
+        costs.assign((size_t) this->width * this->height, 1);
+        sectorChanged.assign((size_t) sectorsX * sectorsY, 0);
+    }
+
+    uint32_t NavGrid::getWidth() const {
+        return width;
+    }
+
+    uint32_t NavGrid::getHeight() const {
+        return height;
+    }
+
+    uint8_t NavGrid::getCost(uint32_t x, uint32_t y) const {
+        if (x >= width || y >= height)
+            return blocked;
+        return costs[(size_t) y * width + x];
+    }
+
+    void NavGrid::setCost(uint32_t x, uint32_t y, uint8_t cost) {
+        if (x >= width || y >= height)
+            return;
+        cost = std::max<uint8_t>(cost, 1);
+        uint8_t &slot = costs[(size_t) y * width + x];
+        if (slot == cost)
+            return;
+        slot = cost;
+        uint32_t sector = (y / sectorSize) * sectorsX + x / sectorSize;
+        if (!sectorChanged[sector]) {
+            sectorChanged[sector] = 1;
+            changed.push_back(sector);
+        }
+    }
+
+    void NavGrid::takeChangedSectors(std::vector<uint32_t> &sectors) {
+        sectors.swap(changed);
+        changed.clear();
+        for (uint32_t sector: sectors) {
+            sectorChanged[sector] = 0;
+        }
+    }
+
+    uint32_t NavGrid::getSectorsX() const {
+        return sectorsX;
+    }
+
+    uint32_t NavGrid::getSectorsY() const {
+        return sectorsY;
+    }
+
+    bool NavGrid::cellAt(const glm::vec2 &position, uint32_t &x, uint32_t &y) const {
+        float cellX = std::floor((position.x - origin.x) / cellSize);
+        float cellY = std::floor((position.y - origin.y) / cellSize);
+        if (cellX < 0.f || cellY < 0.f || cellX >= (float) width || cellY >= (float) height)
+            return false;
+        x = (uint32_t) cellX;
+        y = (uint32_t) cellY;
+        return true;
+    }
+
+    glm::vec2 NavGrid::getCellCenter(uint32_t x, uint32_t y) const {
+        return origin + glm::vec2(((float) x + 0.5f) * cellSize, ((float) y + 0.5f) * cellSize);
+    }
+
+    FlowField::FlowField(const NavGrid *grid, uint32_t goalX, uint32_t goalY) : grid(grid), goalX(goalX),
+                                                                                goalY(goalY) {
+        sectors.resize((size_t) grid->getSectorsX() * grid->getSectorsY());
+        if (grid->getCost(goalX, goalY) != NavGrid::blocked)
+            push(0, goalX, goalY);
+    }
+
+    void FlowField::require(uint32_t x, uint32_t y) {
+        if (grid->getCost(x, y) != NavGrid::blocked && !isSettled(x, y))
+            required.push_back(pack(x, y));
+    }
+
+    uint32_t FlowField::expand(uint32_t budget) {
+        uint32_t settled = 0, untilCheck = 0;
+        while (!required.empty() && !open.empty() && settled < budget) {
+            if (untilCheck-- == 0) {
+                untilCheck = checkInterval;
+                required.erase(std::remove_if(required.begin(), required.end(), [this](uint32_t cell) {
+                    return isSettled(cell & 0xFFFF, cell >> 16);
+                }), required.end());
+                if (required.empty())
+                    break;
+            }
+            std::pop_heap(open.begin(), open.end(), std::greater<>());
+            uint64_t entry = open.back();
+            open.pop_back();
+            auto value = (uint32_t) (entry >> 32);
+            uint32_t x = (uint32_t) entry & 0xFFFF, y = (uint32_t) entry >> 16 & 0xFFFF;
+            Sector &sector = touch(x, y);
+            if (value != sector.integration[local(x, y)])
+                continue;
+            settled++;
+            //only a repair pops a cell twice, and when its value dropped the cells above it may have a new way down
+            bool resettled = sector.flow[local(x, y)] != unknownFlow;
+
+            //every neighbour with a lower value has been popped already, so the cheapest one is known now.
+            //Relaxing only lowers values above this one and cannot change the choice.
+            uint8_t costs[8];
+            for (int direction = 0; direction < 8; direction++) {
+                costs[direction] = grid->getCost(x + stepX[direction], y + stepY[direction]);
+            }
+            uint8_t flow = goalFlow;
+            uint32_t lowest = value;
+            for (int direction = 0; direction < 8; direction++) {
+                if (!passable(costs, direction))
+                    continue;
+                uint32_t nx = x + stepX[direction], ny = y + stepY[direction];
+                uint32_t neighbour = getValue(nx, ny);
+                if (neighbour < lowest) {
+                    flow = (uint8_t) direction;
+                    lowest = neighbour;
+                }
+                uint32_t next = value + costs[direction] * (direction >= 4 ? diagonalCost : straightCost);
+                if (next < neighbour)
+                    push(next, nx, ny);
+                else if (resettled && neighbour != unvisited && neighbour > value && isSettled(nx, ny))
+                    touch(nx, ny).flow[local(nx, ny)] = lowestNeighbour(nx, ny);
+            }
+            sector.flow[local(x, y)] = flow;
+        }
+        //nothing left to search, whatever is still required cannot reach the goal
+        if (open.empty())
+            required.clear();
+        return settled;
+    }
+
+    void FlowField::invalidate(const std::vector<uint32_t> &changedSectors) {
+        //every cell in or next to the changed sectors is dropped, then every cell whose cheapest path may lead
+        //through a dropped one, found by following the edges that cost exactly the difference of the values at
+        //their ends. The cells left still reach the goal at their old cost along paths nothing changed on.
+        std::vector<std::pair<uint32_t, uint32_t>> dropped;
+        auto drop = [&](uint32_t x, uint32_t y) {
+            uint32_t value = getValue(x, y);
+            if (value == unvisited)
+                return;
+            Sector &sector = touch(x, y);
+            sector.integration[local(x, y)] = unvisited;
+            sector.flow[local(x, y)] = unknownFlow;
+            dropped.emplace_back(pack(x, y), value);
+        };
+        for (uint32_t sector: changedSectors) {
+            uint32_t x0 = sector % grid->getSectorsX() * NavGrid::sectorSize;
+            uint32_t y0 = sector / grid->getSectorsX() * NavGrid::sectorSize;
+            uint32_t x1 = std::min(x0 + NavGrid::sectorSize + 1, grid->getWidth());
+            uint32_t y1 = std::min(y0 + NavGrid::sectorSize + 1, grid->getHeight());
+            for (uint32_t y = y0 > 0 ? y0 - 1 : 0; y < y1; y++) {
+                for (uint32_t x = x0 > 0 ? x0 - 1 : 0; x < x1; x++) {
+                    drop(x, y);
+                }
+            }
+        }
+
+        //the search is repaired from the kept cells around the dropped ones, cheaper ways through the changed
+        //sectors lower kept cells as well when it reaches them
+        std::vector<uint32_t> border;
+        while (!dropped.empty()) {
+            auto [cell, value] = dropped.back();
+            dropped.pop_back();
+            uint32_t x = cell & 0xFFFF, y = cell >> 16;
+            uint8_t costs[8];
+            for (int direction = 0; direction < 8; direction++) {
+                costs[direction] = grid->getCost(x + stepX[direction], y + stepY[direction]);
+            }
+            for (int direction = 0; direction < 8; direction++) {
+                uint32_t nx = x + stepX[direction], ny = y + stepY[direction];
+                uint32_t neighbour = getValue(nx, ny);
+                if (neighbour == unvisited || !passable(costs, direction))
+                    continue;
+                if (neighbour == value + costs[direction] * (direction >= 4 ? diagonalCost : straightCost))
+                    drop(nx, ny);
+                else
+                    border.push_back(pack(nx, ny));
+            }
+        }
+        for (uint32_t cell: border) {
+            uint32_t value = getValue(cell & 0xFFFF, cell >> 16);
+            if (value != unvisited)
+                push(value, cell & 0xFFFF, cell >> 16);
+        }
+        if (getValue(goalX, goalY) == unvisited && grid->getCost(goalX, goalY) != NavGrid::blocked)
+            push(0, goalX, goalY);
+    }
+
+    bool FlowField::hasRequired() const {
+        return !required.empty();
+    }
+
+    bool FlowField::isSettled(uint32_t x, uint32_t y) const {
+        if (x >= grid->getWidth() || y >= grid->getHeight())
+            return false;
+        const Sector *sector = sectors[(y / NavGrid::sectorSize) * grid->getSectorsX() + x / NavGrid::sectorSize].get();
+        if (sector == nullptr || sector->flow[local(x, y)] == unknownFlow)
+            return false;
+        //a repair can still lower cells above the cheapest one waiting to be searched
+        return open.empty() || sector->integration[local(x, y)] <= (uint32_t) (open.front() >> 32);
+    }
+
+    uint32_t FlowField::getIntegration(uint32_t x, uint32_t y) const {
+        return isSettled(x, y) ? getValue(x, y) : unvisited;
+    }
+
+    bool FlowField::getDirection(uint32_t x, uint32_t y, glm::vec2 &direction) const {
+        if (!isSettled(x, y))
+            return false;
+        const Sector *sector = sectors[(y / NavGrid::sectorSize) * grid->getSectorsX() + x / NavGrid::sectorSize].get();
+        uint8_t flow = sector->flow[local(x, y)];
+        if (flow == goalFlow) {
+            direction = glm::vec2(0.f);
+            return true;
+        }
+        float scale = flow >= 4 ? 0.70710678f : 1.f;
+        direction = glm::vec2((float) stepX[flow] * scale, (float) stepY[flow] * scale);
+        return true;
+    }
+
+    uint32_t FlowField::getAllocatedSectors() const {
+        return allocated;
+    }
+
+    bool FlowField::passable(const uint8_t *costs, int direction) {
+        //no cutting corners past a wall, straight neighbours 0 and 1 are along x and 2 and 3 along y
+        return costs[direction] != NavGrid::blocked &&
+               (direction < 4 || (costs[stepX[direction] > 0 ? 0 : 1] != NavGrid::blocked &&
+                                  costs[stepY[direction] > 0 ? 2 : 3] != NavGrid::blocked));
+    }
+
+    uint8_t FlowField::lowestNeighbour(uint32_t x, uint32_t y) const {
+        uint8_t costs[8];
+        for (int direction = 0; direction < 8; direction++) {
+            costs[direction] = grid->getCost(x + stepX[direction], y + stepY[direction]);
+        }
+        uint8_t flow = goalFlow;
+        uint32_t lowest = getValue(x, y);
+        for (int direction = 0; direction < 8; direction++) {
+            uint32_t neighbour = getValue(x + stepX[direction], y + stepY[direction]);
+            if (passable(costs, direction) && neighbour < lowest) {
+                flow = (uint8_t) direction;
+                lowest = neighbour;
+            }
+        }
+        return flow;
+    }
+
+    uint32_t FlowField::getValue(uint32_t x, uint32_t y) const {
+        if (x >= grid->getWidth() || y >= grid->getHeight())
+            return unvisited;
+        const Sector *sector = sectors[(y / NavGrid::sectorSize) * grid->getSectorsX() + x / NavGrid::sectorSize].get();
+        return sector != nullptr ? sector->integration[local(x, y)] : unvisited;
+    }
+
+    FlowField::Sector &FlowField::touch(uint32_t x, uint32_t y) {
+        auto &sector = sectors[(y / NavGrid::sectorSize) * grid->getSectorsX() + x / NavGrid::sectorSize];
+        if (!sector) {
+            sector = std::make_unique<Sector>();
+            sector->integration.assign(NavGrid::sectorSize * NavGrid::sectorSize, unvisited);
+            sector->flow.assign(NavGrid::sectorSize * NavGrid::sectorSize, unknownFlow);
+            allocated++;
+        }
+        return *sector;
+    }
+
+    void FlowField::push(uint32_t value, uint32_t x, uint32_t y) {
+        touch(x, y).integration[local(x, y)] = value;
+        open.push_back((uint64_t) value << 32 | pack(x, y));
+        std::push_heap(open.begin(), open.end(), std::greater<>());
+    }
+
+    FlowFieldCache::FlowFieldCache(const NavGrid *grid, size_t maxFields) : grid(grid), maxFields(maxFields) {
+    }
+
+    FlowField *FlowFieldCache::get(uint32_t goalX, uint32_t goalY) {
+        Entry &entry = fields[pack(goalX, goalY)];
+        if (!entry.field)
+            entry.field = std::make_unique<FlowField>(grid, goalX, goalY);
+        entry.lastUsed = frame;
+        return entry.field.get();
+    }
+
+    void FlowFieldCache::expand(uint32_t budget) {
+        std::vector<FlowField *> active;
+        for (auto &[goal, entry]: fields) {
+            if (entry.field->hasRequired())
+                active.push_back(entry.field.get());
+        }
+        std::for_each(std::execution::par, active.begin(), active.end(), [budget](FlowField *field) {
+            field->expand(budget);
+        });
+    }
+
+    void FlowFieldCache::invalidate(const std::vector<uint32_t> &sectors) {
+        if (sectors.empty())
+            return;
+        for (auto &[goal, entry]: fields) {
+            entry.field->invalidate(sectors);
+        }
+    }
+
+    void FlowFieldCache::endFrame() {
+        uint64_t current = frame++;
+        if (fields.size() <= maxFields)
+            return;
+        //a field asked for this frame is still steering agents, dropping it would restart its search every frame
+        std::vector<std::pair<uint64_t, uint32_t>> byAge;
+        for (auto &[goal, entry]: fields) {
+            if (entry.lastUsed < current)
+                byAge.emplace_back(entry.lastUsed, goal);
+        }
+        std::sort(byAge.begin(), byAge.end());
+        size_t excess = std::min(byAge.size(), fields.size() - maxFields);
+        for (size_t i = 0; i < excess; i++) {
+            fields.erase(byAge[i].second);
+        }
+    }
+
+    size_t FlowFieldCache::getFieldCount() const {
+        return fields.size();
+    }
+
+}
@@ -0,0 +1,207 @@
+#include "GeometryPool.h"
+
+#include <algorithm>
+
+namespace SGE {
+
+    GeometryPool::GeometryPool(Diligent::IRenderDevice *device, uint64_t vertexCapacity, uint64_t indexCapacity) :
+            m_device(device),
+            vertices{"Geometry pool vertices", Diligent::BIND_VERTEX_BUFFER, sizeof(Vertex),
+                     RangeAllocator(vertexCapacity), {}},
+            indices16{"Geometry pool 16 bit indices", Diligent::BIND_INDEX_BUFFER, sizeof(uint16_t),
+                      RangeAllocator(indexCapacity), {}},
+            indices32{"Geometry pool 32 bit indices", Diligent::BIND_INDEX_BUFFER, sizeof(uint32_t),
+                      RangeAllocator(indexCapacity), {}} {
+    }
+
+    GeometryPool::Arena &GeometryPool::indexArena(Diligent::VALUE_TYPE indexType) {
+        return indexType == Diligent::VT_UINT32 ? indices32 : indices16;
+    }
+
+    bool GeometryPool::uploadVertices(Diligent::IDeviceContext *context, uint32_t id, const MeshComponent &mesh) {
+        Entry &entry = entries[id];
+        if (entry.vertices) {
+            vertices.allocator.free(entry.allocation.baseVertex);
+            entry.vertices = false;
+        }
+        if (mesh.vertices.empty())
+            return true;
+
+        uint64_t offset = allocate(context, vertices, mesh.vertices.size());
+        if (offset == RangeAllocator::invalidOffset)
+            return false;
+        context->UpdateBuffer(vertices.buffer, offset * vertices.stride, mesh.vertices.size() * sizeof(Vertex),
+                              mesh.vertices.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        entry.allocation.baseVertex = (uint32_t) offset;
+        entry.allocation.vertexCount = (uint32_t) mesh.vertices.size();
+        entry.vertices = true;
+        return true;
+    }
+
+    bool GeometryPool::uploadIndices(Diligent::IDeviceContext *context, uint32_t id, const MeshComponent &mesh) {
+        Entry &entry = entries[id];
+        if (entry.indices) {
+            indexArena(entry.allocation.indexType).allocator.free(entry.allocation.firstIndex);
+            entry.indices = false;
+        }
+        if (mesh.indices.empty())
+            return true;
+
+        Diligent::VALUE_TYPE indexType = mesh.uses32BitIndices() ? Diligent::VT_UINT32 : Diligent::VT_UINT16;
+        Arena &arena = indexArena(indexType);
+        uint64_t offset = allocate(context, arena, mesh.indices.size());
+        if (offset == RangeAllocator::invalidOffset)
+            return false;
+
+        std::vector<uint16_t> narrowIndices;
+        const void *data = mesh.indices.data();
+        if (indexType == Diligent::VT_UINT16) {
+            narrowIndices.assign(mesh.indices.begin(), mesh.indices.end());
+            data = narrowIndices.data();
+        }
+        context->UpdateBuffer(arena.buffer, offset * arena.stride, mesh.indices.size() * arena.stride, data,
+                              Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        entry.allocation.firstIndex = (uint32_t) offset;
+        entry.allocation.indexCount = (uint32_t) mesh.indices.size();
+        entry.allocation.indexType = indexType;
+        entry.indices = true;
+        return true;
+    }
+
+    void GeometryPool::release(uint32_t id) {
+        auto it = entries.find(id);
+        if (it == entries.end())
+            return;
+        if (it->second.vertices)
+            vertices.allocator.free(it->second.allocation.baseVertex);
+        if (it->second.indices)
+            indexArena(it->second.allocation.indexType).allocator.free(it->second.allocation.firstIndex);
+        entries.erase(it);
+    }
+
+    bool GeometryPool::hasVertices(uint32_t id) const {
+        auto it = entries.find(id);
+        return it != entries.end() && it->second.vertices;
+    }
+
+    bool GeometryPool::hasIndices(uint32_t id) const {
+        auto it = entries.find(id);
+        return it != entries.end() && it->second.indices;
+    }
+
+    const GeometryAllocation *GeometryPool::find(uint32_t id) const {
+        auto it = entries.find(id);
+        return it == entries.end() ? nullptr : &it->second.allocation;
+    }
+
+    Diligent::IBuffer *GeometryPool::getVertexBuffer() const {
+        return vertices.buffer;
+    }
+
+    Diligent::IBuffer *GeometryPool::getIndexBuffer(Diligent::VALUE_TYPE indexType) const {
+        return indexType == Diligent::VT_UINT32 ? indices32.buffer : indices16.buffer;
+    }
+
+    uint64_t GeometryPool::allocate(Diligent::IDeviceContext *context, Arena &arena, uint64_t count) {
+        if (!arena.buffer) {
+            uint64_t capacity = std::max<uint64_t>(arena.allocator.getCapacity(), count);
+            rebuild(context, arena, capacity, {});
+            arena.allocator.grow(capacity);
+        }
+        uint64_t offset = arena.allocator.allocate(count);
+        if (offset != RangeAllocator::invalidOffset)
+            return offset;
+
+        //enough free space that is only scattered is packed first, growing is the last resort
+        uint64_t freeSize = arena.allocator.getCapacity() - arena.allocator.getUsedSize();
+        if (freeSize >= count * 2 && defragment(context, arena)) {
+            offset = arena.allocator.allocate(count);
+            if (offset != RangeAllocator::invalidOffset)
+                return offset;
+        }
+
+        uint64_t capacity = std::max<uint64_t>(arena.allocator.getCapacity(), 1024);
+        while (capacity < arena.allocator.getUsedSize() + count)
+            capacity *= 2;
+        capacity *= 2;
+        std::vector<Copy> copies;
+        if (arena.allocator.getCapacity() > 0)
+            copies.push_back({0, 0, arena.allocator.getCapacity()});
+        rebuild(context, arena, capacity, copies);
+        arena.allocator.grow(capacity);
+        return arena.allocator.allocate(count);
+    }
+
+    void GeometryPool::rebuild(Diligent::IDeviceContext *context, Arena &arena, uint64_t capacity,
+                               const std::vector<Copy> &copies) {
+        Diligent::BufferDesc desc;
+        desc.Name = arena.name.c_str();
+        desc.Size = capacity * arena.stride;
+        desc.Usage = Diligent::USAGE_DEFAULT;
+        desc.BindFlags = arena.bindFlags;
+        Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+        m_device->CreateBuffer(desc, nullptr, &buffer);
+
+        //the old buffer is kept alive by any command list still reading it
+        for (const auto &copy: copies) {
+            context->CopyBuffer(arena.buffer, copy.from * arena.stride, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                buffer, copy.to * arena.stride, copy.size * arena.stride,
+                                Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
+        arena.buffer = buffer;
+    }
+
+    bool GeometryPool::defragment(Diligent::IDeviceContext *context, float threshold) {
+        bool moved = false;
+        for (Arena *arena: {&vertices, &indices16, &indices32}) {
+            if (arena->buffer && arena->allocator.getFragmentation() > threshold)
+                moved |= defragment(context, *arena);
+        }
+        return moved;
+    }
+
+    bool GeometryPool::defragment(Diligent::IDeviceContext *context, Arena &arena) {
+        std::vector<RangeAllocator::Move> moves = arena.allocator.defragment();
+        if (moves.empty())
+            return false;
+
+        std::unordered_map<uint64_t, uint64_t> movedTo;
+        for (const auto &move: moves) {
+            movedTo[move.from] = move.to;
+        }
+
+        //every allocation is copied since the packed layout goes into a fresh buffer, neighbours that stay
+        //neighbours are merged into one copy
+        std::vector<Copy> copies;
+        for (auto &[id, entry]: entries) {
+            uint32_t *offset = nullptr;
+            uint64_t size = 0;
+            if (&arena == &vertices && entry.vertices) {
+                offset = &entry.allocation.baseVertex;
+                size = entry.allocation.vertexCount;
+            } else if (entry.indices && &arena == &indexArena(entry.allocation.indexType)) {
+                offset = &entry.allocation.firstIndex;
+                size = entry.allocation.indexCount;
+            }
+            if (offset == nullptr)
+                continue;
+            auto found = movedTo.find(*offset);
+            uint64_t to = found == movedTo.end() ? *offset : found->second;
+            copies.push_back({*offset, to, size});
+            *offset = (uint32_t) to;
+        }
+        std::sort(copies.begin(), copies.end(), [](const Copy &a, const Copy &b) { return a.to < b.to; });
+        std::vector<Copy> merged;
+        for (const auto &copy: copies) {
+            if (!merged.empty() && merged.back().to + merged.back().size == copy.to &&
+                merged.back().from + merged.back().size == copy.from)
+                merged.back().size += copy.size;
+            else
+                merged.push_back(copy);
+        }
+
+        rebuild(context, arena, arena.allocator.getCapacity(), merged);
+        return true;
+    }
+
+}
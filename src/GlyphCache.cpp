@@ -0,0 +1,189 @@
+#include "GlyphCache.h"
+
+#include <algorithm>
+
+namespace SGE {
+
+    namespace {
+        constexpr uint32_t glyphColumns = 5;
+        constexpr uint32_t glyphRows = 7;
+
+        //rows from the top, the leftmost column in bit 4, for the characters 32 to 126
+        constexpr uint8_t asciiGlyphs[95][glyphRows] = {
+                {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04},
+                {0x0a, 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00}, {0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a},
+                {0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04}, {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},
+                {0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d}, {0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00},
+                {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}, {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08},
+                {0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00}, {0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00},
+                {0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08}, {0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00},
+                {0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c}, {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00},
+                {0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e}, {0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e},
+                {0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f}, {0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e},
+                {0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02}, {0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e},
+                {0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e}, {0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+                {0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e}, {0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c},
+                {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00}, {0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08},
+                {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}, {0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00},
+                {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}, {0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04},
+                {0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e}, {0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11},
+                {0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e}, {0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e},
+                {0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c}, {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f},
+                {0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10}, {0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f},
+                {0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11}, {0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e},
+                {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c}, {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},
+                {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f}, {0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11},
+                {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, {0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},
+                {0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10}, {0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d},
+                {0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11}, {0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e},
+                {0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e},
+                {0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04}, {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a},
+                {0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11}, {0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04},
+                {0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f}, {0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e},
+                {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00}, {0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e},
+                {0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f},
+                {0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f},
+                {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e}, {0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e},
+                {0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f}, {0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e},
+                {0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08}, {0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x0e},
+                {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11}, {0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e},
+                {0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0c}, {0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12},
+                {0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e}, {0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11},
+                {0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11}, {0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e},
+                {0x00, 0x00, 0x1e, 0x11, 0x1e, 0x10, 0x10}, {0x00, 0x00, 0x0d, 0x13, 0x0f, 0x01, 0x01},
+                {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10}, {0x00, 0x00, 0x0e, 0x10, 0x0e, 0x01, 0x1e},
+                {0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06}, {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d},
+                {0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04}, {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a},
+                {0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11}, {0x00, 0x00, 0x11, 0x11, 0x0f, 0x01, 0x0e},
+                {0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f}, {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02},
+                {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08},
+                {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00},
+        };
+    }
+
+    uint32_t BitmapFont::scaleFor(uint32_t pixelSize) {
+        return std::max(1u, (pixelSize + 4) / 8);
+    }
+
+    FontMetrics BitmapFont::getMetrics(uint32_t pixelSize) const {
+        auto scale = (float) scaleFor(pixelSize);
+        //one empty row under the baseline for descenders and one between lines
+        return {(float) glyphRows * scale, scale, (float) (glyphRows + 2) * scale};
+    }
+
+    void BitmapFont::rasterize(uint32_t codepoint, uint32_t pixelSize, GlyphBitmap &glyph) const {
+        if (codepoint < 32 || codepoint > 126)
+            codepoint = '?';
+        uint32_t scale = scaleFor(pixelSize);
+        const uint8_t *rows = asciiGlyphs[codepoint - 32];
+        glyph.advance = (float) ((glyphColumns + 1) * scale);
+        glyph.bearingX = 0;
+        glyph.bearingY = (int32_t) (glyphRows * scale);
+        glyph.pixels.clear();
+        if (codepoint == ' ') {
+            glyph.width = glyph.height = 0;
+            return;
+        }
+        glyph.width = glyphColumns * scale;
+        glyph.height = glyphRows * scale;
+        glyph.pixels.resize((size_t) glyph.width * glyph.height);
+        for (uint32_t y = 0; y < glyph.height; y++) {
+            uint8_t row = rows[y / scale];
+            for (uint32_t x = 0; x < glyph.width; x++) {
+                glyph.pixels[(size_t) y * glyph.width + x] = (row >> (glyphColumns - 1 - x / scale)) & 1 ? 255 : 0;
+            }
+        }
+    }
+
+    GlyphCache::GlyphCache(const GlyphSource *source, uint32_t width, uint32_t height) :
+            source(source), width(width), height(height), packer(width, height),
+            pixels((size_t) width * height, 0) {
+    }
+
+    const CachedGlyph *GlyphCache::get(uint32_t codepoint, uint32_t pixelSize) {
+        uint64_t key = (uint64_t) pixelSize << 32 | codepoint;
+        auto it = glyphs.find(key);
+        if (it != glyphs.end())
+            return &it->second;
+
+        source->rasterize(codepoint, pixelSize, scratch);
+        rasterized++;
+        CachedGlyph glyph;
+        glyph.bearingX = scratch.bearingX;
+        glyph.bearingY = scratch.bearingY;
+        glyph.advance = scratch.advance;
+        //blank glyphs such as the space only need their advance, they take no room in the atlas
+        if (scratch.width > 0 && scratch.height > 0) {
+            AtlasRect padded;
+            if (!packer.insert(scratch.width + 2 * padding, scratch.height + 2 * padding, padded))
+                return nullptr;
+            glyph.rect = {padded.x + padding, padded.y + padding, scratch.width, scratch.height};
+            for (uint32_t y = 0; y < scratch.height; y++) {
+                std::copy_n(scratch.pixels.data() + (size_t) y * scratch.width, scratch.width,
+                            pixels.data() + (size_t) (glyph.rect.y + y) * width + glyph.rect.x);
+            }
+            markDirty(glyph.rect);
+        }
+        return &glyphs.emplace(key, glyph).first->second;
+    }
+
+    FontMetrics GlyphCache::getMetrics(uint32_t pixelSize) const {
+        return source->getMetrics(pixelSize);
+    }
+
+    void GlyphCache::clear() {
+        glyphs.clear();
+        packer = SkylinePacker(width, height);
+        std::fill(pixels.begin(), pixels.end(), 0);
+        generation++;
+        markDirty({0, 0, width, height});
+    }
+
+    void GlyphCache::markDirty(const AtlasRect &rect) {
+        if (!dirty) {
+            dirtyX0 = rect.x;
+            dirtyY0 = rect.y;
+            dirtyX1 = rect.x + rect.width;
+            dirtyY1 = rect.y + rect.height;
+            dirty = true;
+            return;
+        }
+        dirtyX0 = std::min(dirtyX0, rect.x);
+        dirtyY0 = std::min(dirtyY0, rect.y);
+        dirtyX1 = std::max(dirtyX1, rect.x + rect.width);
+        dirtyY1 = std::max(dirtyY1, rect.y + rect.height);
+    }
+
+    bool GlyphCache::takeDirtyRect(AtlasRect &rect) {
+        if (!dirty)
+            return false;
+        rect = {dirtyX0, dirtyY0, dirtyX1 - dirtyX0, dirtyY1 - dirtyY0};
+        dirty = false;
+        return true;
+    }
+
+    uint32_t GlyphCache::getGeneration() const {
+        return generation;
+    }
+
+    uint32_t GlyphCache::getWidth() const {
+        return width;
+    }
+
+    uint32_t GlyphCache::getHeight() const {
+        return height;
+    }
+
+    const std::vector<uint8_t> &GlyphCache::getPixels() const {
+        return pixels;
+    }
+
+    uint32_t GlyphCache::getGlyphCount() const {
+        return (uint32_t) glyphs.size();
+    }
+
+    uint64_t GlyphCache::getRasterizedCount() const {
+        return rasterized;
+    }
+
+}
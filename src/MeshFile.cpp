@@ -0,0 +1,127 @@
+#include "MeshFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace SGE {
+
+    bool MeshFile::write(const std::string &path, const MeshComponent &mesh, std::string &error) {
+        MeshFileHeader header;
+        header.vertexCount = (uint32_t) mesh.vertices.size();
+        header.indexCount = (uint32_t) mesh.indices.size();
+        header.indexStride = mesh.indexStride();
+        header.lodCount = (uint32_t) mesh.lods.size();
+
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            error = "Could not open " + path + " for writing";
+            return false;
+        }
+
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && std::fwrite(mesh.vertices.data(), sizeof(Vertex), mesh.vertices.size(), file) == mesh.vertices.size();
+        if (mesh.uses32BitIndices()) {
+            ok = ok && std::fwrite(mesh.indices.data(), sizeof(uint32_t), mesh.indices.size(), file) == mesh.indices.size();
+        } else {
+            std::vector<uint16_t> narrowIndices(mesh.indices.begin(), mesh.indices.end());
+            ok = ok && std::fwrite(narrowIndices.data(), sizeof(uint16_t), narrowIndices.size(), file) ==
+                       narrowIndices.size();
+        }
+        ok = ok && std::fwrite(mesh.lods.data(), sizeof(MeshLod), mesh.lods.size(), file) == mesh.lods.size();
+        ok = std::fclose(file) == 0 && ok;
+
+        if (!ok)
+            error = "Failed to write " + path;
+        return ok;
+    }
+
+    bool MeshFile::read(const std::string &path, MeshComponent &mesh, std::string &error) {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            error = "Could not open " + path;
+            return false;
+        }
+
+        std::fseek(file, 0, SEEK_END);
+        long size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        std::vector<char> data(size > 0 ? size : 0);
+        bool ok = std::fread(data.data(), 1, data.size(), file) == data.size();
+        std::fclose(file);
+        if (!ok) {
+            error = "Failed to read " + path;
+            return false;
+        }
+
+        if (!read(data.data(), data.size(), mesh, error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        return true;
+    }
+
+    bool MeshFile::read(const char *data, size_t size, MeshComponent &mesh, std::string &error) {
+        MeshFileHeader header;
+        MeshFileHeader expected;
+        if (size < sizeof(header)) {
+            error = "Mesh file is truncated";
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version) {
+            error = "Not a version " + std::to_string(expected.version) + " mesh file";
+            return false;
+        }
+        if (header.indexStride != sizeof(uint16_t) && header.indexStride != sizeof(uint32_t)) {
+            error = "Invalid index size";
+            return false;
+        }
+
+        size_t vertexBytes = (size_t) header.vertexCount * sizeof(Vertex);
+        size_t indexBytes = (size_t) header.indexCount * header.indexStride;
+        size_t lodBytes = (size_t) header.lodCount * sizeof(MeshLod);
+        if (size < sizeof(header) + vertexBytes + indexBytes + lodBytes) {
+            error = "Mesh file is truncated";
+            return false;
+        }
+
+        const char *cursor = data + sizeof(header);
+        mesh.vertices.resize(header.vertexCount);
+        std::memcpy(mesh.vertices.data(), cursor, vertexBytes);
+        cursor += vertexBytes;
+
+        mesh.indices.resize(header.indexCount);
+        if (header.indexStride == sizeof(uint32_t)) {
+            std::memcpy(mesh.indices.data(), cursor, indexBytes);
+        } else {
+            for (uint32_t i = 0; i < header.indexCount; i++) {
+                uint16_t index;
+                std::memcpy(&index, cursor + i * sizeof(uint16_t), sizeof(uint16_t));
+                mesh.indices[i] = index;
+            }
+        }
+        cursor += indexBytes;
+
+        mesh.lods.resize(header.lodCount);
+        std::memcpy(mesh.lods.data(), cursor, lodBytes);
+
+        //cooked meshes skip the importer's validation, the renderers index with all of these unchecked
+        for (uint32_t i = 0; i < header.indexCount; i++) {
+            if (mesh.indices[i] >= header.vertexCount) {
+                error = "Index " + std::to_string(i) + " is " + std::to_string(mesh.indices[i]) +
+                        " but there are only " + std::to_string(header.vertexCount) + " vertices";
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < header.lodCount; i++) {
+            if ((uint64_t) mesh.lods[i].firstIndex + mesh.lods[i].indexCount > header.indexCount) {
+                error = "Lod " + std::to_string(i) + " reaches past the " + std::to_string(header.indexCount) +
+                        " indices";
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
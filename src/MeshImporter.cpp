@@ -0,0 +1,110 @@
+#include "MeshImporter.h"
+#include "CustomYaml.h"
+#include "DtParser.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+
+#include <filesystem>
+
+namespace SGE {
+
+    bool MeshImporter::read(const std::string &path, uint32_t &id, MeshComponent &mesh, std::string &error,
+                            std::string &report, const AtlasLayout *atlas) {
+        std::filesystem::path file(path);
+        if (file.extension() == ".mesh") {
+            //binary meshes are written already optimized and with their lods
+            return MeshFile::read(path, mesh, error);
+        }
+
+        if (file.extension() == ".dt") {
+            DtHeader header;
+            if (!DtParser::parseFile(path, mesh, header, error))
+                return false;
+        } else if (!readYaml(path, id, mesh, error, atlas)) {
+            return false;
+        }
+        //the optimizer indexes its tables with every index, so a malformed mesh is rejected before it runs
+        if (!MeshOptimizer::validate(mesh, error)) {
+            error = path + ": " + error;
+            return false;
+        }
+
+        report = process(file.filename().string(), mesh);
+        return true;
+    }
+
+    bool MeshImporter::isSourceFormat(const std::string &path) {
+        std::filesystem::path extension = std::filesystem::path(path).extension();
+        if (extension == ".dt")
+            return true;
+        if (extension != ".yml" && extension != ".yaml")
+            return false;
+        //shader descriptions and other yaml files live next to the meshes, only a Mesh node makes one a mesh. A file
+        //that does not parse is still taken so the cook reports it instead of skipping it.
+        try {
+            return (bool) YAML::LoadFile(path)["Mesh"];
+        } catch (YAML::Exception &) {
+            return true;
+        }
+    }
+
+    std::string MeshImporter::process(const std::string &name, MeshComponent &mesh) {
+        MeshOptimizationReport report = MeshOptimizer::optimize(mesh);
+        //lods are built last since they append to the optimized index list
+        MeshSimplifier::buildLods(mesh);
+        return MeshOptimizer::formatReport(name, report);
+    }
+
+    bool MeshImporter::readYaml(const std::string &path, uint32_t &id, MeshComponent &mesh, std::string &error,
+                                const AtlasLayout *atlas) {
+        YAML::Node original;
+        try {
+            original = YAML::LoadFile(path);
+        } catch (YAML::Exception &e) {
+            error = e.what();
+            return false;
+        }
+
+        YAML::Node node = original["Mesh"];
+        if (!node) {
+            error = "No Mesh node in " + path;
+            return false;
+        }
+
+        try {
+            id = node["PregenID"].as<uint32_t>();
+
+            mesh.vertices.clear();
+            mesh.vertices.reserve(node["NumVerts"].as<int>());
+            for (const auto &position: node["Vertices"]) {
+                mesh.vertices.push_back({position.as<glm::vec3>(), glm::vec4(0.f)});
+            }
+
+            mesh.indices = node["Indices"].as<std::vector<uint32_t>>();
+
+            //coordinates over the sprite image, one per vertex
+            if (node["TexCoords"]) {
+                auto texCoords = node["TexCoords"].as<std::vector<std::vector<float>>>();
+                for (size_t i = 0; i < texCoords.size() && i < mesh.vertices.size(); i++) {
+                    if (texCoords[i].size() >= 2)
+                        mesh.vertices[i].texCoord = glm::vec4(texCoords[i][0], texCoords[i][1], 0.f, 0.f);
+                }
+            }
+            if (node["Sprite"] && atlas != nullptr) {
+                std::string sprite = node["Sprite"].as<std::string>();
+                const AtlasEntry *entry = atlas->find(sprite);
+                if (entry == nullptr) {
+                    error = "Sprite " + sprite + " used by " + path + " is not in the atlas";
+                    return false;
+                }
+                AtlasPacker::remapTexCoords(mesh, *atlas, *entry);
+            }
+        } catch (YAML::Exception &e) {
+            error = e.what();
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,272 @@
+#include "MeshOptimizer.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <sstream>
+
+namespace SGE {
+
+    namespace {
+        struct VertexHash {
+            size_t operator()(const Vertex &vertex) const {
+                float values[7] = {vertex.pos.x, vertex.pos.y, vertex.pos.z, vertex.texCoord.x, vertex.texCoord.y,
+                                   vertex.texCoord.z, vertex.texCoord.w};
+                uint64_t hash = 14695981039346656037ull;
+                for (float value: values) {
+                    //-0 and 0 compare equal so they have to hash equal as well
+                    value += 0.f;
+                    uint32_t bits;
+                    std::memcpy(&bits, &value, sizeof(bits));
+                    hash = (hash ^ bits) * 1099511628211ull;
+                }
+                return static_cast<size_t>(hash);
+            }
+        };
+
+        //scoring constants from Tom Forsyth's linear-speed vertex cache optimisation, the scored cache holds
+        //cacheSize vertices
+        constexpr float kCacheDecayPower = 1.5f;
+        constexpr float kLastTriScore = 0.75f;
+        constexpr float kValenceBoostScale = 2.0f;
+        constexpr float kValenceBoostPower = 0.5f;
+
+        float vertexScore(int cachePosition, uint32_t remaining, uint32_t cacheSize) {
+            if (remaining == 0)
+                return -1.f;
+
+            float score = 0.f;
+            if (cachePosition >= 0) {
+                if (cachePosition < 3) {
+                    score = kLastTriScore;
+                } else {
+                    float scaler = 1.f / (float) (cacheSize - 3);
+                    score = std::pow(1.f - (cachePosition - 3) * scaler, kCacheDecayPower);
+                }
+            }
+            score += kValenceBoostScale * std::pow((float) remaining, -kValenceBoostPower);
+            return score;
+        }
+    }
+
+    MeshOptimizationReport MeshOptimizer::optimize(MeshComponent &mesh, uint32_t cacheSize) {
+        MeshOptimizationReport report;
+        report.before = computeStats(mesh, cacheSize);
+        weldVertices(mesh);
+        optimizeVertexCache(mesh, cacheSize);
+        optimizeVertexFetch(mesh);
+        report.after = computeStats(mesh, cacheSize);
+        return report;
+    }
+
+    bool MeshOptimizer::validate(const MeshComponent &mesh, std::string &error) {
+        if (mesh.indices.size() % 3 != 0) {
+            error = std::to_string(mesh.indices.size()) + " indices do not form whole triangles";
+            return false;
+        }
+        for (size_t i = 0; i < mesh.indices.size(); i++) {
+            if (mesh.indices[i] >= mesh.vertices.size()) {
+                error = "index " + std::to_string(i) + " is " + std::to_string(mesh.indices[i]) +
+                        " but there are only " + std::to_string(mesh.vertices.size()) + " vertices";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void MeshOptimizer::weldVertices(MeshComponent &mesh) {
+        std::unordered_map<Vertex, uint32_t, VertexHash> unique;
+        unique.reserve(mesh.vertices.size());
+
+        std::vector<uint32_t> remap(mesh.vertices.size());
+        std::vector<Vertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); i++) {
+            auto result = unique.emplace(mesh.vertices[i], (uint32_t) vertices.size());
+            if (result.second)
+                vertices.push_back(mesh.vertices[i]);
+            remap[i] = result.first->second;
+        }
+
+        for (auto &index: mesh.indices) {
+            index = remap[index];
+        }
+        mesh.vertices.swap(vertices);
+    }
+
+    void MeshOptimizer::optimizeVertexCache(MeshComponent &mesh, uint32_t cacheSize) {
+        optimizeVertexCache(mesh.indices, mesh.vertices.size(), cacheSize);
+    }
+
+    void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize) {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+        //the last triangle alone takes three entries, a smaller cache leaves nothing to score
+        cacheSize = std::max(cacheSize, 4u);
+
+        //triangle adjacency per vertex, the first remaining[v] entries of each slice are the unemitted triangles
+        std::vector<uint32_t> remaining(vertexCount, 0);
+        for (auto index: indices) {
+            remaining[index]++;
+        }
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] = offsets[v] + remaining[v];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (size_t k = 0; k < 3; k++) {
+                uint32_t v = indices[t * 3 + k];
+                adjacency[fill[v]++] = (uint32_t) t;
+            }
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) {
+            vertexScores[v] = vertexScore(-1, remaining[v], cacheSize);
+        }
+
+        std::vector<float> triangleScores(triangleCount);
+        std::vector<bool> emitted(triangleCount, false);
+        int bestTriangle = 0;
+        for (size_t t = 0; t < triangleCount; t++) {
+            const uint32_t *tri = &indices[t * 3];
+            triangleScores[t] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+            if (triangleScores[t] > triangleScores[bestTriangle])
+                bestTriangle = (int) t;
+        }
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        std::vector<uint32_t> cache, nextCache;
+        cache.reserve(cacheSize + 3);
+        nextCache.reserve(cacheSize + 3);
+        size_t cursor = 0;
+
+        for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+            if (bestTriangle < 0) {
+                //nothing adjacent to the cache is left, continue with the next unemitted triangle in input order
+                while (emitted[cursor])
+                    cursor++;
+                bestTriangle = (int) cursor;
+            }
+
+            const uint32_t *tri = &indices[bestTriangle * 3];
+            emitted[bestTriangle] = true;
+            nextCache.clear();
+            for (size_t k = 0; k < 3; k++) {
+                uint32_t v = tri[k];
+                output.push_back(v);
+                nextCache.push_back(v);
+
+                uint32_t *begin = &adjacency[offsets[v]];
+                uint32_t *end = begin + remaining[v];
+                std::iter_swap(std::find(begin, end, (uint32_t) bestTriangle), end - 1);
+                remaining[v]--;
+            }
+
+            for (auto v: cache) {
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                    nextCache.push_back(v);
+            }
+            for (size_t i = cacheSize; i < nextCache.size(); i++) {
+                cachePosition[nextCache[i]] = -1;
+                vertexScores[nextCache[i]] = vertexScore(-1, remaining[nextCache[i]], cacheSize);
+            }
+            if (nextCache.size() > cacheSize)
+                nextCache.resize(cacheSize);
+            cache.swap(nextCache);
+
+            for (size_t i = 0; i < cache.size(); i++) {
+                cachePosition[cache[i]] = (int) i;
+                vertexScores[cache[i]] = vertexScore((int) i, remaining[cache[i]], cacheSize);
+            }
+
+            bestTriangle = -1;
+            float bestScore = -1.f;
+            for (auto v: cache) {
+                for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+                    uint32_t t = adjacency[a];
+                    const uint32_t *other = &indices[t * 3];
+                    triangleScores[t] = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+                    if (triangleScores[t] > bestScore) {
+                        bestScore = triangleScores[t];
+                        bestTriangle = (int) t;
+                    }
+                }
+            }
+        }
+
+        indices.swap(output);
+    }
+
+    void MeshOptimizer::optimizeVertexFetch(MeshComponent &mesh) {
+        //renumber vertices in first use order so the index stream walks the vertex buffer forwards
+        std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+        std::vector<Vertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+        for (auto &index: mesh.indices) {
+            if (remap[index] == UINT32_MAX) {
+                remap[index] = (uint32_t) vertices.size();
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+        mesh.vertices.swap(vertices);
+    }
+
+    float MeshOptimizer::computeAcmr(const MeshComponent &mesh, uint32_t cacheSize) {
+        size_t triangleCount = mesh.indices.size() / 3;
+        if (triangleCount == 0)
+            return 0.f;
+
+        //simulates a fifo post transform cache, a vertex is cached while fewer than cacheSize misses followed it
+        std::vector<uint32_t> timestamps(mesh.vertices.size(), 0);
+        uint32_t time = cacheSize + 1;
+        size_t misses = 0;
+        for (auto index: mesh.indices) {
+            if (time - timestamps[index] > cacheSize) {
+                timestamps[index] = time++;
+                misses++;
+            }
+        }
+        return (float) misses / (float) triangleCount;
+    }
+
+    MeshStats MeshOptimizer::computeStats(const MeshComponent &mesh, uint32_t cacheSize) {
+        MeshStats stats;
+        stats.vertexCount = mesh.vertices.size();
+        stats.indexCount = mesh.indices.size();
+        stats.sizeBytes = mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * mesh.indexStride();
+        stats.acmr = computeAcmr(mesh, cacheSize);
+        return stats;
+    }
+
+    void MeshOptimizer::computeBounds(const MeshComponent &mesh, Bounds &bounds) {
+        if (mesh.vertices.empty()) {
+            bounds = Bounds();
+            return;
+        }
+        bounds.min = mesh.vertices[0].pos;
+        bounds.max = mesh.vertices[0].pos;
+        for (const auto &vertex: mesh.vertices) {
+            bounds.min = glm::min(bounds.min, vertex.pos);
+            bounds.max = glm::max(bounds.max, vertex.pos);
+        }
+    }
+
+    std::string MeshOptimizer::formatReport(const std::string &name, const MeshOptimizationReport &report) {
+        std::stringstream stream;
+        stream << "Optimized mesh " << name
+               << ": vertices " << report.before.vertexCount << " -> " << report.after.vertexCount
+               << ", indices " << report.before.indexCount << " -> " << report.after.indexCount
+               << ", bytes " << report.before.sizeBytes << " -> " << report.after.sizeBytes
+               << ", ACMR " << report.before.acmr << " -> " << report.after.acmr;
+        return stream.str();
+    }
+
+}
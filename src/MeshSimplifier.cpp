@@ -0,0 +1,268 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace SGE {
+
+    namespace {
+        //boundary edges get an extra plane so open meshes such as flat grids keep their outline
+        constexpr double kBoundaryWeight = 10.0;
+
+        struct Quadric {
+            double a2 = 0, ab = 0, ac = 0, ad = 0;
+            double b2 = 0, bc = 0, bd = 0;
+            double c2 = 0, cd = 0;
+            double d2 = 0;
+
+            void addPlane(const glm::vec3 &normal, float distance, double weight) {
+                double a = normal.x, b = normal.y, c = normal.z, d = distance;
+                a2 += weight * a * a;
+                ab += weight * a * b;
+                ac += weight * a * c;
+                ad += weight * a * d;
+                b2 += weight * b * b;
+                bc += weight * b * c;
+                bd += weight * b * d;
+                c2 += weight * c * c;
+                cd += weight * c * d;
+                d2 += weight * d * d;
+            }
+
+            Quadric &operator+=(const Quadric &other) {
+                a2 += other.a2;
+                ab += other.ab;
+                ac += other.ac;
+                ad += other.ad;
+                b2 += other.b2;
+                bc += other.bc;
+                bd += other.bd;
+                c2 += other.c2;
+                cd += other.cd;
+                d2 += other.d2;
+                return *this;
+            }
+
+            double error(const glm::vec3 &p) const {
+                double x = p.x, y = p.y, z = p.z;
+                double result = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                                + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                                + c2 * z * z + 2 * cd * z
+                                + d2;
+                return std::max(result, 0.0);
+            }
+        };
+
+        struct Collapse {
+            uint32_t remove;
+            uint32_t keep;
+            double cost;
+        };
+
+        double collapseCost(const std::vector<Quadric> &quadrics, const std::vector<Vertex> &vertices,
+                            uint32_t remove, uint32_t keep) {
+            Quadric combined = quadrics[remove];
+            combined += quadrics[keep];
+            return combined.error(vertices[keep].pos);
+        }
+    }
+
+    std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<Vertex> &vertices,
+                                                   const std::vector<uint32_t> &source, size_t targetIndexCount,
+                                                   float targetError, float &resultError) {
+        std::vector<uint32_t> indices = source;
+        resultError = 0.f;
+        size_t vertexCount = vertices.size();
+        if (indices.size() <= targetIndexCount || vertexCount == 0)
+            return indices;
+
+        glm::vec3 min = vertices[indices[0]].pos, max = min;
+        for (auto index: indices) {
+            min = glm::min(min, vertices[index].pos);
+            max = glm::max(max, vertices[index].pos);
+        }
+        glm::vec3 size = max - min;
+        double extent = std::max(size.x, std::max(size.y, size.z));
+        double errorLimit = (targetError * extent) * (targetError * extent);
+
+        std::vector<Quadric> quadrics(vertexCount);
+        std::vector<std::pair<uint64_t, uint32_t>> edges;
+        edges.reserve(indices.size());
+        for (size_t t = 0; t < indices.size(); t += 3) {
+            const glm::vec3 &a = vertices[indices[t]].pos;
+            const glm::vec3 &b = vertices[indices[t + 1]].pos;
+            const glm::vec3 &c = vertices[indices[t + 2]].pos;
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            if (glm::length(normal) == 0.f)
+                continue;
+            normal = glm::normalize(normal);
+            for (size_t k = 0; k < 3; k++) {
+                quadrics[indices[t + k]].addPlane(normal, -glm::dot(normal, a), 1.0);
+
+                uint32_t from = indices[t + k], to = indices[t + (k + 1) % 3];
+                uint64_t key = ((uint64_t) std::min(from, to) << 32) | std::max(from, to);
+                edges.emplace_back(key, (uint32_t) t);
+            }
+        }
+
+        //an edge used by a single triangle is on the boundary
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size(); i++) {
+            bool shared = (i > 0 && edges[i - 1].first == edges[i].first) ||
+                          (i + 1 < edges.size() && edges[i + 1].first == edges[i].first);
+            if (shared)
+                continue;
+
+            uint32_t from = (uint32_t) (edges[i].first >> 32), to = (uint32_t) edges[i].first;
+            size_t t = edges[i].second;
+            const glm::vec3 &a = vertices[indices[t]].pos;
+            glm::vec3 faceNormal = glm::normalize(glm::cross(vertices[indices[t + 1]].pos - a,
+                                                             vertices[indices[t + 2]].pos - a));
+            glm::vec3 edge = vertices[to].pos - vertices[from].pos;
+            glm::vec3 normal = glm::cross(edge, faceNormal);
+            if (glm::length(normal) == 0.f)
+                continue;
+            normal = glm::normalize(normal);
+            float distance = -glm::dot(normal, vertices[from].pos);
+            quadrics[from].addPlane(normal, distance, kBoundaryWeight);
+            quadrics[to].addPlane(normal, distance, kBoundaryWeight);
+        }
+
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<bool> locked(vertexCount);
+        std::vector<uint32_t> valence(vertexCount), offsets(vertexCount + 1), adjacency;
+        std::vector<uint64_t> keys;
+        std::vector<Collapse> collapses;
+        double maxCost = 0.0;
+
+        //every pass collapses the cheapest edges whose neighbourhoods do not overlap, then rebuilds the index list
+        while (indices.size() > targetIndexCount) {
+            std::fill(valence.begin(), valence.end(), 0);
+            for (auto index: indices) {
+                valence[index]++;
+            }
+            for (size_t v = 0; v < vertexCount; v++) {
+                offsets[v + 1] = offsets[v] + valence[v];
+            }
+            adjacency.resize(indices.size());
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < indices.size(); t += 3) {
+                for (size_t k = 0; k < 3; k++) {
+                    adjacency[fill[indices[t + k]]++] = (uint32_t) t;
+                }
+            }
+
+            keys.clear();
+            for (size_t t = 0; t < indices.size(); t += 3) {
+                for (size_t k = 0; k < 3; k++) {
+                    uint32_t from = indices[t + k], to = indices[t + (k + 1) % 3];
+                    keys.push_back(((uint64_t) std::min(from, to) << 32) | std::max(from, to));
+                }
+            }
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+            collapses.clear();
+            for (auto key: keys) {
+                uint32_t a = (uint32_t) (key >> 32), b = (uint32_t) key;
+                double costA = collapseCost(quadrics, vertices, a, b);
+                double costB = collapseCost(quadrics, vertices, b, a);
+                if (costA <= costB) {
+                    collapses.push_back({a, b, costA});
+                } else {
+                    collapses.push_back({b, a, costB});
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &lhs, const Collapse &rhs) {
+                return lhs.cost < rhs.cost;
+            });
+
+            std::iota(remap.begin(), remap.end(), 0);
+            std::fill(locked.begin(), locked.end(), false);
+            size_t triangles = indices.size() / 3;
+            size_t collapsed = 0;
+            for (const auto &collapse: collapses) {
+                if (collapse.cost > errorLimit || triangles * 3 <= targetIndexCount)
+                    break;
+                if (locked[collapse.remove] || locked[collapse.keep])
+                    continue;
+
+                //reject collapses that would flip a triangle around the removed vertex
+                bool flipped = false;
+                size_t degenerate = 0;
+                const glm::vec3 &target = vertices[collapse.keep].pos;
+                for (uint32_t a = offsets[collapse.remove]; a < offsets[collapse.remove + 1] && !flipped; a++) {
+                    const uint32_t *tri = &indices[adjacency[a]];
+                    if (tri[0] == collapse.keep || tri[1] == collapse.keep || tri[2] == collapse.keep) {
+                        degenerate++;
+                        continue;
+                    }
+                    glm::vec3 p[3], q[3];
+                    for (size_t k = 0; k < 3; k++) {
+                        p[k] = vertices[tri[k]].pos;
+                        q[k] = tri[k] == collapse.remove ? target : p[k];
+                    }
+                    glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                    flipped = glm::dot(before, after) <= 0.f;
+                }
+                if (flipped)
+                    continue;
+
+                remap[collapse.remove] = collapse.keep;
+                quadrics[collapse.keep] += quadrics[collapse.remove];
+                for (uint32_t a = offsets[collapse.remove]; a < offsets[collapse.remove + 1]; a++) {
+                    const uint32_t *tri = &indices[adjacency[a]];
+                    locked[tri[0]] = locked[tri[1]] = locked[tri[2]] = true;
+                }
+                triangles -= degenerate;
+                maxCost = std::max(maxCost, collapse.cost);
+                collapsed++;
+            }
+
+            if (collapsed == 0)
+                break;
+
+            size_t write = 0;
+            for (size_t t = 0; t < indices.size(); t += 3) {
+                uint32_t a = remap[indices[t]], b = remap[indices[t + 1]], c = remap[indices[t + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+                indices[write++] = a;
+                indices[write++] = b;
+                indices[write++] = c;
+            }
+            indices.resize(write);
+        }
+
+        resultError = (float) std::sqrt(maxCost);
+        return indices;
+    }
+
+    void MeshSimplifier::buildLods(MeshComponent &mesh, uint32_t maxLevels, float reduction, float targetError) {
+        mesh.lods.clear();
+        if (mesh.indices.empty())
+            return;
+
+        mesh.lods.push_back({0, (uint32_t) mesh.indices.size(), 0.f});
+        std::vector<uint32_t> full = mesh.indices;
+        size_t previousCount = full.size();
+        for (uint32_t level = 1; level < maxLevels; level++) {
+            size_t target = (size_t) (previousCount * reduction) / 3 * 3;
+            float error;
+            //simplifying from the full mesh each time keeps the error relative to what is actually drawn at lod 0
+            std::vector<uint32_t> lod = simplify(mesh.vertices, full, target, targetError, error);
+            //stop once the error limit prevents meaningful savings
+            if (lod.empty() || lod.size() > previousCount * 0.9f)
+                break;
+
+            MeshOptimizer::optimizeVertexCache(lod, mesh.vertices.size());
+            mesh.lods.push_back({(uint32_t) mesh.indices.size(), (uint32_t) lod.size(), error});
+            mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+            previousCount = lod.size();
+        }
+    }
+
+}
@@ -1,4 +1,12 @@
 #include "ModelLoader.h"
+#include "MeshImporter.h"
+#include "MeshFile.h"
+#include "PakArchive.h"
+#include "PipelineCache.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <filesystem>
 
 namespace SGE {
     entt::registry *ModelLoader::m_registry;
@@ -8,21 +16,36 @@ namespace SGE {
     ModelLoader::ModelLoader(entt::registry *registry) {
         m_registry = registry;
         m_deviceClass = DeviceClass::getInstance();
+        //starts with room for a million vertices and indices and doubles from there
+        geometryPool = std::make_unique<GeometryPool>(m_deviceClass->m_pDevice, 1 << 20, 1 << 20);
+
+        //optional, without an archive every mesh is read from its own file
+        std::error_code ec;
+        std::string error;
+        if (std::filesystem::exists(pakPath, ec) && !PakArchive::getInstance()->open(pakPath, error))
+            Logger::getInstance()->writeToLog(error);
     }
 
     bool ModelLoader::loadShader(const std::string &loc) {
+        return loadShader(loc, 0);
+    }
+
+    bool ModelLoader::loadShader(const std::string &loc, uint32_t id) {
         YAML::Node original;
         try {
-            original = YAML::LoadFile("data/models" + loc);
-        } catch (YAML::ParserException &e) {
+            original = YAML::LoadFile(modelPath(loc));
+        } catch (YAML::Exception &e) {
             boxer::show(e.what(), "Error loading shader");
             return false;
         }
 
         YAML::Node node = original["ShaderProgram"];
-        uint32_t id = node["PregenID"].as<uint32_t>();
+        if (node["PregenID"])
+            id = node["PregenID"].as<uint32_t>();
 
-        if (meshStorage.find(id) == meshStorage.end()) {
+        //immediate mode drawers such as the debug lines write their own vertices every frame and have no mesh
+        bool immediate = node["Immediate"] && node["Immediate"].as<bool>();
+        if (!immediate && meshStorage.find(id) == meshStorage.end()) {
             boxer::show(("You must call loadMesh first for " + loc).c_str(), "Shader Program Error");
             return false;
         }
@@ -31,52 +54,35 @@ namespace SGE {
 
         std::string fs = node["FragmentShader"].as<std::string>();
 
-        Program prgm {programStorage[id].first, programStorage[id].second};
-
-        Diligent::GraphicsPipelineStateCreateInfo psoCreateInfo;
-        psoCreateInfo.PSODesc.Name = loc.c_str();
-        psoCreateInfo.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_GRAPHICS;
-        psoCreateInfo.GraphicsPipeline.NumRenderTargets = 1;
+        PipelineDesc pipelineDesc;
+        pipelineDesc.name = loc;
+        pipelineDesc.vertexShader.type = Diligent::SHADER_TYPE_VERTEX;
+        pipelineDesc.vertexShader.name = vs;
+        pipelineDesc.pixelShader.type = Diligent::SHADER_TYPE_PIXEL;
+        pipelineDesc.pixelShader.name = fs;
+        if (!PipelineCache::readSource("shaders/" + vs + ".vsh", pipelineDesc.vertexShader.source) ||
+            !PipelineCache::readSource("shaders/" + fs + ".psh", pipelineDesc.pixelShader.source)) {
+            boxer::show(("Could not read the shaders of " + loc).c_str(), "Shader Program Error");
+            return false;
+        }
         auto &desc = m_deviceClass->m_pSwapChain->GetDesc();
-        psoCreateInfo.GraphicsPipeline.RTVFormats[0] = desc.ColorBufferFormat;
-        psoCreateInfo.GraphicsPipeline.DSVFormat = desc.DepthBufferFormat;
-        psoCreateInfo.GraphicsPipeline.PrimitiveTopology = Diligent::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        psoCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = Diligent::CULL_MODE_BACK;
-        psoCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = true;
-
-        Diligent::ShaderCreateInfo shaderCI;
-        shaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_HLSL;
-        shaderCI.UseCombinedTextureSamplers = true;
-
-        Diligent::RefCntAutoPtr<Diligent::IShaderSourceInputStreamFactory> shaderSourceFactory;
-        m_deviceClass->m_pDevice->GetEngineFactory()->CreateDefaultShaderSourceStreamFactory(nullptr, &shaderSourceFactory);
-        shaderCI.pShaderSourceStreamFactory = shaderSourceFactory;
-
-        Diligent::RefCntAutoPtr<Diligent::IShader> pVS;
-        shaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_VERTEX;
-        shaderCI.EntryPoint = "main";
-        shaderCI.Desc.Name = vs.c_str();
-        shaderCI.FilePath = ("shaders/" + vs + ".vsh").c_str();
-        m_deviceClass->m_pDevice->CreateShader(shaderCI, &pVS);
-        if (node["UseModelViewProj"].as<bool>()) {
+        pipelineDesc.rtvFormat = desc.ColorBufferFormat;
+        pipelineDesc.dsvFormat = desc.DepthBufferFormat;
+
+        //one buffer for every shader, the renderer writes the camera into it once per frame
+        bool useConstants = node["UseModelViewProj"].as<bool>();
+        if (useConstants && !frameConstants) {
             Diligent::BufferDesc cbDesc;
             cbDesc.Name = "Model View Projection Matrix";
             cbDesc.Size = sizeof(float) * 16;
-            cbDesc.Usage = Diligent::USAGE_DYNAMIC;
+            //written with UpdateBuffer, dynamic buffers mapped on the immediate context cannot be read by deferred ones
+            cbDesc.Usage = Diligent::USAGE_DEFAULT;
             cbDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
-            cbDesc.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
-            m_deviceClass->m_pDevice->CreateBuffer(cbDesc, nullptr, &projMatrixStorage[id]);
+            m_deviceClass->m_pDevice->CreateBuffer(cbDesc, nullptr, &frameConstants);
         }
 
-        Diligent::RefCntAutoPtr<Diligent::IShader> pPS;
-        shaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_PIXEL;
-        shaderCI.EntryPoint = "main";
-        shaderCI.Desc.Name = fs.c_str();
-        shaderCI.FilePath = ("shader/" + vs + ".psh").c_str();
-        m_deviceClass->m_pDevice->CreateShader(shaderCI, &pPS);
-
         int size = node["LayoutElements"].size();
-        std::vector<Diligent::LayoutElement> layoutElements(size / 2);
+        pipelineDesc.layout.resize(size / 2);
         for (int i = 0; i < size; i += 2) {
             Diligent::VALUE_TYPE vt;
             std::string name = node["LayoutElements"][i].as<std::string>();
@@ -98,20 +104,67 @@ namespace SGE {
                 vt = Diligent::VT_UINT32;
             }
 
-            layoutElements[i / 2] = {(uint32_t) i / 2, 0, node["LayoutElements"][i + 1].as<uint32_t>(), vt, false};
+            pipelineDesc.layout[i / 2] = {(uint32_t) i / 2, 0, node["LayoutElements"][i + 1].as<uint32_t>(), vt, false};
+        }
+
+        //instanced shaders read a world matrix per instance from the second vertex buffer, as four float4 rows
+        if (node["Instanced"] && node["Instanced"].as<bool>()) {
+            uint32_t first = (uint32_t) pipelineDesc.layout.size();
+            for (uint32_t row = 0; row < 4; row++) {
+                pipelineDesc.layout.emplace_back(first + row, 1, 4, Diligent::VT_FLOAT32, false,
+                                                 Diligent::INPUT_ELEMENT_FREQUENCY_PER_INSTANCE);
+            }
+        }
+
+        //lines take two vertices each, anything else is a triangle list
+        if (node["Topology"] && node["Topology"].as<std::string>() == "lines")
+            pipelineDesc.topology = Diligent::PRIMITIVE_TOPOLOGY_LINE_LIST;
+
+        //flat sprites are seen from either side and drawn in queue order rather than by depth
+        if (node["CullMode"]) {
+            std::string cull = node["CullMode"].as<std::string>();
+            if (cull == "none")
+                pipelineDesc.cullMode = Diligent::CULL_MODE_NONE;
+            else if (cull == "front")
+                pipelineDesc.cullMode = Diligent::CULL_MODE_FRONT;
+        }
+        if (node["DepthTest"] && !node["DepthTest"].as<bool>()) {
+            pipelineDesc.depthEnable = false;
+            pipelineDesc.depthWrite = false;
         }
+        if (node["Textures"])
+            pipelineDesc.textures = node["Textures"].as<std::vector<std::string>>();
 
-        psoCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = layoutElements.data();
-        psoCreateInfo.GraphicsPipeline.InputLayout.NumElements = layoutElements.size();
-        psoCreateInfo.pVS = pVS;
-        psoCreateInfo.pPS = pPS;
-        psoCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
-        m_deviceClass->m_pDevice->CreateGraphicsPipelineState(psoCreateInfo, &prgm.shaderPointer);
-        if (projMatrixStorage.find(id) != projMatrixStorage.end()) {
+        if (!pipelineCache) {
+            pipelineDevice = std::make_unique<DiligentPipelineDevice>(m_deviceClass->m_pDevice);
+            pipelineCache = std::make_unique<PipelineCache>(pipelineDevice.get(), "data/cache/shaders");
+        }
+
+        Program prgm;
+        std::string error;
+        if (!pipelineCache->getPipeline(pipelineDesc, prgm.shaderPointer, error)) {
+            boxer::show(error.c_str(), "Shader Program Error");
+            return false;
+        }
+        //the pipeline may be shared with other meshes, the static constants are copied into this mesh's binding
+        //when it is created below so setting them here does not disturb bindings made earlier
+        if (useConstants) {
             prgm.shaderPointer->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "Constants")->Set(
-                    projMatrixStorage[id]);
+                    frameConstants);
         }
         prgm.shaderPointer->CreateShaderResourceBinding(&prgm.shaderBinding, true);
+        programStorage[id] = {prgm.shaderPointer, prgm.shaderBinding};
+        programGenerations[id]++;
+        for (uint32_t sharer: programSharers[id]) {
+            programStorage[sharer] = programStorage[id];
+            programGenerations[sharer]++;
+        }
+        ShaderDescription &description = shaderDescriptions[loc];
+        description.file = modelPath(loc);
+        description.vertexShader = vs;
+        description.pixelShader = fs;
+        if (std::find(description.ids.begin(), description.ids.end(), id) == description.ids.end())
+            description.ids.push_back(id);
         return true;
     }
 
@@ -129,38 +182,123 @@ namespace SGE {
             return modelLoader.get();
     }
 
+    bool ModelLoader::readMesh(const std::string &loc, uint32_t &id, MeshComponent &mesh, std::string &error) {
+        //meshes converted by the AssetCooker skip parsing and optimization entirely, the archive is checked first
+        //since it needs neither a file open nor a copy for uncompressed entries
+        PakArchive *archive = PakArchive::getInstance();
+        if (const PakEntry *entry = archive->find("models/" + loc + ".mesh")) {
+            const char *data;
+            size_t size;
+            if (archive->view(*entry, data, size))
+                return MeshFile::read(data, size, mesh, error);
+            std::vector<char> buffer;
+            return archive->read(*entry, buffer, error) && MeshFile::read(buffer.data(), buffer.size(), mesh, error);
+        }
+
+        std::string cooked = "data/cooked/models/" + loc + ".mesh";
+        std::error_code ec;
+        if (std::filesystem::exists(cooked, ec) && MeshFile::read(cooked, mesh, error))
+            return true;
+
+        std::string report;
+        if (!MeshImporter::read(modelPath(loc), id, mesh, error, report))
+            return false;
+        if (!report.empty())
+            Logger::getInstance()->writeToLog(report);
+        return true;
+    }
+
+    void ModelLoader::prefetchMesh(const std::string &loc) {
+        PakArchive *archive = PakArchive::getInstance();
+        if (const PakEntry *entry = archive->find("models/" + loc + ".mesh"))
+            archive->prefetch(*entry);
+    }
+
     bool ModelLoader::loadMesh(const std::string &loc) {
-        YAML::Node original;
-        try {
-            original = YAML::LoadFile("data/models" + loc);
-        } catch (YAML::ParserException &e) {
-            boxer::show(e.what(), "Error loading mesh");
+        return loadMesh(loc, 0);
+    }
+
+    bool ModelLoader::loadMesh(const std::string &loc, uint32_t id) {
+        MeshComponent mesh;
+        std::string error;
+        if (!readMesh(loc, id, mesh, error)) {
+            boxer::show(error.c_str(), "Error loading mesh");
             return false;
         }
 
-        YAML::Node node = original["Mesh"];
+        addMesh(id, std::move(mesh));
+        auto &ids = meshFiles[modelPath(loc)];
+        if (std::find(ids.begin(), ids.end(), id) == ids.end())
+            ids.push_back(id);
+        return true;
+    }
 
-        uint32_t id = node["PregenID"].as<uint32_t>();
-        auto &mesh = meshStorage[id];
+    void ModelLoader::replaceMesh(uint32_t id, MeshComponent &&mesh, const std::string &name) {
+        addMesh(id, std::move(mesh));
+        //only buffers that were uploaded before are rebuilt, streamed meshes upload on their own schedule
+        if (geometryPool->hasVertices(id))
+            createVertexBuffer(id, name);
+        if (geometryPool->hasIndices(id))
+            createIndexBuffer(id, name);
+    }
 
-        int verticesCount = node["NumVerts"].as<int>();
-        mesh.vertices.reserve(verticesCount);
+    std::vector<uint32_t> ModelLoader::findMeshIds(const std::string &path) const {
+        auto it = meshFiles.find(path);
+        return it == meshFiles.end() ? std::vector<uint32_t>() : it->second;
+    }
 
-        int length = node["NumIndices"].as<int>();
-        mesh.indices.reserve(length);
+    std::vector<std::string> ModelLoader::findShaderDescriptions(const std::string &path) const {
+        std::filesystem::path file(path);
+        std::string extension = file.extension().string();
+        std::string stem = file.stem().string();
 
-//        mesh.vertices = node["Vertices"].as<std::vector<Vertex>>();
-        std::vector<float> temp = node["Vertices"].as<std::vector<float>>();
-        mesh.vertices;
+        std::vector<std::string> locs;
+        for (const auto &[loc, description]: shaderDescriptions) {
+            if (description.file == path || (extension == ".vsh" && description.vertexShader == stem) ||
+                (extension == ".psh" && description.pixelShader == stem))
+                locs.push_back(loc);
+        }
+        return locs;
+    }
 
-        mesh.indices = node["Indices"].as<std::vector<unsigned short>>();
-        return true;
+    std::vector<uint32_t> ModelLoader::getShaderIds(const std::string &loc) const {
+        auto it = shaderDescriptions.find(loc);
+        return it == shaderDescriptions.end() ? std::vector<uint32_t>() : it->second.ids;
+    }
+
+    std::string ModelLoader::normalizePath(const std::string &path) {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    std::string ModelLoader::modelPath(const std::string &loc) {
+        return normalizePath("data/models/" + loc);
+    }
+
+    void ModelLoader::addMesh(uint32_t id, MeshComponent &&mesh) {
+        meshStorage[id] = std::move(mesh);
+    }
+
+    void ModelLoader::unloadMesh(uint32_t id) {
+        meshStorage.erase(id);
+        geometryPool->release(id);
+    }
+
+    bool ModelLoader::hasMesh(uint32_t id) const {
+        return meshStorage.find(id) != meshStorage.end();
+    }
+
+    void ModelLoader::attachMesh(entt::entity entity, uint32_t id) {
+        auto &mesh = meshStorage[id];
+        auto &instance = m_registry->emplace_or_replace<MeshInstance>(entity);
+        instance.meshId = id;
+        instance.lodCount = std::max<uint32_t>(1, (uint32_t) mesh.lods.size());
+        MeshOptimizer::computeBounds(mesh, m_registry->get_or_emplace<Bounds>(entity));
     }
 
     bool ModelLoader::loadVertexBuffer(const std::string &loc) {
         YAML::Node original;
         try {
-            original = YAML::LoadFile("data/models" + loc);
+            original = YAML::LoadFile(modelPath(loc));
         } catch (YAML::ParserException &e) {
             boxer::show(e.what(), "Error loading vertex buffer");
             return false;
@@ -174,25 +312,21 @@ namespace SGE {
             return false;
         }
 
-        auto &ref = vbStorage[id];
-        auto &mesh = meshStorage[id];
-        Diligent::BufferDesc VertBuffDesc;
-        VertBuffDesc.Name = loc.c_str();
-        VertBuffDesc.Usage = Diligent::USAGE_IMMUTABLE;
-        VertBuffDesc.BindFlags = Diligent::BIND_VERTEX_BUFFER;
-        VertBuffDesc.Size = mesh.vertices.size() * sizeof(Vertex);
-        Diligent::BufferData VBData;
-        VBData.pData = mesh.vertices.data();
-        VBData.DataSize = mesh.vertices.size() * sizeof(Vertex);
-        m_deviceClass->m_pDevice->CreateBuffer(VertBuffDesc, &VBData, &ref);
+        return createVertexBuffer(id, loc);
+    }
 
+    bool ModelLoader::createVertexBuffer(uint32_t id, const std::string &name) {
+        if (!geometryPool->uploadVertices(m_deviceClass->m_pImmediateContext, id, meshStorage[id])) {
+            Logger::getInstance()->writeToLog("Error, no room in the geometry pool for the vertices of " + name);
+            return false;
+        }
         return true;
     }
 
     bool ModelLoader::loadIndexBuffer(const std::string &loc) {
         YAML::Node original;
         try {
-            original = YAML::LoadFile("data/models" + loc);
+            original = YAML::LoadFile(modelPath(loc));
         } catch (YAML::ParserException &e) {
             boxer::show(e.what(), "Error loading index buffer");
             return false;
@@ -206,18 +340,14 @@ namespace SGE {
             return false;
         }
 
-        auto &ref = ibStorage[id];
-        auto &mesh = meshStorage[id];
-        Diligent::BufferDesc IndBuffDesc;
-        IndBuffDesc.Name = loc.c_str();
-        IndBuffDesc.Usage = Diligent::USAGE_IMMUTABLE;
-        IndBuffDesc.BindFlags = Diligent::BIND_INDEX_BUFFER;
-        IndBuffDesc.Size = mesh.indices.size() * sizeof(short);
-        Diligent::BufferData IBData;
-        IBData.pData = mesh.indices.data();
-        IBData.DataSize = mesh.indices.size() * sizeof(short);
-        m_deviceClass->m_pDevice->CreateBuffer(IndBuffDesc, &IBData, &ref);
+        return createIndexBuffer(id, loc);
+    }
 
+    bool ModelLoader::createIndexBuffer(uint32_t id, const std::string &name) {
+        if (!geometryPool->uploadIndices(m_deviceClass->m_pImmediateContext, id, meshStorage[id])) {
+            Logger::getInstance()->writeToLog("Error, no room in the geometry pool for the indices of " + name);
+            return false;
+        }
         return true;
     }
 
@@ -226,19 +356,55 @@ namespace SGE {
     }
 
     VertexBuffer ModelLoader::getVertexBuffer(uint32_t id) {
-        return {vbStorage[id]};
+        return {geometryPool->getVertexBuffer()};
     }
 
     IndexBuffer ModelLoader::getIndexBuffer(uint32_t id) {
-        return {ibStorage[id]};
+        const GeometryAllocation *allocation = geometryPool->find(id);
+        Diligent::VALUE_TYPE indexType = allocation != nullptr ? allocation->indexType : Diligent::VT_UINT16;
+        return {geometryPool->getIndexBuffer(indexType), indexType};
+    }
+
+    GeometryAllocation ModelLoader::getGeometry(uint32_t id) const {
+        const GeometryAllocation *allocation = geometryPool->find(id);
+        return allocation != nullptr ? *allocation : GeometryAllocation();
+    }
+
+    void ModelLoader::compactGeometry(float threshold) {
+        geometryPool->defragment(m_deviceClass->m_pImmediateContext, threshold);
     }
 
     Program ModelLoader::getShaderProgram(uint32_t id) {
         return {programStorage[id].first, programStorage[id].second};
     }
 
-    ModelViewProjMatrix ModelLoader::getProjectionMatrix(uint32_t id) {
-        return {projMatrixStorage[id]};
+    bool ModelLoader::shareShaderProgram(uint32_t id, uint32_t source) {
+        if (!hasShaderProgram(source))
+            return false;
+        programStorage[id] = programStorage[source];
+        programGenerations[id]++;
+        std::vector<uint32_t> &sharers = programSharers[source];
+        if (std::find(sharers.begin(), sharers.end(), id) == sharers.end())
+            sharers.push_back(id);
+        return true;
+    }
+
+    uint32_t ModelLoader::getProgramGeneration(uint32_t id) const {
+        auto it = programGenerations.find(id);
+        return it != programGenerations.end() ? it->second : 0;
+    }
+
+    bool ModelLoader::hasShaderProgram(uint32_t id) const {
+        auto it = programStorage.find(id);
+        return it != programStorage.end() && it->second.first != nullptr;
+    }
+
+    bool ModelLoader::hasGpuMesh(uint32_t id) const {
+        return geometryPool->hasVertices(id) && geometryPool->hasIndices(id);
+    }
+
+    ModelViewProjMatrix ModelLoader::getFrameConstants() const {
+        return {frameConstants};
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,402 @@
+#include "PakArchive.h"
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#if PLATFORM_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SGE {
+
+    std::unique_ptr<PakArchive> PakArchive::pakArchive;
+
+    namespace {
+        constexpr uint32_t maxBucketBits = 20;
+
+        uint32_t bucketOf(uint64_t hash, uint32_t bucketBits) {
+            return bucketBits == 0 ? 0 : (uint32_t) (hash >> (64 - bucketBits));
+        }
+
+        uint64_t alignUp(uint64_t value, uint64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        bool writePadding(std::FILE *file, uint64_t from, uint64_t to) {
+            static const char zeros[PakArchive::alignment] = {};
+            while (from < to) {
+                size_t count = (size_t) std::min<uint64_t>(to - from, sizeof(zeros));
+                if (std::fwrite(zeros, 1, count, file) != count)
+                    return false;
+                from += count;
+            }
+            return true;
+        }
+    }
+
+    PakArchive *PakArchive::getInstance() {
+        if (!pakArchive) {
+            pakArchive = std::make_unique<PakArchive>();
+        }
+        return pakArchive.get();
+    }
+
+    PakArchive::~PakArchive() {
+        close();
+    }
+
+    uint64_t PakArchive::hashName(std::string_view name) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c: name) {
+            hash = (hash ^ (unsigned char) c) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool PakArchive::open(const std::string &path, std::string &error) {
+        close();
+
+#if PLATFORM_WIN32
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            m_file = nullptr;
+            error = "Could not open " + path;
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(m_file, &fileSize);
+        m_size = (uint64_t) fileSize.QuadPart;
+        m_mapping = m_size > 0 ? CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        if (m_mapping != nullptr)
+            m_data = (const char *) MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "Could not open " + path;
+            return false;
+        }
+        struct stat info{};
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            m_size = (uint64_t) info.st_size;
+            void *mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            m_data = mapped == MAP_FAILED ? nullptr : (const char *) mapped;
+        }
+        //the mapping keeps the file alive on its own
+        ::close(fd);
+#endif
+        if (m_data == nullptr) {
+            close();
+            error = "Could not map " + path;
+            return false;
+        }
+
+        PakHeader header;
+        PakHeader expected;
+        if (m_size < sizeof(header)) {
+            close();
+            error = path + " is truncated";
+            return false;
+        }
+        std::memcpy(&header, m_data, sizeof(header));
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version) {
+            close();
+            error = path + " is not a version " + std::to_string(expected.version) + " pak archive";
+            return false;
+        }
+
+        uint64_t bucketBytes = ((uint64_t(1) << header.bucketBits) + 1) * sizeof(uint32_t);
+        uint64_t entriesOffset = alignUp(bucketBytes, 8);
+        uint64_t entryBytes = (uint64_t) header.entryCount * sizeof(PakEntry);
+        if (header.bucketBits > maxBucketBits || header.tocOffset > m_size || header.tocSize > m_size - header.tocOffset ||
+            entriesOffset + entryBytes > header.tocSize) {
+            close();
+            error = path + " has a corrupt table of contents";
+            return false;
+        }
+
+        //the table is copied out so lookups never fault pages in, the entry data stays in the mapping
+        const char *toc = m_data + header.tocOffset;
+        m_bucketBits = header.bucketBits;
+        m_buckets.resize((size_t(1) << header.bucketBits) + 1);
+        std::memcpy(m_buckets.data(), toc, bucketBytes);
+        m_entries.resize(header.entryCount);
+        std::memcpy(m_entries.data(), toc + entriesOffset, entryBytes);
+        m_names.assign(toc + entriesOffset + entryBytes, header.tocSize - entriesOffset - entryBytes);
+
+        //lookups index the entries with the bucket bounds, they have to rise steadily up to the entry count
+        bool valid = m_buckets.back() == header.entryCount;
+        for (size_t i = 0; i + 1 < m_buckets.size(); i++) {
+            valid = valid && m_buckets[i] <= m_buckets[i + 1];
+        }
+        for (const auto &entry: m_entries) {
+            valid = valid && entry.offset <= header.tocOffset && entry.storedSize <= header.tocOffset - entry.offset &&
+                    ((entry.flags & PakCompressed) != 0 || entry.size == entry.storedSize) &&
+                    (uint64_t) entry.nameOffset + entry.nameLength <= m_names.size();
+        }
+        if (!valid) {
+            close();
+            error = path + " has a corrupt table of contents";
+            return false;
+        }
+        return true;
+    }
+
+    void PakArchive::close() {
+#if PLATFORM_WIN32
+        if (m_data != nullptr)
+            UnmapViewOfFile(m_data);
+        if (m_mapping != nullptr)
+            CloseHandle(m_mapping);
+        if (m_file != nullptr)
+            CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = nullptr;
+#else
+        if (m_data != nullptr)
+            munmap((void *) m_data, m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+        m_bucketBits = 0;
+        m_buckets.clear();
+        m_entries.clear();
+        m_names.clear();
+    }
+
+    bool PakArchive::isOpen() const {
+        return m_data != nullptr;
+    }
+
+    const PakEntry *PakArchive::find(std::string_view name) const {
+        if (!isOpen())
+            return nullptr;
+
+        uint64_t hash = hashName(name);
+        uint32_t bucket = bucketOf(hash, m_bucketBits);
+        for (uint32_t i = m_buckets[bucket]; i < m_buckets[bucket + 1]; i++) {
+            const PakEntry &entry = m_entries[i];
+            if (entry.hash == hash && getName(entry) == name)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    std::string_view PakArchive::getName(const PakEntry &entry) const {
+        return std::string_view(m_names).substr(entry.nameOffset, entry.nameLength);
+    }
+
+    const std::vector<PakEntry> &PakArchive::getEntries() const {
+        return m_entries;
+    }
+
+    bool PakArchive::view(const PakEntry &entry, const char *&data, size_t &size) const {
+        if (!isOpen() || (entry.flags & PakCompressed) != 0)
+            return false;
+        data = m_data + entry.offset;
+        size = (size_t) entry.size;
+        return true;
+    }
+
+    bool PakArchive::read(const PakEntry &entry, std::vector<char> &out, std::string &error) const {
+        if (!isOpen()) {
+            error = "Pak archive is not open";
+            return false;
+        }
+
+        out.resize((size_t) entry.size);
+        const char *stored = m_data + entry.offset;
+        if ((entry.flags & PakCompressed) == 0) {
+            std::memcpy(out.data(), stored, out.size());
+            return true;
+        }
+        if (!BlockCompression::decompress((const uint8_t *) stored, (size_t) entry.storedSize, (uint8_t *) out.data(),
+                                          out.size())) {
+            error = "Corrupt compressed entry " + std::string(getName(entry));
+            return false;
+        }
+        return true;
+    }
+
+    bool PakArchive::read(std::string_view name, std::vector<char> &out, std::string &error) const {
+        const PakEntry *entry = find(name);
+        if (entry == nullptr) {
+            error = "No entry " + std::string(name) + " in pak archive";
+            return false;
+        }
+        return read(*entry, out, error);
+    }
+
+    void PakArchive::prefetch(const PakEntry &entry) const {
+        prefetch(entry, 0, entry.storedSize);
+    }
+
+    void PakArchive::prefetch(const PakEntry &entry, uint64_t offset, uint64_t size) const {
+        if (!isOpen() || offset >= entry.storedSize)
+            return;
+        size = std::min(size, entry.storedSize - offset);
+        //entries are page aligned already, only the offset inside the entry needs rounding down
+        uint64_t start = entry.offset + offset / alignment * alignment;
+        uint64_t length = entry.offset + offset + size - start;
+#if PLATFORM_WIN32
+        WIN32_MEMORY_RANGE_ENTRY range{(PVOID) (m_data + start), (SIZE_T) length};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+        madvise((void *) (m_data + start), length, MADV_WILLNEED);
+#endif
+    }
+
+    PakStream::PakStream(const PakArchive &archive, const PakEntry &entry) : m_archive(archive), m_entry(entry) {
+        size_t size;
+        if (m_archive.view(m_entry, m_data, size))
+            return;
+
+        std::string error;
+        m_failed = !m_archive.read(m_entry, m_decoded, error);
+        m_data = m_decoded.data();
+    }
+
+    size_t PakStream::read(char *out, size_t size) {
+        if (m_failed)
+            return 0;
+
+        size = (size_t) std::min<uint64_t>(size, remaining());
+        if (m_decoded.empty() && m_cursor + size + readAhead > m_prefetched) {
+            //stay one window ahead so the copy below rarely waits on a page fault
+            uint64_t from = std::max(m_prefetched, m_cursor);
+            uint64_t to = m_cursor + size + readAhead * 2;
+            m_archive.prefetch(m_entry, from, to - from);
+            m_prefetched = to;
+        }
+        std::memcpy(out, m_data + m_cursor, size);
+        m_cursor += size;
+        return size;
+    }
+
+    uint64_t PakStream::remaining() const {
+        return m_entry.size - m_cursor;
+    }
+
+    bool PakStream::failed() const {
+        return m_failed;
+    }
+
+    void PakWriter::add(const std::string &name, std::vector<char> data, bool compress) {
+        Pending pending;
+        pending.name = name;
+        pending.size = data.size();
+        if (compress && !data.empty()) {
+            std::vector<char> compressed(BlockCompression::compressBound(data.size()));
+            size_t compressedSize = BlockCompression::compress((const uint8_t *) data.data(), data.size(),
+                                                               (uint8_t *) compressed.data(), compressed.size());
+            if (compressedSize > 0 && compressedSize <= data.size() - data.size() / 8) {
+                compressed.resize(compressedSize);
+                data = std::move(compressed);
+                pending.compressed = true;
+            }
+        }
+        pending.data = std::move(data);
+        m_pending.push_back(std::move(pending));
+    }
+
+    bool PakWriter::write(const std::string &path, std::string &error) const {
+        std::vector<PakEntry> entries(m_pending.size());
+        std::vector<size_t> order(m_pending.size());
+        std::string names;
+        for (size_t i = 0; i < m_pending.size(); i++) {
+            entries[i].hash = PakArchive::hashName(m_pending[i].name);
+            entries[i].size = m_pending[i].size;
+            entries[i].storedSize = m_pending[i].data.size();
+            entries[i].flags = m_pending[i].compressed ? PakCompressed : 0;
+            entries[i].nameOffset = (uint32_t) names.size();
+            entries[i].nameLength = (uint32_t) m_pending[i].name.size();
+            names += m_pending[i].name;
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return entries[a].hash < entries[b].hash;
+        });
+        for (size_t i = 1; i < order.size(); i++) {
+            if (m_pending[order[i]].name == m_pending[order[i - 1]].name) {
+                error = "Duplicate pak entry " + m_pending[order[i]].name;
+                return false;
+            }
+        }
+
+        //roughly one entry per bucket
+        PakHeader header;
+        header.entryCount = (uint32_t) entries.size();
+        while (header.bucketBits < maxBucketBits && (size_t(1) << header.bucketBits) < entries.size()) {
+            header.bucketBits++;
+        }
+
+        //written under a temporary name and renamed over the archive at the end. A running engine keeps the old one
+        //mapped, truncating it in place would fault every page it touches afterwards
+        std::string temporary = path + ".tmp";
+        std::FILE *file = std::fopen(temporary.c_str(), "wb");
+        if (file == nullptr) {
+            error = "Could not open " + temporary + " for writing";
+            return false;
+        }
+
+        //the header is written last so a partially written archive never validates
+        bool ok = writePadding(file, 0, sizeof(header));
+        uint64_t position = sizeof(header);
+        std::vector<PakEntry> sorted;
+        sorted.reserve(entries.size());
+        for (size_t index: order) {
+            PakEntry entry = entries[index];
+            entry.offset = alignUp(position, PakArchive::alignment);
+            const auto &data = m_pending[index].data;
+            ok = ok && writePadding(file, position, entry.offset);
+            ok = ok && std::fwrite(data.data(), 1, data.size(), file) == data.size();
+            position = entry.offset + data.size();
+            sorted.push_back(entry);
+        }
+
+        std::vector<uint32_t> buckets((size_t(1) << header.bucketBits) + 1);
+        uint32_t next = 0;
+        for (uint32_t bucket = 0; bucket < buckets.size(); bucket++) {
+            while (next < sorted.size() && bucketOf(sorted[next].hash, header.bucketBits) < bucket) {
+                next++;
+            }
+            buckets[bucket] = next;
+        }
+        buckets.back() = (uint32_t) sorted.size();
+
+        header.tocOffset = alignUp(position, 8);
+        uint64_t bucketBytes = buckets.size() * sizeof(uint32_t);
+        header.tocSize = alignUp(bucketBytes, 8) + sorted.size() * sizeof(PakEntry) + names.size();
+        ok = ok && writePadding(file, position, header.tocOffset);
+        ok = ok && std::fwrite(buckets.data(), 1, bucketBytes, file) == bucketBytes;
+        ok = ok && writePadding(file, bucketBytes, alignUp(bucketBytes, 8));
+        ok = ok && std::fwrite(sorted.data(), sizeof(PakEntry), sorted.size(), file) == sorted.size();
+        ok = ok && std::fwrite(names.data(), 1, names.size(), file) == names.size();
+
+        ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = std::fclose(file) == 0 && ok;
+        std::error_code ec;
+        if (!ok) {
+            std::filesystem::remove(temporary, ec);
+            error = "Failed to write " + temporary;
+            return false;
+        }
+        std::filesystem::rename(temporary, path, ec);
+        if (ec) {
+            std::filesystem::remove(temporary, ec);
+            error = "Could not replace " + path;
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,197 @@
+#include "Particles.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define SGE_PARTICLES_SSE
+#include <emmintrin.h>
+#endif
+
+namespace SGE {
+
+    namespace {
+        //every lane count used below divides this
+        constexpr size_t padding = 8;
+
+        size_t padded(size_t count) {
+            return (count + padding - 1) / padding * padding;
+        }
+
+        //runs task on [first, last) ranges of at most chunkSize covering [0, count), in parallel when there are several
+        template<typename Task>
+        void forEachChunk(size_t count, const Task &task) {
+            size_t chunkCount = (count + ParticlePool::chunkSize - 1) / ParticlePool::chunkSize;
+            if (chunkCount <= 1) {
+                task(0, count);
+                return;
+            }
+            std::vector<size_t> chunks(chunkCount);
+            std::iota(chunks.begin(), chunks.end(), 0);
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+                size_t first = chunk * ParticlePool::chunkSize;
+                task(first, std::min(first + ParticlePool::chunkSize, count));
+            });
+        }
+    }
+
+    ParticlePool::ParticlePool(uint32_t capacity, uint64_t seed) : capacity(capacity), state(seed | 1) {
+        for (auto *array: {&positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ, &age, &lifetime,
+                           &startSize}) {
+            array->assign(padded(capacity), 0.f);
+        }
+    }
+
+    uint32_t ParticlePool::spawn(uint32_t spawnCount, const ParticleSpawn &spawn) {
+        spawnCount = std::min(spawnCount, capacity - count);
+        for (uint32_t i = count; i < count + spawnCount; i++) {
+            positionX[i] = spawn.position.x;
+            positionY[i] = spawn.position.y;
+            positionZ[i] = spawn.position.z;
+            velocityX[i] = spawn.velocity.x + random() * spawn.spread;
+            velocityY[i] = spawn.velocity.y + random() * spawn.spread;
+            velocityZ[i] = spawn.velocity.z + random() * spawn.spread;
+            age[i] = 0.f;
+            lifetime[i] = spawn.lifetime;
+            startSize[i] = spawn.size;
+        }
+        count += spawnCount;
+        return spawnCount;
+    }
+
+    void ParticlePool::update(float dt, const glm::vec3 &gravity) {
+        //the padding past the last live particle is updated along with it, the kernels never need a scalar tail
+        forEachChunk(padded(count), [&](size_t first, size_t last) {
+            updateRange(first, last, dt, gravity);
+        });
+        removeDead();
+    }
+
+    void ParticlePool::writeInstances(InstanceData *instances) const {
+        forEachChunk(count, [&](size_t first, size_t last) {
+            writeRange(first, last, instances);
+        });
+    }
+
+    uint32_t ParticlePool::size() const {
+        return count;
+    }
+
+    uint32_t ParticlePool::getCapacity() const {
+        return capacity;
+    }
+
+    glm::vec3 ParticlePool::getPosition(uint32_t particle) const {
+        return {positionX[particle], positionY[particle], positionZ[particle]};
+    }
+
+    float ParticlePool::getAge(uint32_t particle) const {
+        return age[particle];
+    }
+
+    void ParticlePool::updateRange(size_t first, size_t last, float dt, const glm::vec3 &gravity) {
+        //semi implicit euler, the velocity is updated first and the position moves with the new one
+        float *px = positionX.data(), *py = positionY.data(), *pz = positionZ.data();
+        float *vx = velocityX.data(), *vy = velocityY.data(), *vz = velocityZ.data();
+        float *ages = age.data();
+#if defined(__AVX__)
+        const __m256 step = _mm256_set1_ps(dt);
+        const __m256 gx = _mm256_set1_ps(gravity.x * dt), gy = _mm256_set1_ps(gravity.y * dt);
+        const __m256 gz = _mm256_set1_ps(gravity.z * dt);
+        for (size_t i = first; i < last; i += 8) {
+            __m256 x = _mm256_add_ps(_mm256_loadu_ps(vx + i), gx);
+            __m256 y = _mm256_add_ps(_mm256_loadu_ps(vy + i), gy);
+            __m256 z = _mm256_add_ps(_mm256_loadu_ps(vz + i), gz);
+            _mm256_storeu_ps(vx + i, x);
+            _mm256_storeu_ps(vy + i, y);
+            _mm256_storeu_ps(vz + i, z);
+            _mm256_storeu_ps(px + i, _mm256_add_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(x, step)));
+            _mm256_storeu_ps(py + i, _mm256_add_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(y, step)));
+            _mm256_storeu_ps(pz + i, _mm256_add_ps(_mm256_loadu_ps(pz + i), _mm256_mul_ps(z, step)));
+            _mm256_storeu_ps(ages + i, _mm256_add_ps(_mm256_loadu_ps(ages + i), step));
+        }
+#elif defined(SGE_PARTICLES_SSE)
+        const __m128 step = _mm_set1_ps(dt);
+        const __m128 gx = _mm_set1_ps(gravity.x * dt), gy = _mm_set1_ps(gravity.y * dt);
+        const __m128 gz = _mm_set1_ps(gravity.z * dt);
+        for (size_t i = first; i < last; i += 4) {
+            __m128 x = _mm_add_ps(_mm_loadu_ps(vx + i), gx);
+            __m128 y = _mm_add_ps(_mm_loadu_ps(vy + i), gy);
+            __m128 z = _mm_add_ps(_mm_loadu_ps(vz + i), gz);
+            _mm_storeu_ps(vx + i, x);
+            _mm_storeu_ps(vy + i, y);
+            _mm_storeu_ps(vz + i, z);
+            _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(x, step)));
+            _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(y, step)));
+            _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(z, step)));
+            _mm_storeu_ps(ages + i, _mm_add_ps(_mm_loadu_ps(ages + i), step));
+        }
+#else
+        for (size_t i = first; i < last; i++) {
+            vx[i] += gravity.x * dt;
+            vy[i] += gravity.y * dt;
+            vz[i] += gravity.z * dt;
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            pz[i] += vz[i] * dt;
+            ages[i] += dt;
+        }
+#endif
+    }
+
+    void ParticlePool::writeRange(size_t first, size_t last, InstanceData *instances) const {
+        //translation times a uniform scale, column by column the way glm lays out a mat4. The output is the ring's
+        //staging memory that UniformRing::upload copies to the gpu right after, so it is written through the cache
+        //where that copy finds it, one aligned store per column.
+#if defined(__AVX__) || defined(SGE_PARTICLES_SSE)
+        if (((uintptr_t) instances & 15) == 0) {
+            for (size_t i = first; i < last; i++) {
+                float scale = startSize[i] * std::max(0.f, 1.f - age[i] / lifetime[i]);
+                auto *out = (float *) &instances[i].world;
+                _mm_store_ps(out, _mm_set_ps(0.f, 0.f, 0.f, scale));
+                _mm_store_ps(out + 4, _mm_set_ps(0.f, 0.f, scale, 0.f));
+                _mm_store_ps(out + 8, _mm_set_ps(0.f, scale, 0.f, 0.f));
+                _mm_store_ps(out + 12, _mm_set_ps(1.f, positionZ[i], positionY[i], positionX[i]));
+            }
+            return;
+        }
+#endif
+        for (size_t i = first; i < last; i++) {
+            float scale = startSize[i] * std::max(0.f, 1.f - age[i] / lifetime[i]);
+            glm::mat4 &world = instances[i].world;
+            world[0] = glm::vec4(scale, 0.f, 0.f, 0.f);
+            world[1] = glm::vec4(0.f, scale, 0.f, 0.f);
+            world[2] = glm::vec4(0.f, 0.f, scale, 0.f);
+            world[3] = glm::vec4(positionX[i], positionY[i], positionZ[i], 1.f);
+        }
+    }
+
+    void ParticlePool::removeDead() {
+        uint32_t i = 0;
+        while (i < count) {
+            if (age[i] < lifetime[i]) {
+                i++;
+                continue;
+            }
+            //the last particle moves into the hole and is checked in turn
+            count--;
+            for (auto *array: {&positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ, &age,
+                               &lifetime, &startSize}) {
+                (*array)[i] = (*array)[count];
+            }
+        }
+    }
+
+    float ParticlePool::random() {
+        //xorshift64*, the top 24 bits become a float in [-1, 1)
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        uint64_t bits = (state * 0x2545F4914F6CDD1Dull) >> 40;
+        return (float) bits / 8388608.f - 1.f;
+    }
+
+}
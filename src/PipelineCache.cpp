@@ -0,0 +1,285 @@
+#include "PipelineCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace SGE {
+
+    namespace {
+        constexpr uint64_t fnvOffset = 14695981039346656037ull;
+
+        uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+            auto *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        template<typename T>
+        uint64_t hashValue(uint64_t hash, const T &value) {
+            return hashBytes(hash, &value, sizeof(value));
+        }
+
+        uint64_t hashString(uint64_t hash, const std::string &value) {
+            //the length keeps "ab" + "c" apart from "a" + "bc"
+            return hashBytes(hashValue(hash, (uint64_t) value.size()), value.data(), value.size());
+        }
+    }
+
+    DiligentPipelineDevice::DiligentPipelineDevice(Diligent::IRenderDevice *device) : m_device(device) {
+        m_device->GetEngineFactory()->CreateDefaultShaderSourceStreamFactory(nullptr, &m_sourceFactory);
+    }
+
+    std::string DiligentPipelineDevice::getBackendName() const {
+        return "diligent-" + std::to_string((int) m_device->GetDeviceInfo().Type);
+    }
+
+    bool DiligentPipelineDevice::canLoadBytecode() const {
+        auto type = m_device->GetDeviceInfo().Type;
+        return type != Diligent::RENDER_DEVICE_TYPE_GL && type != Diligent::RENDER_DEVICE_TYPE_GLES;
+    }
+
+    bool DiligentPipelineDevice::compileShader(const ShaderSource &shader, std::vector<uint8_t> &bytecode,
+                                               std::string &error) {
+        if (!canLoadBytecode()) {
+            bytecode.assign(shader.source.begin(), shader.source.end());
+            return true;
+        }
+
+        Diligent::ShaderCreateInfo shaderCI;
+        shaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_HLSL;
+        shaderCI.UseCombinedTextureSamplers = true;
+        shaderCI.pShaderSourceStreamFactory = m_sourceFactory;
+        shaderCI.Source = shader.source.c_str();
+        shaderCI.EntryPoint = shader.entryPoint.c_str();
+        shaderCI.Desc.ShaderType = shader.type;
+        shaderCI.Desc.Name = shader.name.c_str();
+
+        Diligent::RefCntAutoPtr<Diligent::IShader> compiled;
+        m_device->CreateShader(shaderCI, &compiled);
+        if (!compiled) {
+            error = "Failed to compile shader " + shader.name;
+            return false;
+        }
+
+        const void *data = nullptr;
+        Diligent::Uint64 size = 0;
+        compiled->GetBytecode(&data, size);
+        if (data == nullptr || size == 0) {
+            error = "Shader " + shader.name + " has no bytecode";
+            return false;
+        }
+        bytecode.assign(static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+        return true;
+    }
+
+    bool DiligentPipelineDevice::createShader(Diligent::SHADER_TYPE type, const std::string &name,
+                                              const std::vector<uint8_t> &bytecode,
+                                              Diligent::RefCntAutoPtr<Diligent::IShader> &shader) {
+        Diligent::ShaderCreateInfo shaderCI;
+        shaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_HLSL;
+        shaderCI.UseCombinedTextureSamplers = true;
+        shaderCI.pShaderSourceStreamFactory = m_sourceFactory;
+        shaderCI.EntryPoint = "main";
+        shaderCI.Desc.ShaderType = type;
+        shaderCI.Desc.Name = name.c_str();
+
+        std::string source;
+        if (canLoadBytecode()) {
+            shaderCI.ByteCode = bytecode.data();
+            shaderCI.ByteCodeSize = bytecode.size();
+        } else {
+            source.assign(bytecode.begin(), bytecode.end());
+            shaderCI.Source = source.c_str();
+        }
+        m_device->CreateShader(shaderCI, &shader);
+        return shader != nullptr;
+    }
+
+    bool DiligentPipelineDevice::createPipeline(const PipelineDesc &desc, const std::vector<uint8_t> &vertexBytecode,
+                                                const std::vector<uint8_t> &pixelBytecode,
+                                                Diligent::RefCntAutoPtr<Diligent::IPipelineState> &pipeline,
+                                                std::string &error) {
+        Diligent::RefCntAutoPtr<Diligent::IShader> pVS;
+        Diligent::RefCntAutoPtr<Diligent::IShader> pPS;
+        if (!createShader(Diligent::SHADER_TYPE_VERTEX, desc.vertexShader.name, vertexBytecode, pVS) ||
+            !createShader(Diligent::SHADER_TYPE_PIXEL, desc.pixelShader.name, pixelBytecode, pPS)) {
+            error = "Failed to create the shaders of " + desc.name;
+            return false;
+        }
+
+        Diligent::GraphicsPipelineStateCreateInfo psoCreateInfo;
+        psoCreateInfo.PSODesc.Name = desc.name.c_str();
+        psoCreateInfo.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_GRAPHICS;
+        psoCreateInfo.GraphicsPipeline.NumRenderTargets = 1;
+        psoCreateInfo.GraphicsPipeline.RTVFormats[0] = desc.rtvFormat;
+        psoCreateInfo.GraphicsPipeline.DSVFormat = desc.dsvFormat;
+        psoCreateInfo.GraphicsPipeline.PrimitiveTopology = desc.topology;
+        psoCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = desc.cullMode;
+        psoCreateInfo.GraphicsPipeline.RasterizerDesc.FillMode = desc.fillMode;
+        psoCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = desc.depthEnable;
+        psoCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthWriteEnable = desc.depthWrite;
+        psoCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = desc.layout.data();
+        psoCreateInfo.GraphicsPipeline.InputLayout.NumElements = desc.layout.size();
+        psoCreateInfo.pVS = pVS;
+        psoCreateInfo.pPS = pPS;
+        psoCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
+
+        //textures are set on each binding instead of the pipeline, the samplers never change
+        std::vector<Diligent::ShaderResourceVariableDesc> variables;
+        std::vector<Diligent::ImmutableSamplerDesc> samplers;
+        //a default sampler filters linearly and clamps
+        Diligent::SamplerDesc linear;
+        for (const auto &texture: desc.textures) {
+            variables.emplace_back(Diligent::SHADER_TYPE_PIXEL, texture.c_str(),
+                                   Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE);
+            samplers.emplace_back(Diligent::SHADER_TYPE_PIXEL, texture.c_str(), linear);
+        }
+        psoCreateInfo.PSODesc.ResourceLayout.Variables = variables.data();
+        psoCreateInfo.PSODesc.ResourceLayout.NumVariables = (Diligent::Uint32) variables.size();
+        psoCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers = samplers.data();
+        psoCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = (Diligent::Uint32) samplers.size();
+        m_device->CreateGraphicsPipelineState(psoCreateInfo, &pipeline);
+        if (!pipeline) {
+            error = "Failed to create pipeline " + desc.name;
+            return false;
+        }
+        return true;
+    }
+
+    PipelineCache::PipelineCache(PipelineDevice *device, std::string directory) : m_device(device),
+                                                                                  m_directory(std::move(directory)) {
+        std::error_code ec;
+        std::filesystem::create_directories(m_directory, ec);
+    }
+
+    bool PipelineCache::readSource(const std::string &path, std::string &source) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        source.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    uint64_t PipelineCache::hashShader(const ShaderSource &shader) const {
+        uint64_t hash = hashString(fnvOffset, m_device->getBackendName());
+        hash = hashValue(hash, shader.type);
+        hash = hashString(hash, shader.entryPoint);
+        return hashString(hash, shader.source);
+    }
+
+    uint64_t PipelineCache::hashPipeline(const PipelineDesc &desc) const {
+        uint64_t hash = hashValue(fnvOffset, hashShader(desc.vertexShader));
+        hash = hashValue(hash, hashShader(desc.pixelShader));
+        //field by field, the element struct carries a semantic name pointer that must not be hashed
+        hash = hashValue(hash, (uint64_t) desc.layout.size());
+        for (const auto &element: desc.layout) {
+            hash = hashValue(hash, element.InputIndex);
+            hash = hashValue(hash, element.BufferSlot);
+            hash = hashValue(hash, element.NumComponents);
+            hash = hashValue(hash, element.ValueType);
+            hash = hashValue(hash, element.IsNormalized);
+            hash = hashValue(hash, element.RelativeOffset);
+            hash = hashValue(hash, element.Stride);
+            hash = hashValue(hash, element.Frequency);
+            hash = hashValue(hash, element.InstanceDataStepRate);
+        }
+        hash = hashValue(hash, desc.rtvFormat);
+        hash = hashValue(hash, desc.dsvFormat);
+        hash = hashValue(hash, desc.topology);
+        hash = hashValue(hash, desc.cullMode);
+        hash = hashValue(hash, desc.fillMode);
+        hash = hashValue(hash, desc.depthEnable);
+        hash = hashValue(hash, desc.depthWrite);
+        hash = hashValue(hash, (uint64_t) desc.textures.size());
+        for (const auto &texture: desc.textures) {
+            hash = hashString(hash, texture);
+        }
+        return hash;
+    }
+
+    bool PipelineCache::getPipeline(const PipelineDesc &desc, Diligent::RefCntAutoPtr<Diligent::IPipelineState> &pipeline,
+                                    std::string &error) {
+        uint64_t hash = hashPipeline(desc);
+        auto it = m_pipelines.find(hash);
+        if (it != m_pipelines.end()) {
+            m_pipelineHits++;
+            pipeline = it->second;
+            return true;
+        }
+
+        std::vector<uint8_t> vertexBytecode;
+        std::vector<uint8_t> pixelBytecode;
+        if (!getBytecode(desc.vertexShader, vertexBytecode, error) || !getBytecode(desc.pixelShader, pixelBytecode, error))
+            return false;
+        if (!m_device->createPipeline(desc, vertexBytecode, pixelBytecode, pipeline, error))
+            return false;
+
+        m_pipelines[hash] = pipeline;
+        return true;
+    }
+
+    bool PipelineCache::getBytecode(const ShaderSource &shader, std::vector<uint8_t> &bytecode, std::string &error) {
+        uint64_t hash = hashShader(shader);
+        auto it = m_bytecode.find(hash);
+        if (it != m_bytecode.end()) {
+            bytecode = it->second;
+            return true;
+        }
+
+        bool persistent = m_device->canLoadBytecode();
+        std::string path = getCachePath(hash);
+        if (persistent) {
+            std::ifstream file(path, std::ios::binary);
+            if (file) {
+                bytecode.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                if (!bytecode.empty()) {
+                    m_shaderDiskHits++;
+                    m_bytecode[hash] = bytecode;
+                    return true;
+                }
+            }
+        }
+
+        if (!m_device->compileShader(shader, bytecode, error))
+            return false;
+        m_shaderCompiles++;
+        m_bytecode[hash] = bytecode;
+
+        if (persistent) {
+            //written under a temporary name first so a crash never leaves a truncated blob behind
+            std::string temporary = path + ".tmp";
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(bytecode.data()), (std::streamsize) bytecode.size());
+            file.close();
+            std::error_code ec;
+            if (file)
+                std::filesystem::rename(temporary, path, ec);
+            else
+                std::filesystem::remove(temporary, ec);
+        }
+        return true;
+    }
+
+    std::string PipelineCache::getCachePath(uint64_t hash) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long) hash);
+        return m_directory + "/" + name;
+    }
+
+    size_t PipelineCache::getPipelineHits() const {
+        return m_pipelineHits;
+    }
+
+    size_t PipelineCache::getShaderCompiles() const {
+        return m_shaderCompiles;
+    }
+
+    size_t PipelineCache::getShaderDiskHits() const {
+        return m_shaderDiskHits;
+    }
+
+}
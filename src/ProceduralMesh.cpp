@@ -0,0 +1,132 @@
+#include "ProceduralMesh.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <vector>
+
+namespace SGE {
+
+    namespace {
+        std::vector<uint32_t> taskRange(uint32_t count) {
+            std::vector<uint32_t> range(count);
+            std::iota(range.begin(), range.end(), 0);
+            return range;
+        }
+
+        //two clockwise triangles for the quad whose lower left corner is base
+        inline void writeQuad(uint32_t *out, uint32_t base, uint32_t rowLength) {
+            out[0] = base;
+            out[1] = base + rowLength;
+            out[2] = base + rowLength + 1;
+            out[3] = base;
+            out[4] = base + rowLength + 1;
+            out[5] = base + 1;
+        }
+    }
+
+    bool ProceduralMesh::generate(const ProceduralMeshDesc &desc, MeshComponent &mesh) {
+        switch (desc.shape) {
+            case ProceduralShape::Grid:
+                grid(mesh, desc.width, desc.height, desc.size);
+                break;
+            case ProceduralShape::Plane:
+                plane(mesh, desc.size, desc.width);
+                break;
+            case ProceduralShape::CubeSphere:
+                cubeSphere(mesh, desc.width, desc.size);
+                break;
+        }
+        return !mesh.indices.empty();
+    }
+
+    void ProceduralMesh::grid(MeshComponent &mesh, uint32_t width, uint32_t height, float spacing) {
+        mesh.vertices.clear();
+        mesh.indices.clear();
+        if (width < 2 || height < 2)
+            return;
+
+        mesh.vertices.resize(width * height);
+        mesh.indices.resize((width - 1) * (height - 1) * 6);
+        float xOffset = (width - 1) / 2.f;
+        float yOffset = (height - 1) / 2.f;
+
+        auto rows = taskRange(height);
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t row) {
+            Vertex *vertices = &mesh.vertices[row * width];
+            for (uint32_t column = 0; column < width; column++) {
+                vertices[column] = {glm::vec3((column - xOffset) * spacing, (row - yOffset) * spacing, 0.f),
+                                    glm::vec4(column / (float) (width - 1), row / (float) (height - 1), 0.f, 0.f)};
+            }
+
+            if (row == height - 1)
+                return;
+            uint32_t *indices = &mesh.indices[row * (width - 1) * 6];
+            for (uint32_t column = 0; column < width - 1; column++) {
+                writeQuad(indices + column * 6, row * width + column, width);
+            }
+        });
+    }
+
+    void ProceduralMesh::plane(MeshComponent &mesh, float sideLength, uint32_t subdivisions) {
+        subdivisions = std::max(subdivisions, 1u);
+        grid(mesh, subdivisions + 1, subdivisions + 1, sideLength / subdivisions);
+    }
+
+    void ProceduralMesh::cubeSphere(MeshComponent &mesh, uint32_t subdivisions, float radius) {
+        //normal, u and v of every face with u x v = normal so all faces share one winding from the outside
+        static const glm::vec3 faces[6][3] = {
+                {{1, 0, 0},  {0, 1, 0}, {0, 0, 1}},
+                {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+                {{0, 1, 0},  {0, 0, 1}, {1, 0, 0}},
+                {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+                {{0, 0, 1},  {1, 0, 0}, {0, 1, 0}},
+                {{0, 0, -1}, {0, 1, 0}, {1, 0, 0}}
+        };
+
+        subdivisions = std::max(subdivisions, 1u);
+        uint32_t rowLength = subdivisions + 1;
+        uint32_t faceVertices = rowLength * rowLength;
+        uint32_t faceIndices = subdivisions * subdivisions * 6;
+        mesh.vertices.resize(faceVertices * 6);
+        mesh.indices.resize(faceIndices * 6);
+
+        auto faceRange = taskRange(6);
+        std::for_each(std::execution::par, faceRange.begin(), faceRange.end(), [&](uint32_t face) {
+            const glm::vec3 &normal = faces[face][0];
+            const glm::vec3 &u = faces[face][1];
+            const glm::vec3 &v = faces[face][2];
+            Vertex *vertices = &mesh.vertices[face * faceVertices];
+            for (uint32_t row = 0; row < rowLength; row++) {
+                float t = row / (float) subdivisions;
+                for (uint32_t column = 0; column < rowLength; column++) {
+                    float s = column / (float) subdivisions;
+                    glm::vec3 cube = normal + (2.f * s - 1.f) * u + (2.f * t - 1.f) * v;
+                    vertices[row * rowLength + column] = {glm::normalize(cube) * radius, glm::vec4(s, t, 0.f, 0.f)};
+                }
+            }
+
+            uint32_t *indices = &mesh.indices[face * faceIndices];
+            for (uint32_t row = 0; row < subdivisions; row++) {
+                for (uint32_t column = 0; column < subdivisions; column++) {
+                    writeQuad(indices + (row * subdivisions + column) * 6,
+                              face * faceVertices + row * rowLength + column, rowLength);
+                }
+            }
+        });
+    }
+
+    bool ProceduralMesh::parseShape(const std::string &name, ProceduralShape &shape) {
+        if (name == "grid") {
+            shape = ProceduralShape::Grid;
+        } else if (name == "plane") {
+            shape = ProceduralShape::Plane;
+        } else if (name == "cubesphere") {
+            shape = ProceduralShape::CubeSphere;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,294 @@
+#include "RangeAllocator.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace SGE {
+
+    namespace {
+        inline uint32_t highestBit(uint64_t value) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanReverse64(&index, value);
+            return (uint32_t) index;
+#else
+            return 63 - (uint32_t) __builtin_clzll(value);
+#endif
+        }
+
+        inline uint32_t lowestBit(uint64_t value) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, value);
+            return (uint32_t) index;
+#else
+            return (uint32_t) __builtin_ctzll(value);
+#endif
+        }
+    }
+
+    RangeAllocator::RangeAllocator(uint64_t capacity) {
+        bins.assign(firstLevelCount * secondLevelCount, none);
+        secondLevelMaps.assign(firstLevelCount, 0);
+        grow(capacity);
+    }
+
+    void RangeAllocator::mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel) {
+        //sizes below secondLevelCount get a bin each, above that every power of two is split into secondLevelCount
+        //equal bins
+        uint32_t bit = highestBit(size);
+        if (bit < secondLevelBits) {
+            firstLevel = 0;
+            secondLevel = (uint32_t) size;
+        } else {
+            firstLevel = bit - secondLevelBits + 1;
+            secondLevel = (uint32_t) (size >> (bit - secondLevelBits)) ^ secondLevelCount;
+        }
+    }
+
+    uint32_t RangeAllocator::newBlock() {
+        if (!unusedBlocks.empty()) {
+            uint32_t index = unusedBlocks.back();
+            unusedBlocks.pop_back();
+            blocks[index] = Block();
+            return index;
+        }
+        blocks.emplace_back();
+        return (uint32_t) blocks.size() - 1;
+    }
+
+    void RangeAllocator::insertFree(uint32_t index) {
+        Block &block = blocks[index];
+        uint32_t firstLevel, secondLevel;
+        mapping(block.size, firstLevel, secondLevel);
+        uint32_t &bin = bins[firstLevel * secondLevelCount + secondLevel];
+        block.free = true;
+        block.previousFree = none;
+        block.nextFree = bin;
+        if (bin != none)
+            blocks[bin].previousFree = index;
+        bin = index;
+        firstLevelMap |= 1ull << firstLevel;
+        secondLevelMaps[firstLevel] |= 1u << secondLevel;
+    }
+
+    void RangeAllocator::removeFree(uint32_t index) {
+        Block &block = blocks[index];
+        uint32_t firstLevel, secondLevel;
+        mapping(block.size, firstLevel, secondLevel);
+        uint32_t &bin = bins[firstLevel * secondLevelCount + secondLevel];
+        if (block.previousFree != none)
+            blocks[block.previousFree].nextFree = block.nextFree;
+        else
+            bin = block.nextFree;
+        if (block.nextFree != none)
+            blocks[block.nextFree].previousFree = block.previousFree;
+        if (bin == none) {
+            secondLevelMaps[firstLevel] &= ~(1u << secondLevel);
+            if (secondLevelMaps[firstLevel] == 0)
+                firstLevelMap &= ~(1ull << firstLevel);
+        }
+        block.free = false;
+        block.previousFree = block.nextFree = none;
+    }
+
+    uint32_t RangeAllocator::findFree(uint64_t size) const {
+        //rounding the size up to the next bin boundary means any block in the bin found fits without a search
+        uint32_t bit = highestBit(size);
+        uint64_t rounded = size;
+        if (bit >= secondLevelBits)
+            rounded += (1ull << (bit - secondLevelBits)) - 1;
+
+        uint32_t firstLevel, secondLevel;
+        mapping(rounded, firstLevel, secondLevel);
+        if (firstLevel < firstLevelCount) {
+            uint32_t secondMap = secondLevelMaps[firstLevel] & (~0u << secondLevel);
+            if (secondMap == 0) {
+                uint64_t firstMap = firstLevel + 1 < 64 ? firstLevelMap & (~0ull << (firstLevel + 1)) : 0;
+                if (firstMap != 0) {
+                    firstLevel = lowestBit(firstMap);
+                    secondMap = secondLevelMaps[firstLevel];
+                }
+            }
+            if (secondMap != 0)
+                return bins[firstLevel * secondLevelCount + lowestBit(secondMap)];
+        }
+
+        //the bin of the exact size can still hold a block that fits, which matters when the range is nearly full
+        mapping(size, firstLevel, secondLevel);
+        for (uint32_t index = bins[firstLevel * secondLevelCount + secondLevel]; index != none;
+             index = blocks[index].nextFree) {
+            if (blocks[index].size >= size)
+                return index;
+        }
+        return none;
+    }
+
+    uint64_t RangeAllocator::allocate(uint64_t size) {
+        if (size == 0)
+            return invalidOffset;
+        uint32_t index = findFree(size);
+        if (index == none)
+            return invalidOffset;
+        removeFree(index);
+
+        if (blocks[index].size > size) {
+            uint32_t rest = newBlock();
+            Block &block = blocks[index];
+            blocks[rest].offset = block.offset + size;
+            blocks[rest].size = block.size - size;
+            blocks[rest].previous = index;
+            blocks[rest].next = block.next;
+            if (block.next != none)
+                blocks[block.next].previous = rest;
+            else
+                last = rest;
+            block.next = rest;
+            block.size = size;
+            insertFree(rest);
+        }
+
+        allocated[blocks[index].offset] = index;
+        used += size;
+        return blocks[index].offset;
+    }
+
+    void RangeAllocator::free(uint64_t offset) {
+        auto it = allocated.find(offset);
+        if (it == allocated.end())
+            return;
+        uint32_t index = it->second;
+        allocated.erase(it);
+        used -= blocks[index].size;
+        release(index);
+    }
+
+    void RangeAllocator::release(uint32_t index) {
+        uint32_t next = blocks[index].next;
+        if (next != none && blocks[next].free) {
+            removeFree(next);
+            blocks[index].size += blocks[next].size;
+            blocks[index].next = blocks[next].next;
+            if (blocks[next].next != none)
+                blocks[blocks[next].next].previous = index;
+            else
+                last = index;
+            unusedBlocks.push_back(next);
+        }
+
+        uint32_t previous = blocks[index].previous;
+        if (previous != none && blocks[previous].free) {
+            removeFree(previous);
+            blocks[previous].size += blocks[index].size;
+            blocks[previous].next = blocks[index].next;
+            if (blocks[index].next != none)
+                blocks[blocks[index].next].previous = previous;
+            else
+                last = previous;
+            unusedBlocks.push_back(index);
+            index = previous;
+        }
+        insertFree(index);
+    }
+
+    void RangeAllocator::grow(uint64_t newCapacity) {
+        if (newCapacity <= capacity)
+            return;
+        uint64_t added = newCapacity - capacity;
+        if (last != none && blocks[last].free) {
+            removeFree(last);
+            blocks[last].size += added;
+            insertFree(last);
+        } else {
+            uint32_t index = newBlock();
+            blocks[index].offset = capacity;
+            blocks[index].size = added;
+            blocks[index].previous = last;
+            if (last != none)
+                blocks[last].next = index;
+            else
+                first = index;
+            last = index;
+            insertFree(index);
+        }
+        capacity = newCapacity;
+    }
+
+    std::vector<RangeAllocator::Move> RangeAllocator::defragment() {
+        std::vector<Move> moves;
+        std::vector<uint64_t> sizes;
+        uint64_t cursor = 0;
+        for (uint32_t index = first; index != none; index = blocks[index].next) {
+            const Block &block = blocks[index];
+            if (block.free)
+                continue;
+            if (block.offset != cursor)
+                moves.push_back({block.offset, cursor, block.size});
+            sizes.push_back(block.size);
+            cursor += block.size;
+        }
+
+        //the packed layout is rebuilt from scratch, one block per allocation followed by a single free block
+        uint64_t oldCapacity = capacity;
+        blocks.clear();
+        unusedBlocks.clear();
+        allocated.clear();
+        std::fill(bins.begin(), bins.end(), none);
+        std::fill(secondLevelMaps.begin(), secondLevelMaps.end(), 0);
+        firstLevelMap = 0;
+        first = last = none;
+        capacity = 0;
+
+        for (uint64_t size: sizes) {
+            uint32_t index = newBlock();
+            blocks[index].offset = capacity;
+            blocks[index].size = size;
+            blocks[index].previous = last;
+            if (last != none)
+                blocks[last].next = index;
+            else
+                first = index;
+            last = index;
+            allocated[capacity] = index;
+            capacity += size;
+        }
+        grow(oldCapacity);
+        return moves;
+    }
+
+    uint64_t RangeAllocator::getCapacity() const {
+        return capacity;
+    }
+
+    uint64_t RangeAllocator::getUsedSize() const {
+        return used;
+    }
+
+    uint64_t RangeAllocator::getLargestFreeBlock() const {
+        if (firstLevelMap == 0)
+            return 0;
+        uint32_t firstLevel = highestBit(firstLevelMap);
+        uint32_t secondLevel = highestBit(secondLevelMaps[firstLevel]);
+        uint64_t largest = 0;
+        for (uint32_t index = bins[firstLevel * secondLevelCount + secondLevel]; index != none;
+             index = blocks[index].nextFree) {
+            largest = std::max(largest, blocks[index].size);
+        }
+        return largest;
+    }
+
+    float RangeAllocator::getFragmentation() const {
+        uint64_t freeSize = capacity - used;
+        if (freeSize == 0)
+            return 0.f;
+        return 1.f - (float) getLargestFreeBlock() / (float) freeSize;
+    }
+
+    size_t RangeAllocator::getAllocationCount() const {
+        return allocated.size();
+    }
+
+}
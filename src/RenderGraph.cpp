@@ -0,0 +1,349 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace SGE {
+
+    bool TextureInfo::operator==(const TextureInfo &other) const {
+        return width == other.width && height == other.height && format == other.format &&
+               bindFlags == other.bindFlags && bytesPerPixel == other.bytesPerPixel;
+    }
+
+    uint64_t TextureInfo::size() const {
+        return (uint64_t) width * height * bytesPerPixel;
+    }
+
+    RenderGraph::PassBuilder::PassBuilder(RenderGraph *graph, uint32_t pass) : m_graph(graph), m_pass(pass) {
+    }
+
+    void RenderGraph::PassBuilder::read(ResourceHandle handle, ResourceState state) {
+        m_graph->versions[handle].readers.push_back(m_pass);
+        m_graph->passes[m_pass].reads.push_back({handle, state});
+    }
+
+    ResourceHandle RenderGraph::PassBuilder::write(ResourceHandle handle, ResourceState state) {
+        Version version;
+        version.resource = m_graph->versions[handle].resource;
+        version.writer = m_pass;
+        version.previous = handle;
+        m_graph->versions.push_back(version);
+        auto written = (ResourceHandle) (m_graph->versions.size() - 1);
+        m_graph->passes[m_pass].writes.push_back({written, state});
+        if (m_graph->resources[version.resource].imported)
+            m_graph->passes[m_pass].sideEffect = true;
+        return written;
+    }
+
+    void RenderGraph::PassBuilder::sideEffect() {
+        m_graph->passes[m_pass].sideEffect = true;
+    }
+
+    void RenderGraph::reset() {
+        resources.clear();
+        versions.clear();
+        passes.clear();
+        ordered.clear();
+        compiled.clear();
+        finalBarriers.clear();
+        physicalTextures.clear();
+        physicalImported.clear();
+        stats = RenderGraphStats();
+    }
+
+    ResourceHandle RenderGraph::importTexture(const std::string &name, const TextureInfo &info,
+                                              ResourceState initialState, ResourceState finalState) {
+        Resource resource;
+        resource.name = name;
+        resource.info = info;
+        resource.imported = true;
+        resource.initialState = initialState;
+        resource.finalState = finalState;
+        resources.push_back(resource);
+        versions.push_back({(uint32_t) (resources.size() - 1), none, none, {}});
+        return (ResourceHandle) (versions.size() - 1);
+    }
+
+    ResourceHandle RenderGraph::createTexture(const std::string &name, const TextureInfo &info) {
+        Resource resource;
+        resource.name = name;
+        resource.info = info;
+        resources.push_back(resource);
+        versions.push_back({(uint32_t) (resources.size() - 1), none, none, {}});
+        return (ResourceHandle) (versions.size() - 1);
+    }
+
+    uint32_t RenderGraph::addPass(const std::string &name, const std::function<void(PassBuilder &)> &setup,
+                                  std::function<void()> execute) {
+        passes.push_back({name, std::move(execute), {}, {}, false});
+        auto pass = (uint32_t) (passes.size() - 1);
+        PassBuilder builder(this, pass);
+        setup(builder);
+        return pass;
+    }
+
+    bool RenderGraph::compile(std::string &error) {
+        ordered.clear();
+        compiled.clear();
+        finalBarriers.clear();
+        physicalTextures.clear();
+        physicalImported.clear();
+        stats = RenderGraphStats();
+        for (auto &resource: resources) {
+            resource.physical = none;
+        }
+
+        if (!order(error))
+            return false;
+        assignPhysical();
+        if (!buildBarriers(error))
+            return false;
+
+        stats.passCount = (uint32_t) ordered.size();
+        stats.culledPasses = (uint32_t) (passes.size() - ordered.size());
+        stats.physicalCount = (uint32_t) physicalTextures.size();
+        for (const auto &pass: compiled) {
+            stats.barrierCount += (uint32_t) pass.barriers.size();
+        }
+        stats.barrierCount += (uint32_t) finalBarriers.size();
+        return true;
+    }
+
+    bool RenderGraph::order(std::string &error) {
+        //a pass is needed when it has side effects or something needed reads what it wrote, walked backwards
+        //from the side effects through every version a needed pass touches
+        std::vector<bool> needed(passes.size(), false);
+        std::vector<uint32_t> stack;
+        for (uint32_t pass = 0; pass < passes.size(); pass++) {
+            if (passes[pass].sideEffect) {
+                needed[pass] = true;
+                stack.push_back(pass);
+            }
+        }
+        auto require = [&](uint32_t pass) {
+            if (pass != none && !needed[pass]) {
+                needed[pass] = true;
+                stack.push_back(pass);
+            }
+        };
+        while (!stack.empty()) {
+            uint32_t pass = stack.back();
+            stack.pop_back();
+            for (const auto &access: passes[pass].reads) {
+                require(versions[access.version].writer);
+            }
+            //a write keeps the contents it does not overwrite, so whatever produced the previous version stays
+            for (const auto &access: passes[pass].writes) {
+                require(versions[versions[access.version].previous].writer);
+            }
+        }
+
+        //edges run from the writer of a version to its readers and to the pass writing the next version, and from
+        //every reader of a version to the pass that overwrites it
+        std::vector<std::vector<uint32_t>> edges(passes.size());
+        std::vector<uint32_t> incoming(passes.size(), 0);
+        auto link = [&](uint32_t from, uint32_t to) {
+            if (from == none || from == to || !needed[from])
+                return;
+            edges[from].push_back(to);
+            incoming[to]++;
+        };
+        for (uint32_t pass = 0; pass < passes.size(); pass++) {
+            if (!needed[pass])
+                continue;
+            for (const auto &access: passes[pass].reads) {
+                const Version &version = versions[access.version];
+                if (version.writer == none && !resources[version.resource].imported) {
+                    error = "Pass " + passes[pass].name + " reads " + resources[version.resource].name +
+                            " before anything writes it";
+                    return false;
+                }
+                link(version.writer, pass);
+            }
+            for (const auto &access: passes[pass].writes) {
+                const Version &previous = versions[versions[access.version].previous];
+                link(previous.writer, pass);
+                for (uint32_t reader: previous.readers) {
+                    link(reader, pass);
+                }
+            }
+        }
+
+        //among the passes that are ready the earliest declared goes first, so the order is stable and follows the
+        //order passes were added in whenever the dependencies allow it
+        std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> ready;
+        uint32_t neededCount = 0;
+        for (uint32_t pass = 0; pass < passes.size(); pass++) {
+            if (!needed[pass])
+                continue;
+            neededCount++;
+            if (incoming[pass] == 0)
+                ready.push(pass);
+        }
+        while (!ready.empty()) {
+            uint32_t pass = ready.top();
+            ready.pop();
+            ordered.push_back(pass);
+            for (uint32_t next: edges[pass]) {
+                if (--incoming[next] == 0)
+                    ready.push(next);
+            }
+        }
+        if (ordered.size() != neededCount) {
+            error = "The render graph has a cycle";
+            ordered.clear();
+            return false;
+        }
+        return true;
+    }
+
+    void RenderGraph::assignPhysical() {
+        //first and last position in the ordered passes at which every resource is touched
+        std::vector<uint32_t> first(resources.size(), none), last(resources.size(), 0);
+        for (uint32_t position = 0; position < ordered.size(); position++) {
+            const Pass &pass = passes[ordered[position]];
+            auto touch = [&](const Access &access) {
+                uint32_t resource = versions[access.version].resource;
+                first[resource] = std::min(first[resource], position);
+                last[resource] = std::max(last[resource], position);
+            };
+            std::for_each(pass.reads.begin(), pass.reads.end(), touch);
+            std::for_each(pass.writes.begin(), pass.writes.end(), touch);
+        }
+
+        std::vector<uint32_t> transients;
+        for (uint32_t resource = 0; resource < resources.size(); resource++) {
+            if (first[resource] == none)
+                continue;
+            if (resources[resource].imported) {
+                resources[resource].physical = (uint32_t) physicalTextures.size();
+                physicalTextures.push_back(resources[resource].info);
+                physicalImported.push_back(true);
+            } else {
+                transients.push_back(resource);
+            }
+        }
+        std::stable_sort(transients.begin(), transients.end(), [&](uint32_t a, uint32_t b) {
+            return first[a] < first[b];
+        });
+
+        //a transient moves into the first physical texture of the same description that is free again by the
+        //time it is first used, backends without placed resources can then still alias by sharing the texture
+        std::vector<uint32_t> freeFrom;
+        for (uint32_t resource: transients) {
+            const TextureInfo &info = resources[resource].info;
+            stats.transientCount++;
+            stats.transientBytes += info.size();
+            uint32_t chosen = none;
+            for (uint32_t physical = 0; physical < physicalTextures.size(); physical++) {
+                if (!physicalImported[physical] && physicalTextures[physical] == info &&
+                    freeFrom[physical] <= first[resource]) {
+                    chosen = physical;
+                    break;
+                }
+            }
+            if (chosen == none) {
+                chosen = (uint32_t) physicalTextures.size();
+                physicalTextures.push_back(info);
+                physicalImported.push_back(false);
+                stats.allocatedBytes += info.size();
+            }
+            freeFrom.resize(physicalTextures.size(), 0);
+            freeFrom[chosen] = last[resource] + 1;
+            resources[resource].physical = chosen;
+        }
+    }
+
+    bool RenderGraph::buildBarriers(std::string &error) {
+        std::vector<ResourceState> current(physicalTextures.size(), ResourceState::Undefined);
+        for (const auto &resource: resources) {
+            if (resource.imported && resource.physical != none)
+                current[resource.physical] = resource.initialState;
+        }
+
+        std::vector<uint32_t> lastPass(physicalTextures.size(), none);
+        std::vector<ResourceState> wanted(physicalTextures.size());
+        for (uint32_t pass: ordered) {
+            CompiledPass compiledPass{pass, {}};
+            auto want = [&](const Access &access) {
+                const Resource &resource = resources[versions[access.version].resource];
+                uint32_t physical = resource.physical;
+                if (lastPass[physical] == pass) {
+                    if (wanted[physical] != access.state) {
+                        error = "Pass " + passes[pass].name + " uses " + resource.name + " in two states";
+                        return false;
+                    }
+                    return true;
+                }
+                lastPass[physical] = pass;
+                wanted[physical] = access.state;
+                //an aliased texture starts undefined for each resource placed in it, its old contents are garbage
+                ResourceState before = current[physical];
+                if (!resource.imported && versions[access.version].writer == pass &&
+                    versions[versions[access.version].previous].writer == none)
+                    before = ResourceState::Undefined;
+                if (before != access.state || before == ResourceState::UnorderedAccess)
+                    compiledPass.barriers.push_back({physical, before, access.state});
+                current[physical] = access.state;
+                return true;
+            };
+            for (const auto &access: passes[pass].reads) {
+                if (!want(access))
+                    return false;
+            }
+            for (const auto &access: passes[pass].writes) {
+                if (!want(access))
+                    return false;
+            }
+            compiled.push_back(std::move(compiledPass));
+        }
+
+        for (const auto &resource: resources) {
+            if (resource.imported && resource.physical != none && current[resource.physical] != resource.finalState)
+                finalBarriers.push_back({resource.physical, current[resource.physical], resource.finalState});
+        }
+        return true;
+    }
+
+    void RenderGraph::execute(GraphBackend &backend) const {
+        backend.prepare(*this);
+        for (const auto &pass: compiled) {
+            if (!pass.barriers.empty())
+                backend.transition(*this, pass.barriers);
+            if (passes[pass.pass].execute)
+                passes[pass.pass].execute();
+        }
+        if (!finalBarriers.empty())
+            backend.transition(*this, finalBarriers);
+    }
+
+    const std::vector<CompiledPass> &RenderGraph::getCompiledPasses() const {
+        return compiled;
+    }
+
+    const std::vector<GraphBarrier> &RenderGraph::getFinalBarriers() const {
+        return finalBarriers;
+    }
+
+    const std::string &RenderGraph::getPassName(uint32_t pass) const {
+        return passes[pass].name;
+    }
+
+    uint32_t RenderGraph::getPhysical(ResourceHandle handle) const {
+        return resources[versions[handle].resource].physical;
+    }
+
+    const std::vector<TextureInfo> &RenderGraph::getPhysicalTextures() const {
+        return physicalTextures;
+    }
+
+    bool RenderGraph::isImported(uint32_t physical) const {
+        return physicalImported[physical];
+    }
+
+    const RenderGraphStats &RenderGraph::getStats() const {
+        return stats;
+    }
+
+}
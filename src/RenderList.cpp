@@ -0,0 +1,84 @@
+#include "RenderList.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+
+namespace SGE {
+
+    std::vector<RecordRange> RenderList::partition(const std::vector<DrawBatch> &batches, uint32_t workerCount,
+                                                   uint32_t batchCost) {
+        std::vector<RecordRange> ranges;
+        uint32_t count = (uint32_t) batches.size();
+        workerCount = std::min(std::max(workerCount, 1u), count);
+        if (count == 0)
+            return ranges;
+
+        uint64_t total = 0;
+        for (const auto &batch: batches) {
+            total += batchCost + batch.instanceCount;
+        }
+
+        //a range closes once the running cost passes its share of the total, leaving at least one batch for every
+        //range still to come
+        uint64_t cost = 0;
+        RecordRange range;
+        for (uint32_t i = 0; i < count; i++) {
+            cost += batchCost + batches[i].instanceCount;
+            uint32_t remainingRanges = workerCount - (uint32_t) ranges.size() - 1;
+            bool full = cost * workerCount >= total * (ranges.size() + 1);
+            if (remainingRanges > 0 && (full || count - i - 1 == remainingRanges)) {
+                range.last = i + 1;
+                ranges.push_back(range);
+                range.first = i + 1;
+            }
+        }
+        range.last = count;
+        ranges.push_back(range);
+        return ranges;
+    }
+
+    void RenderList::record(const std::vector<DrawBatch> &batches, const std::vector<RecordRange> &ranges,
+                            const std::vector<CommandRecorder *> &recorders) {
+        auto recordRange = [&](size_t index) {
+            CommandRecorder *recorder = recorders[index];
+            recorder->begin();
+            for (uint32_t i = ranges[index].first; i < ranges[index].last; i++) {
+                recorder->record(batches[i]);
+            }
+            recorder->end();
+        };
+
+        //a single range stays on the calling thread, which may be the only one allowed to touch its context
+        if (ranges.size() == 1) {
+            recordRange(0);
+        } else {
+            std::vector<size_t> workers(ranges.size());
+            std::iota(workers.begin(), workers.end(), 0);
+            std::for_each(std::execution::par, workers.begin(), workers.end(), recordRange);
+        }
+
+        for (size_t i = 0; i < ranges.size(); i++) {
+            recorders[i]->submit();
+        }
+    }
+
+    PacketRecorder::PacketRecorder(std::vector<DrawBatch> *merged) : m_merged(merged) {
+    }
+
+    void PacketRecorder::begin() {
+        m_packets.clear();
+    }
+
+    void PacketRecorder::record(const DrawBatch &batch) {
+        m_packets.push_back(batch);
+    }
+
+    void PacketRecorder::end() {
+    }
+
+    void PacketRecorder::submit() {
+        m_merged->insert(m_merged->end(), m_packets.begin(), m_packets.end());
+    }
+
+}
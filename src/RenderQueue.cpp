@@ -0,0 +1,142 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace SGE {
+
+    namespace {
+        constexpr uint32_t radixBits = 11;
+        constexpr uint32_t radixSize = 1 << radixBits;
+        constexpr uint32_t radixPasses = (64 + radixBits - 1) / radixBits;
+        //everything above the depth identifies the batch
+        constexpr uint32_t batchShift = RenderQueue::depthBits;
+    }
+
+    void RenderQueue::clear() {
+        items.clear();
+        gathered.clear();
+        instances.clear();
+        batches.clear();
+
+        //slots are only recycled between frames, and only once the table gets close to the key's capacity
+        if (pipelines.size() > (3u << pipelineBits) / 4 || meshes.size() > (3u << meshBits) / 4) {
+            pipelineSlots.clear();
+            meshSlots.clear();
+            pipelines.clear();
+            meshes.clear();
+        }
+    }
+
+    void RenderQueue::reserve(size_t count) {
+        items.reserve(count);
+        scratch.reserve(count);
+        gathered.reserve(count);
+        instances.reserve(count);
+    }
+
+    uint64_t RenderQueue::makeKey(uint32_t pipelineSlot, uint32_t meshSlot, uint32_t lod, float depth) {
+        constexpr uint32_t depthMax = (1u << depthBits) - 1;
+        uint32_t quantized = (uint32_t) (std::clamp(depth, 0.f, 1.f) * (float) depthMax);
+        return ((uint64_t) pipelineSlot << (meshBits + lodBits + depthBits)) |
+               ((uint64_t) meshSlot << (lodBits + depthBits)) |
+               ((uint64_t) std::min(lod, (1u << lodBits) - 1) << depthBits) |
+               quantized;
+    }
+
+    uint32_t RenderQueue::getPipelineSlot(uint64_t pipeline) {
+        auto [it, inserted] = pipelineSlots.try_emplace(pipeline, (uint32_t) pipelines.size());
+        if (inserted) {
+            assert(pipelines.size() < (1u << pipelineBits));
+            pipelines.push_back(pipeline);
+        }
+        return it->second;
+    }
+
+    uint32_t RenderQueue::getMeshSlot(uint32_t mesh) {
+        auto [it, inserted] = meshSlots.try_emplace(mesh, (uint32_t) meshes.size());
+        if (inserted) {
+            assert(meshes.size() < (1u << meshBits));
+            meshes.push_back(mesh);
+        }
+        return it->second;
+    }
+
+    void RenderQueue::push(uint64_t pipeline, uint32_t mesh, uint32_t lod, float depth, const glm::mat4 &world) {
+        RenderItem item;
+        item.key = makeKey(getPipelineSlot(pipeline), getMeshSlot(mesh), lod, depth);
+        item.instance = (uint32_t) gathered.size();
+        items.push_back(item);
+        gathered.push_back({world});
+    }
+
+    void RenderQueue::sort() {
+        size_t count = items.size();
+        if (count < 2)
+            return;
+
+        //lsd radix sort over 11 bit digits. All digit histograms are counted in one read of the keys, and passes
+        //where every key has the same digit are skipped, which is most of the high pipeline digits in a typical frame
+        scratch.resize(count);
+        std::vector<uint32_t> histograms(radixPasses * radixSize, 0);
+        for (const auto &item: items) {
+            for (uint32_t pass = 0; pass < radixPasses; pass++) {
+                histograms[pass * radixSize + ((item.key >> (pass * radixBits)) & (radixSize - 1))]++;
+            }
+        }
+
+        for (uint32_t pass = 0; pass < radixPasses; pass++) {
+            uint32_t shift = pass * radixBits;
+            uint32_t *histogram = histograms.data() + pass * radixSize;
+            if (histogram[(items[0].key >> shift) & (radixSize - 1)] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t bucket = 0; bucket < radixSize; bucket++) {
+                uint32_t size = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += size;
+            }
+            for (const auto &item: items) {
+                scratch[histogram[(item.key >> shift) & (radixSize - 1)]++] = item;
+            }
+            items.swap(scratch);
+        }
+    }
+
+    void RenderQueue::buildBatches() {
+        batches.clear();
+        instances.resize(items.size());
+        for (size_t i = 0; i < items.size(); i++) {
+            const RenderItem &item = items[i];
+            instances[i] = gathered[item.instance];
+
+            if (i == 0 || (item.key >> batchShift) != (items[i - 1].key >> batchShift)) {
+                DrawBatch batch;
+                batch.pipeline = pipelines[item.key >> (meshBits + lodBits + depthBits)];
+                batch.mesh = meshes[(item.key >> (lodBits + depthBits)) & ((1u << meshBits) - 1)];
+                batch.lod = (uint32_t) (item.key >> depthBits) & ((1u << lodBits) - 1);
+                batch.firstInstance = (uint32_t) i;
+                batches.push_back(batch);
+            }
+            batches.back().instanceCount++;
+        }
+    }
+
+    size_t RenderQueue::size() const {
+        return items.size();
+    }
+
+    const std::vector<RenderItem> &RenderQueue::getItems() const {
+        return items;
+    }
+
+    const std::vector<InstanceData> &RenderQueue::getInstances() const {
+        return instances;
+    }
+
+    const std::vector<DrawBatch> &RenderQueue::getBatches() const {
+        return batches;
+    }
+
+}
@@ -0,0 +1,276 @@
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <execution>
+#include <numeric>
+
+namespace SGE {
+
+    namespace {
+        inline uint32_t packColor(const glm::vec4 &color) {
+            auto channel = [](float value) {
+                return (uint32_t) std::lround(std::clamp(value, 0.f, 1.f) * 255.f);
+            };
+            return channel(color.r) | channel(color.g) << 8 | channel(color.b) << 16 | 0xff000000u;
+        }
+
+        //edges shared by two triangles are walked in opposite directions, so exactly one of them owns the pixels
+        //lying on it
+        inline bool ownsEdge(float dx, float dy) {
+            return dy < 0.f || (dy == 0.f && dx > 0.f);
+        }
+
+        inline bool outside(const glm::vec4 *clip, int axis, float sign) {
+            for (int i = 0; i < 3; i++) {
+                if (sign * clip[i][axis] <= clip[i].w)
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    void Framebuffer::resize(uint32_t newWidth, uint32_t newHeight) {
+        width = newWidth;
+        height = newHeight;
+        color.assign((size_t) width * height, 0);
+        depth.assign((size_t) width * height, 1.f);
+    }
+
+    void Framebuffer::clear(uint32_t clearColor, float clearDepth) {
+        std::fill(color.begin(), color.end(), clearColor);
+        std::fill(depth.begin(), depth.end(), clearDepth);
+    }
+
+    bool Framebuffer::writePpm(const std::string &path) const {
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+        std::fprintf(file, "P6\n%u %u\n255\n", width, height);
+        std::vector<unsigned char> row((size_t) width * 3);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint32_t pixel = color[(size_t) y * width + x];
+                row[x * 3] = (unsigned char) (pixel & 0xff);
+                row[x * 3 + 1] = (unsigned char) (pixel >> 8 & 0xff);
+                row[x * 3 + 2] = (unsigned char) (pixel >> 16 & 0xff);
+            }
+            std::fwrite(row.data(), 1, row.size(), file);
+        }
+        return std::fclose(file) == 0;
+    }
+
+    SoftwareRasterizer::SoftwareRasterizer(uint32_t width, uint32_t height) {
+        framebuffer.resize(width, height);
+        tilesX = (width + tileSize - 1) / tileSize;
+        tilesY = (height + tileSize - 1) / tileSize;
+        tileTriangles.resize((size_t) tilesX * tilesY);
+    }
+
+    void SoftwareRasterizer::setMeshes(const std::unordered_map<uint32_t, const MeshComponent *> *newMeshes) {
+        meshes = newMeshes;
+    }
+
+    void SoftwareRasterizer::beginFrame(const glm::mat4 &newViewProj, const std::vector<InstanceData> *newInstances,
+                                        uint32_t clearColor) {
+        viewProj = newViewProj;
+        instances = newInstances;
+        triangles.clear();
+        framebuffer.clear(clearColor, 1.f);
+    }
+
+    void SoftwareRasterizer::transform(const DrawBatch &batch, std::vector<RasterTriangle> &out) const {
+        auto found = meshes->find(batch.mesh);
+        if (found == meshes->end())
+            return;
+        const MeshComponent &mesh = *found->second;
+        uint32_t first = 0;
+        uint32_t count = (uint32_t) mesh.indices.size();
+        if (batch.lod < mesh.lods.size()) {
+            first = mesh.lods[batch.lod].firstIndex;
+            count = mesh.lods[batch.lod].indexCount;
+        }
+
+        for (uint32_t instance = batch.firstInstance; instance < batch.firstInstance + batch.instanceCount; instance++) {
+            glm::mat4 mvp = viewProj * (*instances)[instance].world;
+            for (uint32_t i = first; i + 2 < first + count; i += 3) {
+                glm::vec4 clip[3];
+                glm::vec4 colors[3];
+                for (int k = 0; k < 3; k++) {
+                    const Vertex &vertex = mesh.vertices[mesh.indices[i + k]];
+                    clip[k] = mvp * glm::vec4(vertex.pos, 1.f);
+                    colors[k] = vertex.texCoord;
+                }
+                //whole triangles outside one side of the volume are dropped before any clipping
+                if (outside(clip, 0, -1.f) || outside(clip, 0, 1.f) || outside(clip, 1, -1.f) ||
+                    outside(clip, 1, 1.f) || outside(clip, 2, 1.f))
+                    continue;
+                emit(clip, colors, out);
+            }
+        }
+    }
+
+    void SoftwareRasterizer::emit(const glm::vec4 *clip, const glm::vec4 *colors,
+                                  std::vector<RasterTriangle> &out) const {
+        //clip against the near plane z = -w, which leaves at most a quad
+        glm::vec4 polygon[4], polygonColors[4];
+        int size = 0;
+        for (int i = 0; i < 3; i++) {
+            int j = (i + 1) % 3;
+            float di = clip[i].z + clip[i].w;
+            float dj = clip[j].z + clip[j].w;
+            if (di >= 0.f) {
+                polygon[size] = clip[i];
+                polygonColors[size++] = colors[i];
+            }
+            if ((di >= 0.f) != (dj >= 0.f)) {
+                float t = di / (di - dj);
+                polygon[size] = clip[i] + (clip[j] - clip[i]) * t;
+                polygonColors[size++] = colors[i] + (colors[j] - colors[i]) * t;
+            }
+        }
+
+        for (int fan = 1; fan + 1 < size; fan++) {
+            int corners[3] = {0, fan, fan + 1};
+            RasterTriangle triangle;
+            for (int k = 0; k < 3; k++) {
+                const glm::vec4 &position = polygon[corners[k]];
+                float inverseW = 1.f / position.w;
+                triangle.x[k] = (position.x * inverseW * 0.5f + 0.5f) * (float) framebuffer.width;
+                triangle.y[k] = (0.5f - position.y * inverseW * 0.5f) * (float) framebuffer.height;
+                triangle.z[k] = position.z * inverseW * 0.5f + 0.5f;
+                triangle.inverseW[k] = inverseW;
+                triangle.colorOverW[k] = polygonColors[corners[k]] * inverseW;
+            }
+            float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+                         (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+            if (area == 0.f || !std::isfinite(area))
+                continue;
+            //one winding for everything, nothing is backface culled
+            if (area < 0.f) {
+                std::swap(triangle.x[1], triangle.x[2]);
+                std::swap(triangle.y[1], triangle.y[2]);
+                std::swap(triangle.z[1], triangle.z[2]);
+                std::swap(triangle.inverseW[1], triangle.inverseW[2]);
+                std::swap(triangle.colorOverW[1], triangle.colorOverW[2]);
+            }
+            out.push_back(triangle);
+        }
+    }
+
+    void SoftwareRasterizer::append(const std::vector<RasterTriangle> &newTriangles) {
+        triangles.insert(triangles.end(), newTriangles.begin(), newTriangles.end());
+    }
+
+    void SoftwareRasterizer::rasterize() {
+        for (auto &list: tileTriangles) {
+            list.clear();
+        }
+        float maxX = (float) framebuffer.width - 1.f;
+        float maxY = (float) framebuffer.height - 1.f;
+        for (uint32_t i = 0; i < (uint32_t) triangles.size(); i++) {
+            const RasterTriangle &triangle = triangles[i];
+            float left = std::clamp(std::min({triangle.x[0], triangle.x[1], triangle.x[2]}), 0.f, maxX);
+            float right = std::clamp(std::max({triangle.x[0], triangle.x[1], triangle.x[2]}), 0.f, maxX);
+            float top = std::clamp(std::min({triangle.y[0], triangle.y[1], triangle.y[2]}), 0.f, maxY);
+            float bottom = std::clamp(std::max({triangle.y[0], triangle.y[1], triangle.y[2]}), 0.f, maxY);
+            for (uint32_t ty = (uint32_t) top / tileSize; ty <= (uint32_t) bottom / tileSize; ty++) {
+                for (uint32_t tx = (uint32_t) left / tileSize; tx <= (uint32_t) right / tileSize; tx++) {
+                    tileTriangles[ty * tilesX + tx].push_back(i);
+                }
+            }
+        }
+
+        std::vector<uint32_t> tiles(tileTriangles.size());
+        std::iota(tiles.begin(), tiles.end(), 0);
+        std::for_each(std::execution::par, tiles.begin(), tiles.end(), [this](uint32_t tile) {
+            rasterizeTile(tile);
+        });
+    }
+
+    void SoftwareRasterizer::rasterizeTile(uint32_t tile) {
+        int tileLeft = (int) (tile % tilesX * tileSize);
+        int tileTop = (int) (tile / tilesX * tileSize);
+        int tileRight = std::min(tileLeft + (int) tileSize, (int) framebuffer.width) - 1;
+        int tileBottom = std::min(tileTop + (int) tileSize, (int) framebuffer.height) - 1;
+
+        for (uint32_t index: tileTriangles[tile]) {
+            const RasterTriangle &t = triangles[index];
+            int left = std::max(tileLeft, (int) std::floor(std::min({t.x[0], t.x[1], t.x[2]})));
+            int right = std::min(tileRight, (int) std::ceil(std::max({t.x[0], t.x[1], t.x[2]})));
+            int top = std::max(tileTop, (int) std::floor(std::min({t.y[0], t.y[1], t.y[2]})));
+            int bottom = std::min(tileBottom, (int) std::ceil(std::max({t.y[0], t.y[1], t.y[2]})));
+            if (left > right || top > bottom)
+                continue;
+
+            //edge k is opposite vertex k, its function is positive inside and steps by a per pixel in x and b in y
+            float a[3], b[3], c[3];
+            bool owned[3];
+            for (int k = 0; k < 3; k++) {
+                int from = (k + 1) % 3;
+                int to = (k + 2) % 3;
+                float dx = t.x[to] - t.x[from];
+                float dy = t.y[to] - t.y[from];
+                a[k] = -dy;
+                b[k] = dx;
+                c[k] = dy * t.x[from] - dx * t.y[from];
+                owned[k] = ownsEdge(dx, dy);
+            }
+            float inverseArea = 1.f / (a[0] * t.x[0] + b[0] * t.y[0] + c[0]);
+
+            for (int y = top; y <= bottom; y++) {
+                float py = (float) y + 0.5f;
+                size_t row = (size_t) y * framebuffer.width;
+                for (int x = left; x <= right; x++) {
+                    float px = (float) x + 0.5f;
+                    float e[3];
+                    bool inside = true;
+                    for (int k = 0; k < 3 && inside; k++) {
+                        e[k] = a[k] * px + b[k] * py + c[k];
+                        inside = e[k] > 0.f || (e[k] == 0.f && owned[k]);
+                    }
+                    if (!inside)
+                        continue;
+
+                    float w0 = e[0] * inverseArea, w1 = e[1] * inverseArea, w2 = e[2] * inverseArea;
+                    float z = w0 * t.z[0] + w1 * t.z[1] + w2 * t.z[2];
+                    float &depth = framebuffer.depth[row + x];
+                    if (z < 0.f || z >= depth)
+                        continue;
+                    depth = z;
+                    float inverseW = w0 * t.inverseW[0] + w1 * t.inverseW[1] + w2 * t.inverseW[2];
+                    glm::vec4 color = (t.colorOverW[0] * w0 + t.colorOverW[1] * w1 + t.colorOverW[2] * w2) / inverseW;
+                    framebuffer.color[row + x] = packColor(color);
+                }
+            }
+        }
+    }
+
+    const Framebuffer &SoftwareRasterizer::getFramebuffer() const {
+        return framebuffer;
+    }
+
+    size_t SoftwareRasterizer::getTriangleCount() const {
+        return triangles.size();
+    }
+
+    RasterRecorder::RasterRecorder(SoftwareRasterizer *rasterizer) : m_rasterizer(rasterizer) {
+    }
+
+    void RasterRecorder::begin() {
+        m_triangles.clear();
+    }
+
+    void RasterRecorder::record(const DrawBatch &batch) {
+        m_rasterizer->transform(batch, m_triangles);
+    }
+
+    void RasterRecorder::end() {
+    }
+
+    void RasterRecorder::submit() {
+        m_rasterizer->append(m_triangles);
+    }
+
+}
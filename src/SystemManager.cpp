@@ -26,9 +26,21 @@ namespace SGE {
         node = node["Systems"];
         gameTime->setUp(m_world, node);
         primaryMovement->setUp(m_world, node);
+        navigation->setUp(m_world, node);
+        steering->setUp(m_world, node);
         updateMovement->setUp(m_world, node);
+        animationPlayer->setUp(m_world, node);
         camera->setUp(m_world, node);
+        uiLayout->setUp(m_world, node);
+        assetStreaming->setUp(m_world, node);
+        hotReload->setUp(m_world, node);
+        lodSelection->setUp(m_world, node);
+        frustumCulling->setUp(m_world, node);
+        tilemapRenderer->setUp(m_world, node);
+        textRenderer->setUp(m_world, node);
         render->setUp(m_world, node);
+        particleSystem->setUp(m_world, node);
+        debugDrawRenderer->setUp(m_world, node);
         meshModelLoader->setUp(m_world, node);
         closeEngine->setUp(m_world, node);
         graphicsUnloader->setUp(m_world, node);
@@ -57,7 +69,7 @@ namespace SGE {
         }
 
         //second set of systems
-        if (!runSystem(primaryMovement.get())) {
+        if (!runSystem(primaryMovement.get(), navigation.get(), steering.get())) {
             return false;
         }
 
@@ -67,12 +79,42 @@ namespace SGE {
         }
 
         //fourth set of systems
-        if (!runSystem(camera.get())) {
+        if (!runSystem(animationPlayer.get())) {
             return false;
         }
 
         //fifth set of systems
-        if (!runSystem(render.get())) {
+        if (!runSystem(camera.get(), uiLayout.get())) {
+            return false;
+        }
+
+        //sixth set of systems
+        if (!runSystem(assetStreaming.get())) {
+            return false;
+        }
+
+        //seventh set of systems
+        if (!runSystem(hotReload.get())) {
+            return false;
+        }
+
+        //eighth set of systems
+        if (!runSystem(lodSelection.get(), frustumCulling.get())) {
+            return false;
+        }
+
+        //ninth set of systems
+        if (!runSystem(tilemapRenderer.get(), textRenderer.get())) {
+            return false;
+        }
+
+        //tenth set of systems
+        if (!runSystem(render.get(), particleSystem.get())) {
+            return false;
+        }
+
+        //eleventh set of systems
+        if (!runSystem(debugDrawRenderer.get())) {
             return false;
         }
 
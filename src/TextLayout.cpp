@@ -0,0 +1,262 @@
+#include "TextLayout.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SGE {
+
+    namespace {
+        uint64_t hashBytes(uint64_t hash, const void *data, size_t size) {
+            auto bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        template<typename T>
+        uint64_t hashValue(uint64_t hash, const T &value) {
+            return hashBytes(hash, &value, sizeof(value));
+        }
+
+        uint64_t hashText(const std::string &text, const TextStyle &style) {
+            uint64_t hash = 14695981039346656037ull;
+            hash = hashBytes(hash, text.data(), text.size());
+            hash = hashValue(hash, style.pixelSize);
+            hash = hashValue(hash, style.maxWidth);
+            return hashValue(hash, style.align);
+        }
+
+        constexpr uint32_t replacementCharacter = 0xFFFD;
+
+        struct Line {
+            size_t first;
+            size_t end;
+            float width;
+        };
+    }
+
+    bool TextStyle::operator==(const TextStyle &other) const {
+        return pixelSize == other.pixelSize && maxWidth == other.maxWidth && align == other.align;
+    }
+
+    TextLayoutCache::TextLayoutCache(GlyphCache *glyphs) : glyphs(glyphs) {
+    }
+
+    const TextBlock &TextLayoutCache::layout(const std::string &text, const TextStyle &style) {
+        //a hash collision simply lays the other string out over the entry, both stay correct
+        Entry &entry = entries[hashText(text, style)];
+        entry.used = true;
+        if (entry.built && entry.block.generation == glyphs->getGeneration() && entry.style == style &&
+            entry.text == text) {
+            hits++;
+            return entry.block;
+        }
+
+        misses++;
+        entry.text = text;
+        entry.style = style;
+        entry.built = true;
+        if (!build(text, style, entry.block)) {
+            //text that does not even fit into an empty cache keeps the glyphs that did
+            glyphs->clear();
+            build(text, style, entry.block);
+        }
+        return entry.block;
+    }
+
+    bool TextLayoutCache::build(const std::string &text, const TextStyle &style, TextBlock &block) {
+        block.quads.clear();
+        block.size = glm::vec2(0.f);
+        block.generation = glyphs->getGeneration();
+        decodeUtf8(text, codepoints);
+        FontMetrics metrics = glyphs->getMetrics(style.pixelSize);
+        glm::vec2 texel(1.f / (float) glyphs->getWidth(), 1.f / (float) glyphs->getHeight());
+
+        //quads are placed relative to the start of their line and the baseline, lines are moved into place at the
+        //end once their widths are known
+        std::vector<Line> lines;
+        size_t lineStart = 0;
+        float penX = 0.f;
+        //end of the last glyph that is not a space, trailing spaces do not count towards the width of a line
+        float inkEnd = 0.f;
+        //the last place the line can be broken, right after a run of spaces
+        size_t breakQuad = SIZE_MAX;
+        float breakX = 0.f, breakWidth = 0.f;
+        auto newLine = [&](size_t end, float width) {
+            lines.push_back({lineStart, end, width});
+            lineStart = end;
+            breakQuad = SIZE_MAX;
+            breakWidth = 0.f;
+        };
+
+        bool complete = true;
+        for (uint32_t codepoint: codepoints) {
+            if (codepoint == '\n') {
+                newLine(block.quads.size(), inkEnd);
+                penX = inkEnd = 0.f;
+                continue;
+            }
+            if (codepoint == '\r')
+                continue;
+            if (codepoint == '\t')
+                codepoint = ' ';
+
+            const CachedGlyph *glyph = glyphs->get(codepoint, style.pixelSize);
+            if (glyph == nullptr) {
+                complete = false;
+                break;
+            }
+            if (codepoint == ' ') {
+                if (penX > 0.f && breakQuad != block.quads.size())
+                    breakWidth = inkEnd;
+                penX += glyph->advance;
+                breakQuad = block.quads.size();
+                breakX = penX;
+                continue;
+            }
+
+            float right = penX + (float) glyph->bearingX + (float) glyph->rect.width;
+            if (style.maxWidth > 0.f && right > style.maxWidth && penX > 0.f) {
+                if (breakQuad != SIZE_MAX && breakWidth > 0.f) {
+                    //the word in progress moves down to the next line
+                    newLine(breakQuad, breakWidth);
+                    for (size_t i = lineStart; i < block.quads.size(); i++) {
+                        block.quads[i].min.x -= breakX;
+                        block.quads[i].max.x -= breakX;
+                    }
+                    penX -= breakX;
+                    inkEnd = std::max(0.f, inkEnd - breakX);
+                } else {
+                    //a single word wider than the line is broken between characters
+                    newLine(block.quads.size(), inkEnd);
+                    penX = inkEnd = 0.f;
+                }
+                right = penX + (float) glyph->bearingX + (float) glyph->rect.width;
+            }
+
+            if (glyph->rect.width > 0) {
+                GlyphQuad quad;
+                quad.min = {penX + (float) glyph->bearingX, -(float) glyph->bearingY};
+                quad.max = quad.min + glm::vec2((float) glyph->rect.width, (float) glyph->rect.height);
+                quad.uvMin = glm::vec2((float) glyph->rect.x, (float) glyph->rect.y) * texel;
+                quad.uvMax = glm::vec2((float) (glyph->rect.x + glyph->rect.width),
+                                       (float) (glyph->rect.y + glyph->rect.height)) * texel;
+                block.quads.push_back(quad);
+            }
+            penX += glyph->advance;
+            inkEnd = std::max(right, penX);
+        }
+        newLine(block.quads.size(), inkEnd);
+
+        float widest = 0.f;
+        for (const auto &line: lines) {
+            widest = std::max(widest, line.width);
+        }
+        float alignWidth = style.maxWidth > 0.f ? style.maxWidth : widest;
+        for (size_t i = 0; i < lines.size(); i++) {
+            float x = 0.f;
+            if (style.align == TextAlign::Center)
+                x = std::floor((alignWidth - lines[i].width) / 2.f);
+            else if (style.align == TextAlign::Right)
+                x = alignWidth - lines[i].width;
+            glm::vec2 offset(x, metrics.ascent + (float) i * metrics.lineHeight);
+            for (size_t quad = lines[i].first; quad < lines[i].end; quad++) {
+                block.quads[quad].min += offset;
+                block.quads[quad].max += offset;
+            }
+        }
+        block.size = {style.align == TextAlign::Left ? widest : alignWidth,
+                      (float) lines.size() * metrics.lineHeight};
+        return complete;
+    }
+
+    void TextLayoutCache::endFrame() {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (!it->second.used) {
+                it = entries.erase(it);
+            } else {
+                it->second.used = false;
+                it++;
+            }
+        }
+    }
+
+    void TextLayoutCache::clear() {
+        entries.clear();
+    }
+
+    uint32_t TextLayoutCache::getBlockCount() const {
+        return (uint32_t) entries.size();
+    }
+
+    uint64_t TextLayoutCache::getHits() const {
+        return hits;
+    }
+
+    uint64_t TextLayoutCache::getMisses() const {
+        return misses;
+    }
+
+    void TextLayoutCache::appendQuads(const TextBlock &block, const glm::vec2 &topLeft, const glm::vec4 &color,
+                                      MeshComponent &mesh) {
+        auto channel = [](float value) {
+            return (uint32_t) (std::clamp(value, 0.f, 1.f) * 255.f + 0.5f);
+        };
+        //24 bits fit a float exactly, so the shader gets the color back without loss
+        auto packed = (float) (channel(color.r) << 16 | channel(color.g) << 8 | channel(color.b));
+        for (const auto &quad: block.quads) {
+            auto first = (uint32_t) mesh.vertices.size();
+            float left = topLeft.x + quad.min.x, right = topLeft.x + quad.max.x;
+            float top = topLeft.y - quad.min.y, bottom = topLeft.y - quad.max.y;
+            mesh.vertices.push_back({{left, bottom, 0.f}, {quad.uvMin.x, quad.uvMax.y, packed, color.a}});
+            mesh.vertices.push_back({{right, bottom, 0.f}, {quad.uvMax.x, quad.uvMax.y, packed, color.a}});
+            mesh.vertices.push_back({{right, top, 0.f}, {quad.uvMax.x, quad.uvMin.y, packed, color.a}});
+            mesh.vertices.push_back({{left, top, 0.f}, {quad.uvMin.x, quad.uvMin.y, packed, color.a}});
+            for (uint32_t corner: {0u, 1u, 2u, 0u, 2u, 3u}) {
+                mesh.indices.push_back(first + corner);
+            }
+        }
+    }
+
+    void TextLayoutCache::decodeUtf8(const std::string &text, std::vector<uint32_t> &out) {
+        out.clear();
+        auto bytes = reinterpret_cast<const unsigned char *>(text.data());
+        size_t size = text.size();
+        for (size_t i = 0; i < size;) {
+            unsigned char lead = bytes[i];
+            uint32_t length, codepoint;
+            if (lead < 0x80) {
+                length = 1;
+                codepoint = lead;
+            } else if ((lead & 0xE0) == 0xC0) {
+                length = 2;
+                codepoint = lead & 0x1F;
+            } else if ((lead & 0xF0) == 0xE0) {
+                length = 3;
+                codepoint = lead & 0x0F;
+            } else if ((lead & 0xF8) == 0xF0) {
+                length = 4;
+                codepoint = lead & 0x07;
+            } else {
+                out.push_back(replacementCharacter);
+                i++;
+                continue;
+            }
+            bool valid = i + length <= size;
+            for (uint32_t k = 1; valid && k < length; k++) {
+                valid = (bytes[i + k] & 0xC0) == 0x80;
+                codepoint = codepoint << 6 | (bytes[i + k] & 0x3F);
+            }
+            if (!valid) {
+                //only the lead byte is skipped so the next character still decodes
+                out.push_back(replacementCharacter);
+                i++;
+                continue;
+            }
+            out.push_back(codepoint);
+            i += length;
+        }
+    }
+
+}
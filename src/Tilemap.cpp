@@ -0,0 +1,210 @@
+#include "Tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+
+namespace SGE {
+
+    Tilemap::Tilemap(uint32_t width, uint32_t height, float tileSize, const glm::vec2 &origin) :
+            width(width), height(height), tileSize(tileSize), origin(origin) {
+        chunksX = (width + chunkSize - 1) / chunkSize;
+        chunksY = (height + chunkSize - 1) / chunkSize;
+        chunks.resize((size_t) chunksX * chunksY);
+    }
+
+    uint32_t Tilemap::getWidth() const {
+        return width;
+    }
+
+    uint32_t Tilemap::getHeight() const {
+        return height;
+    }
+
+    float Tilemap::getTileSize() const {
+        return tileSize;
+    }
+
+    const glm::vec2 &Tilemap::getOrigin() const {
+        return origin;
+    }
+
+    uint16_t Tilemap::get(uint32_t x, uint32_t y) const {
+        if (x >= width || y >= height)
+            return emptyTile;
+        const Chunk &chunk = chunks[(y / chunkSize) * chunksX + x / chunkSize];
+        if (chunk.tiles.empty())
+            return emptyTile;
+        return chunk.tiles[(y % chunkSize) * chunkSize + x % chunkSize];
+    }
+
+    void Tilemap::set(uint32_t x, uint32_t y, uint16_t tile) {
+        if (x >= width || y >= height)
+            return;
+        uint32_t index = (y / chunkSize) * chunksX + x / chunkSize;
+        Chunk &chunk = chunks[index];
+        if (chunk.tiles.empty()) {
+            if (tile == emptyTile)
+                return;
+            chunk.tiles.assign(chunkSize * chunkSize, emptyTile);
+        }
+        uint16_t &slot = chunk.tiles[(y % chunkSize) * chunkSize + x % chunkSize];
+        if (slot == tile)
+            return;
+        chunk.tileCount += (tile != emptyTile) - (slot != emptyTile);
+        slot = tile;
+        chunk.version++;
+        markDirty(index);
+    }
+
+    void Tilemap::fill(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, uint16_t tile) {
+        x1 = std::min(x1, width);
+        y1 = std::min(y1, height);
+        if (x0 >= x1 || y0 >= y1)
+            return;
+        //walked chunk by chunk so every chunk is looked up and marked once instead of once per tile
+        for (uint32_t cy = y0 / chunkSize; cy <= (y1 - 1) / chunkSize; cy++) {
+            for (uint32_t cx = x0 / chunkSize; cx <= (x1 - 1) / chunkSize; cx++) {
+                uint32_t index = cy * chunksX + cx;
+                Chunk &chunk = chunks[index];
+                if (chunk.tiles.empty()) {
+                    if (tile == emptyTile)
+                        continue;
+                    chunk.tiles.assign(chunkSize * chunkSize, emptyTile);
+                }
+                uint32_t left = std::max(x0, cx * chunkSize) - cx * chunkSize;
+                uint32_t right = std::min(x1, (cx + 1) * chunkSize) - cx * chunkSize;
+                uint32_t bottom = std::max(y0, cy * chunkSize) - cy * chunkSize;
+                uint32_t top = std::min(y1, (cy + 1) * chunkSize) - cy * chunkSize;
+                bool changed = false;
+                for (uint32_t y = bottom; y < top; y++) {
+                    uint16_t *row = chunk.tiles.data() + y * chunkSize;
+                    for (uint32_t x = left; x < right; x++) {
+                        if (row[x] == tile)
+                            continue;
+                        chunk.tileCount += (tile != emptyTile) - (row[x] != emptyTile);
+                        row[x] = tile;
+                        changed = true;
+                    }
+                }
+                if (changed) {
+                    chunk.version++;
+                    markDirty(index);
+                }
+            }
+        }
+    }
+
+    void Tilemap::setPalette(const std::vector<glm::vec4> &newPalette) {
+        palette = newPalette;
+        for (uint32_t chunk = 0; chunk < chunks.size(); chunk++) {
+            if (!chunks[chunk].tiles.empty())
+                markDirty(chunk);
+        }
+    }
+
+    void Tilemap::markDirty(uint32_t chunk) {
+        if (!chunks[chunk].dirty) {
+            chunks[chunk].dirty = true;
+            dirty.push_back(chunk);
+        }
+    }
+
+    const std::vector<uint32_t> &Tilemap::rebuildDirty() {
+        rebuilt.swap(dirty);
+        dirty.clear();
+        std::for_each(std::execution::par, rebuilt.begin(), rebuilt.end(), [this](uint32_t chunk) {
+            buildMesh(chunks[chunk]);
+            chunks[chunk].dirty = false;
+        });
+        return rebuilt;
+    }
+
+    void Tilemap::buildMesh(Chunk &chunk) const {
+        chunk.mesh.vertices.clear();
+        chunk.mesh.indices.clear();
+        chunk.mesh.lods.clear();
+        if (chunk.tileCount == 0) {
+            //nothing left to draw, the tiles are dropped so an emptied chunk costs nothing again
+            chunk.tiles = std::vector<uint16_t>();
+            return;
+        }
+
+        //runs of equal tiles along a row become one quad, which for typical maps of large uniform areas cuts the
+        //vertex count by an order of magnitude
+        for (uint32_t y = 0; y < chunkSize; y++) {
+            const uint16_t *row = chunk.tiles.data() + y * chunkSize;
+            uint32_t x = 0;
+            while (x < chunkSize) {
+                uint16_t tile = row[x];
+                uint32_t end = x + 1;
+                while (end < chunkSize && row[end] == tile)
+                    end++;
+                if (tile != emptyTile) {
+                    glm::vec4 color = tile < palette.size() ? palette[tile] : glm::vec4(1.f);
+                    auto first = (uint32_t) chunk.mesh.vertices.size();
+                    float left = (float) x * tileSize, right = (float) end * tileSize;
+                    float bottom = (float) y * tileSize, top = (float) (y + 1) * tileSize;
+                    chunk.mesh.vertices.push_back({{left, bottom, 0.f}, color});
+                    chunk.mesh.vertices.push_back({{right, bottom, 0.f}, color});
+                    chunk.mesh.vertices.push_back({{right, top, 0.f}, color});
+                    chunk.mesh.vertices.push_back({{left, top, 0.f}, color});
+                    for (uint32_t corner: {0u, 1u, 2u, 0u, 2u, 3u}) {
+                        chunk.mesh.indices.push_back(first + corner);
+                    }
+                }
+                x = end;
+            }
+        }
+    }
+
+    void Tilemap::visibleChunks(const glm::vec2 &center, const glm::vec2 &halfExtents,
+                                std::vector<uint32_t> &visible) const {
+        visible.clear();
+        float chunkExtent = (float) chunkSize * tileSize;
+        glm::vec2 low = (center - halfExtents - origin) / chunkExtent;
+        glm::vec2 high = (center + halfExtents - origin) / chunkExtent;
+        if (high.x < 0.f || high.y < 0.f || low.x >= (float) chunksX || low.y >= (float) chunksY)
+            return;
+        auto x0 = (uint32_t) std::max(0.f, std::floor(low.x));
+        auto y0 = (uint32_t) std::max(0.f, std::floor(low.y));
+        uint32_t x1 = std::min(chunksX - 1, (uint32_t) std::floor(high.x));
+        uint32_t y1 = std::min(chunksY - 1, (uint32_t) std::floor(high.y));
+        for (uint32_t y = y0; y <= y1; y++) {
+            for (uint32_t x = x0; x <= x1; x++) {
+                uint32_t chunk = y * chunksX + x;
+                if (chunks[chunk].tileCount > 0)
+                    visible.push_back(chunk);
+            }
+        }
+    }
+
+    uint32_t Tilemap::getChunkCount() const {
+        return (uint32_t) chunks.size();
+    }
+
+    const MeshComponent &Tilemap::getChunkMesh(uint32_t chunk) const {
+        return chunks[chunk].mesh;
+    }
+
+    MeshComponent Tilemap::takeChunkMesh(uint32_t chunk) {
+        MeshComponent mesh = std::move(chunks[chunk].mesh);
+        chunks[chunk].mesh = MeshComponent();
+        return mesh;
+    }
+
+    bool Tilemap::isChunkEmpty(uint32_t chunk) const {
+        return chunks[chunk].tileCount == 0;
+    }
+
+    glm::vec3 Tilemap::getChunkOrigin(uint32_t chunk) const {
+        float chunkExtent = (float) chunkSize * tileSize;
+        return {origin.x + (float) (chunk % chunksX) * chunkExtent, origin.y + (float) (chunk / chunksX) * chunkExtent,
+                0.f};
+    }
+
+    uint32_t Tilemap::getChunkVersion(uint32_t chunk) const {
+        return chunks[chunk].version;
+    }
+
+}
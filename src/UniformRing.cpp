@@ -0,0 +1,159 @@
+#include "UniformRing.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SGE {
+
+    RingAllocator::RingAllocator(uint64_t capacity) {
+        reset(capacity);
+    }
+
+    void RingAllocator::reset(uint64_t newCapacity) {
+        capacity = newCapacity;
+        frames.clear();
+        head = tail = used = currentFrameSize = 0;
+    }
+
+    uint64_t RingAllocator::allocate(uint64_t size, uint64_t alignment) {
+        //an empty ring starts over at zero so the largest possible block is free, frames still queued would move
+        //head back to their old tail when released so they have to be gone too
+        if (used == 0 && frames.empty())
+            head = tail = 0;
+        if (size == 0 || size > capacity || used == capacity)
+            return invalidOffset;
+
+        uint64_t aligned = (tail + alignment - 1) & ~(alignment - 1);
+        uint64_t offset = invalidOffset;
+        if (tail >= head) {
+            if (aligned + size <= capacity) {
+                offset = aligned;
+            } else if (size <= head) {
+                //wrap around, the bytes left at the end are given to this frame
+                used += capacity - tail;
+                currentFrameSize += capacity - tail;
+                tail = 0;
+                offset = 0;
+            }
+        } else if (aligned + size <= head) {
+            offset = aligned;
+        }
+        if (offset == invalidOffset)
+            return invalidOffset;
+
+        uint64_t taken = offset + size - tail;
+        used += taken;
+        currentFrameSize += taken;
+        tail = offset + size;
+        return offset;
+    }
+
+    void RingAllocator::finishFrame(uint64_t frame) {
+        frames.push_back({frame, tail, currentFrameSize});
+        currentFrameSize = 0;
+    }
+
+    void RingAllocator::releaseCompleted(uint64_t completedFrame) {
+        while (!frames.empty() && frames.front().frame <= completedFrame) {
+            head = frames.front().tail;
+            used -= frames.front().size;
+            frames.pop_front();
+        }
+    }
+
+    uint64_t RingAllocator::getCapacity() const {
+        return capacity;
+    }
+
+    uint64_t RingAllocator::getUsedSize() const {
+        return used;
+    }
+
+    size_t RingAllocator::getFramesInFlight() const {
+        return frames.size();
+    }
+
+    UniformRing::UniformRing(std::string name, Diligent::BIND_FLAGS bindFlags, uint64_t capacity) :
+            name(std::move(name)), bindFlags(bindFlags), allocator(capacity) {
+    }
+
+    void UniformRing::createBuffer(Diligent::IRenderDevice *renderDevice, uint64_t capacity) {
+        Diligent::BufferDesc desc;
+        desc.Name = name.c_str();
+        desc.Size = capacity;
+        //updated rather than mapped so command lists recorded on deferred contexts can read it
+        desc.Usage = Diligent::USAGE_DEFAULT;
+        desc.BindFlags = bindFlags;
+        //the old buffer stays alive until the frames still reading it are done
+        buffer.Release();
+        renderDevice->CreateBuffer(desc, nullptr, &buffer);
+        staging.assign(capacity, 0);
+        allocator.reset(capacity);
+    }
+
+    void UniformRing::beginFrame(Diligent::IRenderDevice *renderDevice) {
+        device = renderDevice;
+        if (!fence) {
+            std::string fenceName = name + " fence";
+            Diligent::FenceDesc desc;
+            desc.Name = fenceName.c_str();
+            device->CreateFence(desc, &fence);
+        }
+        if (!buffer)
+            createBuffer(device, allocator.getCapacity());
+        allocator.releaseCompleted(fence->GetCompletedValue());
+        spans.clear();
+        uploaded = 0;
+    }
+
+    uint64_t UniformRing::write(const void *data, uint64_t size, uint64_t alignment) {
+        void *destination = nullptr;
+        uint64_t offset = reserve(size, alignment, destination);
+        if (offset != RingAllocator::invalidOffset)
+            std::memcpy(destination, data, size);
+        return offset;
+    }
+
+    uint64_t UniformRing::reserve(uint64_t size, uint64_t alignment, void *&data) {
+        uint64_t offset = allocator.allocate(size, alignment);
+        if (offset == RingAllocator::invalidOffset && spans.empty() && uploaded == 0) {
+            //room for a request this size in every frame that can be in flight at once
+            uint64_t capacity = std::max<uint64_t>(allocator.getCapacity(), 1024) * 2;
+            while (capacity < size * (allocator.getFramesInFlight() + 1))
+                capacity *= 2;
+            createBuffer(device, capacity);
+            offset = allocator.allocate(size, alignment);
+        }
+        if (offset == RingAllocator::invalidOffset)
+            return offset;
+
+        data = staging.data() + offset;
+        if (!spans.empty() && spans.back().end <= offset)
+            spans.back().end = offset + size;
+        else
+            spans.push_back({offset, offset + size});
+        return offset;
+    }
+
+    void UniformRing::upload(Diligent::IDeviceContext *context) {
+        for (const auto &span: spans) {
+            context->UpdateBuffer(buffer, span.begin, span.end - span.begin, staging.data() + span.begin,
+                                  Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
+        uploaded += spans.size();
+        spans.clear();
+    }
+
+    void UniformRing::endFrame(Diligent::IDeviceContext *context) {
+        upload(context);
+        uploaded = 0;
+        allocator.finishFrame(frame);
+        context->EnqueueSignal(fence, frame);
+        frame++;
+    }
+
+    Diligent::IBuffer *UniformRing::getBuffer() const {
+        return buffer;
+    }
+
+}
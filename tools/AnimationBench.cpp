@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Animation.h"
+
+//plays a handful of shared clips with random keys on many animators at different times and speeds and times a
+//frame of sampling them. Afterwards every animator is sampled again from its keys with an exact lerp and a slerp
+//built on acos and sin, and the largest differences are reported.
+//run as AnimationBench [--animators n] [--clips n] [--keys n] [--frames n] [--seed n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double milliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    //keys at random gaps, the rotations turn up to about 120 degrees between two keys and may flip sign
+    SGE::AnimationClip randomClip(std::mt19937 &random, uint32_t keys) {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f), gap(0.1f, 0.5f);
+        SGE::AnimationClip clip;
+        for (SGE::AnimationTrack &track: clip.tracks) {
+            float time = 0.f;
+            for (uint32_t key = 0; key < keys; key++) {
+                track.times.push_back(time);
+                time += gap(random);
+            }
+        }
+        glm::vec4 rotation(1.f, 0.f, 0.f, 0.f);
+        for (uint32_t key = 0; key < keys; key++) {
+            clip.tracks[SGE::AnimationClip::Position].values.emplace_back(unit(random) * 10.f, unit(random) * 10.f,
+                                                                          unit(random) * 10.f, 0.f);
+            clip.tracks[SGE::AnimationClip::Scale].values.emplace_back(1.f + unit(random) * 0.5f,
+                                                                       1.f + unit(random) * 0.5f,
+                                                                       1.f + unit(random) * 0.5f, 0.f);
+            glm::vec4 next(rotation.x + unit(random), rotation.y + unit(random), rotation.z + unit(random),
+                           rotation.w + unit(random));
+            float length = std::sqrt(next.x * next.x + next.y * next.y + next.z * next.z + next.w * next.w);
+            rotation = glm::vec4(next.x / length, next.y / length, next.z / length, next.w / length);
+            float sign = unit(random) < 0.f ? -1.f : 1.f;
+            clip.tracks[SGE::AnimationClip::Rotation].values.emplace_back(rotation.x * sign, rotation.y * sign,
+                                                                          rotation.z * sign, rotation.w * sign);
+        }
+        return clip;
+    }
+
+    //the track at time by binary search, exact slerp for rotations
+    void reference(const SGE::AnimationTrack &track, float time, bool rotation, double *out) {
+        const std::vector<float> &times = track.times;
+        auto after = (size_t) (std::upper_bound(times.begin(), times.end(), time) - times.begin());
+        size_t before = after == 0 ? 0 : after - 1;
+        after = std::min(after, times.size() - 1);
+        double t = before == after ? 0.0 : (time - times[before]) / (double) (times[after] - times[before]);
+        const float *a = &track.values[before].x, *b = &track.values[after].x;
+        if (!rotation) {
+            for (int i = 0; i < 3; i++) {
+                out[i] = a[i] + (b[i] - (double) a[i]) * t;
+            }
+            return;
+        }
+        double dot = 0.0;
+        for (int i = 0; i < 4; i++) {
+            dot += (double) a[i] * b[i];
+        }
+        double sign = dot < 0.0 ? -1.0 : 1.0;
+        double angle = std::acos(std::min(1.0, std::abs(dot)));
+        double keep = 1.0 - t, take = t;
+        if (angle > 1e-6) {
+            keep = std::sin((1.0 - t) * angle) / std::sin(angle);
+            take = std::sin(t * angle) / std::sin(angle);
+        }
+        for (int i = 0; i < 4; i++) {
+            out[i] = a[i] * keep + b[i] * take * sign;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t animators = 10000, clipCount = 16, keys = 32, frames = 600, seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--animators" && i + 1 < argc) {
+            animators = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--clips" && i + 1 < argc) {
+            clipCount = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--keys" && i + 1 < argc) {
+            keys = std::max(2ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--frames" && i + 1 < argc) {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--seed" && i + 1 < argc) {
+            seed = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    std::mt19937 random(seed);
+    SGE::AnimationLibrary library;
+    for (uint32_t clip = 0; clip < clipCount; clip++) {
+        library.add("clip " + std::to_string(clip), randomClip(random, keys));
+    }
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::vector<SGE::Animator> states(animators);
+    std::vector<SGE::Transform> transforms(animators);
+    for (uint32_t i = 0; i < animators; i++) {
+        states[i].clip = i % clipCount;
+        states[i].time = unit(random) * library.get(states[i].clip)->duration;
+        states[i].speed = 0.5f + unit(random);
+        states[i].loop = i % 8 != 0;
+    }
+
+    const float dt = 1.f / 60.f;
+    SGE::AnimationSampler sampler;
+    Clock::duration sampling{};
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        auto start = Clock::now();
+        sampler.resize(animators);
+        for (uint32_t i = 0; i < animators; i++) {
+            sampler.prepare(i, *library.get(states[i].clip), states[i], transforms[i], dt);
+        }
+        sampler.evaluate();
+        for (uint32_t i = 0; i < animators; i++) {
+            sampler.read(i, transforms[i]);
+        }
+        sampling += Clock::now() - start;
+    }
+
+    double positionError = 0.0, scaleError = 0.0, rotationError = 0.0;
+    for (uint32_t i = 0; i < animators; i++) {
+        const SGE::AnimationClip &clip = *library.get(states[i].clip);
+        double position[4], rotation[4], scale[4];
+        reference(clip.tracks[SGE::AnimationClip::Position], states[i].time, false, position);
+        reference(clip.tracks[SGE::AnimationClip::Rotation], states[i].time, true, rotation);
+        reference(clip.tracks[SGE::AnimationClip::Scale], states[i].time, false, scale);
+        const SGE::Transform &transform = transforms[i];
+        for (int axis = 0; axis < 3; axis++) {
+            positionError = std::max(positionError, std::abs(position[axis] - (&transform.position.x)[axis]));
+            scaleError = std::max(scaleError, std::abs(scale[axis] - (&transform.scale.x)[axis]));
+        }
+        double dot = std::abs(rotation[0] * transform.rotation.w + rotation[1] * transform.rotation.x +
+                              rotation[2] * transform.rotation.y + rotation[3] * transform.rotation.z);
+        rotationError = std::max(rotationError, 2.0 * std::acos(std::min(1.0, dot)));
+    }
+    std::cout << animators << " animators on " << clipCount << " clips of " << keys << " keys, "
+              << milliseconds(sampling) / frames * 1000.0 << " us a frame" << std::endl;
+    std::cout << "largest error: position " << positionError << ", scale " << scaleError << ", rotation "
+              << rotationError << " radians" << std::endl;
+    if (positionError > 1e-4 || scaleError > 1e-5 || rotationError > 2e-3) {
+        std::cerr << "sampled poses are off their keys" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <cstdio>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "AtlasPacker.h"
+#include "MeshImporter.h"
+#include "MeshFile.h"
+#include "PakArchive.h"
+
+//converts the source meshes under <data>/models into binary .mesh files under <output>/models. The database in
+//<output>/cooker.db remembers the size, modification time and content hash of every source so unchanged assets are
+//skipped without being read, and touched but identical assets are skipped after hashing. Every cooked mesh is then
+//packed into <output>/assets.pak, which the engine maps once instead of opening each file.
+//Sprite images under <data>/sprites are packed into atlas pages under <output>/atlas first, meshes naming a sprite
+//then get texture coordinates inside the atlas. The atlas layout is kept with the hash of every input and the pages
+//are only repacked when that hash changes.
+namespace {
+    namespace fs = std::filesystem;
+
+    //bump whenever the cooked output changes for the same input, this forces a full rebuild
+    const std::string cookerVersion = "mesh3-lod4-atlas1";
+
+    struct Record {
+        uint64_t hash = 0;
+        uint64_t size = 0;
+        int64_t modified = 0;
+    };
+
+    enum class Outcome {
+        UpToDate,
+        Cooked,
+        Failed
+    };
+
+    struct Job {
+        std::string name;
+        fs::path source;
+        fs::path output;
+        Record record;
+        bool known = false;
+        Outcome outcome = Outcome::UpToDate;
+        std::string message;
+    };
+
+    uint64_t hashFile(const fs::path &path, bool &ok) {
+        uint64_t hash = 14695981039346656037ull;
+        std::FILE *file = std::fopen(path.string().c_str(), "rb");
+        ok = file != nullptr;
+        if (!ok)
+            return hash;
+
+        std::vector<unsigned char> buffer(1 << 16);
+        size_t read;
+        while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+            for (size_t i = 0; i < read; i++) {
+                hash = (hash ^ buffer[i]) * 1099511628211ull;
+            }
+        }
+        std::fclose(file);
+        return hash;
+    }
+
+    bool loadDatabase(const fs::path &path, std::unordered_map<std::string, Record> &records) {
+        std::ifstream file(path);
+        std::string line;
+        if (!file || !std::getline(file, line) || line != "version " + cookerVersion)
+            return false;
+
+        while (std::getline(file, line)) {
+            std::istringstream stream(line);
+            Record record;
+            std::string name;
+            stream >> record.hash >> record.size >> record.modified;
+            stream.get();
+            std::getline(stream, name);
+            if (stream.fail() || name.empty())
+                continue;
+            records[name] = record;
+        }
+        return true;
+    }
+
+    bool saveDatabase(const fs::path &path, const std::unordered_map<std::string, Record> &records) {
+        std::ofstream file(path, std::ios::trunc);
+        file << "version " << cookerVersion << "\n";
+        for (const auto &[name, record]: records) {
+            file << record.hash << " " << record.size << " " << record.modified << " " << name << "\n";
+        }
+        return (bool) file;
+    }
+
+    bool writePak(const fs::path &path, const fs::path &outputRoot,
+                  const std::unordered_map<std::string, Record> &records, const std::vector<std::string> &extra,
+                  std::string &error) {
+        SGE::PakWriter writer;
+        std::vector<std::string> entries = extra;
+        for (const auto &[name, record]: records) {
+            entries.push_back("models/" + name + ".mesh");
+        }
+        for (const auto &entry: entries) {
+            std::ifstream file(outputRoot / entry, std::ios::binary);
+            std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (!file.good() && !file.eof()) {
+                error = "could not read " + (outputRoot / entry).string();
+                return false;
+            }
+            writer.add(entry, std::move(data), true);
+        }
+        return writer.write(path.string(), error);
+    }
+
+    struct SpriteImage {
+        fs::path source;
+        std::vector<unsigned char> pixels;
+    };
+
+    //binary ppm, the one image format the tools already read and write. Only the header is read unless pixels is
+    //given.
+    bool readPpm(const fs::path &path, uint32_t &width, uint32_t &height, std::vector<unsigned char> *pixels) {
+        std::FILE *file = std::fopen(path.string().c_str(), "rb");
+        if (file == nullptr)
+            return false;
+        unsigned max = 0;
+        bool ok = std::fscanf(file, "P6 %u %u %u", &width, &height, &max) == 3 && max == 255 && std::fgetc(file) != EOF;
+        if (ok && pixels != nullptr) {
+            pixels->resize((size_t) width * height * 3);
+            ok = std::fread(pixels->data(), 1, pixels->size(), file) == pixels->size();
+        }
+        std::fclose(file);
+        return ok;
+    }
+
+    bool writePpm(const fs::path &path, uint32_t width, uint32_t height, const std::vector<unsigned char> &pixels) {
+        std::FILE *file = std::fopen(path.string().c_str(), "wb");
+        if (file == nullptr)
+            return false;
+        std::fprintf(file, "P6\n%u %u\n255\n", width, height);
+        std::fwrite(pixels.data(), 1, pixels.size(), file);
+        return std::fclose(file) == 0;
+    }
+
+    std::string pageName(uint32_t page) {
+        return "atlas/page" + std::to_string(page) + ".ppm";
+    }
+
+    //packs every sprite under spriteRoot into atlas pages, reusing the previous layout and pages when the sprites
+    //hash the same. changed tells whether the layout differs from the one meshes were cooked against before.
+    bool cookAtlas(const fs::path &spriteRoot, const fs::path &outputRoot, bool force, SGE::AtlasLayout &layout,
+                   bool &changed, std::string &error) {
+        std::vector<SGE::AtlasSprite> sprites;
+        std::vector<fs::path> sources;
+        for (const auto &entry: fs::recursive_directory_iterator(spriteRoot)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".ppm")
+                continue;
+            sprites.push_back({fs::relative(entry.path(), spriteRoot).replace_extension().generic_string()});
+            sources.push_back(entry.path());
+        }
+        std::vector<char> readable(sprites.size());
+        std::for_each(std::execution::par, sprites.begin(), sprites.end(), [&](SGE::AtlasSprite &sprite) {
+            size_t index = &sprite - sprites.data();
+            bool ok;
+            sprite.hash = hashFile(sources[index], ok);
+            readable[index] = ok && readPpm(sources[index], sprite.width, sprite.height, nullptr);
+        });
+        for (size_t i = 0; i < sprites.size(); i++) {
+            if (!readable[i]) {
+                error = "could not read the sprite " + sources[i].string();
+                return false;
+            }
+        }
+
+        SGE::AtlasDesc desc;
+        fs::path layoutPath = outputRoot / "atlas" / "atlas.layout";
+        uint64_t inputHash = SGE::AtlasPacker::hashInputs(sprites, desc);
+        SGE::AtlasLayout cached;
+        std::string ignored;
+        std::error_code ec;
+        if (!force && SGE::AtlasPacker::read(layoutPath.string(), cached, ignored) && cached.inputHash == inputHash) {
+            bool pagesExist = true;
+            for (uint32_t page = 0; page < cached.pageCount; page++) {
+                pagesExist = pagesExist && fs::exists(outputRoot / pageName(page), ec);
+            }
+            if (pagesExist) {
+                layout = std::move(cached);
+                changed = false;
+                return true;
+            }
+        }
+
+        if (!SGE::AtlasPacker::pack(sprites, desc, layout, error))
+            return false;
+
+        //each page is composed on its own thread, the padding repeats the sprite's edge pixels
+        fs::create_directories(outputRoot / "atlas", ec);
+        std::vector<uint32_t> pages(layout.pageCount);
+        std::iota(pages.begin(), pages.end(), 0);
+        std::vector<std::string> failures(layout.pageCount);
+        std::unordered_map<std::string, size_t> sourceOf;
+        for (size_t i = 0; i < sprites.size(); i++) {
+            sourceOf[sprites[i].name] = i;
+        }
+        std::for_each(std::execution::par, pages.begin(), pages.end(), [&](uint32_t page) {
+            std::vector<unsigned char> pixels((size_t) desc.pageWidth * desc.pageHeight * 3, 0);
+            std::vector<unsigned char> image;
+            for (const auto &entry: layout.entries) {
+                if (entry.page != page)
+                    continue;
+                uint32_t width, height;
+                if (!readPpm(sources[sourceOf.at(entry.name)], width, height, &image) || width != entry.rect.width ||
+                    height != entry.rect.height) {
+                    failures[page] = "the sprite " + entry.name + " changed while cooking";
+                    return;
+                }
+                int pad = (int) desc.padding;
+                for (int y = -pad; y < (int) height + pad; y++) {
+                    int sy = std::clamp(y, 0, (int) height - 1);
+                    for (int x = -pad; x < (int) width + pad; x++) {
+                        int sx = std::clamp(x, 0, (int) width - 1);
+                        size_t to = ((size_t) (entry.rect.y + y) * desc.pageWidth + entry.rect.x + x) * 3;
+                        size_t from = ((size_t) sy * width + sx) * 3;
+                        std::copy_n(image.begin() + (ptrdiff_t) from, 3, pixels.begin() + (ptrdiff_t) to);
+                    }
+                }
+            }
+            if (!writePpm(outputRoot / pageName(page), desc.pageWidth, desc.pageHeight, pixels))
+                failures[page] = "could not write " + (outputRoot / pageName(page)).string();
+        });
+        for (const auto &failure: failures) {
+            if (!failure.empty()) {
+                error = failure;
+                return false;
+            }
+        }
+        changed = true;
+        return SGE::AtlasPacker::write(layoutPath.string(), layout, error);
+    }
+
+    void cook(Job &job, const SGE::AtlasLayout *atlas, bool atlasChanged) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(job.source, ec);
+        int64_t modified = fs::last_write_time(job.source, ec).time_since_epoch().count();
+        bool outputExists = fs::exists(job.output, ec);
+        if (job.known && outputExists && !atlasChanged && job.record.size == size && job.record.modified == modified)
+            return;
+
+        bool ok;
+        uint64_t hash = hashFile(job.source, ok);
+        if (!ok) {
+            job.outcome = Outcome::Failed;
+            job.message = "could not read " + job.source.string();
+            return;
+        }
+
+        bool changed = !job.known || !outputExists || atlasChanged || job.record.hash != hash;
+        job.record = {hash, size, modified};
+        if (!changed)
+            return;
+
+        uint32_t id = 0;
+        SGE::MeshComponent mesh;
+        std::string report;
+        if (!SGE::MeshImporter::read(job.source.string(), id, mesh, job.message, report, atlas) ||
+            !SGE::MeshFile::write(job.output.string(), mesh, job.message)) {
+            //the engine prefers a cooked mesh to its source, an older cook would hide the broken source
+            fs::remove(job.output, ec);
+            job.outcome = Outcome::Failed;
+            return;
+        }
+        job.outcome = Outcome::Cooked;
+        job.message = report;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: AssetCooker <data directory> <output directory> [--force] [--no-pak]\n";
+        return 1;
+    }
+
+    fs::path sourceRoot = fs::path(argv[1]) / "models";
+    fs::path outputRoot = fs::path(argv[2]);
+    bool force = false;
+    bool pak = true;
+    for (int i = 3; i < argc; i++) {
+        std::string option = argv[i];
+        force = force || option == "--force";
+        pak = pak && option != "--no-pak";
+    }
+    fs::path databasePath = outputRoot / "cooker.db";
+    fs::path pakPath = outputRoot / "assets.pak";
+
+    std::unordered_map<std::string, Record> records;
+    if (!force && !loadDatabase(databasePath, records))
+        records.clear();
+
+    std::error_code ec;
+    if (!fs::is_directory(sourceRoot, ec)) {
+        std::cerr << sourceRoot.string() << " is not a directory\n";
+        return 1;
+    }
+
+    fs::path spriteRoot = fs::path(argv[1]) / "sprites";
+    SGE::AtlasLayout atlas;
+    bool haveAtlas = fs::is_directory(spriteRoot, ec);
+    bool atlasChanged = false;
+    std::vector<std::string> atlasFiles;
+    if (haveAtlas) {
+        std::string error;
+        if (!cookAtlas(spriteRoot, outputRoot, force, atlas, atlasChanged, error)) {
+            std::cerr << "Error, could not build the sprite atlas: " << error << "\n";
+            return 1;
+        }
+        atlasFiles.push_back("atlas/atlas.layout");
+        for (uint32_t page = 0; page < atlas.pageCount; page++) {
+            atlasFiles.push_back(pageName(page));
+        }
+        std::cout << (atlasChanged ? "Packed " : "Reused ") << atlas.entries.size() << " sprites on "
+                  << atlas.pageCount << " atlas pages\n";
+    }
+
+    std::vector<Job> jobs;
+    for (const auto &entry: fs::recursive_directory_iterator(sourceRoot)) {
+        if (!entry.is_regular_file() || !SGE::MeshImporter::isSourceFormat(entry.path().string()))
+            continue;
+        //files with example in their name only document the source formats and are never cooked
+        if (entry.path().filename().string().find("example") != std::string::npos)
+            continue;
+
+        Job job;
+        job.name = fs::relative(entry.path(), sourceRoot).generic_string();
+        job.source = entry.path();
+        job.output = outputRoot / "models" / (job.name + ".mesh");
+        auto it = records.find(job.name);
+        if (it != records.end()) {
+            job.record = it->second;
+            job.known = true;
+        }
+        fs::create_directories(job.output.parent_path(), ec);
+        jobs.push_back(std::move(job));
+    }
+
+    std::for_each(std::execution::par, jobs.begin(), jobs.end(), [&](Job &job) {
+        cook(job, haveAtlas ? &atlas : nullptr, atlasChanged);
+    });
+
+    std::unordered_map<std::string, Record> updated;
+    std::unordered_set<std::string> sources;
+    size_t cooked = 0, upToDate = 0, failed = 0;
+    for (const auto &job: jobs) {
+        sources.insert(job.name);
+        switch (job.outcome) {
+            case Outcome::Cooked:
+                cooked++;
+                updated[job.name] = job.record;
+                std::cout << job.message << "\n";
+                break;
+            case Outcome::UpToDate:
+                upToDate++;
+                updated[job.name] = job.record;
+                break;
+            case Outcome::Failed:
+                failed++;
+                std::cerr << "Error, failed to cook " << job.name << ": " << job.message << "\n";
+                break;
+        }
+    }
+    //sources that disappeared take their cooked output with them
+    bool removed = false;
+    for (const auto &[name, record]: records) {
+        if (sources.find(name) == sources.end()) {
+            fs::remove(outputRoot / "models" / (name + ".mesh"), ec);
+            removed = true;
+        }
+    }
+
+    fs::create_directories(outputRoot, ec);
+    if (!saveDatabase(databasePath, updated)) {
+        std::cerr << "Error, could not write " << databasePath.string() << "\n";
+        return 1;
+    }
+
+    //a failed asset is left out of the archive so the engine falls back to parsing its source
+    if (pak && (force || cooked > 0 || failed > 0 || removed || atlasChanged || !fs::exists(pakPath, ec))) {
+        std::string error;
+        if (!writePak(pakPath, outputRoot, updated, atlasFiles, error)) {
+            std::cerr << "Error, could not write " << pakPath.string() << ": " << error << "\n";
+            return 1;
+        }
+    } else if (!pak) {
+        fs::remove(pakPath, ec);
+    }
+
+    std::cout << "Cooked " << cooked << ", up to date " << upToDate << ", failed " << failed << "\n";
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AtlasPacker.h"
+
+//packs generated sprite sets the size of a sprite heavy scene and checks that no two sprites overlap and every one
+//stays on its page. Prints the pack time, the page count and how full the pages are.
+//run as AtlasBench [--sprites n] [--page size] [--iterations n] [--seed n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    uint32_t nextRandom(uint32_t &state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    bool validate(const SGE::AtlasLayout &layout, size_t spriteCount, std::string &error) {
+        if (layout.entries.size() != spriteCount) {
+            error = "sprites went missing";
+            return false;
+        }
+        uint32_t padding = layout.desc.padding;
+        std::vector<std::vector<const SGE::AtlasEntry *>> pages(layout.pageCount);
+        for (const auto &entry: layout.entries) {
+            if (entry.rect.x < padding || entry.rect.y < padding ||
+                entry.rect.x + entry.rect.width + padding > layout.desc.pageWidth ||
+                entry.rect.y + entry.rect.height + padding > layout.desc.pageHeight) {
+                error = entry.name + " sticks out of its page";
+                return false;
+            }
+            pages[entry.page].push_back(&entry);
+        }
+        //sweep along x per page, only sprites whose x ranges overlap are compared
+        for (auto &page: pages) {
+            std::sort(page.begin(), page.end(), [](const SGE::AtlasEntry *a, const SGE::AtlasEntry *b) {
+                return a->rect.x < b->rect.x;
+            });
+            for (size_t i = 0; i < page.size(); i++) {
+                const SGE::AtlasRect &a = page[i]->rect;
+                for (size_t j = i + 1; j < page.size() && page[j]->rect.x < a.x + a.width + 2 * padding; j++) {
+                    const SGE::AtlasRect &b = page[j]->rect;
+                    if (b.y < a.y + a.height + 2 * padding && a.y < b.y + b.height + 2 * padding) {
+                        error = page[i]->name + " overlaps " + page[j]->name;
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t spriteCount = 20000, pageSize = 4096, iterations = 5, seed = 12345;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--sprites" && i + 1 < argc) {
+            spriteCount = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--page" && i + 1 < argc) {
+            pageSize = std::max(64ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--seed" && i + 1 < argc) {
+            seed = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    //mostly small icons and tiles with a few large sprites, like a typical 2d scene
+    std::vector<SGE::AtlasSprite> sprites(spriteCount);
+    for (uint32_t i = 0; i < spriteCount; i++) {
+        uint32_t kind = nextRandom(seed) % 10;
+        uint32_t limit = kind < 7 ? 32 : kind < 9 ? 96 : 256;
+        sprites[i].name = "sprite" + std::to_string(i);
+        sprites[i].width = 8 + nextRandom(seed) % limit;
+        sprites[i].height = 8 + nextRandom(seed) % limit;
+        sprites[i].hash = i;
+    }
+
+    SGE::AtlasDesc desc;
+    desc.pageWidth = pageSize;
+    desc.pageHeight = pageSize;
+    desc.maxPages = 256;
+    SGE::AtlasLayout layout;
+    std::string error;
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (!SGE::AtlasPacker::pack(sprites, desc, layout, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+    auto packed = Clock::now();
+    uint64_t hash = SGE::AtlasPacker::hashInputs(sprites, desc);
+    auto hashed = Clock::now();
+    if (!validate(layout, sprites.size(), error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    uint64_t spriteArea = 0;
+    for (const auto &sprite: sprites) {
+        spriteArea += (uint64_t) sprite.width * sprite.height;
+    }
+    double occupancy = (double) spriteArea / ((double) layout.pageCount * pageSize * pageSize);
+    std::cout << spriteCount << " sprites on " << layout.pageCount << " pages of " << pageSize << "x" << pageSize
+              << ", " << occupancy * 100.0 << "% covered" << std::endl;
+    std::cout << "pack " << std::chrono::duration<double, std::milli>(packed - start).count() / iterations
+              << " ms, input hash " << std::chrono::duration<double, std::milli>(hashed - packed).count()
+              << " ms (" << std::hex << hash << std::dec << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DebugDraw.h"
+
+//records lines from several threads at once the way parallel systems would, collects them like the renderer does
+//once per frame and checks every line arrived exactly once with its vertices in order. Prints the time spent
+//recording and collecting per frame.
+//run as DebugDrawBench [--threads n] [--lines n] [--frames n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double milliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t threads = 8, lines = 20000, frames = 20;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--threads" && i + 1 < argc) {
+            threads = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--lines" && i + 1 < argc) {
+            lines = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--frames" && i + 1 < argc) {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+    if (!SGE::DebugDraw::enabled) {
+        std::cout << "debug draw is compiled out, nothing to measure" << std::endl;
+        return 0;
+    }
+
+    std::vector<SGE::Vertex> vertices;
+    Clock::duration recording{}, collecting{};
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        //new threads every frame, so the buffers of the ones that exited have to be drained and dropped as well
+        auto start = Clock::now();
+        std::vector<std::thread> workers;
+        for (uint32_t t = 0; t < threads; t++) {
+            workers.emplace_back([t, lines, frame] {
+                for (uint32_t line = 0; line < lines; line++) {
+                    glm::vec4 color((float) t, (float) line, (float) frame, 1.f);
+                    SGE::DebugDraw::line({(float) line, 0.f, 0.f}, {(float) line, 1.f, 0.f}, color);
+                }
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        auto recorded = Clock::now();
+        vertices.clear();
+        SGE::DebugDraw::collect(vertices);
+        auto collected = Clock::now();
+        recording += recorded - start;
+        collecting += collected - recorded;
+
+        if (vertices.size() != (size_t) threads * lines * 2) {
+            std::cerr << "frame " << frame << " collected " << vertices.size() / 2 << " lines instead of "
+                      << (size_t) threads * lines << std::endl;
+            return 1;
+        }
+        //each thread's lines are contiguous and in the order it recorded them
+        std::vector<uint32_t> next(threads, 0);
+        for (size_t v = 0; v < vertices.size(); v += 2) {
+            const glm::vec4 &color = vertices[v].texCoord;
+            auto t = (uint32_t) color.x, line = (uint32_t) color.y;
+            if (t >= threads || line != next[t] || (uint32_t) color.z != frame ||
+                vertices[v].pos.x != (float) line || vertices[v + 1].pos.y != 1.f) {
+                std::cerr << "frame " << frame << " has a wrong vertex at " << v << std::endl;
+                return 1;
+            }
+            next[t]++;
+        }
+    }
+
+    //a box is twelve lines and nothing is left over once collected
+    SGE::DebugDraw::box(glm::vec3(0.f), glm::vec3(1.f), glm::vec4(1.f));
+    vertices.clear();
+    SGE::DebugDraw::collect(vertices);
+    SGE::DebugDraw::collect(vertices);
+    if (vertices.size() != 24) {
+        std::cerr << "a box came out as " << vertices.size() << " vertices" << std::endl;
+        return 1;
+    }
+
+    std::cout << threads << " threads x " << lines << " lines per frame" << std::endl;
+    std::cout << "record " << milliseconds(recording) / frames << " ms, collect " << milliseconds(collecting) / frames
+              << " ms" << std::endl;
+    return 0;
+}
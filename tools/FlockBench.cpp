@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Flocking.h"
+
+//flies a flock spread over a square sized so a boid has about density neighbours, integrating it the way
+//UpdateMovement does, and times steering it each frame. Afterwards the hash is checked to hold every boid once in
+//its own cell, and a sample of boids is steered again by testing against every other boid.
+//run as FlockBench [--boids n] [--frames n] [--density n] [--seed n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double milliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    glm::vec2 steerTowards(glm::vec2 direction, glm::vec2 velocity, const SGE::Boid &boid) {
+        float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        if (length <= 0.f)
+            return glm::vec2(0.f);
+        glm::vec2 force = direction * (boid.maxSpeed / length) - velocity;
+        float size = std::sqrt(force.x * force.x + force.y * force.y);
+        return size > boid.maxForce ? force * (boid.maxForce / size) : force;
+    }
+
+    glm::vec2 bruteForce(const std::vector<glm::vec2> &positions, const std::vector<glm::vec2> &velocities,
+                         const SGE::Boid &boid, const SGE::FlockSettings &settings, uint32_t self) {
+        glm::vec2 sum(0.f), heading(0.f), away(0.f);
+        uint32_t neighbours = 0;
+        for (uint32_t other = 0; other < positions.size(); other++) {
+            glm::vec2 offset = positions[other] - positions[self];
+            float distance = offset.x * offset.x + offset.y * offset.y;
+            if (distance >= settings.radius * settings.radius || distance <= 0.f)
+                continue;
+            neighbours++;
+            sum += positions[other];
+            heading += velocities[other];
+            if (distance < settings.separationRadius * settings.separationRadius)
+                away -= offset * (1.f / distance);
+        }
+        if (neighbours == 0)
+            return glm::vec2(0.f);
+        glm::vec2 acceleration = steerTowards(away, velocities[self], boid) * settings.separation +
+                                 steerTowards(heading, velocities[self], boid) * settings.alignment +
+                                 steerTowards(sum * (1.f / (float) neighbours) - positions[self], velocities[self],
+                                              boid) * settings.cohesion;
+        float force = std::sqrt(acceleration.x * acceleration.x + acceleration.y * acceleration.y);
+        return force > boid.maxForce ? acceleration * (boid.maxForce / force) : acceleration;
+    }
+
+    bool checkHash(const SGE::SpatialHash &hash, const std::vector<glm::vec2> &positions) {
+        std::vector<uint32_t> seen(positions.size(), 0);
+        for (const SGE::SpatialHash::Cell &cell: hash.getCells()) {
+            if (hash.find(cell.x, cell.y) != &cell) {
+                std::cerr << "cell " << cell.x << ", " << cell.y << " is not found" << std::endl;
+                return false;
+            }
+            for (uint32_t slot = cell.first; slot < cell.last; slot++) {
+                uint32_t point = hash.getOrder()[slot];
+                seen[point]++;
+                if ((int32_t) std::floor(positions[point].x / hash.getCellSize()) != cell.x ||
+                    (int32_t) std::floor(positions[point].y / hash.getCellSize()) != cell.y ||
+                    (slot > cell.first && hash.getOrder()[slot - 1] >= point)) {
+                    std::cerr << "boid " << point << " is out of place in its cell" << std::endl;
+                    return false;
+                }
+            }
+        }
+        for (uint32_t point = 0; point < seen.size(); point++) {
+            if (seen[point] != 1) {
+                std::cerr << "boid " << point << " is in the hash " << seen[point] << " times" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t boids = 100000, frames = 120, seed = 1;
+    float density = 8.f;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--boids" && i + 1 < argc) {
+            boids = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--frames" && i + 1 < argc) {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--density" && i + 1 < argc) {
+            density = std::max(0.1f, std::strtof(argv[++i], nullptr));
+        } else if (option == "--seed" && i + 1 < argc) {
+            seed = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    const float dt = 1.f / 60.f;
+    SGE::FlockSettings settings;
+    SGE::Boid boid;
+    float side = std::sqrt((float) boids * 3.14159265f * settings.radius * settings.radius / density);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> place(-side * 0.5f, side * 0.5f), speed(-boid.maxSpeed, boid.maxSpeed);
+    std::vector<glm::vec2> positions(boids), velocities(boids);
+    for (uint32_t i = 0; i < boids; i++) {
+        positions[i] = glm::vec2(place(random), place(random));
+        velocities[i] = glm::vec2(speed(random), speed(random)) * 0.5f;
+    }
+
+    SGE::Flock flock;
+    flock.resize(boids);
+    Clock::duration steering{};
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        for (uint32_t i = 0; i < boids; i++) {
+            flock.set(i, positions[i], velocities[i], boid);
+        }
+        auto start = Clock::now();
+        flock.steer(settings);
+        steering += Clock::now() - start;
+        if (frame + 1 == frames)
+            break;
+        for (uint32_t i = 0; i < boids; i++) {
+            const glm::vec2 &acceleration = flock.getAcceleration(i);
+            positions[i] += velocities[i] * dt + acceleration * (0.5f * dt * dt);
+            velocities[i] += acceleration * dt;
+        }
+    }
+
+    if (!checkHash(flock.getHash(), positions))
+        return 1;
+    std::uniform_int_distribution<uint32_t> pick(0, boids - 1);
+    for (uint32_t i = 0; i < std::min(boids, 1000u); i++) {
+        uint32_t self = pick(random);
+        glm::vec2 expected = bruteForce(positions, velocities, boid, settings, self);
+        const glm::vec2 &acceleration = flock.getAcceleration(self);
+        //the sums are added up in a different order, so a flock far from the origin differs in the last bits
+        if (std::abs(acceleration.x - expected.x) > 1e-3f * boid.maxForce ||
+            std::abs(acceleration.y - expected.y) > 1e-3f * boid.maxForce) {
+            std::cerr << "boid " << self << " steers differently from testing every other boid" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << boids << " boids in " << flock.getHash().getCells().size() << " cells, steering "
+              << milliseconds(steering) / frames << " ms a frame" << std::endl;
+    return 0;
+}
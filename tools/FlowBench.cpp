@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FlowField.h"
+
+//steers a crowd of agents to a few goals across a generated map of walls and rough ground through the flow field
+//cache and times a frame once the fields are warm. Every settled cell is checked against a plain Dijkstra over the
+//whole map, before and after walls are added to one sector and the fields repaired. A cache with fewer fields than
+//goals has to keep every field still in use and only drop the ones nobody asks for anymore.
+//run as FlowBench [--size n] [--agents n] [--goals n] [--frames n] [--seed n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Agent {
+        glm::vec2 position;
+        uint32_t goal;
+    };
+
+    double milliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    //the same costs and moves as FlowField, with nothing but a dense array and a heap
+    std::vector<uint32_t> reference(const SGE::NavGrid &grid, uint32_t goalX, uint32_t goalY) {
+        const int stepX[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+        const int stepY[8] = {0, 0, 1, -1, 1, 1, -1, -1};
+        uint32_t width = grid.getWidth();
+        std::vector<uint32_t> values((size_t) width * grid.getHeight(), SGE::FlowField::unvisited);
+        std::vector<std::pair<uint32_t, uint32_t>> open{{0, goalY * width + goalX}};
+        values[goalY * width + goalX] = 0;
+        while (!open.empty()) {
+            std::pop_heap(open.begin(), open.end(), std::greater<>());
+            auto [value, cell] = open.back();
+            open.pop_back();
+            if (value != values[cell])
+                continue;
+            uint32_t x = cell % width, y = cell / width;
+            for (int d = 0; d < 8; d++) {
+                uint32_t nx = x + stepX[d], ny = y + stepY[d];
+                uint8_t cost = grid.getCost(nx, ny);
+                if (cost == SGE::NavGrid::blocked || (d >= 4 && (grid.getCost(nx, y) == SGE::NavGrid::blocked ||
+                                                                 grid.getCost(x, ny) == SGE::NavGrid::blocked)))
+                    continue;
+                uint32_t next = value + cost * (d >= 4 ? 14 : 10);
+                if (next < values[ny * width + nx]) {
+                    values[ny * width + nx] = next;
+                    open.emplace_back(next, ny * width + nx);
+                    std::push_heap(open.begin(), open.end(), std::greater<>());
+                }
+            }
+        }
+        return values;
+    }
+
+    bool check(const SGE::NavGrid &grid, SGE::FlowField *field, uint32_t goalX, uint32_t goalY, uint32_t &settled) {
+        std::vector<uint32_t> expected = reference(grid, goalX, goalY);
+        settled = 0;
+        for (uint32_t y = 0; y < grid.getHeight(); y++) {
+            for (uint32_t x = 0; x < grid.getWidth(); x++) {
+                if (!field->isSettled(x, y))
+                    continue;
+                settled++;
+                if (field->getIntegration(x, y) != expected[(size_t) y * grid.getWidth() + x]) {
+                    std::cerr << "cell " << x << ", " << y << " is " << field->getIntegration(x, y) << " instead of "
+                              << expected[(size_t) y * grid.getWidth() + x] << std::endl;
+                    return false;
+                }
+                //the flow has to lead downhill
+                glm::vec2 direction;
+                field->getDirection(x, y, direction);
+                uint32_t nx = x + (direction.x > 0.f) - (direction.x < 0.f);
+                uint32_t ny = y + (direction.y > 0.f) - (direction.y < 0.f);
+                if (direction != glm::vec2(0.f) && field->getIntegration(nx, ny) >= field->getIntegration(x, y)) {
+                    std::cerr << "the flow of cell " << x << ", " << y << " leads uphill" << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    //more goals in use than the cache holds, none of them may be evicted and searched again from scratch
+    bool checkOverflow(const SGE::NavGrid &grid, const std::vector<glm::uvec2> &goals) {
+        const size_t maxFields = 2;
+        SGE::FlowFieldCache cache(&grid, maxFields);
+        std::vector<SGE::FlowField *> fields(goals.size());
+        for (uint32_t frame = 0; frame < 4; frame++) {
+            for (size_t goal = 0; goal < goals.size(); goal++) {
+                SGE::FlowField *field = cache.get(goals[goal].x, goals[goal].y);
+                if (frame > 0 && (field != fields[goal] || !field->isSettled(goals[goal].x, goals[goal].y))) {
+                    std::cerr << "the field of goal " << goal << " was evicted while in use" << std::endl;
+                    return false;
+                }
+                fields[goal] = field;
+                field->require(goals[goal].x, goals[goal].y);
+            }
+            cache.expand(UINT32_MAX);
+            cache.endFrame();
+            if (cache.getFieldCount() != goals.size()) {
+                std::cerr << cache.getFieldCount() << " of " << goals.size() << " fields in use were kept"
+                          << std::endl;
+                return false;
+            }
+        }
+
+        //once only the first goal is asked for, the stale fields go down to the soft cap and the used one stays
+        if (cache.get(goals[0].x, goals[0].y) != fields[0])
+            return false;
+        cache.endFrame();
+        if (cache.getFieldCount() != maxFields || cache.get(goals[0].x, goals[0].y) != fields[0]) {
+            std::cerr << cache.getFieldCount() << " fields were kept after the other goals went unused" << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t size = 1024, agentCount = 20000, goalCount = 4, frames = 60, seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--size" && i + 1 < argc) {
+            size = std::clamp<uint32_t>(std::strtoul(argv[++i], nullptr, 10), 64, SGE::NavGrid::maxSize);
+        } else if (option == "--agents" && i + 1 < argc) {
+            agentCount = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--goals" && i + 1 < argc) {
+            goalCount = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--frames" && i + 1 < argc) {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--seed" && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    //walls with gaps and patches of rough ground
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<uint32_t> coordinate(0, size - 1);
+    SGE::NavGrid grid(size, size, 1.f);
+    for (uint32_t wall = 0; wall < size / 8; wall++) {
+        uint32_t x = coordinate(random), y = coordinate(random), length = 8 + coordinate(random) % (size / 4);
+        bool horizontal = random() & 1;
+        for (uint32_t i = 0; i < length; i++) {
+            grid.setCost(horizontal ? x + i : x, horizontal ? y : y + i, SGE::NavGrid::blocked);
+        }
+    }
+    for (uint32_t patch = 0; patch < size / 4; patch++) {
+        uint32_t x = coordinate(random), y = coordinate(random);
+        for (uint32_t i = 0; i < 64; i++) {
+            uint32_t px = x + i % 8, py = y + i / 8;
+            if (grid.getCost(px, py) != SGE::NavGrid::blocked)
+                grid.setCost(px, py, 3);
+        }
+    }
+    std::vector<uint32_t> changed;
+    grid.takeChangedSectors(changed);
+
+    std::vector<glm::uvec2> goals;
+    while (goals.size() < goalCount) {
+        glm::uvec2 goal(coordinate(random), coordinate(random));
+        if (grid.getCost(goal.x, goal.y) != SGE::NavGrid::blocked)
+            goals.push_back(goal);
+    }
+    std::vector<Agent> agents;
+    while (agents.size() < agentCount) {
+        uint32_t x = coordinate(random), y = coordinate(random);
+        if (grid.getCost(x, y) != SGE::NavGrid::blocked)
+            agents.push_back({grid.getCellCenter(x, y), (uint32_t) agents.size() % goalCount});
+    }
+
+    if (goalCount > 2 && !checkOverflow(grid, goals))
+        return 1;
+
+    SGE::FlowFieldCache cache(&grid, goalCount);
+    std::vector<SGE::FlowField *> fields(goalCount);
+    auto frame = [&]() {
+        for (uint32_t goal = 0; goal < goalCount; goal++) {
+            fields[goal] = cache.get(goals[goal].x, goals[goal].y);
+        }
+        for (const Agent &agent: agents) {
+            uint32_t x, y;
+            if (grid.cellAt(agent.position, x, y))
+                fields[agent.goal]->require(x, y);
+        }
+        cache.expand(UINT32_MAX);
+        std::for_each(std::execution::par, agents.begin(), agents.end(), [&](Agent &agent) {
+            uint32_t x, y;
+            glm::vec2 direction;
+            if (grid.cellAt(agent.position, x, y) && fields[agent.goal]->getDirection(x, y, direction))
+                agent.position += direction * (4.f / 60.f);
+        });
+        cache.endFrame();
+    };
+
+    auto start = Clock::now();
+    frame();
+    auto cold = Clock::now();
+    for (uint32_t i = 0; i < frames; i++) {
+        frame();
+    }
+    auto warm = Clock::now();
+
+    uint32_t settled = 0, total = 0;
+    for (uint32_t goal = 0; goal < goalCount; goal++) {
+        if (!check(grid, fields[goal], goals[goal].x, goals[goal].y, settled))
+            return 1;
+        total += settled;
+    }
+
+    //a block of wall in the sector of the first agent, then the fields are repaired on the next frame
+    uint32_t wallX, wallY;
+    grid.cellAt(agents[0].position, wallX, wallY);
+    wallX = wallX / SGE::NavGrid::sectorSize * SGE::NavGrid::sectorSize;
+    wallY = wallY / SGE::NavGrid::sectorSize * SGE::NavGrid::sectorSize;
+    for (uint32_t i = 4; i < SGE::NavGrid::sectorSize - 4; i++) {
+        grid.setCost(wallX + i, wallY + SGE::NavGrid::sectorSize / 2, SGE::NavGrid::blocked);
+        grid.setCost(wallX + i, wallY + 4, 1);
+    }
+    auto editStart = Clock::now();
+    grid.takeChangedSectors(changed);
+    cache.invalidate(changed);
+    frame();
+    auto edited = Clock::now();
+    uint32_t repaired = 0;
+    for (uint32_t goal = 0; goal < goalCount; goal++) {
+        if (!check(grid, fields[goal], goals[goal].x, goals[goal].y, settled))
+            return 1;
+        repaired += settled;
+    }
+
+    std::cout << agentCount << " agents, " << goalCount << " goals, " << total << " cells settled" << std::endl;
+    std::cout << "first frame " << milliseconds(cold - start) << " ms, frame " << milliseconds(warm - cold) / frames
+              << " ms, frame after a sector changed " << milliseconds(edited - editStart) << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AnchorLayout.h"
+
+//builds an inventory screen the size of the ones in the game, windows holding grids of slots that each hold an icon,
+//a count and a few decorations, and lays it out for a series of window sizes. Every rectangle is checked against a
+//plain recursive solve of the same rules, then the time to flatten the tree and to lay it out is printed.
+//run as LayoutBench [--windows n] [--slots n] [--iterations n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Tree {
+        std::vector<SGE::AnchorRule> rules;
+        std::vector<uint32_t> parents;
+
+        uint32_t add(uint32_t parent, glm::vec2 anchorMin, glm::vec2 anchorMax, glm::vec2 offsetMin,
+                     glm::vec2 offsetMax) {
+            rules.push_back({anchorMin, anchorMax, offsetMin, offsetMax});
+            parents.push_back(parent);
+            return (uint32_t) rules.size() - 1;
+        }
+    };
+
+    //children are added before their parents here and there so build has to sort them out
+    Tree makeInventory(uint32_t windows, uint32_t slots) {
+        Tree tree;
+        for (uint32_t w = 0; w < windows; w++) {
+            float x = (float) (w % 4) * 0.25f, y = (float) (w / 4 % 2) * 0.5f;
+            uint32_t panel = tree.add(SGE::AnchorLayout::window, {x, y}, {x + 0.25f, y + 0.5f}, {8.f, 8.f},
+                                      {-8.f, -8.f});
+            tree.add(panel, {0.f, 0.f}, {1.f, 0.f}, {0.f, 0.f}, {0.f, 24.f});
+            uint32_t grid = tree.add(panel, {0.f, 0.f}, {1.f, 1.f}, {4.f, 28.f}, {-4.f, -4.f});
+            auto columns = (uint32_t) std::ceil(std::sqrt((float) slots));
+            for (uint32_t s = 0; s < slots; s++) {
+                float u = (float) (s % columns) / (float) columns, v = (float) (s / columns) / (float) columns;
+                float step = 1.f / (float) columns;
+                uint32_t slot = tree.add(grid, {u, v}, {u + step, v + step}, {1.f, 1.f}, {-1.f, -1.f});
+                tree.add(slot, {0.5f, 0.5f}, {0.5f, 0.5f}, {-16.f, -16.f}, {16.f, 16.f});
+                tree.add(slot, {1.f, 1.f}, {1.f, 1.f}, {-20.f, -10.f}, {-2.f, -2.f});
+                tree.add(slot, {0.f, 0.f}, {1.f, 0.f}, {0.f, 0.f}, {0.f, 2.f});
+            }
+        }
+        //moves every parent behind its first child so the input is not already in depth order
+        std::vector<uint32_t> order(tree.rules.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = (uint32_t) order.size() - 1 - i;
+        }
+        Tree reversed;
+        std::vector<uint32_t> newIndex(order.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            newIndex[order[i]] = i;
+        }
+        for (uint32_t i = 0; i < order.size(); i++) {
+            uint32_t old = order[i];
+            reversed.rules.push_back(tree.rules[old]);
+            reversed.parents.push_back(tree.parents[old] == SGE::AnchorLayout::window ? SGE::AnchorLayout::window
+                                                                                      : newIndex[tree.parents[old]]);
+        }
+        return reversed;
+    }
+
+    SGE::UIRect solve(const Tree &tree, uint32_t element, float width, float height) {
+        SGE::UIRect parent{0.f, 0.f, width, height};
+        if (tree.parents[element] != SGE::AnchorLayout::window)
+            parent = solve(tree, tree.parents[element], width, height);
+        const SGE::AnchorRule &rule = tree.rules[element];
+        float parentWidth = parent.right - parent.left, parentHeight = parent.bottom - parent.top;
+        return {parent.left + parentWidth * rule.anchorMin.x + rule.offsetMin.x,
+                parent.top + parentHeight * rule.anchorMin.y + rule.offsetMin.y,
+                parent.left + parentWidth * rule.anchorMax.x + rule.offsetMax.x,
+                parent.top + parentHeight * rule.anchorMax.y + rule.offsetMax.y};
+    }
+
+    double milliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t windows = 8, slots = 400, iterations = 100;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--windows" && i + 1 < argc) {
+            windows = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--slots" && i + 1 < argc) {
+            slots = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    Tree tree = makeInventory(windows, slots);
+    SGE::AnchorLayout layout;
+    std::string error;
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (!layout.build(tree.rules, tree.parents, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+    auto built = Clock::now();
+    //a different window size every time, like dragging the corner of the window
+    for (uint32_t i = 0; i < iterations; i++) {
+        layout.compute(1280.f + (float) i, 720.f + (float) i * 0.5f);
+    }
+    auto computed = Clock::now();
+
+    float width = 1280.f + (float) (iterations - 1), height = 720.f + (float) (iterations - 1) * 0.5f;
+    for (uint32_t element = 0; element < tree.rules.size(); element++) {
+        SGE::UIRect expected = solve(tree, element, width, height);
+        SGE::UIRect rect = layout.getRect(element);
+        if (std::abs(rect.left - expected.left) > 0.01f || std::abs(rect.top - expected.top) > 0.01f ||
+            std::abs(rect.right - expected.right) > 0.01f || std::abs(rect.bottom - expected.bottom) > 0.01f) {
+            std::cerr << "element " << element << " is misplaced" << std::endl;
+            return 1;
+        }
+    }
+
+    //a parent cycle is reported and the elements in it still get placed
+    Tree cyclic = tree;
+    cyclic.parents[0] = (uint32_t) cyclic.rules.size() - 1;
+    cyclic.parents.back() = 0;
+    if (layout.build(cyclic.rules, cyclic.parents, error)) {
+        std::cerr << "a parent cycle went unnoticed" << std::endl;
+        return 1;
+    }
+
+    std::cout << layout.getElementCount() << " elements " << layout.getDepth() << " levels deep" << std::endl;
+    std::cout << "build " << milliseconds(built - start) / iterations << " ms, layout "
+              << milliseconds(computed - built) * 1000.0 / iterations << " us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Particles.h"
+
+//runs one emitter at the rate that keeps the requested number of particles alive at 60 frames a second, after a
+//lifetime of warm up frames times spawning, updating and writing the instance matrices of each frame. The
+//particles are launched without spread so every one of them can be checked against the closed form of the
+//integration for its age.
+//run as ParticleBench [--particles n] [--frames n] [--lifetime seconds]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double milliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t particles = 1000000, frames = 120;
+    float lifetime = 2.f;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--particles" && i + 1 < argc) {
+            particles = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--frames" && i + 1 < argc) {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--lifetime" && i + 1 < argc) {
+            lifetime = std::max(0.1f, std::strtof(argv[++i], nullptr));
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    const float dt = 1.f / 60.f;
+    const auto lifetimeFrames = (uint32_t) std::ceil(lifetime / dt);
+    const uint32_t perFrame = (particles + lifetimeFrames - 1) / lifetimeFrames;
+    const glm::vec3 gravity(0.f, -9.8f, 0.f);
+    SGE::ParticleSpawn spawn;
+    spawn.position = {1.f, 2.f, 3.f};
+    spawn.velocity = {0.5f, 6.f, -0.25f};
+    spawn.lifetime = lifetime;
+    spawn.size = 0.1f;
+
+    SGE::ParticlePool pool(particles);
+    std::vector<SGE::InstanceData> instances(particles);
+    Clock::duration spawning{}, updating{}, writing{};
+    for (uint32_t frame = 0; frame < lifetimeFrames + frames; frame++) {
+        auto start = Clock::now();
+        pool.spawn(perFrame, spawn);
+        auto spawned = Clock::now();
+        pool.update(dt, gravity);
+        auto updated = Clock::now();
+        pool.writeInstances(instances.data());
+        auto written = Clock::now();
+        if (frame >= lifetimeFrames) {
+            spawning += spawned - start;
+            updating += updated - spawned;
+            writing += written - updated;
+        }
+    }
+
+    //after n steps v = v0 + n g dt and p = p0 + v0 n dt + g dt^2 n (n + 1) / 2
+    for (uint32_t particle = 0; particle < pool.size(); particle++) {
+        float steps = std::round(pool.getAge(particle) / dt);
+        glm::vec3 expected = spawn.position + spawn.velocity * (steps * dt) +
+                             gravity * (dt * dt * steps * (steps + 1.f) * 0.5f);
+        glm::vec3 position = pool.getPosition(particle);
+        const glm::mat4 &world = instances[particle].world;
+        float scale = spawn.size * std::max(0.f, 1.f - pool.getAge(particle) / lifetime);
+        if (std::abs(position.x - expected.x) > 1e-3f || std::abs(position.y - expected.y) > 1e-3f ||
+            std::abs(position.z - expected.z) > 1e-3f || pool.getAge(particle) >= lifetime) {
+            std::cerr << "particle " << particle << " is off its path" << std::endl;
+            return 1;
+        }
+        if (world[3].x != position.x || world[3].y != position.y || world[3].z != position.z ||
+            std::abs(world[0].x - scale) > 1e-6f) {
+            std::cerr << "particle " << particle << " has a wrong instance matrix" << std::endl;
+            return 1;
+        }
+    }
+    if (pool.size() + perFrame < std::min(particles, perFrame * (lifetimeFrames - 1))) {
+        std::cerr << "only " << pool.size() << " particles alive" << std::endl;
+        return 1;
+    }
+
+    double total = milliseconds(spawning + updating + writing) / frames;
+    std::cout << pool.size() << " particles alive, " << perFrame << " spawned per frame" << std::endl;
+    std::cout << "spawn " << milliseconds(spawning) / frames << " ms, update " << milliseconds(updating) / frames
+              << " ms, instances " << milliseconds(writing) / frames << " ms, frame " << total << " ms" << std::endl;
+    return 0;
+}
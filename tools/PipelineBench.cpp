@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "PipelineCache.h"
+
+//runs the pipeline cache against a stub device that counts the shaders it compiles and the pipelines it creates.
+//Checks that an identical description is served from the cache, that changing any one field the hash covers creates
+//a new pipeline while renaming does not, and that a second cache over the same directory loads every shader from
+//disk instead of compiling it. Afterwards many generated descriptions are looked up and timed.
+//run as PipelineBench [--pipelines n] [--lookups n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using namespace SGE;
+
+    //the stub has no pipeline objects to hand out, so pipelines are told apart by how many were created
+    class StubPipelineDevice : public PipelineDevice {
+    public:
+        explicit StubPipelineDevice(std::string backend) : backend(std::move(backend)) {}
+
+        std::string getBackendName() const override {
+            return backend;
+        }
+
+        bool canLoadBytecode() const override {
+            return true;
+        }
+
+        bool compileShader(const ShaderSource &shader, std::vector<uint8_t> &bytecode, std::string &error) override {
+            if (shader.source.empty()) {
+                error = "Shader " + shader.name + " has no source";
+                return false;
+            }
+            compiles++;
+            bytecode = fakeBytecode(shader);
+            return true;
+        }
+
+        bool createPipeline(const PipelineDesc &desc, const std::vector<uint8_t> &vertexBytecode,
+                            const std::vector<uint8_t> &pixelBytecode,
+                            Diligent::RefCntAutoPtr<Diligent::IPipelineState> &, std::string &error) override {
+            //bytecode read back from disk has to be what was compiled for exactly these shaders
+            if (vertexBytecode != fakeBytecode(desc.vertexShader) || pixelBytecode != fakeBytecode(desc.pixelShader)) {
+                error = "Pipeline " + desc.name + " was given the bytecode of other shaders";
+                return false;
+            }
+            creates++;
+            return true;
+        }
+
+        static std::vector<uint8_t> fakeBytecode(const ShaderSource &shader) {
+            std::vector<uint8_t> bytecode(shader.source.begin(), shader.source.end());
+            bytecode.insert(bytecode.end(), shader.entryPoint.begin(), shader.entryPoint.end());
+            bytecode.push_back((uint8_t) shader.type);
+            return bytecode;
+        }
+
+        std::string backend;
+        size_t compiles = 0;
+        size_t creates = 0;
+    };
+
+    PipelineDesc baseDesc() {
+        PipelineDesc desc;
+        desc.name = "Base";
+        desc.vertexShader = {Diligent::SHADER_TYPE_VERTEX, "vs_base", "main", "float4 main() : SV_POSITION"};
+        desc.pixelShader = {Diligent::SHADER_TYPE_PIXEL, "ps_base", "main", "float4 main() : SV_TARGET"};
+        desc.layout.emplace_back(0, 0, 3, Diligent::VT_FLOAT32, false);
+        desc.layout.emplace_back(1, 0, 4, Diligent::VT_FLOAT32, false);
+        desc.rtvFormat = Diligent::TEX_FORMAT_RGBA8_UNORM_SRGB;
+        desc.dsvFormat = Diligent::TEX_FORMAT_D32_FLOAT;
+        return desc;
+    }
+
+    struct Variant {
+        std::string field;
+        std::function<void(PipelineDesc &)> change;
+    };
+
+    //one change per field the pipeline hash covers
+    std::vector<Variant> keyVariants() {
+        return {
+                {"vertex source",        [](PipelineDesc &d) { d.vertexShader.source += " "; }},
+                {"pixel source",         [](PipelineDesc &d) { d.pixelShader.source += " "; }},
+                {"vertex entry point",   [](PipelineDesc &d) { d.vertexShader.entryPoint = "vertexMain"; }},
+                {"pixel entry point",    [](PipelineDesc &d) { d.pixelShader.entryPoint = "pixelMain"; }},
+                {"layout size",          [](PipelineDesc &d) { d.layout.pop_back(); }},
+                {"input index",          [](PipelineDesc &d) { d.layout[1].InputIndex = 2; }},
+                {"buffer slot",          [](PipelineDesc &d) { d.layout[1].BufferSlot = 1; }},
+                {"component count",      [](PipelineDesc &d) { d.layout[1].NumComponents = 2; }},
+                {"value type",           [](PipelineDesc &d) { d.layout[1].ValueType = Diligent::VT_FLOAT16; }},
+                {"normalized",           [](PipelineDesc &d) { d.layout[1].IsNormalized = true; }},
+                {"relative offset",      [](PipelineDesc &d) { d.layout[1].RelativeOffset = 12; }},
+                {"stride",               [](PipelineDesc &d) { d.layout[1].Stride = 28; }},
+                {"frequency",            [](PipelineDesc &d) {
+                    d.layout[1].Frequency = Diligent::INPUT_ELEMENT_FREQUENCY_PER_INSTANCE;
+                }},
+                {"instance step rate",   [](PipelineDesc &d) { d.layout[1].InstanceDataStepRate = 2; }},
+                {"render target format", [](PipelineDesc &d) { d.rtvFormat = Diligent::TEX_FORMAT_RGBA8_UNORM; }},
+                {"depth format",         [](PipelineDesc &d) { d.dsvFormat = Diligent::TEX_FORMAT_D24_UNORM_S8_UINT; }},
+                {"topology",             [](PipelineDesc &d) {
+                    d.topology = Diligent::PRIMITIVE_TOPOLOGY_LINE_LIST;
+                }},
+                {"cull mode",            [](PipelineDesc &d) { d.cullMode = Diligent::CULL_MODE_NONE; }},
+                {"fill mode",            [](PipelineDesc &d) { d.fillMode = Diligent::FILL_MODE_WIREFRAME; }},
+                {"depth test",           [](PipelineDesc &d) { d.depthEnable = false; }},
+                {"depth write",          [](PipelineDesc &d) { d.depthWrite = false; }},
+                {"textures",             [](PipelineDesc &d) { d.textures.emplace_back("g_Texture"); }},
+        };
+    }
+
+    bool get(PipelineCache &cache, const PipelineDesc &desc) {
+        Diligent::RefCntAutoPtr<Diligent::IPipelineState> pipeline;
+        std::string error;
+        if (!cache.getPipeline(desc, pipeline, error)) {
+            std::cerr << error << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool checkDeduplication(const std::string &directory) {
+        StubPipelineDevice device("stub");
+        PipelineCache cache(&device, directory);
+        PipelineDesc base = baseDesc();
+        if (!get(cache, base) || !get(cache, base))
+            return false;
+        if (device.creates != 1 || device.compiles != 2 || cache.getPipelineHits() != 1) {
+            std::cerr << "the same description created " << device.creates << " pipelines" << std::endl;
+            return false;
+        }
+
+        //names only label the objects, two descriptions that differ in nothing else share a pipeline
+        PipelineDesc renamed = base;
+        renamed.name = "Renamed";
+        renamed.vertexShader.name = "vs_renamed";
+        renamed.pixelShader.name = "ps_renamed";
+        if (!get(cache, renamed))
+            return false;
+        if (device.creates != 1) {
+            std::cerr << "renaming a description created a pipeline" << std::endl;
+            return false;
+        }
+
+        for (const Variant &variant: keyVariants()) {
+            PipelineDesc desc = base;
+            variant.change(desc);
+            size_t creates = device.creates;
+            if (!get(cache, desc) || !get(cache, desc))
+                return false;
+            if (device.creates != creates + 1) {
+                std::cerr << "changing the " << variant.field << " created " << device.creates - creates
+                          << " pipelines instead of one" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool checkPersistence(const std::string &directory) {
+        std::vector<PipelineDesc> descs{baseDesc()};
+        for (const Variant &variant: keyVariants()) {
+            descs.push_back(baseDesc());
+            variant.change(descs.back());
+        }
+
+        //the first run compiles every distinct shader once and writes it out
+        StubPipelineDevice first("stub");
+        {
+            PipelineCache cache(&first, directory);
+            for (const auto &desc: descs) {
+                if (!get(cache, desc))
+                    return false;
+            }
+        }
+
+        StubPipelineDevice second("stub");
+        PipelineCache cache(&second, directory);
+        for (const auto &desc: descs) {
+            if (!get(cache, desc))
+                return false;
+        }
+        if (second.compiles != 0 || cache.getShaderDiskHits() != first.compiles) {
+            std::cerr << "a second run compiled " << second.compiles << " shaders and loaded "
+                      << cache.getShaderDiskHits() << " of " << first.compiles << " from disk" << std::endl;
+            return false;
+        }
+
+        //bytecode of one backend is never loaded by another
+        StubPipelineDevice other("other");
+        PipelineCache otherCache(&other, directory);
+        if (!get(otherCache, descs[0]))
+            return false;
+        if (other.compiles != 2 || otherCache.getShaderDiskHits() != 0) {
+            std::cerr << "another backend loaded shaders compiled for the stub" << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t pipelineCount = 1000, lookups = 100000;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--pipelines" && i + 1 < argc) {
+            pipelineCount = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--lookups" && i + 1 < argc) {
+            lookups = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::path directory = std::filesystem::temp_directory_path(ec) / "PipelineBench";
+    std::filesystem::remove_all(directory, ec);
+    bool ok = checkDeduplication((directory / "dedup").string()) && checkPersistence((directory / "disk").string());
+    if (!ok) {
+        std::filesystem::remove_all(directory, ec);
+        return 1;
+    }
+
+    //materials that differ in their pixel shader and a few states, the way a scene's pipelines do
+    std::vector<PipelineDesc> descs(pipelineCount, baseDesc());
+    for (uint32_t i = 0; i < pipelineCount; i++) {
+        descs[i].pixelShader.source += "//material " + std::to_string(i / 8);
+        descs[i].cullMode = i % 2 == 0 ? Diligent::CULL_MODE_BACK : Diligent::CULL_MODE_NONE;
+        descs[i].depthWrite = i % 4 < 2;
+        descs[i].topology = i % 8 < 4 ? Diligent::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST :
+                            Diligent::PRIMITIVE_TOPOLOGY_LINE_LIST;
+    }
+    StubPipelineDevice device("stub");
+    PipelineCache cache(&device, (directory / "bench").string());
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < lookups; i++) {
+        if (!get(cache, descs[i % pipelineCount])) {
+            std::filesystem::remove_all(directory, ec);
+            return 1;
+        }
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    std::filesystem::remove_all(directory, ec);
+    if (device.creates != std::min(pipelineCount, lookups)) {
+        std::cerr << pipelineCount << " distinct descriptions created " << device.creates << " pipelines"
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << device.creates << " pipelines from " << device.compiles << " shaders, " << lookups << " lookups at "
+              << elapsed * 1000.0 / lookups << " ns each" << std::endl;
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RangeAllocator.h"
+
+//fuzzes the range allocator behind GeometryPool against a plain map of the live allocations. Every allocation has to
+//land inside the range clear of all others, and has to succeed whenever the map still has a gap large enough. The
+//used size, allocation count and largest free block are compared after every step. Defragmenting is checked by
+//applying its moves to a buffer tagged with the owner of every element, each allocation has to come out packed in
+//offset order with its contents intact. Afterwards a long allocate and free mix and a defragment are timed.
+//run as RangeBench [--operations n] [--seed n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using namespace SGE;
+
+    //offset to size of every live allocation, and the owner of every element so moves can be followed
+    struct Reference {
+        std::map<uint64_t, uint64_t> live;
+        std::vector<int64_t> owners;
+        uint64_t used = 0;
+
+        uint64_t largestGap(uint64_t capacity) const {
+            uint64_t end = 0, largest = 0;
+            for (const auto &[offset, size]: live) {
+                largest = std::max(largest, offset - end);
+                end = offset + size;
+            }
+            return std::max(largest, capacity - end);
+        }
+
+        bool fits(uint64_t offset, uint64_t size, uint64_t capacity) const {
+            if (offset + size > capacity)
+                return false;
+            auto next = live.upper_bound(offset);
+            if (next != live.end() && offset + size > next->first)
+                return false;
+            return next == live.begin() || std::prev(next)->first + std::prev(next)->second <= offset;
+        }
+
+        void add(uint64_t offset, uint64_t size) {
+            live[offset] = size;
+            used += size;
+            std::fill(owners.begin() + (int64_t) offset, owners.begin() + (int64_t) (offset + size), (int64_t) offset);
+        }
+    };
+
+    bool checkDefragment(RangeAllocator &allocator, Reference &reference) {
+        std::vector<int64_t> owners = reference.owners;
+        for (const auto &move: allocator.defragment()) {
+            std::copy(owners.begin() + (int64_t) move.from, owners.begin() + (int64_t) (move.from + move.size),
+                      owners.begin() + (int64_t) move.to);
+        }
+
+        std::map<uint64_t, uint64_t> packed;
+        uint64_t end = 0;
+        for (const auto &[offset, size]: reference.live) {
+            for (uint64_t i = end; i < end + size; i++) {
+                if (owners[i] != (int64_t) offset) {
+                    std::cerr << "defragmenting lost the contents of the allocation at " << offset << std::endl;
+                    return false;
+                }
+            }
+            packed[end] = size;
+            end += size;
+        }
+        if (allocator.getFragmentation() != 0.f || allocator.getLargestFreeBlock() != allocator.getCapacity() - end) {
+            std::cerr << "defragmenting left " << allocator.getFragmentation() << " of the free space scattered"
+                      << std::endl;
+            return false;
+        }
+
+        //the packed allocations are freed by their new offsets from here on
+        reference.live.clear();
+        reference.used = 0;
+        std::fill(reference.owners.begin(), reference.owners.end(), -1);
+        for (const auto &[offset, size]: packed) {
+            reference.add(offset, size);
+        }
+        return true;
+    }
+
+    bool checkRandom(std::mt19937_64 &rng, uint32_t rounds) {
+        for (uint32_t round = 0; round < rounds; round++) {
+            RangeAllocator allocator(1000 + rng() % 100000);
+            Reference reference;
+            reference.owners.assign(allocator.getCapacity(), -1);
+            for (int step = 0; step < 5000; step++) {
+                uint32_t action = rng() % 100;
+                if (action < 55) {
+                    //mostly small meshes with the occasional large one
+                    uint64_t size = 1 + rng() % (rng() % 2 == 0 ? 64 : 4000);
+                    uint64_t offset = allocator.allocate(size);
+                    if (offset == RangeAllocator::invalidOffset) {
+                        if (reference.largestGap(allocator.getCapacity()) >= size) {
+                            std::cerr << "an allocation of " << size << " failed with a gap of "
+                                      << reference.largestGap(allocator.getCapacity()) << " free" << std::endl;
+                            return false;
+                        }
+                    } else if (!reference.fits(offset, size, allocator.getCapacity())) {
+                        std::cerr << "offset " << offset << " of size " << size
+                                  << " overlaps a live allocation or the end of the range" << std::endl;
+                        return false;
+                    } else {
+                        reference.add(offset, size);
+                    }
+                } else if (action < 95 && !reference.live.empty()) {
+                    auto it = std::next(reference.live.begin(), (int64_t) (rng() % reference.live.size()));
+                    allocator.free(it->first);
+                    reference.used -= it->second;
+                    reference.live.erase(it);
+                } else if (action < 97) {
+                    allocator.grow(allocator.getCapacity() + rng() % 5000);
+                    reference.owners.resize(allocator.getCapacity(), -1);
+                } else if (!checkDefragment(allocator, reference)) {
+                    return false;
+                }
+
+                if (allocator.getUsedSize() != reference.used ||
+                    allocator.getAllocationCount() != reference.live.size() ||
+                    allocator.getLargestFreeBlock() != reference.largestGap(allocator.getCapacity())) {
+                    std::cerr << "the allocator reports " << allocator.getUsedSize() << " used in "
+                              << allocator.getAllocationCount() << " allocations with a largest free block of "
+                              << allocator.getLargestFreeBlock() << ", expected " << reference.used << " in "
+                              << reference.live.size() << " with "
+                              << reference.largestGap(allocator.getCapacity()) << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t operations = 1000000;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--operations" && i + 1 < argc) {
+            operations = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    std::mt19937_64 rng(seed);
+    if (!checkRandom(rng, 30))
+        return 1;
+
+    //vertex ranges of streamed meshes coming and going around a working set of twenty thousand
+    RangeAllocator allocator(1ull << 30);
+    std::vector<uint64_t> offsets;
+    uint32_t failed = 0;
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < operations; i++) {
+        if (offsets.size() < 20000 || rng() % 2 == 0) {
+            uint64_t offset = allocator.allocate(1 + rng() % 20000);
+            if (offset != RangeAllocator::invalidOffset)
+                offsets.push_back(offset);
+            else
+                failed++;
+        } else {
+            size_t index = rng() % offsets.size();
+            allocator.free(offsets[index]);
+            offsets[index] = offsets.back();
+            offsets.pop_back();
+        }
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    float fragmentation = allocator.getFragmentation();
+
+    start = Clock::now();
+    size_t moves = allocator.defragment().size();
+    double defragmentTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::cout << operations << " operations at " << elapsed * 1000.0 / operations << " ns each, " << failed
+              << " failed, " << offsets.size() << " live with " << fragmentation * 100.f
+              << "% of the free space scattered" << std::endl;
+    std::cout << "defragmenting took " << moves << " moves in " << defragmentTime << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MeshFile.h"
+#include "ProceduralMesh.h"
+#include "RenderList.h"
+#include "RenderQueue.h"
+#include "SoftwareRasterizer.h"
+
+//renders a fixed scene through the engine's render queue and render list into the software rasterizer, without a
+//window or a gpu. Prints the time of every stage and can write the image or compare it to a reference, so render
+//path changes can be measured and image diffed on any machine.
+//run as RenderBench [--mesh file.mesh] [--instances n] [--frames n] [--workers n] [--size w h] [--out image.ppm]
+//[--reference image.ppm]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double milliseconds(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    bool readPpm(const std::string &path, uint32_t &width, uint32_t &height, std::vector<unsigned char> &pixels) {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return false;
+        unsigned max = 0;
+        bool ok = std::fscanf(file, "P6 %u %u %u", &width, &height, &max) == 3 && max == 255 && std::fgetc(file) != EOF;
+        if (ok) {
+            pixels.resize((size_t) width * height * 3);
+            ok = std::fread(pixels.data(), 1, pixels.size(), file) == pixels.size();
+        }
+        std::fclose(file);
+        return ok;
+    }
+
+    //every instance is placed by a fixed generator so runs are comparable
+    uint32_t nextRandom(uint32_t &state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::string meshPath, outPath, referencePath;
+    uint32_t instanceCount = 20000, frames = 20, workers = 8, width = 1280, height = 720;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--mesh" && i + 1 < argc) {
+            meshPath = argv[++i];
+        } else if (option == "--instances" && i + 1 < argc) {
+            instanceCount = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--frames" && i + 1 < argc) {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--workers" && i + 1 < argc) {
+            workers = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--size" && i + 2 < argc) {
+            width = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+            height = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (option == "--reference" && i + 1 < argc) {
+            referencePath = argv[++i];
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+    if (width == 0 || height == 0) {
+        std::cerr << "The image size must not be zero" << std::endl;
+        return 2;
+    }
+
+    SGE::MeshComponent mesh;
+    std::string error;
+    if (!meshPath.empty()) {
+        if (!SGE::MeshFile::read(meshPath, mesh, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    } else {
+        SGE::ProceduralMeshDesc desc;
+        desc.shape = SGE::ProceduralShape::CubeSphere;
+        desc.width = 8;
+        desc.size = 0.5f;
+        SGE::ProceduralMesh::generate(desc, mesh);
+    }
+    std::unordered_map<uint32_t, const SGE::MeshComponent *> meshes{{1, &mesh}};
+
+    //a 60 degree field of view built from tan(30) directly, compilers fold trigonometry at different precisions and
+    //the reference image has to come out the same from every build
+    float top = 0.1f * 0.577350269f, right = top * (float) width / (float) height;
+    glm::mat4 projection = glm::frustum(-right, right, -top, top, 0.1f, 200.f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, 40.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+    glm::mat4 viewProj = projection * view;
+
+    std::vector<glm::mat4> worlds(instanceCount);
+    uint32_t seed = 12345;
+    for (auto &world: worlds) {
+        glm::vec3 position((nextRandom(seed) % 4000) / 100.f - 20.f, (nextRandom(seed) % 2400) / 100.f - 12.f,
+                           (nextRandom(seed) % 3000) / 100.f - 30.f);
+        world = glm::translate(glm::mat4(1.f), position);
+    }
+
+    SGE::RenderQueue queue;
+    SGE::SoftwareRasterizer rasterizer(width, height);
+    rasterizer.setMeshes(&meshes);
+    std::vector<SGE::RasterRecorder> recorders(std::max(workers, 1u), SGE::RasterRecorder(&rasterizer));
+    std::vector<SGE::CommandRecorder *> active;
+
+    double queueTime = 0, recordTime = 0, rasterTime = 0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        auto start = Clock::now();
+        queue.clear();
+        queue.reserve(worlds.size());
+        for (const auto &world: worlds) {
+            glm::vec4 clip = viewProj * world[3];
+            queue.push(1, 1, 0, clip.w != 0.f ? clip.z / clip.w : clip.z, world);
+        }
+        queue.sort();
+        queue.buildBatches();
+        auto queued = Clock::now();
+
+        rasterizer.beginFrame(viewProj, &queue.getInstances());
+        auto ranges = SGE::RenderList::partition(queue.getBatches(), workers);
+        active.clear();
+        for (size_t i = 0; i < ranges.size(); i++) {
+            active.push_back(&recorders[i]);
+        }
+        if (!ranges.empty())
+            SGE::RenderList::record(queue.getBatches(), ranges, active);
+        auto recorded = Clock::now();
+
+        rasterizer.rasterize();
+        auto rasterized = Clock::now();
+
+        queueTime += milliseconds(start, queued);
+        recordTime += milliseconds(queued, recorded);
+        rasterTime += milliseconds(recorded, rasterized);
+    }
+
+    std::cout << instanceCount << " instances, " << rasterizer.getTriangleCount() << " triangles, " << width << "x"
+              << height << ", " << workers << " workers, " << frames << " frames" << std::endl;
+    std::cout << "queue " << queueTime / frames << " ms, record " << recordTime / frames << " ms, rasterize "
+              << rasterTime / frames << " ms, total " << (queueTime + recordTime + rasterTime) / frames
+              << " ms per frame" << std::endl;
+
+    const SGE::Framebuffer &framebuffer = rasterizer.getFramebuffer();
+    if (!outPath.empty() && !framebuffer.writePpm(outPath)) {
+        std::cerr << "Could not write " << outPath << std::endl;
+        return 1;
+    }
+    if (!referencePath.empty()) {
+        uint32_t referenceWidth, referenceHeight;
+        std::vector<unsigned char> reference;
+        if (!readPpm(referencePath, referenceWidth, referenceHeight, reference) || referenceWidth != width ||
+            referenceHeight != height) {
+            std::cerr << "Could not read a " << width << "x" << height << " reference from " << referencePath
+                      << std::endl;
+            return 1;
+        }
+        size_t different = 0;
+        for (size_t i = 0; i < framebuffer.color.size(); i++) {
+            uint32_t pixel = framebuffer.color[i];
+            if (reference[i * 3] != (pixel & 0xff) || reference[i * 3 + 1] != (pixel >> 8 & 0xff) ||
+                reference[i * 3 + 2] != (pixel >> 16 & 0xff))
+                different++;
+        }
+        std::cout << different << " pixels differ from " << referencePath << std::endl;
+        return different == 0 ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "UniformRing.h"
+
+//runs the ring allocator behind UniformRing without a gpu. Checks that offsets honour their alignment, that a
+//request which does not fit before the end of the range wraps around to the start, and that space stays taken until
+//the frame owning it is released as completed. A random stream of allocations, finished frames and completed fences
+//is then checked against a list of every live allocation, and allocating a frame's worth is timed.
+//run as RingBench [--frames n] [--allocations n] [--seed n]
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using namespace SGE;
+
+    struct Allocation {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    bool checkAlignment() {
+        RingAllocator ring(1 << 16);
+        for (uint64_t alignment = 1; alignment <= 256; alignment *= 2) {
+            //an odd size first so the next offset is never already aligned
+            if (ring.allocate(3, 1) == RingAllocator::invalidOffset)
+                return false;
+            uint64_t offset = ring.allocate(64, alignment);
+            if (offset == RingAllocator::invalidOffset || offset % alignment != 0) {
+                std::cerr << "an allocation aligned to " << alignment << " got offset " << offset << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool checkWrapAround() {
+        RingAllocator ring(1000);
+        if (ring.allocate(600, 16) != 0)
+            return false;
+        ring.finishFrame(1);
+        if (ring.allocate(300, 16) != 608)
+            return false;
+        ring.finishFrame(2);
+        ring.releaseCompleted(1);
+
+        //frame 2 ends at 908, the request starts over at zero and the 92 bytes it skipped count as used
+        uint64_t offset = ring.allocate(500, 16);
+        if (offset != 0 || ring.getUsedSize() != 1000 - 600 + 500) {
+            std::cerr << "a wrapped allocation got offset " << offset << " with " << ring.getUsedSize()
+                      << " bytes used" << std::endl;
+            return false;
+        }
+        ring.finishFrame(3);
+        ring.releaseCompleted(3);
+        if (ring.getUsedSize() != 0 || ring.getFramesInFlight() != 0) {
+            std::cerr << ring.getUsedSize() << " bytes stayed used after every frame completed" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool checkFenceBlocking() {
+        RingAllocator ring(1000);
+        if (ring.allocate(600, 16) != 0)
+            return false;
+        ring.finishFrame(1);
+        //frame 1 may still be read by the gpu, its space is not handed out again however often it is asked for
+        for (int attempt = 0; attempt < 4; attempt++) {
+            if (ring.allocate(600, 16) != RingAllocator::invalidOffset) {
+                std::cerr << "space of a frame in flight was reused" << std::endl;
+                return false;
+            }
+        }
+        //a fence that has not reached the frame yet releases nothing
+        ring.releaseCompleted(0);
+        if (ring.allocate(600, 16) != RingAllocator::invalidOffset || ring.getFramesInFlight() != 1)
+            return false;
+        ring.finishFrame(2);
+        ring.releaseCompleted(2);
+        if (ring.allocate(600, 16) != 0) {
+            std::cerr << "space of a completed frame was not reused" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool overlaps(const Allocation &a, const Allocation &b) {
+        return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+    }
+
+    //every allocation handed out has to stay clear of all the ones whose frame has not completed yet
+    bool checkRandom(std::mt19937 &rng, uint32_t rounds) {
+        for (uint32_t round = 0; round < rounds; round++) {
+            uint64_t capacity = 256 + rng() % 4096;
+            RingAllocator ring(capacity);
+            std::deque<std::pair<uint64_t, std::vector<Allocation>>> inFlight;
+            std::vector<Allocation> current;
+            uint64_t frame = 1, completed = 0;
+            for (int step = 0; step < 3000; step++) {
+                uint32_t action = rng() % 10;
+                if (action < 7) {
+                    Allocation allocation{0, 1 + rng() % 200};
+                    uint64_t alignment = 1ull << (rng() % 5);
+                    allocation.offset = ring.allocate(allocation.size, alignment);
+                    if (allocation.offset == RingAllocator::invalidOffset)
+                        continue;
+                    bool clear = allocation.offset % alignment == 0 &&
+                                 allocation.offset + allocation.size <= capacity;
+                    for (const auto &[owner, allocations]: inFlight) {
+                        for (const auto &other: allocations) {
+                            clear &= !overlaps(allocation, other);
+                        }
+                    }
+                    for (const auto &other: current) {
+                        clear &= !overlaps(allocation, other);
+                    }
+                    if (!clear) {
+                        std::cerr << "offset " << allocation.offset << " of size " << allocation.size
+                                  << " overlaps a live allocation or the end of the ring" << std::endl;
+                        return false;
+                    }
+                    current.push_back(allocation);
+                } else if (action < 9) {
+                    ring.finishFrame(frame);
+                    inFlight.emplace_back(frame++, std::move(current));
+                    current.clear();
+                } else if (completed + 1 < frame) {
+                    completed += 1 + rng() % (frame - completed - 1);
+                    ring.releaseCompleted(completed);
+                    while (!inFlight.empty() && inFlight.front().first <= completed)
+                        inFlight.pop_front();
+                }
+            }
+            ring.finishFrame(frame);
+            ring.releaseCompleted(frame);
+            if (ring.getUsedSize() != 0) {
+                std::cerr << ring.getUsedSize() << " bytes stayed used after every frame completed" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t frames = 1000, allocations = 4096, seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--frames" && i + 1 < argc) {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--allocations" && i + 1 < argc) {
+            allocations = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--seed" && i + 1 < argc) {
+            seed = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    std::mt19937 rng(seed);
+    if (!checkAlignment() || !checkWrapAround() || !checkFenceBlocking() || !checkRandom(rng, 200))
+        return 1;
+
+    //instance and constant data the way the renderer writes it, the gpu is two frames behind
+    constexpr uint64_t framesInFlight = 3;
+    std::vector<uint64_t> sizes(allocations);
+    for (auto &size: sizes) {
+        size = 64 * (1 + rng() % 8);
+    }
+    uint64_t perFrame = 0;
+    for (auto size: sizes) {
+        perFrame += size + 255;
+    }
+    RingAllocator ring(perFrame * framesInFlight);
+    auto start = Clock::now();
+    for (uint64_t frame = 1; frame <= frames; frame++) {
+        if (frame > framesInFlight - 1)
+            ring.releaseCompleted(frame - (framesInFlight - 1));
+        for (auto size: sizes) {
+            if (ring.allocate(size, 256) == RingAllocator::invalidOffset) {
+                std::cerr << "frame " << frame << " ran out of room with " << ring.getFramesInFlight()
+                          << " frames in flight" << std::endl;
+                return 1;
+            }
+        }
+        ring.finishFrame(frame);
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    std::cout << frames << " frames of " << allocations << " allocations, " << elapsed * 1000.0 / frames / allocations
+              << " ns per allocation" << std::endl;
+    return 0;
+}
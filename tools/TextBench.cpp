@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TextLayout.h"
+
+//lays out a screen full of generated labels through the glyph and layout caches the way the TextRenderer does every
+//frame, with a few of them changing each frame. Checks that wrapped lines stay inside their width, that every quad
+//samples the glyph it was laid out for and that unchanged strings are served from the cache, then prints the cost
+//of a cold frame, a frame where nothing changed and a frame with changes.
+//run as TextBench [--strings n] [--frames n] [--changes n] [--atlas size] [--out atlas.pgm]
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const char *const words[] = {"health", "mana", "gold", "wood", "stone", "score", "level", "quest", "north",
+                                 "village", "merchant", "bridge", "harvest", "winter", "garrison", "lantern"};
+
+    uint32_t nextRandom(uint32_t &state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    std::string makeLabel(uint32_t &seed) {
+        std::string label;
+        uint32_t count = 1 + nextRandom(seed) % 8;
+        for (uint32_t i = 0; i < count; i++) {
+            if (i > 0)
+                label += ' ';
+            label += words[nextRandom(seed) % (sizeof(words) / sizeof(words[0]))];
+        }
+        return label + ": " + std::to_string(nextRandom(seed) % 100000);
+    }
+
+    struct Label {
+        std::string text;
+        SGE::TextStyle style;
+    };
+
+    //one frame of the TextRenderer: lay every label out and rebuild the batch, again when the glyph cache was
+    //cleared part way
+    void buildBatch(SGE::TextLayoutCache &layouts, SGE::GlyphCache &glyphs, const std::vector<Label> &labels,
+                    SGE::MeshComponent &batch) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            uint32_t generation = glyphs.getGeneration();
+            batch.vertices.clear();
+            batch.indices.clear();
+            for (size_t i = 0; i < labels.size(); i++) {
+                const SGE::TextBlock &block = layouts.layout(labels[i].text, labels[i].style);
+                SGE::TextLayoutCache::appendQuads(block, {0.f, -(float) (i % 64) * 24.f}, glm::vec4(1.f), batch);
+            }
+            if (glyphs.getGeneration() == generation)
+                break;
+        }
+        layouts.endFrame();
+    }
+
+    bool validate(SGE::TextLayoutCache &layouts, SGE::GlyphCache &glyphs, const SGE::GlyphSource &font,
+                  const std::vector<Label> &labels, std::string &error) {
+        std::vector<uint32_t> codepoints;
+        SGE::GlyphBitmap bitmap;
+        const std::vector<uint8_t> &pixels = glyphs.getPixels();
+        for (const auto &label: labels) {
+            const SGE::TextBlock &block = layouts.layout(label.text, label.style);
+            if (block.generation != glyphs.getGeneration()) {
+                error = "\"" + label.text + "\" points into an old glyph cache";
+                return false;
+            }
+            //the bitmap font draws every printable character except the space, in order
+            SGE::TextLayoutCache::decodeUtf8(label.text, codepoints);
+            codepoints.erase(std::remove(codepoints.begin(), codepoints.end(), (uint32_t) ' '), codepoints.end());
+            if (codepoints.size() != block.quads.size()) {
+                error = "\"" + label.text + "\" has " + std::to_string(block.quads.size()) + " quads";
+                return false;
+            }
+            for (size_t i = 0; i < block.quads.size(); i++) {
+                const SGE::GlyphQuad &quad = block.quads[i];
+                if (label.style.maxWidth > 0.f && quad.max.x > label.style.maxWidth) {
+                    error = "\"" + label.text + "\" runs past its width";
+                    return false;
+                }
+                font.rasterize(codepoints[i], label.style.pixelSize, bitmap);
+                auto x0 = (uint32_t) (quad.uvMin.x * (float) glyphs.getWidth() + 0.5f);
+                auto y0 = (uint32_t) (quad.uvMin.y * (float) glyphs.getHeight() + 0.5f);
+                if ((uint32_t) (quad.max.x - quad.min.x) != bitmap.width ||
+                    (uint32_t) (quad.max.y - quad.min.y) != bitmap.height) {
+                    error = "\"" + label.text + "\" has a quad of the wrong size";
+                    return false;
+                }
+                for (uint32_t y = 0; y < bitmap.height; y++) {
+                    if (!std::equal(bitmap.pixels.begin() + (ptrdiff_t) (y * bitmap.width),
+                                    bitmap.pixels.begin() + (ptrdiff_t) ((y + 1) * bitmap.width),
+                                    pixels.begin() + (ptrdiff_t) ((y0 + y) * glyphs.getWidth() + x0))) {
+                        error = "\"" + label.text + "\" samples the wrong glyph";
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    double milliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t stringCount = 2000, frames = 200, changes = 20, atlasSize = 512;
+    std::string out;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--strings" && i + 1 < argc) {
+            stringCount = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--frames" && i + 1 < argc) {
+            frames = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--changes" && i + 1 < argc) {
+            changes = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--atlas" && i + 1 < argc) {
+            atlasSize = std::max(64ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (option == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    //labels in a few sizes, a third of them wrapped into narrow boxes
+    uint32_t seed = 12345;
+    std::vector<Label> labels(stringCount);
+    for (auto &label: labels) {
+        label.text = makeLabel(seed);
+        label.style.pixelSize = 8 + 8 * (nextRandom(seed) % 3);
+        label.style.align = (SGE::TextAlign) (nextRandom(seed) % 3);
+        if (nextRandom(seed) % 3 == 0)
+            label.style.maxWidth = (float) (120 + nextRandom(seed) % 200);
+    }
+
+    SGE::BitmapFont font;
+    SGE::GlyphCache glyphs(&font, atlasSize, atlasSize);
+    SGE::TextLayoutCache layouts(&glyphs);
+    SGE::MeshComponent batch;
+
+    auto start = Clock::now();
+    buildBatch(layouts, glyphs, labels, batch);
+    auto cold = Clock::now() - start;
+    uint64_t rasterized = glyphs.getRasterizedCount();
+
+    //frames where nothing changed only look the strings up
+    uint64_t misses = layouts.getMisses();
+    uint32_t generation = glyphs.getGeneration();
+    start = Clock::now();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        buildBatch(layouts, glyphs, labels, batch);
+    }
+    auto unchanged = (Clock::now() - start) / frames;
+    if (glyphs.getGeneration() != generation) {
+        std::cerr << "the glyph atlas is too small for the text on screen and is cleared every frame" << std::endl;
+        return 1;
+    }
+    if (layouts.getMisses() != misses || glyphs.getRasterizedCount() != rasterized) {
+        std::cerr << "unchanged strings were laid out again" << std::endl;
+        return 1;
+    }
+
+    start = Clock::now();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        for (uint32_t i = 0; i < changes && stringCount > 0; i++) {
+            labels[nextRandom(seed) % stringCount].text = makeLabel(seed);
+        }
+        buildBatch(layouts, glyphs, labels, batch);
+    }
+    auto changed = (Clock::now() - start) / frames;
+    uint64_t changedMisses = layouts.getMisses() - misses;
+
+    std::string error;
+    if (!validate(layouts, glyphs, font, labels, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if (layouts.getBlockCount() > stringCount) {
+        std::cerr << "replaced strings were not evicted" << std::endl;
+        return 1;
+    }
+
+    std::cout << stringCount << " strings, " << batch.vertices.size() / 4 << " quads in one batch, "
+              << glyphs.getGlyphCount() << " glyphs cached in " << atlasSize << "x" << atlasSize << std::endl;
+    std::cout << "cold " << milliseconds(cold) << " ms, unchanged " << milliseconds(unchanged) << " ms, "
+              << changes << " changed " << milliseconds(changed) << " ms per frame, "
+              << changedMisses << " layouts redone" << std::endl;
+
+    if (!out.empty()) {
+        std::ofstream file(out, std::ios::binary | std::ios::trunc);
+        file << "P5\n" << atlasSize << " " << atlasSize << "\n255\n";
+        const std::vector<uint8_t> &pixels = glyphs.getPixels();
+        file.write(reinterpret_cast<const char *>(pixels.data()), (std::streamsize) pixels.size());
+    }
+    return 0;
+}